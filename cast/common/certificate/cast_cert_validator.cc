@@ -12,12 +12,15 @@
 #include <string.h>
 
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <utility>
 
+#include "absl/types/optional.h"
 #include "cast/common/certificate/cast_cert_validator_internal.h"
 #include "cast/common/certificate/cast_crl.h"
 #include "cast/common/certificate/cast_trust_store.h"
+#include "cast/common/certificate/device_cert_cache.h"
 #include "util/osp_logging.h"
 
 namespace openscreen {
@@ -127,36 +130,46 @@ CastDeviceCertPolicy GetAudioPolicy(const std::vector<X509*>& path) {
   return policy;
 }
 
-}  // namespace
-
-Error VerifyDeviceCert(const std::vector<std::string>& der_certs,
-                       const DateTime& time,
-                       std::unique_ptr<CertVerificationContext>* context,
-                       CastDeviceCertPolicy* policy,
-                       const CastCRL* crl,
-                       CRLPolicy crl_policy,
-                       TrustStore* trust_store) {
-  if (!trust_store) {
-    trust_store = CastTrustStore::GetInstance()->trust_store();
-  }
-
-  // Fail early if CRL is required but not provided.
-  if (!crl && crl_policy == CRLPolicy::kCrlRequired) {
-    return Error::Code::kErrCrlInvalid;
+// Returns the times between which every certificate on |path| is valid.
+bool GetPathValidTimeRange(const std::vector<X509*>& path,
+                           DateTime* not_before,
+                           DateTime* not_after) {
+  for (size_t i = 0; i < path.size(); ++i) {
+    DateTime cert_not_before;
+    DateTime cert_not_after;
+    if (!GetCertValidTimeRange(path[i], &cert_not_before, &cert_not_after)) {
+      return false;
+    }
+    if (i == 0 || *not_before < cert_not_before) {
+      *not_before = cert_not_before;
+    }
+    if (i == 0 || cert_not_after < *not_after) {
+      *not_after = cert_not_after;
+    }
   }
+  return !path.empty();
+}
 
+// Does the work of VerifyDeviceCert(), filling |entry| with the results on
+// success. |crl| is null unless revocation must be checked. Sets |cacheable|
+// if the validity window of |entry| is known, so that it may be cached.
+Error VerifyDeviceCertPath(const std::vector<std::string>& der_certs,
+                           const DateTime& time,
+                           const CastCRL* crl,
+                           TrustStore* trust_store,
+                           DeviceCertCache::Entry* entry,
+                           bool* cacheable) {
   CertificatePathResult result_path = {};
   Error error = FindCertificatePath(der_certs, time, &result_path, trust_store);
   if (!error.ok()) {
     return error;
   }
 
-  if (crl_policy == CRLPolicy::kCrlRequired &&
-      !crl->CheckRevocation(result_path.path, time)) {
+  if (crl && !crl->CheckRevocation(result_path.path, time)) {
     return Error::Code::kErrCertsRevoked;
   }
 
-  *policy = GetAudioPolicy(result_path.path);
+  entry->policy = GetAudioPolicy(result_path.path);
 
   // Finally, make sure there is a common name to give to
   // CertVerificationContextImpl.
@@ -169,13 +182,90 @@ Error VerifyDeviceCert(const std::vector<std::string>& der_certs,
     return Error::Code::kErrCertsRestrictions;
   }
   common_name.resize(len);
+  entry->common_name = std::move(common_name);
+  entry->public_key.reset(X509_get_pubkey(result_path.target_cert.get()));
 
-  context->reset(new CertVerificationContextImpl(
-      bssl::UniquePtr<EVP_PKEY>{X509_get_pubkey(result_path.target_cert.get())},
-      std::move(common_name)));
-
+  *cacheable = GetPathValidTimeRange(result_path.path, &entry->not_before,
+                                     &entry->not_after);
+  if (crl) {
+    if (entry->not_before < crl->not_before()) {
+      entry->not_before = crl->not_before();
+    }
+    if (crl->not_after() < entry->not_after) {
+      entry->not_after = crl->not_after();
+    }
+    entry->crl_not_before = crl->not_before();
+  }
   return Error::Code::kNone;
 }
 
+}  // namespace
+
+Error VerifyDeviceCert(const std::vector<std::string>& der_certs,
+                       const DateTime& time,
+                       std::unique_ptr<CertVerificationContext>* context,
+                       CastDeviceCertPolicy* policy,
+                       const CastCRL* crl,
+                       CRLPolicy crl_policy,
+                       TrustStore* trust_store,
+                       DeviceCertCache* cache) {
+  if (!trust_store) {
+    trust_store = CastTrustStore::GetInstance()->trust_store();
+  }
+
+  // Fail early if CRL is required but not provided.
+  if (!crl && crl_policy == CRLPolicy::kCrlRequired) {
+    return Error::Code::kErrCrlInvalid;
+  }
+
+  // The CRL is only checked if it is required.
+  const CastCRL* checked_crl =
+      (crl_policy == CRLPolicy::kCrlRequired) ? crl : nullptr;
+
+  const auto start_time = std::chrono::steady_clock::now();
+  const auto elapsed = [&start_time] {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_time);
+  };
+
+  absl::optional<std::string> key;
+  if (cache) {
+    if (checked_crl) {
+      cache->OnCrlUsed(*checked_crl);
+    }
+    ErrorOr<std::string> key_or_error =
+        DeviceCertCache::ComputeKey(der_certs, *trust_store, checked_crl);
+    if (key_or_error) {
+      key = std::move(key_or_error.value());
+    }
+    const absl::optional<DeviceCertCache::Entry> entry =
+        key ? cache->Find(*key, time) : absl::nullopt;
+    if (entry) {
+      *policy = entry->policy;
+      context->reset(new CertVerificationContextImpl(
+          bssl::UpRef(entry->public_key), entry->common_name));
+      cache->RecordVerificationTime(true, elapsed());
+      return Error::Code::kNone;
+    }
+  }
+
+  DeviceCertCache::Entry entry;
+  bool cacheable = false;
+  const Error error = VerifyDeviceCertPath(der_certs, time, checked_crl,
+                                           trust_store, &entry, &cacheable);
+  if (error.ok()) {
+    *policy = entry.policy;
+    context->reset(new CertVerificationContextImpl(
+        bssl::UpRef(entry.public_key), entry.common_name));
+    if (cache && key && cacheable) {
+      cache->Insert(std::move(*key), std::move(entry));
+    }
+  }
+  if (cache) {
+    cache->RecordVerificationTime(false, elapsed());
+  }
+  return error;
+}
+
 }  // namespace cast
 }  // namespace openscreen
@@ -42,6 +42,7 @@ enum class DigestAlgorithm {
   kSha512,
 };
 
+class DeviceCertCache;
 struct TrustStore;
 
 // An object of this type is returned by the VerifyDeviceCert function, and can
@@ -93,6 +94,10 @@ class CertVerificationContext {
 //   root CAs during chain verification.  If this is nullptr, the built-in Cast
 //   root certificates will be used.
 //
+// * |cache| is an optional cache of previously verified chains, which is
+//   consulted before verifying |der_certs|, and to which |der_certs| is added
+//   if verified.
+//
 // Outputs:
 //
 // Returns Error::Code::kNone on success.  Otherwise, the corresponding
@@ -110,7 +115,8 @@ class CertVerificationContext {
     CastDeviceCertPolicy* policy,
     const CastCRL* crl,
     CRLPolicy crl_policy,
-    TrustStore* trust_store = nullptr);
+    TrustStore* trust_store = nullptr,
+    DeviceCertCache* cache = nullptr);
 
 }  // namespace cast
 }  // namespace openscreen
@@ -12,6 +12,7 @@
 #include <openssl/x509v3.h>
 #include <time.h>
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <string>
@@ -374,12 +375,31 @@ TrustStore TrustStore::CreateInstanceFromPemFile(absl::string_view file_path) {
   std::vector<std::string> certs = ReadCertificatesFromPemFile(file_path);
   for (const auto& der_cert : certs) {
     const uint8_t* data = (const uint8_t*)der_cert.data();
-    store.certs.emplace_back(d2i_X509(nullptr, &data, der_cert.size()));
+    store.AddCert(
+        bssl::UniquePtr<X509>(d2i_X509(nullptr, &data, der_cert.size())));
   }
 
   return store;
 }
 
+void TrustStore::AddCert(bssl::UniquePtr<X509> cert) {
+  if (cert) {
+    X509_NAME* const subject_name = X509_get_subject_name(cert.get());
+    const uint32_t hash = static_cast<uint32_t>(X509_NAME_hash(subject_name));
+    subject_index_[hash].push_back(static_cast<uint32_t>(certs_.size()));
+  }
+  certs_.push_back(std::move(cert));
+}
+
+const std::vector<uint32_t>& TrustStore::GetCertIndicesForSubject(
+    X509_NAME* name) const {
+  static const std::vector<uint32_t>* const kNoCerts =
+      new std::vector<uint32_t>();
+  const auto it =
+      subject_index_.find(static_cast<uint32_t>(X509_NAME_hash(name)));
+  return (it == subject_index_.end()) ? *kNoCerts : it->second;
+}
+
 bool VerifySignedData(const EVP_MD* digest,
                       EVP_PKEY* public_key,
                       const ConstDataSpan& data,
@@ -484,8 +504,16 @@ Error FindCertificatePath(const std::vector<std::string>& der_certs,
     // The next issuer certificate to add to the current path.
     X509* next_issuer = nullptr;
 
-    for (uint32_t i = trust_store_index; i < trust_store->certs.size(); ++i) {
-      X509* trust_store_cert = trust_store->certs[i].get();
+    // Only the trust anchors whose subject name hashes like the issuer name
+    // are candidates, and they are tried in the order of |trust_store|.
+    const std::vector<uint32_t>& trust_store_candidates =
+        trust_store->GetCertIndicesForSubject(target_issuer_name);
+    for (auto it = std::lower_bound(trust_store_candidates.begin(),
+                                    trust_store_candidates.end(),
+                                    trust_store_index);
+         it != trust_store_candidates.end(); ++it) {
+      const uint32_t i = *it;
+      X509* trust_store_cert = trust_store->certs()[i].get();
       X509_NAME* trust_store_cert_name =
           X509_get_subject_name(trust_store_cert);
       OSP_DVLOG << "FindCertificatePath: Trust store certificate issuer name: "
@@ -512,7 +540,7 @@ Error FindCertificatePath(const std::vector<std::string>& der_certs,
                         first_index)) {
           CertPathStep& next_step = path[--path_index];
           next_step.cert = intermediate_cert;
-          next_step.trust_store_index = trust_store->certs.size();
+          next_step.trust_store_index = trust_store->certs().size();
           next_step.intermediate_cert_index = i + 1;
           next_issuer = intermediate_cert;
           break;
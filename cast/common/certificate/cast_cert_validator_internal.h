@@ -6,8 +6,11 @@
 #define CAST_COMMON_CERTIFICATE_CAST_CERT_VALIDATOR_INTERNAL_H_
 
 #include <openssl/x509.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "absl/strings/string_view.h"
@@ -30,7 +33,24 @@ struct TrustStore {
 
   static TrustStore CreateInstanceFromPemFile(absl::string_view file_path);
 
-  std::vector<bssl::UniquePtr<X509>> certs;
+  // Appends |cert| to the trust anchors, and indexes it by its subject name.
+  void AddCert(bssl::UniquePtr<X509> cert);
+
+  // The trust anchors, in the order they were added.
+  const std::vector<bssl::UniquePtr<X509>>& certs() const { return certs_; }
+
+  // Returns, in increasing order, the indices into certs() of the certificates
+  // whose subject name has the same hash as |name|. Callers must still compare
+  // the names, since different names may share a hash.
+  const std::vector<uint32_t>& GetCertIndicesForSubject(X509_NAME* name) const;
+
+ private:
+  std::vector<bssl::UniquePtr<X509>> certs_;
+
+  // Indices into |certs_| keyed by the X509_NAME_hash() of their subject
+  // names. This is kept up to date by AddCert(), so that lookups never mutate
+  // a TrustStore that may be shared.
+  std::unordered_map<uint32_t, std::vector<uint32_t>> subject_index_;
 };
 
 // Adds a trust anchor given a DER-encoded certificate from static
@@ -7,6 +7,10 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "cast/common/certificate/cast_cert_validator_internal.h"
 #include "cast/common/certificate/testing/test_helpers.h"
 #include "gtest/gtest.h"
@@ -73,7 +77,7 @@ void RunTest(Error::Code expected_result,
       // Add a trust anchor and enforce constraints on it (regular mode for
       // built-in Cast roots).
       fake_trust_store = std::make_unique<TrustStore>();
-      fake_trust_store->certs.emplace_back(fake_root);
+      fake_trust_store->AddCert(bssl::UniquePtr<X509>(fake_root));
       trust_store = fake_trust_store.get();
     }
   }
@@ -625,6 +629,66 @@ TEST(VerifyCastDeviceCertTest, TimeDateConversionValidate) {
   EXPECT_EQ(org_date.year, converted_date.year);
 }
 
+bssl::UniquePtr<X509> ParseCertDer(const std::string& der) {
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(der.data());
+  return bssl::UniquePtr<X509>(d2i_X509(nullptr, &data, der.size()));
+}
+
+// Tests that trust anchors having the same subject name are found in the same
+// bucket of the subject index, in the order they were added.
+TEST(TrustStoreTest, IndexesAnchorsBySubjectName) {
+  const std::vector<std::string> certs = ReadCertificatesFromPemFile(
+      GetSpecificTestDataPath() + "certificates/chromecast_gen1.pem");
+  ASSERT_EQ(2u, certs.size());
+
+  TrustStore trust_store;
+  trust_store.AddCert(ParseCertDer(certs[0]));
+  trust_store.AddCert(ParseCertDer(certs[1]));
+  trust_store.AddCert(ParseCertDer(certs[0]));
+  trust_store.AddCert(ParseCertDer(certs[0]));
+  ASSERT_EQ(4u, trust_store.certs().size());
+  for (const auto& cert : trust_store.certs()) {
+    ASSERT_TRUE(cert);
+  }
+
+  X509_NAME* const device_name =
+      X509_get_subject_name(trust_store.certs()[0].get());
+  X509_NAME* const ica_name =
+      X509_get_subject_name(trust_store.certs()[1].get());
+  ASSERT_NE(0, X509_NAME_cmp(device_name, ica_name));
+  EXPECT_EQ(std::vector<uint32_t>({0, 2, 3}),
+            trust_store.GetCertIndicesForSubject(device_name));
+  EXPECT_EQ(std::vector<uint32_t>({1}),
+            trust_store.GetCertIndicesForSubject(ica_name));
+}
+
+// Tests that trust anchors added after a lookup are found by later lookups.
+TEST(TrustStoreTest, IndexesAnchorsAddedAfterLookup) {
+  const std::vector<std::string> certs = ReadCertificatesFromPemFile(
+      GetSpecificTestDataPath() + "certificates/chromecast_gen1.pem");
+  ASSERT_EQ(2u, certs.size());
+  bssl::UniquePtr<X509> device_cert = ParseCertDer(certs[0]);
+  bssl::UniquePtr<X509> ica_cert = ParseCertDer(certs[1]);
+  ASSERT_TRUE(device_cert);
+  ASSERT_TRUE(ica_cert);
+  X509_NAME* const device_name = X509_get_subject_name(device_cert.get());
+  X509_NAME* const ica_name = X509_get_subject_name(ica_cert.get());
+
+  TrustStore trust_store;
+  EXPECT_TRUE(trust_store.GetCertIndicesForSubject(device_name).empty());
+
+  trust_store.AddCert(std::move(device_cert));
+  EXPECT_EQ(std::vector<uint32_t>({0}),
+            trust_store.GetCertIndicesForSubject(device_name));
+  EXPECT_TRUE(trust_store.GetCertIndicesForSubject(ica_name).empty());
+
+  trust_store.AddCert(std::move(ica_cert));
+  EXPECT_EQ(std::vector<uint32_t>({0}),
+            trust_store.GetCertIndicesForSubject(device_name));
+  EXPECT_EQ(std::vector<uint32_t>({1}),
+            trust_store.GetCertIndicesForSubject(ica_name));
+}
+
 }  // namespace
 }  // namespace cast
 }  // namespace openscreen
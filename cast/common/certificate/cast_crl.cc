@@ -5,9 +5,13 @@
 #include "cast/common/certificate/cast_crl.h"
 
 #include <openssl/digest.h>
+#include <stdint.h>
 #include <time.h>
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
+#include <utility>
 
 #include "absl/strings/string_view.h"
 #include "cast/common/certificate/cast_cert_validator_internal.h"
@@ -52,7 +56,7 @@ class CastCRLTrustStore {
 
  private:
   CastCRLTrustStore() {
-    trust_store_.certs.emplace_back(MakeTrustAnchor(kCastCRLRootCaDer));
+    trust_store_.AddCert(MakeTrustAnchor(kCastCRLRootCaDer));
   }
 
   TrustStore trust_store_;
@@ -137,7 +141,10 @@ bool VerifyCRL(const Crl& crl,
 
 }  // namespace
 
-CastCRL::CastCRL(const TbsCrl& tbs_crl, const DateTime& overall_not_after) {
+CastCRL::CastCRL(const TbsCrl& tbs_crl,
+                 const DateTime& overall_not_after,
+                 std::string fingerprint)
+    : fingerprint_(std::move(fingerprint)) {
   // Parse the validity information.
   // Assume DateTimeFromSeconds will succeed. Successful call to VerifyCRL means
   // that these calls were successful.
@@ -161,6 +168,31 @@ CastCRL::CastCRL(const TbsCrl& tbs_crl, const DateTime& overall_not_after) {
     auto& serial_number_range = revoked_serial_numbers_[issuer_hash];
     serial_number_range.push_back({first_serial_number, last_serial_number});
   }
+
+  // Sort each issuer's ranges and merge the ones that overlap or touch, so that
+  // CheckRevocation() can binary search them.
+  for (auto& issuer_ranges : revoked_serial_numbers_) {
+    std::vector<SerialNumberRange>& ranges = issuer_ranges.second;
+    std::sort(ranges.begin(), ranges.end(),
+              [](const SerialNumberRange& a, const SerialNumberRange& b) {
+                return a.first_serial < b.first_serial;
+              });
+    size_t merged_count = 0;
+    for (const SerialNumberRange& range : ranges) {
+      if (merged_count > 0) {
+        SerialNumberRange& last_merged = ranges[merged_count - 1];
+        if (range.first_serial <= last_merged.last_serial ||
+            (last_merged.last_serial != UINT64_MAX &&
+             range.first_serial == last_merged.last_serial + 1)) {
+          last_merged.last_serial =
+              std::max(last_merged.last_serial, range.last_serial);
+          continue;
+        }
+      }
+      ranges[merged_count++] = range;
+    }
+    ranges.resize(merged_count);
+  }
 }
 
 CastCRL::~CastCRL() {}
@@ -205,11 +237,18 @@ bool CastCRL::CheckRevocation(const std::vector<X509*>& trusted_chain,
           continue;
         }
         serial_number = maybe_serial.value();
-        for (const auto& revoked_serial : issuer_iter->second) {
-          if (revoked_serial.first_serial <= serial_number &&
-              revoked_serial.last_serial >= serial_number) {
-            return false;
-          }
+
+        // Find the last range starting at or before |serial_number|. Since the
+        // ranges are disjoint, it is the only one that may contain it.
+        const std::vector<SerialNumberRange>& ranges = issuer_iter->second;
+        const auto next_range = std::upper_bound(
+            ranges.begin(), ranges.end(), serial_number,
+            [](uint64_t serial, const SerialNumberRange& range) {
+              return serial < range.first_serial;
+            });
+        if (next_range != ranges.begin() &&
+            std::prev(next_range)->last_serial >= serial_number) {
+          return false;
         }
       }
     }
@@ -242,8 +281,13 @@ std::unique_ptr<CastCRL> ParseAndVerifyCRL(const std::string& crl_proto,
     if (!VerifyCRL(crl, tbs_crl, time, trust_store, &overall_not_after)) {
       return nullptr;
     }
+    ErrorOr<std::string> fingerprint = SHA256HashString(crl.tbs_crl());
+    if (!fingerprint) {
+      return nullptr;
+    }
     // TODO(btolsch): Why is this 'return first successful CRL'?
-    return std::make_unique<CastCRL>(tbs_crl, overall_not_after);
+    return std::make_unique<CastCRL>(tbs_crl, overall_not_after,
+                                     std::move(fingerprint.value()));
   }
   return nullptr;
 }
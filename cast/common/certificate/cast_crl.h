@@ -31,9 +31,17 @@ using SerialNumberRange = ::cast::certificate::SerialNumberRange;
 // the binary in a protobuf message.
 class CastCRL {
  public:
-  CastCRL(const TbsCrl& tbs_crl, const DateTime& overall_not_after);
+  // |fingerprint| identifies the CRL, e.g., the SHA-256 hash of its signed
+  // TbsCrl.
+  CastCRL(const TbsCrl& tbs_crl,
+          const DateTime& overall_not_after,
+          std::string fingerprint);
   ~CastCRL();
 
+  const DateTime& not_before() const { return not_before_; }
+  const DateTime& not_after() const { return not_after_; }
+  const std::string& fingerprint() const { return fingerprint_; }
+
   // Verifies the revocation status of a cast device certificate given a chain
   // of X.509 certificates.
   //
@@ -57,6 +65,7 @@ class CastCRL {
 
   DateTime not_before_;
   DateTime not_after_;
+  const std::string fingerprint_;
 
   // Revoked public key hashes.
   // The values consist of the SHA256 hash of the SubjectPublicKeyInfo.
@@ -64,7 +73,8 @@ class CastCRL {
 
   // Revoked serial number ranges indexed by issuer public key hash.
   // The key is the SHA256 hash of issuer's SubjectPublicKeyInfo.
-  // The value is a list of revoked serial number ranges.
+  // The value is a list of revoked serial number ranges, sorted and merged so
+  // that they are disjoint, which is searched with a binary search.
   std::unordered_map<std::string, std::vector<SerialNumberRange>>
       revoked_serial_numbers_;
 
@@ -4,6 +4,8 @@
 
 #include "cast/common/certificate/cast_crl.h"
 
+#include <chrono>
+
 #include "cast/common/certificate/cast_cert_validator.h"
 #include "cast/common/certificate/cast_cert_validator_internal.h"
 #include "cast/common/certificate/proto/test_suite.pb.h"
@@ -11,6 +13,8 @@
 #include "gtest/gtest.h"
 #include "platform/test/paths.h"
 #include "testing/util/read_file.h"
+#include "util/crypto/certificate_utils.h"
+#include "util/crypto/sha2.h"
 #include "util/osp_logging.h"
 
 namespace openscreen {
@@ -106,8 +110,8 @@ bool RunTest(const DeviceCertTest& test_case) {
     *cast_trust_store = TrustStore::CreateInstanceFromPemFile(
         GetSpecificTestDataPath() + "certificates/cast_test_root_ca.pem");
 
-    EXPECT_FALSE(crl_trust_store->certs.empty());
-    EXPECT_FALSE(cast_trust_store->certs.empty());
+    EXPECT_FALSE(crl_trust_store->certs().empty());
+    EXPECT_FALSE(cast_trust_store->certs().empty());
   }
 
   std::vector<std::string> der_cert_path;
@@ -199,6 +203,59 @@ TEST(CastCertificateTest, TestSuite1) {
   RunTestSuite(GetSpecificTestDataPath() + "testsuite/testsuite1.pb");
 }
 
+TEST(CastCRLTest, ChecksSerialNumbersAgainstManyOverlappingRanges) {
+  bssl::UniquePtr<EVP_PKEY> key = GenerateRsaKeyPair();
+  ErrorOr<bssl::UniquePtr<X509>> issuer = CreateSelfSignedX509Certificate(
+      "Issuer", std::chrono::hours(24), *key, std::chrono::seconds(0),
+      /* make_ca */ true);
+  ASSERT_TRUE(issuer);
+  ErrorOr<bssl::UniquePtr<X509>> device = CreateSelfSignedX509Certificate(
+      "Device", std::chrono::hours(24), *key, std::chrono::seconds(0),
+      /* make_ca */ false, issuer.value().get(), key.get());
+  ASSERT_TRUE(device);
+  const std::string issuer_hash =
+      SHA256HashString(GetSpkiTlv(issuer.value().get())).value();
+
+  // A large synthetic CRL revoking [100 * i + 1, 100 * i + 10], plus two
+  // ranges that overlap and touch those around 5000, and one for another
+  // issuer that revokes everything.
+  TbsCrl tbs_crl;
+  tbs_crl.set_not_before_seconds(0);
+  tbs_crl.set_not_after_seconds(24 * 60 * 60);
+  const auto add_range = [&tbs_crl](const std::string& hash, uint64_t first,
+                                    uint64_t last) {
+    SerialNumberRange* range = tbs_crl.add_revoked_serial_number_ranges();
+    range->set_issuer_public_key_hash(hash);
+    range->set_first_serial_number(first);
+    range->set_last_serial_number(last);
+  };
+  for (uint64_t i = 0; i < 10000; ++i) {
+    add_range(issuer_hash, 100 * i + 1, 100 * i + 10);
+  }
+  add_range(issuer_hash, 5005, 5020);
+  add_range(issuer_hash, 5021, 5030);
+  add_range("another issuer", 1, UINT64_MAX);
+
+  DateTime not_after;
+  ASSERT_TRUE(DateTimeFromSeconds(24 * 60 * 60, &not_after));
+  const CastCRL crl(tbs_crl, not_after, "fingerprint");
+  DateTime now;
+  ASSERT_TRUE(DateTimeFromSeconds(60 * 60, &now));
+
+  const auto is_revoked = [&](uint64_t serial_number) {
+    EXPECT_TRUE(ASN1_INTEGER_set_uint64(
+        X509_get_serialNumber(device.value().get()), serial_number));
+    return !crl.CheckRevocation({issuer.value().get(), device.value().get()},
+                                now);
+  };
+  for (uint64_t serial_number : {1, 10, 5001, 5015, 5021, 5030, 999910}) {
+    EXPECT_TRUE(is_revoked(serial_number)) << serial_number;
+  }
+  for (uint64_t serial_number : {11, 100, 5000, 5031, 999911, 1000001}) {
+    EXPECT_FALSE(is_revoked(serial_number)) << serial_number;
+  }
+}
+
 }  // namespace
 }  // namespace cast
 }  // namespace openscreen
@@ -62,12 +62,12 @@ CastTrustStore* CastTrustStore::CreateInstanceFromPemFile(
 }
 
 CastTrustStore::CastTrustStore() {
-  trust_store_.certs.emplace_back(MakeTrustAnchor(kCastRootCaDer));
-  trust_store_.certs.emplace_back(MakeTrustAnchor(kEurekaRootCaDer));
+  trust_store_.AddCert(MakeTrustAnchor(kCastRootCaDer));
+  trust_store_.AddCert(MakeTrustAnchor(kEurekaRootCaDer));
 }
 
 CastTrustStore::CastTrustStore(const std::vector<uint8_t>& trust_anchor_der) {
-  trust_store_.certs.emplace_back(MakeTrustAnchor(trust_anchor_der));
+  trust_store_.AddCert(MakeTrustAnchor(trust_anchor_der));
 }
 
 CastTrustStore::CastTrustStore(TrustStore trust_store)
@@ -0,0 +1,173 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/common/certificate/device_cert_cache.h"
+
+#include <openssl/digest.h>
+#include <openssl/x509.h>
+
+#include "cast/common/certificate/cast_cert_validator_internal.h"
+#include "cast/common/certificate/cast_crl.h"
+#include "util/crypto/secure_hash.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+// Hashes |value| prefixed by its length, so that the concatenation of several
+// values cannot be mistaken for a different sequence of values.
+void UpdateWithLengthPrefix(SecureHash* hash, const std::string& value) {
+  const uint32_t length = static_cast<uint32_t>(value.size());
+  const uint8_t length_bytes[] = {
+      static_cast<uint8_t>(length >> 24), static_cast<uint8_t>(length >> 16),
+      static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length)};
+  hash->Update(length_bytes, sizeof(length_bytes));
+  hash->Update(value);
+}
+
+}  // namespace
+
+// static
+constexpr size_t DeviceCertCache::kDefaultCapacity;
+
+// static
+DeviceCertCache* DeviceCertCache::GetInstance() {
+  static DeviceCertCache* cache = new DeviceCertCache();
+  return cache;
+}
+
+DeviceCertCache::DeviceCertCache(size_t capacity) : capacity_(capacity) {
+  OSP_DCHECK_GT(capacity_, 0u);
+}
+
+DeviceCertCache::~DeviceCertCache() = default;
+
+// static
+ErrorOr<std::string> DeviceCertCache::ComputeKey(
+    const std::vector<std::string>& der_certs,
+    const TrustStore& trust_store,
+    const CastCRL* crl) {
+  SecureHash hash(EVP_sha256());
+  for (const std::string& der_cert : der_certs) {
+    UpdateWithLengthPrefix(&hash, der_cert);
+  }
+
+  // The trust anchors are identified by their SHA-256 fingerprints, which
+  // follow an empty value that ends the chain.
+  UpdateWithLengthPrefix(&hash, std::string());
+  for (const auto& anchor : trust_store.certs()) {
+    uint8_t digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_length = 0;
+    if (!X509_digest(anchor.get(), EVP_sha256(), digest, &digest_length)) {
+      return Error::Code::kErrCertsParse;
+    }
+    hash.Update(digest, digest_length);
+  }
+
+  UpdateWithLengthPrefix(&hash, crl ? crl->fingerprint() : std::string());
+
+  std::string key(hash.GetHashLength(), 0);
+  hash.Finish(&key[0]);
+  return key;
+}
+
+absl::optional<DeviceCertCache::Entry> DeviceCertCache::Find(
+    const std::string& key,
+    const DateTime& time) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++metrics_.misses;
+    return absl::nullopt;
+  }
+
+  const EntryList::iterator entry = it->second;
+  if (time < entry->second.not_before || entry->second.not_after < time) {
+    entries_.erase(entry);
+    index_.erase(it);
+    ++metrics_.expirations;
+    ++metrics_.misses;
+    return absl::nullopt;
+  }
+
+  entries_.splice(entries_.begin(), entries_, entry);
+  ++metrics_.hits;
+
+  const Entry& found = entry->second;
+  Entry result;
+  result.public_key = bssl::UpRef(found.public_key);
+  result.common_name = found.common_name;
+  result.policy = found.policy;
+  result.not_before = found.not_before;
+  result.not_after = found.not_after;
+  result.crl_not_before = found.crl_not_before;
+  return result;
+}
+
+void DeviceCertCache::Insert(std::string key, Entry entry) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = index_.find(key);
+  if (it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  } else if (entries_.size() >= capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+    ++metrics_.evictions;
+  }
+
+  entries_.emplace_front(key, std::move(entry));
+  index_.emplace(std::move(key), entries_.begin());
+}
+
+void DeviceCertCache::OnCrlUsed(const CastCRL& crl) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (newest_crl_not_before_ && !(*newest_crl_not_before_ < crl.not_before())) {
+    return;
+  }
+  newest_crl_not_before_ = crl.not_before();
+
+  for (auto entry = entries_.begin(); entry != entries_.end();) {
+    if (entry->second.crl_not_before &&
+        *entry->second.crl_not_before < crl.not_before()) {
+      index_.erase(entry->first);
+      entry = entries_.erase(entry);
+      ++metrics_.invalidations;
+    } else {
+      ++entry;
+    }
+  }
+}
+
+void DeviceCertCache::RecordVerificationTime(
+    bool hit,
+    std::chrono::microseconds elapsed) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (hit) {
+    metrics_.hit_time += elapsed;
+  } else {
+    metrics_.miss_time += elapsed;
+  }
+}
+
+void DeviceCertCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  newest_crl_not_before_ = absl::nullopt;
+}
+
+size_t DeviceCertCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+DeviceCertCache::Metrics DeviceCertCache::metrics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return metrics_;
+}
+
+}  // namespace cast
+}  // namespace openscreen
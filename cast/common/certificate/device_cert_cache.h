@@ -0,0 +1,138 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_COMMON_CERTIFICATE_DEVICE_CERT_CACHE_H_
+#define CAST_COMMON_CERTIFICATE_DEVICE_CERT_CACHE_H_
+
+#include <openssl/evp.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/types/optional.h"
+#include "cast/common/certificate/cast_cert_validator.h"
+#include "cast/common/certificate/types.h"
+#include "platform/base/error.h"
+
+namespace openscreen {
+namespace cast {
+
+class CastCRL;
+struct TrustStore;
+
+// A bounded LRU cache of the device certificate chains that VerifyDeviceCert()
+// has successfully verified. Senders reconnect to the same receivers over and
+// over, and a hit spares parsing the chain, building its path to a trust
+// anchor, and checking it against the CRL again.
+//
+// Entries are keyed by a hash of the DER-encoded chain, the trust anchors it
+// was verified against and, if revocation was checked, the CRL. An entry is
+// only used at times when every certificate on its path (and the CRL) is
+// valid, and the entries checked against a CRL are dropped once a newer CRL is
+// used. Failed verifications are never cached.
+//
+// This class is thread-safe: VerifyDeviceCert() may be called on any thread,
+// and so all of its members are guarded by one mutex.
+class DeviceCertCache {
+ public:
+  // The parts of a successful verification needed to repeat its results.
+  struct Entry {
+    // The public key and Common Name of the device certificate.
+    bssl::UniquePtr<EVP_PKEY> public_key;
+    std::string common_name;
+
+    CastDeviceCertPolicy policy = CastDeviceCertPolicy::kUnrestricted;
+
+    // The times between which the whole verified path, and the CRL if it was
+    // checked, are valid.
+    DateTime not_before = {};
+    DateTime not_after = {};
+
+    // The notBefore time of the CRL the path was checked against, if any.
+    absl::optional<DateTime> crl_not_before;
+  };
+
+  struct Metrics {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    // Entries dropped because they were used outside of their validity
+    // window, because the cache was full, or because a newer CRL was used.
+    uint64_t expirations = 0;
+    uint64_t evictions = 0;
+    uint64_t invalidations = 0;
+
+    // The total time VerifyDeviceCert() spent on hits and on misses.
+    std::chrono::microseconds hit_time{0};
+    std::chrono::microseconds miss_time{0};
+  };
+
+  static constexpr size_t kDefaultCapacity = 512;
+
+  // Returns the cache used by the Cast auth library.
+  static DeviceCertCache* GetInstance();
+
+  explicit DeviceCertCache(size_t capacity = kDefaultCapacity);
+  DeviceCertCache(const DeviceCertCache&) = delete;
+  DeviceCertCache& operator=(const DeviceCertCache&) = delete;
+  ~DeviceCertCache();
+
+  // Returns the key for verifying |der_certs| against the anchors in
+  // |trust_store| and, if it is non-null, |crl|.
+  static ErrorOr<std::string> ComputeKey(
+      const std::vector<std::string>& der_certs,
+      const TrustStore& trust_store,
+      const CastCRL* crl);
+
+  // Returns a copy of the entry for |key| and makes it the most recently used,
+  // if it is valid at |time|. Otherwise, returns nullopt, dropping any entry
+  // for |key|. A copy is returned since other threads may drop the entry at
+  // any time.
+  absl::optional<Entry> Find(const std::string& key, const DateTime& time);
+
+  // Adds |entry| for |key|, evicting the least recently used entry if the
+  // cache is full.
+  void Insert(std::string key, Entry entry);
+
+  // Called whenever a chain is about to be checked against |crl|. If |crl| is
+  // newer than any CRL used before, drops the entries checked against older
+  // ones.
+  void OnCrlUsed(const CastCRL& crl);
+
+  // Adds a VerifyDeviceCert() call that took |elapsed| to the metrics.
+  void RecordVerificationTime(bool hit, std::chrono::microseconds elapsed);
+
+  void Clear();
+
+  size_t size() const;
+  Metrics metrics() const;
+
+ private:
+  using EntryList = std::list<std::pair<std::string, Entry>>;
+
+  const size_t capacity_;
+
+  mutable std::mutex mutex_;
+
+  // Ordered from the most to the least recently used.
+  EntryList entries_ GUARDED_BY(mutex_);
+  std::unordered_map<std::string, EntryList::iterator> index_
+      GUARDED_BY(mutex_);
+
+  absl::optional<DateTime> newest_crl_not_before_ GUARDED_BY(mutex_);
+  Metrics metrics_ GUARDED_BY(mutex_);
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_COMMON_CERTIFICATE_DEVICE_CERT_CACHE_H_
@@ -0,0 +1,193 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/common/certificate/device_cert_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "cast/common/certificate/cast_cert_validator.h"
+#include "cast/common/certificate/cast_cert_validator_internal.h"
+#include "cast/common/certificate/cast_crl.h"
+#include "cast/common/certificate/cast_trust_store.h"
+#include "cast/common/certificate/testing/test_helpers.h"
+#include "gtest/gtest.h"
+#include "platform/test/paths.h"
+#include "util/crypto/pem_helpers.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+DateTime CreateDate(int year, int month, int day) {
+  DateTime time = {};
+  time.year = year;
+  time.month = month;
+  time.day = day;
+  return time;
+}
+
+DeviceCertCache::Entry CreateEntry(const std::string& common_name,
+                                   const DateTime& not_before,
+                                   const DateTime& not_after) {
+  DeviceCertCache::Entry entry;
+  entry.common_name = common_name;
+  entry.not_before = not_before;
+  entry.not_after = not_after;
+  return entry;
+}
+
+// Returns a CRL that is valid from |not_before| for a year.
+std::unique_ptr<CastCRL> CreateCrl(const DateTime& not_before,
+                                   const std::string& fingerprint) {
+  DateTime not_after = not_before;
+  ++not_after.year;
+  TbsCrl tbs_crl;
+  tbs_crl.set_not_before_seconds(DateTimeToSeconds(not_before).count());
+  tbs_crl.set_not_after_seconds(DateTimeToSeconds(not_after).count());
+  return std::make_unique<CastCRL>(tbs_crl, not_after, fingerprint);
+}
+
+const std::string& GetSpecificTestDataPath() {
+  static std::string data_path =
+      GetTestDataPath() + "/cast/common/certificate/";
+  return data_path;
+}
+
+TEST(DeviceCertCacheTest, FindsEntriesWithinTheirValidityWindow) {
+  DeviceCertCache cache;
+  const DateTime now = CreateDate(2020, 6, 1);
+  EXPECT_FALSE(cache.Find("key", now));
+
+  cache.Insert("key", CreateEntry("device", CreateDate(2020, 1, 1),
+                                  CreateDate(2021, 1, 1)));
+  const absl::optional<DeviceCertCache::Entry> entry = cache.Find("key", now);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ("device", entry->common_name);
+  EXPECT_FALSE(cache.Find("other key", now));
+
+  // Once the window has passed, the entry is dropped.
+  EXPECT_FALSE(cache.Find("key", CreateDate(2021, 1, 2)));
+  EXPECT_EQ(0u, cache.size());
+
+  EXPECT_EQ(1u, cache.metrics().hits);
+  EXPECT_EQ(3u, cache.metrics().misses);
+  EXPECT_EQ(1u, cache.metrics().expirations);
+}
+
+TEST(DeviceCertCacheTest, EvictsLeastRecentlyUsedEntries) {
+  DeviceCertCache cache(2);
+  const DateTime now = CreateDate(2020, 6, 1);
+  const DateTime not_before = CreateDate(2020, 1, 1);
+  const DateTime not_after = CreateDate(2021, 1, 1);
+  cache.Insert("a", CreateEntry("a", not_before, not_after));
+  cache.Insert("b", CreateEntry("b", not_before, not_after));
+
+  // Using "a" makes "b" the least recently used.
+  ASSERT_TRUE(cache.Find("a", now));
+  cache.Insert("c", CreateEntry("c", not_before, not_after));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_TRUE(cache.Find("a", now));
+  EXPECT_FALSE(cache.Find("b", now));
+  EXPECT_TRUE(cache.Find("c", now));
+  EXPECT_EQ(1u, cache.metrics().evictions);
+
+  // Replacing an entry evicts nothing.
+  cache.Insert("c", CreateEntry("c2", not_before, not_after));
+  EXPECT_EQ("c2", cache.Find("c", now)->common_name);
+  EXPECT_EQ(1u, cache.metrics().evictions);
+}
+
+TEST(DeviceCertCacheTest, NewerCrlInvalidatesEntriesCheckedAgainstOlderOnes) {
+  DeviceCertCache cache;
+  const DateTime now = CreateDate(2020, 6, 1);
+  const std::unique_ptr<CastCRL> old_crl =
+      CreateCrl(CreateDate(2020, 1, 1), "old");
+  const std::unique_ptr<CastCRL> new_crl =
+      CreateCrl(CreateDate(2020, 5, 1), "new");
+
+  cache.OnCrlUsed(*old_crl);
+  DeviceCertCache::Entry checked =
+      CreateEntry("checked", CreateDate(2020, 1, 1), CreateDate(2021, 1, 1));
+  checked.crl_not_before = old_crl->not_before();
+  cache.Insert("checked", std::move(checked));
+  cache.Insert("unchecked", CreateEntry("unchecked", CreateDate(2020, 1, 1),
+                                        CreateDate(2021, 1, 1)));
+
+  // Using the old CRL again, or an even older one, changes nothing.
+  cache.OnCrlUsed(*old_crl);
+  cache.OnCrlUsed(*CreateCrl(CreateDate(2019, 1, 1), "older"));
+  EXPECT_EQ(2u, cache.size());
+
+  cache.OnCrlUsed(*new_crl);
+  EXPECT_FALSE(cache.Find("checked", now));
+  EXPECT_TRUE(cache.Find("unchecked", now));
+  EXPECT_EQ(1u, cache.metrics().invalidations);
+}
+
+TEST(DeviceCertCacheTest, KeysDependOnChainTrustStoreAndCrl) {
+  const std::vector<std::string> chain = {"device", "intermediate"};
+  TrustStore* const cast_trust_store =
+      CastTrustStore::GetInstance()->trust_store();
+  const TrustStore empty_trust_store;
+  const std::unique_ptr<CastCRL> crl = CreateCrl(CreateDate(2020, 1, 1), "a");
+
+  const std::string key =
+      DeviceCertCache::ComputeKey(chain, *cast_trust_store, nullptr).value();
+  EXPECT_EQ(key,
+            DeviceCertCache::ComputeKey(chain, *cast_trust_store, nullptr)
+                .value());
+  EXPECT_NE(key, DeviceCertCache::ComputeKey({"devicei", "ntermediate"},
+                                             *cast_trust_store, nullptr)
+                     .value());
+  EXPECT_NE(key,
+            DeviceCertCache::ComputeKey(chain, empty_trust_store, nullptr)
+                .value());
+  EXPECT_NE(key,
+            DeviceCertCache::ComputeKey(chain, *cast_trust_store, crl.get())
+                .value());
+}
+
+TEST(DeviceCertCacheTest, VerifyDeviceCertReusesCachedVerifications) {
+  const std::string data_path = GetSpecificTestDataPath();
+  const std::vector<std::string> certs = ReadCertificatesFromPemFile(
+      data_path + "certificates/chromecast_gen1.pem");
+  const testing::SignatureTestData signatures = testing::ReadSignatureTestData(
+      data_path + "signeddata/2ZZBG9_FA8FCA3EF91A.pem");
+
+  DeviceCertCache cache;
+  for (int i = 0; i < 2; ++i) {
+    std::unique_ptr<CertVerificationContext> context;
+    CastDeviceCertPolicy policy;
+    ASSERT_TRUE(VerifyDeviceCert(certs, CreateDate(2016, 4, 1), &context,
+                                 &policy, nullptr, CRLPolicy::kCrlOptional,
+                                 nullptr, &cache)
+                    .ok());
+    ASSERT_TRUE(context);
+    EXPECT_EQ("2ZZBG9 FA8FCA3EF91A", context->GetCommonName());
+    EXPECT_EQ(CastDeviceCertPolicy::kUnrestricted, policy);
+    EXPECT_TRUE(context->VerifySignatureOverData(
+        signatures.sha256, signatures.message, DigestAlgorithm::kSha256));
+  }
+  EXPECT_EQ(1u, cache.metrics().hits);
+  EXPECT_EQ(1u, cache.metrics().misses);
+  EXPECT_EQ(1u, cache.size());
+
+  // The cached verification is not used once the chain has expired.
+  std::unique_ptr<CertVerificationContext> context;
+  CastDeviceCertPolicy policy;
+  EXPECT_EQ(Error::Code::kErrCertsDateInvalid,
+            VerifyDeviceCert(certs, CreateDate(2037, 3, 1), &context, &policy,
+                             nullptr, CRLPolicy::kCrlOptional, nullptr, &cache)
+                .code());
+  EXPECT_EQ(1u, cache.metrics().expirations);
+  EXPECT_EQ(0u, cache.size());
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
@@ -5,6 +5,9 @@
 #ifndef CAST_COMMON_CHANNEL_CAST_MESSAGE_HANDLER_H_
 #define CAST_COMMON_CHANNEL_CAST_MESSAGE_HANDLER_H_
 
+#include <utility>
+
+#include "cast/common/channel/json_payload.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
 
 namespace openscreen {
@@ -21,6 +24,17 @@ class CastMessageHandler {
   virtual void OnMessage(VirtualConnectionRouter* router,
                          CastSocket* socket,
                          ::cast::channel::CastMessage message) = 0;
+
+  // Called by the routers instead of OnMessage(), with a |payload| that is
+  // shared by every handler |message| is delivered to. Handlers that read the
+  // JSON payload of |message| should override this to parse it through
+  // |payload|, which must not be used after this returns.
+  virtual void OnMessageWithPayload(VirtualConnectionRouter* router,
+                                    CastSocket* socket,
+                                    ::cast::channel::CastMessage message,
+                                    const JsonPayload& payload) {
+    OnMessage(router, socket, std::move(message));
+  }
 };
 
 }  // namespace cast
@@ -4,6 +4,8 @@
 
 #include "cast/common/public/cast_socket.h"
 
+#include <utility>
+
 #include "cast/common/channel/message_framer.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
 #include "util/osp_logging.h"
@@ -32,13 +34,41 @@ Error CastSocket::Send(const CastMessage& message) {
     return Error::Code::kSocketClosedFailure;
   }
 
-  const ErrorOr<std::vector<uint8_t>> out =
-      message_serialization::Serialize(message);
-  if (!out) {
-    return out.error();
+  const ErrorOr<size_t> framed_size =
+      message_serialization::GetFramedSize(message);
+  if (!framed_size) {
+    return framed_size.error();
+  }
+
+  // Serialize directly into the connection's send buffer, if possible, to
+  // avoid copying the message.
+  if (uint8_t* const region = connection_->ReserveSend(framed_size.value())) {
+    const Error result = message_serialization::SerializeInto(
+        message, absl::Span<uint8_t>(region, framed_size.value()));
+    if (!result.ok()) {
+      return result;
+    }
+    connection_->CommitSend(framed_size.value());
+    return Error::Code::kNone;
   }
 
-  if (!connection_->Send(out.value().data(), out.value().size())) {
+  std::vector<uint8_t> out(framed_size.value());
+  const Error result = message_serialization::SerializeInto(
+      message, absl::Span<uint8_t>(out));
+  if (!result.ok()) {
+    return result;
+  }
+  if (!connection_->Send(out.data(), out.size())) {
+    return Error::Code::kAgain;
+  }
+  return Error::Code::kNone;
+}
+
+Error CastSocket::SendSerialized(absl::Span<const uint8_t> serialized) {
+  if (state_ == State::kError) {
+    return Error::Code::kSocketClosedFailure;
+  }
+  if (!connection_->Send(serialized.data(), serialized.size())) {
     return Error::Code::kAgain;
   }
   return Error::Code::kNone;
@@ -71,20 +101,41 @@ void CastSocket::OnError(TlsConnection* connection, Error error) {
 }
 
 void CastSocket::OnRead(TlsConnection* connection, std::vector<uint8_t> block) {
+  if (read_buffer_.empty()) {
+    // Nothing is pending from prior reads, so frame the messages directly out
+    // of |block|, and only buffer the partial message left at its end, if any.
+    const size_t consumed = ReadMessages(block);
+    read_buffer_.assign(block.begin() + consumed, block.end());
+    return;
+  }
+
   read_buffer_.insert(read_buffer_.end(), block.begin(), block.end());
-  // NOTE: Read as many messages as possible out of |read_buffer_| since we only
-  // get one callback opportunity for this.
-  do {
+  read_offset_ += ReadMessages(absl::Span<const uint8_t>(
+      read_buffer_.data() + read_offset_, read_buffer_.size() - read_offset_));
+  if (read_offset_ == read_buffer_.size()) {
+    read_buffer_.clear();
+    read_offset_ = 0;
+  } else if (read_offset_ >= read_buffer_.size() - read_offset_) {
+    read_buffer_.erase(read_buffer_.begin(),
+                       read_buffer_.begin() + read_offset_);
+    read_offset_ = 0;
+  }
+}
+
+size_t CastSocket::ReadMessages(absl::Span<const uint8_t> input) {
+  // NOTE: Read as many messages as possible out of |input| since we only get
+  // one callback opportunity for this.
+  size_t consumed = 0;
+  while (consumed < input.size()) {
     ErrorOr<DeserializeResult> message_or_error =
-        message_serialization::TryDeserialize(
-            absl::Span<uint8_t>(&read_buffer_[0], read_buffer_.size()));
+        message_serialization::TryDeserialize(input.subspan(consumed));
     if (!message_or_error) {
-      return;
+      break;
     }
-    read_buffer_.erase(read_buffer_.begin(),
-                       read_buffer_.begin() + message_or_error.value().length);
+    consumed += message_or_error.value().length;
     client_->OnMessage(this, std::move(message_or_error.value().message));
-  } while (!read_buffer_.empty());
+  }
+  return consumed;
 }
 
 int CastSocket::g_next_socket_id_ = 1;
@@ -58,6 +58,25 @@ void CastSocketMessagePort::PostMessage(
     const std::string& destination_sender_id,
     const std::string& message_namespace,
     const std::string& message) {
+  PostCastMessage(destination_sender_id,
+                  MakeSimpleUTF8Message(message_namespace, message));
+}
+
+bool CastSocketMessagePort::SupportsBinaryMessages() const {
+  return true;
+}
+
+void CastSocketMessagePort::PostBinaryMessage(
+    const std::string& destination_sender_id,
+    const std::string& message_namespace,
+    const std::string& message) {
+  PostCastMessage(destination_sender_id,
+                  MakeSimpleBinaryMessage(message_namespace, message));
+}
+
+void CastSocketMessagePort::PostCastMessage(
+    const std::string& destination_sender_id,
+    ::cast::channel::CastMessage message) {
   if (!client_) {
     OSP_DLOG_WARN << "Not posting message due to nullptr client_";
     return;
@@ -74,8 +93,8 @@ void CastSocketMessagePort::PostMessage(
     router_->AddConnection(connection, VirtualConnection::AssociatedData{});
   }
 
-  const Error send_error = router_->Send(
-      std::move(connection), MakeSimpleUTF8Message(message_namespace, message));
+  const Error send_error =
+      router_->Send(std::move(connection), std::move(message));
   if (!send_error.ok()) {
     client_->OnError(std::move(send_error));
   }
@@ -99,8 +118,14 @@ void CastSocketMessagePort::OnMessage(VirtualConnectionRouter* router,
     return;
   }
 
-  client_->OnMessage(message.source_id(), message.namespace_(),
-                     message.payload_utf8());
+  if (message.payload_type() ==
+      ::cast::channel::CastMessage_PayloadType_BINARY) {
+    client_->OnBinaryMessage(message.source_id(), message.namespace_(),
+                             message.payload_binary());
+  } else {
+    client_->OnMessage(message.source_id(), message.namespace_(),
+                       message.payload_utf8());
+  }
 }
 
 }  // namespace cast
@@ -39,6 +39,10 @@ class CastSocketMessagePort : public MessagePort, public CastMessageHandler {
   void PostMessage(const std::string& destination_sender_id,
                    const std::string& message_namespace,
                    const std::string& message) override;
+  bool SupportsBinaryMessages() const override;
+  void PostBinaryMessage(const std::string& destination_sender_id,
+                         const std::string& message_namespace,
+                         const std::string& message) override;
 
   // CastMessageHandler overrides.
   void OnMessage(VirtualConnectionRouter* router,
@@ -46,6 +50,11 @@ class CastSocketMessagePort : public MessagePort, public CastMessageHandler {
                  ::cast::channel::CastMessage message) override;
 
  private:
+  // Sends the |message| over the virtual connection to the
+  // |destination_sender_id|, establishing the connection if necessary.
+  void PostCastMessage(const std::string& destination_sender_id,
+                       ::cast::channel::CastMessage message);
+
   VirtualConnectionRouter* const router_;
   std::string client_sender_id_;
   MessagePort::Client* client_ = nullptr;
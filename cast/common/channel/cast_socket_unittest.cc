@@ -4,6 +4,9 @@
 
 #include "cast/common/public/cast_socket.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "cast/common/channel/message_framer.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
 #include "cast/common/channel/testing/fake_cast_socket.h"
@@ -60,6 +63,34 @@ TEST_F(CastSocketTest, SendMessage) {
   ASSERT_TRUE(socket().Send(message_).ok());
 }
 
+TEST_F(CastSocketTest, SendMessageIntoReservedSpace) {
+  connection().set_reserve_send_enabled(true);
+  EXPECT_CALL(connection(), Send(_, _))
+      .WillOnce(Invoke([this](const void* data, size_t len) {
+        EXPECT_EQ(
+            frame_serial_,
+            std::vector<uint8_t>(reinterpret_cast<const uint8_t*>(data),
+                                 reinterpret_cast<const uint8_t*>(data) + len));
+        return true;
+      }));
+  ASSERT_TRUE(socket().Send(message_).ok());
+}
+
+TEST_F(CastSocketTest, SendSerializedMessage) {
+  EXPECT_CALL(connection(), Send(_, _))
+      .WillOnce(Invoke([this](const void* data, size_t len) {
+        EXPECT_EQ(
+            frame_serial_,
+            std::vector<uint8_t>(reinterpret_cast<const uint8_t*>(data),
+                                 reinterpret_cast<const uint8_t*>(data) + len));
+        return true;
+      }))
+      .WillOnce(Return(false));
+  ASSERT_TRUE(socket().SendSerialized(frame_serial_).ok());
+  EXPECT_EQ(Error::Code::kAgain,
+            socket().SendSerialized(frame_serial_).code());
+}
+
 TEST_F(CastSocketTest, SendMessageEventuallyBlocks) {
   EXPECT_CALL(connection(), Send(_, _))
       .Times(3)
@@ -149,6 +180,31 @@ TEST_F(CastSocketTest, ReadMultipleMessagesPerBlock) {
   connection().OnRead(std::move(send_data));
 }
 
+TEST_F(CastSocketTest, ReadManyMessagesAcrossUnalignedBlocks) {
+  constexpr int kNumMessages = 50;
+  std::vector<uint8_t> stream;
+  for (int i = 0; i < kNumMessages; ++i) {
+    stream.insert(stream.end(), frame_serial_.begin(), frame_serial_.end());
+  }
+
+  // Each block size leaves a different mix of whole and partial messages
+  // buffered between reads.
+  const size_t block_sizes[] = {7, frame_serial_.size() + 3, 1000};
+  for (size_t block_size : block_sizes) {
+    EXPECT_CALL(mock_client(), OnMessage(_, _))
+        .Times(kNumMessages)
+        .WillRepeatedly(Invoke([this](CastSocket* socket, CastMessage message) {
+          EXPECT_EQ(message_.SerializeAsString(), message.SerializeAsString());
+        }));
+    for (size_t offset = 0; offset < stream.size(); offset += block_size) {
+      const size_t end = std::min(offset + block_size, stream.size());
+      connection().OnRead(
+          std::vector<uint8_t>(stream.begin() + offset, stream.begin() + end));
+    }
+    ::testing::Mock::VerifyAndClearExpectations(&mock_client());
+  }
+}
+
 TEST_F(CastSocketTest, SanitizedAddress) {
   std::array<uint8_t, 2> result1 = socket().GetSanitizedIpAddress();
   EXPECT_EQ(result1[0], 1u);
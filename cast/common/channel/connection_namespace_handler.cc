@@ -116,6 +116,14 @@ void ConnectionNamespaceHandler::CloseRemoteConnection(VirtualConnection conn) {
 void ConnectionNamespaceHandler::OnMessage(VirtualConnectionRouter* router,
                                            CastSocket* socket,
                                            CastMessage message) {
+  OnMessageWithPayload(router, socket, std::move(message), JsonPayload());
+}
+
+void ConnectionNamespaceHandler::OnMessageWithPayload(
+    VirtualConnectionRouter* router,
+    CastSocket* socket,
+    CastMessage message,
+    const JsonPayload& payload) {
   if (message.destination_id() == kBroadcastId ||
       message.source_id() == kBroadcastId ||
       message.payload_type() !=
@@ -123,12 +131,12 @@ void ConnectionNamespaceHandler::OnMessage(VirtualConnectionRouter* router,
     return;
   }
 
-  ErrorOr<Json::Value> result = json::Parse(message.payload_utf8());
+  const ErrorOr<Json::Value>& result = payload.Parse(message);
   if (result.is_error()) {
     return;
   }
 
-  Json::Value& value = result.value();
+  const Json::Value& value = result.value();
   if (!value.isObject()) {
     return;
   }
@@ -145,20 +153,21 @@ void ConnectionNamespaceHandler::OnMessage(VirtualConnectionRouter* router,
 
   absl::string_view type_str = type.value();
   if (type_str == kMessageTypeConnect) {
-    HandleConnect(socket, std::move(message), std::move(value));
+    HandleConnect(socket, std::move(message), value);
   } else if (type_str == kMessageTypeClose) {
-    HandleClose(socket, std::move(message), std::move(value));
+    HandleClose(socket, std::move(message), value);
   } else if (type_str == kMessageTypeConnected) {
-    HandleConnectedResponse(socket, std::move(message), std::move(value));
+    HandleConnectedResponse(socket, std::move(message), value);
   } else {
     // NOTE: Unknown message type so ignore it.
     // TODO(btolsch): Should be included in future error reporting.
   }
 }
 
-void ConnectionNamespaceHandler::HandleConnect(CastSocket* socket,
-                                               CastMessage message,
-                                               Json::Value parsed_message) {
+void ConnectionNamespaceHandler::HandleConnect(
+    CastSocket* socket,
+    CastMessage message,
+    const Json::Value& parsed_message) {
   if (message.destination_id() == kBroadcastId ||
       message.source_id() == kBroadcastId) {
     return;
@@ -234,9 +243,10 @@ void ConnectionNamespaceHandler::HandleConnect(CastSocket* socket,
   vc_router_->AddConnection(std::move(virtual_conn), std::move(data));
 }
 
-void ConnectionNamespaceHandler::HandleClose(CastSocket* socket,
-                                             CastMessage message,
-                                             Json::Value parsed_message) {
+void ConnectionNamespaceHandler::HandleClose(
+    CastSocket* socket,
+    CastMessage message,
+    const Json::Value& parsed_message) {
   const VirtualConnection conn{std::move(*message.mutable_destination_id()),
                                std::move(*message.mutable_source_id()),
                                ToCastSocketId(socket)};
@@ -251,7 +261,7 @@ void ConnectionNamespaceHandler::HandleClose(CastSocket* socket,
 void ConnectionNamespaceHandler::HandleConnectedResponse(
     CastSocket* socket,
     CastMessage message,
-    Json::Value parsed_message) {
+    const Json::Value& parsed_message) {
   const VirtualConnection conn{std::move(message.destination_id()),
                                std::move(message.source_id()),
                                ToCastSocketId(socket)};
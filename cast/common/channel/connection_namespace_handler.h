@@ -63,17 +63,21 @@ class ConnectionNamespaceHandler : public CastMessageHandler {
   void OnMessage(VirtualConnectionRouter* router,
                  CastSocket* socket,
                  ::cast::channel::CastMessage message) override;
+  void OnMessageWithPayload(VirtualConnectionRouter* router,
+                            CastSocket* socket,
+                            ::cast::channel::CastMessage message,
+                            const JsonPayload& payload) override;
 
  private:
   void HandleConnect(CastSocket* socket,
                      ::cast::channel::CastMessage message,
-                     Json::Value parsed_message);
+                     const Json::Value& parsed_message);
   void HandleClose(CastSocket* socket,
                    ::cast::channel::CastMessage message,
-                   Json::Value parsed_message);
+                   const Json::Value& parsed_message);
   void HandleConnectedResponse(CastSocket* socket,
                                ::cast::channel::CastMessage message,
-                               Json::Value parsed_message);
+                               const Json::Value& parsed_message);
 
   void SendConnect(VirtualConnection virtual_conn);
   void SendClose(VirtualConnection virtual_conn);
@@ -0,0 +1,27 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/common/channel/json_payload.h"
+
+#include "util/json/json_serialization.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+JsonPayload::JsonPayload() = default;
+JsonPayload::~JsonPayload() = default;
+
+const ErrorOr<Json::Value>& JsonPayload::Parse(
+    const ::cast::channel::CastMessage& message) const {
+  if (!result_) {
+    result_.emplace(json::Parse(message.payload_utf8()));
+    payload_size_ = message.payload_utf8().size();
+  }
+  OSP_DCHECK_EQ(payload_size_, message.payload_utf8().size());
+  return *result_;
+}
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,49 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_COMMON_CHANNEL_JSON_PAYLOAD_H_
+#define CAST_COMMON_CHANNEL_JSON_PAYLOAD_H_
+
+#include <cstddef>
+
+#include "absl/types/optional.h"
+#include "cast/common/channel/proto/cast_channel.pb.h"
+#include "json/value.h"
+#include "platform/base/error.h"
+
+namespace openscreen {
+namespace cast {
+
+// The JSON value held by the UTF-8 payload of a CastMessage, which is only
+// parsed once it is first asked for. The routers pass one JsonPayload along
+// with each message they dispatch, and share it among all of the handlers a
+// message is delivered to (e.g., for a broadcast), so that a payload is parsed
+// at most once no matter how many handlers read it.
+class JsonPayload {
+ public:
+  JsonPayload();
+  JsonPayload(const JsonPayload&) = delete;
+  JsonPayload& operator=(const JsonPayload&) = delete;
+  ~JsonPayload();
+
+  // Returns the result of parsing the UTF-8 payload of |message| as JSON. The
+  // payload is only parsed by the first call, so every call must pass the
+  // message this JsonPayload was created for, or a copy of it.
+  const ErrorOr<Json::Value>& Parse(
+      const ::cast::channel::CastMessage& message) const;
+
+  bool is_parsed() const { return result_.has_value(); }
+
+ private:
+  mutable absl::optional<ErrorOr<Json::Value>> result_;
+
+  // The size of the parsed payload, used to check that later calls to Parse()
+  // pass the same message.
+  mutable size_t payload_size_ = 0;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_COMMON_CHANNEL_JSON_PAYLOAD_H_
@@ -0,0 +1,45 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/common/channel/json_payload.h"
+
+#include "cast/common/channel/message_util.h"
+#include "gtest/gtest.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using ::cast::channel::CastMessage;
+
+TEST(JsonPayloadTest, ParsesOnlyOnFirstUse) {
+  const CastMessage message =
+      MakeSimpleUTF8Message(kReceiverNamespace, R"({"requestId":17})");
+  const JsonPayload payload;
+  EXPECT_FALSE(payload.is_parsed());
+
+  const ErrorOr<Json::Value>& parsed = payload.Parse(message);
+  EXPECT_TRUE(payload.is_parsed());
+  ASSERT_TRUE(parsed.is_value());
+  EXPECT_EQ(17, parsed.value()["requestId"].asInt());
+
+  // Later calls, including those passing a copy of the message, return the
+  // same result.
+  const CastMessage copy = message;
+  EXPECT_EQ(&parsed, &payload.Parse(message));
+  EXPECT_EQ(&parsed, &payload.Parse(copy));
+}
+
+TEST(JsonPayloadTest, KeepsParseErrors) {
+  const CastMessage message =
+      MakeSimpleUTF8Message(kReceiverNamespace, "{\"requestId\":");
+  const JsonPayload payload;
+  EXPECT_TRUE(payload.Parse(message).is_error());
+  EXPECT_TRUE(payload.is_parsed());
+  EXPECT_TRUE(payload.Parse(message).is_error());
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
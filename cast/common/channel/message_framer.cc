@@ -28,16 +28,40 @@ static constexpr size_t kMaxBodySize = 65536;
 
 ErrorOr<std::vector<uint8_t>> Serialize(
     const ::cast::channel::CastMessage& message) {
+  const ErrorOr<size_t> framed_size = GetFramedSize(message);
+  if (!framed_size) {
+    return framed_size.error();
+  }
+  std::vector<uint8_t> out(framed_size.value(), 0);
+  const Error result = SerializeInto(message, absl::Span<uint8_t>(out));
+  if (!result.ok()) {
+    return result;
+  }
+  return out;
+}
+
+ErrorOr<size_t> GetFramedSize(const ::cast::channel::CastMessage& message) {
   const size_t message_size = message.ByteSizeLong();
   if (message_size > kMaxBodySize || message_size == 0) {
     return Error::Code::kCastV2InvalidMessage;
   }
-  std::vector<uint8_t> out(message_size + kHeaderSize, 0);
+  return kHeaderSize + message_size;
+}
+
+Error SerializeInto(const ::cast::channel::CastMessage& message,
+                    absl::Span<uint8_t> out) {
+  OSP_DCHECK_GT(out.size(), kHeaderSize);
+  const size_t message_size = out.size() - kHeaderSize;
+  if (static_cast<size_t>(message.GetCachedSize()) != message_size) {
+    return Error::Code::kCastV2InvalidMessage;
+  }
   WriteBigEndian<uint32_t>(message_size, out.data());
-  if (!message.SerializeToArray(&out[kHeaderSize], message_size)) {
+  uint8_t* const end =
+      message.SerializeWithCachedSizesToArray(out.data() + kHeaderSize);
+  if (end != out.data() + out.size()) {
     return Error::Code::kCastV2InvalidMessage;
   }
-  return out;
+  return Error::None();
 }
 
 ErrorOr<DeserializeResult> TryDeserialize(absl::Span<const uint8_t> input) {
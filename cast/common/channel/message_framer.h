@@ -24,6 +24,17 @@ namespace message_serialization {
 ErrorOr<std::vector<uint8_t>> Serialize(
     const ::cast::channel::CastMessage& message);
 
+// Returns the number of bytes |message| occupies once framed (i.e., its
+// serialized size plus the header), or an error if it is empty or too large to
+// be sent.
+ErrorOr<size_t> GetFramedSize(const ::cast::channel::CastMessage& message);
+
+// Frames |message| into |out|, which must be exactly the size returned by
+// GetFramedSize(). |message| must not be modified in between, since the sizes
+// computed by GetFramedSize() are re-used.
+Error SerializeInto(const ::cast::channel::CastMessage& message,
+                    absl::Span<uint8_t> out);
+
 struct DeserializeResult {
   ::cast::channel::CastMessage message;
   size_t length;
@@ -91,6 +91,20 @@ TEST_F(CastFramerTest, TestSerializeErrorMessageTooLarge) {
   EXPECT_FALSE(Serialize(big_message));
 }
 
+TEST_F(CastFramerTest, TestSerializeIntoMatchesSerialize) {
+  const ErrorOr<size_t> framed_size = GetFramedSize(cast_message_);
+  ASSERT_TRUE(framed_size);
+  ASSERT_EQ(framed_size.value(), cast_message_serial_.size());
+
+  EXPECT_TRUE(SerializeInto(cast_message_, GetSpan()).ok());
+  EXPECT_TRUE(std::equal(cast_message_serial_.begin(),
+                         cast_message_serial_.end(), buffer_.begin()));
+
+  // The output must be exactly the framed size.
+  EXPECT_FALSE(SerializeInto(cast_message_, GetSpan(framed_size.value() + 1))
+                   .ok());
+}
+
 TEST_F(CastFramerTest, TestCompleteMessageAtOnce) {
   WriteToBuffer(cast_message_serial_);
 
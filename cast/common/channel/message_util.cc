@@ -110,6 +110,16 @@ CastMessage MakeSimpleUTF8Message(const std::string& namespace_,
   return message;
 }
 
+CastMessage MakeSimpleBinaryMessage(const std::string& namespace_,
+                                    std::string payload) {
+  CastMessage message;
+  message.set_protocol_version(kDefaultOutgoingMessageVersion);
+  message.set_namespace_(namespace_);
+  message.set_payload_type(::cast::channel::CastMessage_PayloadType_BINARY);
+  message.set_payload_binary(std::move(payload));
+  return message;
+}
+
 CastMessage MakeConnectMessage(const std::string& source_id,
                                const std::string& destination_id) {
   CastMessage connect_message =
@@ -229,6 +229,9 @@ inline bool IsTransportNamespace(absl::string_view namespace_) {
 ::cast::channel::CastMessage MakeSimpleUTF8Message(
     const std::string& namespace_,
     std::string payload);
+::cast::channel::CastMessage MakeSimpleBinaryMessage(
+    const std::string& namespace_,
+    std::string payload);
 
 ::cast::channel::CastMessage MakeConnectMessage(
     const std::string& source_id,
@@ -4,6 +4,8 @@
 
 #include "cast/common/channel/namespace_router.h"
 
+#include <utility>
+
 #include "cast/common/channel/proto/cast_channel.pb.h"
 
 namespace openscreen {
@@ -24,10 +26,18 @@ void NamespaceRouter::RemoveNamespaceHandler(const std::string& namespace_) {
 void NamespaceRouter::OnMessage(VirtualConnectionRouter* router,
                                 CastSocket* socket,
                                 ::cast::channel::CastMessage message) {
-  const std::string& ns = message.namespace_();
-  auto it = handlers_.find(ns);
+  OnMessageWithPayload(router, socket, std::move(message), JsonPayload());
+}
+
+void NamespaceRouter::OnMessageWithPayload(
+    VirtualConnectionRouter* router,
+    CastSocket* socket,
+    ::cast::channel::CastMessage message,
+    const JsonPayload& payload) {
+  auto it = handlers_.find(message.namespace_());
   if (it != handlers_.end()) {
-    it->second->OnMessage(router, socket, std::move(message));
+    it->second->OnMessageWithPayload(router, socket, std::move(message),
+                                     payload);
   }
 }
 
@@ -26,6 +26,10 @@ class NamespaceRouter final : public CastMessageHandler {
   void OnMessage(VirtualConnectionRouter* router,
                  CastSocket* socket,
                  ::cast::channel::CastMessage message) override;
+  void OnMessageWithPayload(VirtualConnectionRouter* router,
+                            CastSocket* socket,
+                            ::cast::channel::CastMessage message,
+                            const JsonPayload& payload) override;
 
  private:
   std::map<std::string /* namespace */, CastMessageHandler*> handlers_;
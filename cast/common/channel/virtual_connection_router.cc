@@ -5,9 +5,12 @@
 #include "cast/common/channel/virtual_connection_router.h"
 
 #include <utility>
+#include <vector>
 
 #include "cast/common/channel/cast_message_handler.h"
 #include "cast/common/channel/connection_namespace_handler.h"
+#include "cast/common/channel/json_payload.h"
+#include "cast/common/channel/message_framer.h"
 #include "cast/common/channel/message_util.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
 #include "util/osp_logging.h"
@@ -24,18 +27,17 @@ VirtualConnectionRouter::~VirtualConnectionRouter() = default;
 void VirtualConnectionRouter::AddConnection(
     VirtualConnection virtual_connection,
     VirtualConnection::AssociatedData associated_data) {
-  auto& socket_map = connections_[virtual_connection.socket_id];
-  auto local_entries = socket_map.equal_range(virtual_connection.local_id);
-  auto it = std::find_if(
-      local_entries.first, local_entries.second,
-      [&virtual_connection](const std::pair<std::string, VCTail>& entry) {
-        return entry.second.peer_id == virtual_connection.peer_id;
-      });
-  if (it == socket_map.end()) {
-    socket_map.emplace(std::move(virtual_connection.local_id),
-                       VCTail{std::move(virtual_connection.peer_id),
-                              std::move(associated_data)});
+  LocalIdMap& socket_map = connections_[virtual_connection.socket_id];
+  auto local_entry = socket_map.find(virtual_connection.local_id);
+  if (local_entry == socket_map.end()) {
+    socket_ids_by_local_id_[virtual_connection.local_id].insert(
+        virtual_connection.socket_id);
+    local_entry =
+        socket_map.emplace(std::move(virtual_connection.local_id), PeerIdMap())
+            .first;
   }
+  local_entry->second.emplace(std::move(virtual_connection.peer_id),
+                              std::move(associated_data));
 }
 
 bool VirtualConnectionRouter::RemoveConnection(
@@ -46,43 +48,46 @@ bool VirtualConnectionRouter::RemoveConnection(
     return false;
   }
 
-  auto& socket_map = socket_entry->second;
-  auto local_entries = socket_map.equal_range(virtual_connection.local_id);
-  if (local_entries.first == socket_map.end()) {
+  LocalIdMap& socket_map = socket_entry->second;
+  const auto local_entry = socket_map.find(virtual_connection.local_id);
+  if (local_entry == socket_map.end() ||
+      local_entry->second.erase(virtual_connection.peer_id) == 0u) {
     return false;
   }
-  for (auto it = local_entries.first; it != local_entries.second; ++it) {
-    if (it->second.peer_id == virtual_connection.peer_id) {
-      socket_map.erase(it);
-      if (socket_map.empty()) {
-        connections_.erase(socket_entry);
-      }
-      return true;
+  if (local_entry->second.empty()) {
+    socket_map.erase(local_entry);
+    UnindexLocalId(virtual_connection.local_id, virtual_connection.socket_id);
+    if (socket_map.empty()) {
+      connections_.erase(socket_entry);
     }
   }
-  return false;
+  return true;
 }
 
 void VirtualConnectionRouter::RemoveConnectionsByLocalId(
     const std::string& local_id) {
-  for (auto socket_entry = connections_.begin();
-       socket_entry != connections_.end();) {
-    auto& socket_map = socket_entry->second;
-    auto local_entries = socket_map.equal_range(local_id);
-    if (local_entries.first != socket_map.end()) {
-      socket_map.erase(local_entries.first, local_entries.second);
-      if (socket_map.empty()) {
-        socket_entry = connections_.erase(socket_entry);
-        continue;
-      }
+  const auto index_entry = socket_ids_by_local_id_.find(local_id);
+  if (index_entry == socket_ids_by_local_id_.end()) {
+    return;
+  }
+  const std::unordered_set<int> socket_ids = std::move(index_entry->second);
+  socket_ids_by_local_id_.erase(index_entry);
+  for (int socket_id : socket_ids) {
+    const auto socket_entry = connections_.find(socket_id);
+    OSP_DCHECK(socket_entry != connections_.end());
+    socket_entry->second.erase(local_id);
+    if (socket_entry->second.empty()) {
+      connections_.erase(socket_entry);
     }
-    ++socket_entry;
   }
 }
 
 void VirtualConnectionRouter::RemoveConnectionsBySocketId(int socket_id) {
   auto entry = connections_.find(socket_id);
   if (entry != connections_.end()) {
+    for (const auto& local_entry : entry->second) {
+      UnindexLocalId(local_entry.first, socket_id);
+    }
     connections_.erase(entry);
   }
 }
@@ -90,22 +95,13 @@ void VirtualConnectionRouter::RemoveConnectionsBySocketId(int socket_id) {
 absl::optional<const VirtualConnection::AssociatedData*>
 VirtualConnectionRouter::GetConnectionData(
     const VirtualConnection& virtual_connection) const {
-  auto socket_entry = connections_.find(virtual_connection.socket_id);
-  if (socket_entry == connections_.end()) {
+  const VirtualConnection::AssociatedData* const data = FindConnectionData(
+      virtual_connection.socket_id, virtual_connection.local_id,
+      virtual_connection.peer_id);
+  if (!data) {
     return absl::nullopt;
   }
-
-  auto& socket_map = socket_entry->second;
-  auto local_entries = socket_map.equal_range(virtual_connection.local_id);
-  if (local_entries.first == socket_map.end()) {
-    return absl::nullopt;
-  }
-  for (auto it = local_entries.first; it != local_entries.second; ++it) {
-    if (it->second.peer_id == virtual_connection.peer_id) {
-      return &it->second.data;
-    }
-  }
-  return absl::nullopt;
+  return data;
 }
 
 bool VirtualConnectionRouter::AddHandlerForLocalId(
@@ -163,18 +159,28 @@ Error VirtualConnectionRouter::BroadcastFromLocalPeer(
   message.set_source_id(std::move(local_id));
   message.set_destination_id(kBroadcastId);
 
-  // Broadcast to local endpoints.
+  // Broadcast to local endpoints, which share one parse of the payload.
+  const JsonPayload payload;
   for (const auto& entry : endpoints_) {
     if (entry.first != message.source_id()) {
-      entry.second->OnMessage(this, nullptr, message);
+      entry.second->OnMessageWithPayload(this, nullptr, message, payload);
     }
   }
 
-  // Broadcast to remote endpoints. If an Error occurs, continue broadcasting,
-  // and later return the first Error that occurred.
+  // Broadcast to remote endpoints, serializing the message only once. If an
+  // Error occurs, continue broadcasting, and later return the first Error that
+  // occurred.
+  if (sockets_.empty()) {
+    return Error::None();
+  }
+  const ErrorOr<std::vector<uint8_t>> serialized =
+      message_serialization::Serialize(message);
+  if (!serialized) {
+    return serialized.error();
+  }
   Error error;
   for (const auto& entry : sockets_) {
-    auto result = entry.second.socket->Send(message);
+    auto result = entry.second.socket->SendSerialized(serialized.value());
     if (!result.ok() && error.ok()) {
       error = std::move(result);
     }
@@ -200,8 +206,9 @@ void VirtualConnectionRouter::OnMessage(CastSocket* socket,
 
   const std::string& local_id = message.destination_id();
   if (local_id == kBroadcastId) {
+    const JsonPayload payload;
     for (const auto& entry : endpoints_) {
-      entry.second->OnMessage(this, socket, message);
+      entry.second->OnMessageWithPayload(this, socket, message, payload);
     }
   } else {
     // Connection namespace messages are weird: The message.source_id() and
@@ -220,16 +227,43 @@ void VirtualConnectionRouter::OnMessage(CastSocket* socket,
     // Exception: All transport namespace messages (e.g., device auth,
     // heartbeats, etc.); because these are always assumed to have a route.
     if (!IsTransportNamespace(message.namespace_()) &&
-        !GetConnectionData(VirtualConnection{local_id, message.source_id(),
-                                             socket->socket_id()})) {
+        !FindConnectionData(socket->socket_id(), local_id,
+                            message.source_id())) {
       return;
     }
     auto it = endpoints_.find(local_id);
     if (it != endpoints_.end()) {
-      it->second->OnMessage(this, socket, std::move(message));
+      it->second->OnMessageWithPayload(this, socket, std::move(message),
+                                       JsonPayload());
     }
   }
 }
 
+const VirtualConnection::AssociatedData*
+VirtualConnectionRouter::FindConnectionData(int socket_id,
+                                            const std::string& local_id,
+                                            const std::string& peer_id) const {
+  const auto socket_entry = connections_.find(socket_id);
+  if (socket_entry == connections_.end()) {
+    return nullptr;
+  }
+  const auto local_entry = socket_entry->second.find(local_id);
+  if (local_entry == socket_entry->second.end()) {
+    return nullptr;
+  }
+  const auto it = local_entry->second.find(peer_id);
+  return (it == local_entry->second.end()) ? nullptr : &it->second;
+}
+
+void VirtualConnectionRouter::UnindexLocalId(const std::string& local_id,
+                                             int socket_id) {
+  const auto index_entry = socket_ids_by_local_id_.find(local_id);
+  OSP_DCHECK(index_entry != socket_ids_by_local_id_.end());
+  index_entry->second.erase(socket_id);
+  if (index_entry->second.empty()) {
+    socket_ids_by_local_id_.erase(index_entry);
+  }
+}
+
 }  // namespace cast
 }  // namespace openscreen
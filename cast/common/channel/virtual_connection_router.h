@@ -9,6 +9,8 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "absl/types/optional.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
@@ -113,26 +115,42 @@ class VirtualConnectionRouter final : public CastSocket::Client {
   }
 
  private:
-  // This struct simply stores the remainder of the data {VirtualConnection,
-  // VirtualConnection::AssociatedData} that is not broken up into map keys for
-  // |connections_|.
-  struct VCTail {
-    std::string peer_id;
-    VirtualConnection::AssociatedData data;
-  };
+  // The connections on a socket are indexed by local ID, and then by peer ID.
+  // A sender device may multiplex many of its senders (e.g., browser tabs) over
+  // one socket, each with connections to the same local endpoints.
+  using PeerIdMap = std::unordered_map<std::string /* peer_id */,
+                                       VirtualConnection::AssociatedData>;
+  using LocalIdMap =
+      std::unordered_map<std::string /* local_id */, PeerIdMap>;
 
   struct SocketWithHandler {
     std::unique_ptr<CastSocket> socket;
     SocketErrorHandler* error_handler;
   };
 
+  // Returns the AssociatedData for the given connection, or nullptr if it does
+  // not exist.
+  const VirtualConnection::AssociatedData* FindConnectionData(
+      int socket_id,
+      const std::string& local_id,
+      const std::string& peer_id) const;
+
+  // Removes the entry for |socket_id| from |local_id|'s index entry.
+  void UnindexLocalId(const std::string& local_id, int socket_id);
+
   ConnectionNamespaceHandler* connection_handler_ = nullptr;
 
-  std::map<int /* socket_id */,
-           std::multimap<std::string /* local_id */, VCTail>>
-      connections_;
+  std::unordered_map<int /* socket_id */, LocalIdMap> connections_;
+
+  // A secondary index of |connections_|, so that the connections for a local
+  // ID can be removed without visiting every socket.
+  std::unordered_map<std::string /* local_id */,
+                     std::unordered_set<int /* socket_id */>>
+      socket_ids_by_local_id_;
 
   std::map<int, SocketWithHandler> sockets_;
+  // Ordered, so that broadcasts are delivered in a deterministic order, and
+  // since handlers may add more handlers while a broadcast is being delivered.
   std::map<std::string /* local_id */, CastMessageHandler*> endpoints_;
 };
 
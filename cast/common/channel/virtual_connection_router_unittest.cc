@@ -4,9 +4,14 @@
 
 #include "cast/common/channel/virtual_connection_router.h"
 
+#include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "cast/common/channel/cast_message_handler.h"
 #include "cast/common/channel/connection_namespace_handler.h"
+#include "cast/common/channel/json_payload.h"
 #include "cast/common/channel/message_util.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
 #include "cast/common/channel/testing/fake_cast_socket.h"
@@ -38,6 +43,63 @@ using ::testing::Invoke;
 using ::testing::SaveArg;
 using ::testing::WithArg;
 
+// Records whether each message's payload had already been parsed by another
+// handler, and the type of message it parsed as.
+class ParsingHandler final : public CastMessageHandler {
+ public:
+  // CastMessageHandler overrides.
+  void OnMessage(VirtualConnectionRouter* router,
+                 CastSocket* socket,
+                 CastMessage message) override {
+    OnMessageWithPayload(router, socket, std::move(message), JsonPayload());
+  }
+
+  void OnMessageWithPayload(VirtualConnectionRouter* router,
+                            CastSocket* socket,
+                            CastMessage message,
+                            const JsonPayload& payload) override {
+    already_parsed.push_back(payload.is_parsed());
+    const ErrorOr<Json::Value>& parsed = payload.Parse(message);
+    ASSERT_TRUE(parsed.is_value());
+    types.push_back(parsed.value()["type"].asString());
+  }
+
+  std::vector<bool> already_parsed;
+  std::vector<std::string> types;
+};
+
+// Records the local ID of each handler a message is delivered to. The first
+// message delivered to a handler may also cause it to add more handlers.
+class RecordingHandler final : public CastMessageHandler {
+ public:
+  RecordingHandler(std::string local_id, std::vector<std::string>* deliveries)
+      : local_id_(std::move(local_id)), deliveries_(deliveries) {}
+
+  void AddHandlersOnFirstMessage(std::vector<std::string> local_ids) {
+    local_ids_to_add_ = std::move(local_ids);
+  }
+
+  // CastMessageHandler overrides.
+  void OnMessage(VirtualConnectionRouter* router,
+                 CastSocket* socket,
+                 CastMessage message) override {
+    deliveries_->push_back(local_id_);
+    for (std::string& local_id : local_ids_to_add_) {
+      added_handlers_.push_back(
+          std::make_unique<RecordingHandler>(local_id, deliveries_));
+      ASSERT_TRUE(router->AddHandlerForLocalId(std::move(local_id),
+                                               added_handlers_.back().get()));
+    }
+    local_ids_to_add_.clear();
+  }
+
+ private:
+  const std::string local_id_;
+  std::vector<std::string>* const deliveries_;
+  std::vector<std::string> local_ids_to_add_;
+  std::vector<std::unique_ptr<RecordingHandler>> added_handlers_;
+};
+
 class VirtualConnectionRouterTest : public ::testing::Test {
  public:
   void SetUp() override {
@@ -160,6 +222,48 @@ TEST_F(VirtualConnectionRouterTest, RemoveConnectionsByIds) {
   EXPECT_FALSE(local_router_.GetConnectionData(vc3_));
 }
 
+TEST_F(VirtualConnectionRouterTest, ManyConnectionsPerSocket) {
+  // Many senders multiplexed over each of two sockets, all connected to both
+  // local1 and local2.
+  constexpr int kNumPeers = 100;
+  for (int socket_id : {75, 76}) {
+    for (int i = 0; i < kNumPeers; ++i) {
+      const std::string peer_id = "sender-" + std::to_string(i);
+      local_router_.AddConnection({"local1", peer_id, socket_id}, {});
+      local_router_.AddConnection({"local2", peer_id, socket_id}, {});
+    }
+  }
+  EXPECT_TRUE(local_router_.GetConnectionData({"local1", "sender-42", 76}));
+
+  EXPECT_TRUE(local_router_.RemoveConnection(
+      {"local2", "sender-42", 75},
+      VirtualConnection::CloseReason::kClosedBySelf));
+  EXPECT_FALSE(local_router_.GetConnectionData({"local2", "sender-42", 75}));
+  EXPECT_TRUE(local_router_.GetConnectionData({"local2", "sender-42", 76}));
+  EXPECT_TRUE(local_router_.GetConnectionData({"local1", "sender-42", 75}));
+
+  local_router_.RemoveConnectionsByLocalId("local1");
+  for (int socket_id : {75, 76}) {
+    for (int i = 0; i < kNumPeers; ++i) {
+      const std::string peer_id = "sender-" + std::to_string(i);
+      EXPECT_FALSE(
+          local_router_.GetConnectionData({"local1", peer_id, socket_id}));
+      EXPECT_EQ(socket_id == 76 || i != 42,
+                local_router_.GetConnectionData({"local2", peer_id, socket_id})
+                    .has_value());
+    }
+  }
+
+  // local1 can be re-connected after all of its connections were removed.
+  local_router_.AddConnection({"local1", "sender-42", 75}, {});
+  EXPECT_TRUE(local_router_.GetConnectionData({"local1", "sender-42", 75}));
+
+  local_router_.RemoveConnectionsBySocketId(75);
+  local_router_.RemoveConnectionsBySocketId(76);
+  EXPECT_FALSE(local_router_.GetConnectionData({"local1", "sender-42", 75}));
+  EXPECT_FALSE(local_router_.GetConnectionData({"local2", "sender-0", 76}));
+}
+
 TEST_F(VirtualConnectionRouterTest, LocalIdHandler) {
   MockCastMessageHandler mock_message_handler;
   local_router_.AddHandlerForLocalId("receiver-1234", &mock_message_handler);
@@ -214,6 +318,45 @@ TEST_F(VirtualConnectionRouterTest, RemoveLocalIdHandler) {
   local_router_.RemoveHandlerForLocalId("receiver-1234");
 }
 
+// Tests that a local ID's connections and handler are tracked independently.
+TEST_F(VirtualConnectionRouterTest, ReAddLocalIdHandler) {
+  MockCastMessageHandler mock_message_handler;
+  const VirtualConnection vc{"receiver-1234", "sender-9873",
+                             local_socket_->socket_id()};
+  EXPECT_TRUE(local_router_.AddHandlerForLocalId("receiver-1234",
+                                                 &mock_message_handler));
+  EXPECT_FALSE(local_router_.AddHandlerForLocalId("receiver-1234",
+                                                  &mock_message_handler));
+  local_router_.AddConnection(vc, {});
+  local_router_.AddConnection(vc, {});
+
+  EXPECT_TRUE(local_router_.RemoveHandlerForLocalId("receiver-1234"));
+  EXPECT_FALSE(local_router_.RemoveHandlerForLocalId("receiver-1234"));
+  EXPECT_TRUE(local_router_.GetConnectionData(vc));
+  EXPECT_TRUE(local_router_.AddHandlerForLocalId("receiver-1234",
+                                                 &mock_message_handler));
+
+  CastMessage message;
+  message.set_protocol_version(
+      ::cast::channel::CastMessage_ProtocolVersion_CASTV2_1_0);
+  message.set_namespace_("zrqvn");
+  message.set_source_id("sender-9873");
+  message.set_destination_id("receiver-1234");
+  message.set_payload_type(CastMessage::STRING);
+  message.set_payload_utf8("cnlybnq");
+  EXPECT_CALL(mock_message_handler, OnMessage(_, local_socket_, _));
+  EXPECT_TRUE(remote_socket_->Send(message).ok());
+
+  // The connection was only added once, so one removal drops all routing.
+  EXPECT_TRUE(local_router_.RemoveConnection(
+      vc, VirtualConnection::CloseReason::kClosedBySelf));
+  EXPECT_FALSE(local_router_.GetConnectionData(vc));
+  EXPECT_CALL(mock_message_handler, OnMessage(_, _, _)).Times(0);
+  EXPECT_TRUE(remote_socket_->Send(message).ok());
+
+  local_router_.RemoveHandlerForLocalId("receiver-1234");
+}
+
 TEST_F(VirtualConnectionRouterTest, SendMessage) {
   local_router_.AddConnection(VirtualConnection{"receiver-1234", "sender-4321",
                                                 local_socket_->socket_id()},
@@ -387,6 +530,59 @@ TEST_F(VirtualConnectionRouterTest, BroadcastsFromRemoteSource) {
   ASSERT_TRUE(remote_router_.BroadcastFromLocalPeer("wendy", message).ok());
 }
 
+// Tests that all of the local peers a broadcast is delivered to share a single
+// parse of its payload.
+TEST_F(VirtualConnectionRouterTest, BroadcastsParsePayloadOnce) {
+  ParsingHandler alice, bob;
+  local_router_.AddHandlerForLocalId("alice", &alice);
+  local_router_.AddHandlerForLocalId("bob", &bob);
+
+  // Broadcast from both a local and a remote source.
+  const CastMessage message =
+      MakeSimpleUTF8Message("zrqvn", R"({"type":"PING"})");
+  ASSERT_TRUE(local_router_.BroadcastFromLocalPeer("wendy", message).ok());
+  ASSERT_TRUE(remote_router_.BroadcastFromLocalPeer("wendy", message).ok());
+
+  // Whichever peer received each broadcast first parsed it for the other.
+  ASSERT_EQ(2u, alice.already_parsed.size());
+  ASSERT_EQ(2u, bob.already_parsed.size());
+  for (size_t i = 0; i < 2; ++i) {
+    EXPECT_NE(alice.already_parsed[i], bob.already_parsed[i]);
+  }
+  EXPECT_EQ(std::vector<std::string>({"PING", "PING"}), alice.types);
+  EXPECT_EQ(std::vector<std::string>({"PING", "PING"}), bob.types);
+}
+
+// Tests that broadcasts are delivered to the local peers in order of their
+// local IDs, and that a peer may add more handlers while a broadcast is being
+// delivered.
+TEST_F(VirtualConnectionRouterTest, BroadcastsWhileHandlersAreAdded) {
+  std::vector<std::string> deliveries;
+  RecordingHandler mallory("mallory", &deliveries);
+  RecordingHandler zed("zed", &deliveries);
+  local_router_.AddHandlerForLocalId("zed", &zed);
+  local_router_.AddHandlerForLocalId("mallory", &mallory);
+
+  // Enough handlers to re-hash any hash table, all ordered before "mallory."
+  std::vector<std::string> added_ids;
+  for (int i = 0; i < 100; ++i) {
+    added_ids.push_back("alice-" + std::to_string(100 + i));
+  }
+  mallory.AddHandlersOnFirstMessage(added_ids);
+
+  const CastMessage message =
+      MakeSimpleUTF8Message("zrqvn", R"({"type":"PING"})");
+  ASSERT_TRUE(local_router_.BroadcastFromLocalPeer("wendy", message).ok());
+  EXPECT_EQ(std::vector<std::string>({"mallory", "zed"}), deliveries);
+
+  deliveries.clear();
+  ASSERT_TRUE(local_router_.BroadcastFromLocalPeer("wendy", message).ok());
+  std::vector<std::string> expected_deliveries = added_ids;
+  expected_deliveries.push_back("mallory");
+  expected_deliveries.push_back("zed");
+  EXPECT_EQ(expected_deliveries, deliveries);
+}
+
 // Tests that the VirtualConnectionRouter treats kConnectionNamespace messages
 // as a special case. The details of this are described in the implementation of
 // VirtualConnectionRouter::OnMessage().
@@ -9,6 +9,7 @@
 #include <memory>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "platform/api/tls_connection.h"
 #include "util/weak_ptr.h"
 
@@ -46,6 +47,11 @@ class CastSocket : public TlsConnection::Client {
   // write-blocked.
   [[nodiscard]] Error Send(const ::cast::channel::CastMessage& message);
 
+  // Like Send(), but for a message already serialized and framed by
+  // message_serialization::Serialize(). This allows a message sent over
+  // several sockets to be serialized only once.
+  [[nodiscard]] Error SendSerialized(absl::Span<const uint8_t> serialized);
+
   void SetClient(Client* client);
 
   std::array<uint8_t, 2> GetSanitizedIpAddress();
@@ -67,13 +73,23 @@ class CastSocket : public TlsConnection::Client {
     kError = false,
   };
 
+  // Parses as many complete messages as possible from the start of |input|,
+  // passing each to the Client, and returns the number of bytes they spanned.
+  size_t ReadMessages(absl::Span<const uint8_t> input);
+
   static int g_next_socket_id_;
 
   const std::unique_ptr<TlsConnection> connection_;
   Client* client_;  // May never be null.
   const int socket_id_;
   bool audio_only_ = false;
+
+  // Holds the bytes of a message that has only partially arrived, which begin
+  // at |read_offset_|. Messages are parsed in-place, and the consumed bytes
+  // before |read_offset_| are only discarded once they are no fewer than the
+  // unconsumed ones, so that each byte is moved a bounded number of times.
   std::vector<uint8_t> read_buffer_;
+  size_t read_offset_ = 0;
   State state_ = State::kOpen;
 
   WeakPtrFactory<CastSocket> weak_factory_{this};
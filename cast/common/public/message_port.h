@@ -24,6 +24,14 @@ class MessagePort {
     virtual void OnMessage(const std::string& source_sender_id,
                            const std::string& message_namespace,
                            const std::string& message) = 0;
+
+    // Called for messages carrying an opaque binary payload rather than UTF-8
+    // text. These are only sent by remote ends that have negotiated their use
+    // with the client, so clients that do not support them may ignore them.
+    virtual void OnBinaryMessage(const std::string& source_sender_id,
+                                 const std::string& message_namespace,
+                                 const std::string& message) {}
+
     virtual void OnError(Error error) = 0;
   };
 
@@ -34,6 +42,16 @@ class MessagePort {
   virtual void PostMessage(const std::string& destination_sender_id,
                            const std::string& message_namespace,
                            const std::string& message) = 0;
+
+  // Returns true if this port can carry binary messages, via
+  // PostBinaryMessage() and Client::OnBinaryMessage().
+  virtual bool SupportsBinaryMessages() const { return false; }
+
+  // Posts a message carrying the opaque binary payload |message|. Must only be
+  // called if SupportsBinaryMessages() returns true.
+  virtual void PostBinaryMessage(const std::string& destination_sender_id,
+                                 const std::string& message_namespace,
+                                 const std::string& message) {}
 };
 
 }  // namespace cast
@@ -18,14 +18,14 @@ namespace openscreen {
 namespace cast {
 namespace {
 
-// Parses the given string as a JSON object. If the parse fails, an empty object
-// is returned.
-Json::Value ParseAsObject(absl::string_view value) {
-  ErrorOr<Json::Value> parsed = json::Parse(value);
+// Returns the JSON object parsed from the payload, or |empty_object| if the
+// payload did not parse as a JSON object.
+const Json::Value& GetObjectOrEmpty(const ErrorOr<Json::Value>& parsed,
+                                    const Json::Value& empty_object) {
   if (parsed.is_value() && parsed.value().isObject()) {
-    return std::move(parsed.value());
+    return parsed.value();
   }
-  return Json::Value(Json::objectValue);
+  return empty_object;
 }
 
 // Returns true if the type field in |object| is set to the given |type|.
@@ -47,9 +47,10 @@ std::string GetFirstAppId(ApplicationAgent::Application* app) {
 
 ApplicationAgent::ApplicationAgent(
     TaskRunner* task_runner,
-    DeviceAuthNamespaceHandler::CredentialsProvider* credentials_provider)
+    DeviceAuthNamespaceHandler::CredentialsProvider* credentials_provider,
+    SigningPool* signing_pool)
     : task_runner_(task_runner),
-      auth_handler_(credentials_provider),
+      auth_handler_(credentials_provider, signing_pool),
       connection_handler_(&router_, this),
       message_port_(&router_) {
   router_.AddHandlerForLocalId(kPlatformReceiverId, this);
@@ -123,6 +124,14 @@ void ApplicationAgent::OnError(ReceiverSocketFactory* factory, Error error) {
 void ApplicationAgent::OnMessage(VirtualConnectionRouter* router,
                                  CastSocket* socket,
                                  ::cast::channel::CastMessage message) {
+  OnMessageWithPayload(router, socket, std::move(message), JsonPayload());
+}
+
+void ApplicationAgent::OnMessageWithPayload(
+    VirtualConnectionRouter* router,
+    CastSocket* socket,
+    ::cast::channel::CastMessage message,
+    const JsonPayload& payload) {
   if (message_port_.GetSocketId() == ToCastSocketId(socket) &&
       !message_port_.client_sender_id().empty() &&
       message_port_.client_sender_id() == message.destination_id()) {
@@ -142,7 +151,9 @@ void ApplicationAgent::OnMessage(VirtualConnectionRouter* router,
     return;
   }
 
-  const Json::Value request = ParseAsObject(message.payload_utf8());
+  const Json::Value empty_object(Json::objectValue);
+  const Json::Value& request =
+      GetObjectOrEmpty(payload.Parse(message), empty_object);
   Json::Value response;
   if (ns == kHeartbeatNamespace) {
     if (HasType(request, CastMessageType::kPing)) {
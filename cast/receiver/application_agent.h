@@ -26,6 +26,7 @@ namespace openscreen {
 namespace cast {
 
 class CastSocket;
+class SigningPool;
 
 // A service accepting CastSocket connections, and providing a minimal
 // implementation of the CastV2 application control protocol to launch receiver
@@ -81,9 +82,12 @@ class ApplicationAgent final
     virtual ~Application();
   };
 
+  // If |signing_pool| is non-null, it must outlive |this|, and is used to sign
+  // the replies to auth challenges off of the TaskRunner thread.
   ApplicationAgent(
       TaskRunner* task_runner,
-      DeviceAuthNamespaceHandler::CredentialsProvider* credentials_provider);
+      DeviceAuthNamespaceHandler::CredentialsProvider* credentials_provider,
+      SigningPool* signing_pool = nullptr);
 
   ~ApplicationAgent() final;
 
@@ -114,6 +118,10 @@ class ApplicationAgent final
   void OnMessage(VirtualConnectionRouter* router,
                  CastSocket* socket,
                  ::cast::channel::CastMessage message) final;
+  void OnMessageWithPayload(VirtualConnectionRouter* router,
+                            CastSocket* socket,
+                            ::cast::channel::CastMessage message,
+                            const JsonPayload& payload) final;
 
   // ConnectionNamespaceHandler::VirtualConnectionPolicy overrides.
   bool IsConnectionAllowed(const VirtualConnection& virtual_conn) const final;
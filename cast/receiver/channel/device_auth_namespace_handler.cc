@@ -7,15 +7,19 @@
 #include <openssl/evp.h>
 
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "cast/common/certificate/cast_cert_validator.h"
 #include "cast/common/channel/message_util.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
 #include "cast/common/channel/virtual_connection.h"
 #include "cast/common/channel/virtual_connection_router.h"
+#include "cast/receiver/channel/signing_pool.h"
 #include "platform/base/tls_credentials.h"
 #include "util/crypto/digest_sign.h"
+#include "util/osp_logging.h"
 
 using ::cast::channel::AuthChallenge;
 using ::cast::channel::AuthError;
@@ -46,11 +50,35 @@ CastMessage GenerateErrorMessage(AuthError::ErrorType error_type) {
   return response;
 }
 
+// Returns the reply to an auth challenge: |auth_response| signed with
+// |signature|, or an error if signing failed.
+CastMessage GenerateResponseMessage(AuthResponse* auth_response,
+                                    ErrorOr<std::string> signature) {
+  if (!signature) {
+    return GenerateErrorMessage(AuthError::INTERNAL_ERROR);
+  }
+  auth_response->set_signature(std::move(signature.value()));
+
+  DeviceAuthMessage response_auth_message;
+  response_auth_message.mutable_response()->Swap(auth_response);
+
+  std::string response_string;
+  response_auth_message.SerializeToString(&response_string);
+  CastMessage response;
+  response.set_protocol_version(
+      ::cast::channel::CastMessage_ProtocolVersion_CASTV2_1_0);
+  response.set_namespace_(kAuthNamespace);
+  response.set_payload_type(::cast::channel::CastMessage_PayloadType_BINARY);
+  response.set_payload_binary(std::move(response_string));
+  return response;
+}
+
 }  // namespace
 
 DeviceAuthNamespaceHandler::DeviceAuthNamespaceHandler(
-    CredentialsProvider* creds_provider)
-    : creds_provider_(creds_provider) {}
+    CredentialsProvider* creds_provider,
+    SigningPool* signing_pool)
+    : creds_provider_(creds_provider), signing_pool_(signing_pool) {}
 
 DeviceAuthNamespaceHandler::~DeviceAuthNamespaceHandler() = default;
 
@@ -109,21 +137,21 @@ void DeviceAuthNamespaceHandler::OnMessage(VirtualConnectionRouter* router,
     return;
   }
 
-  std::unique_ptr<AuthResponse> auth_response(new AuthResponse());
-  auth_response->set_client_auth_certificate(device_creds.certs[0]);
+  AuthResponse auth_response;
+  auth_response.set_client_auth_certificate(device_creds.certs[0]);
   for (auto it = device_creds.certs.begin() + 1; it != device_creds.certs.end();
        ++it) {
-    auth_response->add_intermediate_certificate(*it);
+    auth_response.add_intermediate_certificate(*it);
   }
-  auth_response->set_signature_algorithm(::cast::channel::RSASSA_PKCS1v15);
-  auth_response->set_hash_algorithm(hash_alg);
+  auth_response.set_signature_algorithm(::cast::channel::RSASSA_PKCS1v15);
+  auth_response.set_hash_algorithm(hash_alg);
   std::string sender_nonce;
   if (challenge.has_sender_nonce()) {
     sender_nonce = challenge.sender_nonce();
-    auth_response->set_sender_nonce(sender_nonce);
+    auth_response.set_sender_nonce(sender_nonce);
   }
 
-  auth_response->set_crl(device_creds.serialized_crl);
+  auth_response.set_crl(device_creds.serialized_crl);
 
   std::vector<uint8_t> to_be_signed;
   to_be_signed.reserve(sender_nonce.size() + tls_cert_der.size());
@@ -132,26 +160,34 @@ void DeviceAuthNamespaceHandler::OnMessage(VirtualConnectionRouter* router,
   to_be_signed.insert(to_be_signed.end(), tls_cert_der.begin(),
                       tls_cert_der.end());
 
-  ErrorOr<std::string> signature =
-      SignData(digest, device_creds.private_key.get(), to_be_signed);
-  if (!signature) {
-    router->Send(virtual_conn, GenerateErrorMessage(AuthError::INTERNAL_ERROR));
+  if (!signing_pool_) {
+    ErrorOr<std::string> signature =
+        SignData(digest, device_creds.private_key.get(), to_be_signed);
+    router->Send(virtual_conn,
+                 GenerateResponseMessage(&auth_response, std::move(signature)));
     return;
   }
-  auth_response->set_signature(std::move(signature.value()));
 
-  DeviceAuthMessage response_auth_message;
-  response_auth_message.set_allocated_response(auth_response.release());
-
-  std::string response_string;
-  response_auth_message.SerializeToString(&response_string);
-  CastMessage response;
-  response.set_protocol_version(
-      ::cast::channel::CastMessage_ProtocolVersion_CASTV2_1_0);
-  response.set_namespace_(kAuthNamespace);
-  response.set_payload_type(::cast::channel::CastMessage_PayloadType_BINARY);
-  response.set_payload_binary(std::move(response_string));
-  router->Send(virtual_conn, std::move(response));
+  // The signing job holds its own reference to the private key, in case the
+  // credentials change before it runs.
+  std::shared_ptr<EVP_PKEY> private_key(
+      bssl::UpRef(device_creds.private_key).release(), EVP_PKEY_free);
+  const bool is_queued = signing_pool_->Sign(
+      [digest, private_key, to_be_signed = std::move(to_be_signed)] {
+        return SignData(digest, private_key.get(), to_be_signed);
+      },
+      [weak_this = weak_factory_.GetWeakPtr(), router, virtual_conn,
+       auth_response =
+           std::move(auth_response)](ErrorOr<std::string> signature) mutable {
+        if (weak_this) {
+          router->Send(virtual_conn, GenerateResponseMessage(
+                                         &auth_response, std::move(signature)));
+        }
+      });
+  if (!is_queued) {
+    OSP_DVLOG << "Too many auth challenges are waiting to be signed.";
+    router->Send(virtual_conn, GenerateErrorMessage(AuthError::INTERNAL_ERROR));
+  }
 }
 
 }  // namespace cast
@@ -12,10 +12,13 @@
 
 #include "absl/types/span.h"
 #include "cast/common/channel/cast_message_handler.h"
+#include "util/weak_ptr.h"
 
 namespace openscreen {
 namespace cast {
 
+class SigningPool;
+
 struct DeviceCredentials {
   // The device's certificate chain in DER form, where |certs[0]| is the
   // device's certificate and |certs[certs.size()-1]| is the last intermediate
@@ -38,8 +41,14 @@ class DeviceAuthNamespaceHandler final : public CastMessageHandler {
     virtual const DeviceCredentials& GetCurrentDeviceCredentials() = 0;
   };
 
-  // |creds_provider| must outlive |this|.
-  explicit DeviceAuthNamespaceHandler(CredentialsProvider* creds_provider);
+  // |creds_provider| must outlive |this|. If |signing_pool| is non-null, it
+  // must outlive |this|, and the replies to auth challenges are signed on it
+  // and sent once their signatures are posted back, unless |this| has been
+  // destroyed by then (the VirtualConnectionRouter that delivered a challenge
+  // must still exist as long as |this| does). Otherwise, they are signed and
+  // sent before OnMessage() returns.
+  explicit DeviceAuthNamespaceHandler(CredentialsProvider* creds_provider,
+                                      SigningPool* signing_pool = nullptr);
   ~DeviceAuthNamespaceHandler();
 
   // CastMessageHandler overrides.
@@ -49,6 +58,9 @@ class DeviceAuthNamespaceHandler final : public CastMessageHandler {
 
  private:
   CredentialsProvider* const creds_provider_;
+  SigningPool* const signing_pool_;
+
+  WeakPtrFactory<DeviceAuthNamespaceHandler> weak_factory_{this};
 };
 
 }  // namespace cast
@@ -4,6 +4,9 @@
 
 #include "cast/receiver/channel/device_auth_namespace_handler.h"
 
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <utility>
 
 #include "cast/common/certificate/testing/test_helpers.h"
@@ -13,8 +16,10 @@
 #include "cast/common/channel/testing/mock_socket_error_handler.h"
 #include "cast/common/channel/virtual_connection_router.h"
 #include "cast/common/public/cast_socket.h"
+#include "cast/receiver/channel/signing_pool.h"
 #include "cast/receiver/channel/static_credentials.h"
 #include "cast/receiver/channel/testing/device_auth_test_helpers.h"
+#include "cast/receiver/channel/testing/signing_pool_test_helpers.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "platform/test/paths.h"
@@ -24,6 +29,7 @@ namespace openscreen {
 namespace cast {
 namespace {
 
+using ::cast::channel::AuthError;
 using ::cast::channel::AuthResponse;
 using ::cast::channel::CastMessage;
 using ::cast::channel::DeviceAuthMessage;
@@ -48,6 +54,12 @@ class DeviceAuthNamespaceHandlerTest : public ::testing::Test {
   }
 
  protected:
+  // Routes auth challenges to |handler| instead of |auth_handler_|.
+  void UseHandler(DeviceAuthNamespaceHandler* handler) {
+    router_.RemoveHandlerForLocalId(kPlatformReceiverId);
+    router_.AddHandlerForLocalId(kPlatformReceiverId, handler);
+  }
+
   const std::string& data_path_{GetSpecificTestDataPath()};
   FakeCastSocketPair fake_cast_socket_pair_;
   MockSocketErrorHandler mock_error_handler_;
@@ -218,6 +230,141 @@ TEST_F(DeviceAuthNamespaceHandlerTest, UnsupportedSignatureAlgorithm) {
   ASSERT_TRUE(auth_message.has_error());
 }
 
+TEST_F(DeviceAuthNamespaceHandlerTest, AuthResponseFromSigningPool) {
+  InitStaticCredentialsFromFiles(
+      &creds_, nullptr, nullptr, data_path_ + "device_key.pem",
+      data_path_ + "device_chain.pem", data_path_ + "device_tls.pem");
+  ThreadSafeTaskQueue task_runner;
+  SigningPool pool(&task_runner, 1);
+  DeviceAuthNamespaceHandler pooled_handler(&creds_, &pool);
+  UseHandler(&pooled_handler);
+
+  CastMessage auth_challenge;
+  const std::string auth_challenge_string =
+      ReadEntireFileToString(data_path_ + "auth_challenge.pb");
+  ASSERT_TRUE(auth_challenge.ParseFromString(auth_challenge_string));
+
+  // The challenge is signed on the pool's thread, so nothing is sent until the
+  // result is posted back to |task_runner|.
+  EXPECT_CALL(fake_cast_socket_pair_.mock_peer_client, OnMessage(_, _))
+      .Times(0);
+  ASSERT_TRUE(
+      fake_cast_socket_pair_.peer_socket->Send(std::move(auth_challenge)).ok());
+  task_runner.WaitForTasks(1);
+  ::testing::Mock::VerifyAndClearExpectations(
+      &fake_cast_socket_pair_.mock_peer_client);
+
+  CastMessage challenge_reply;
+  EXPECT_CALL(fake_cast_socket_pair_.mock_peer_client, OnMessage(_, _))
+      .WillOnce(
+          Invoke([&challenge_reply](CastSocket* socket, CastMessage message) {
+            challenge_reply = std::move(message);
+          }));
+  task_runner.RunTasks(1);
+
+  const std::string auth_response_string =
+      ReadEntireFileToString(data_path_ + "auth_response.pb");
+  AuthResponse expected_auth_response;
+  ASSERT_TRUE(expected_auth_response.ParseFromString(auth_response_string));
+
+  DeviceAuthMessage auth_message;
+  ASSERT_EQ(challenge_reply.payload_type(),
+            ::cast::channel::CastMessage_PayloadType_BINARY);
+  ASSERT_TRUE(auth_message.ParseFromString(challenge_reply.payload_binary()));
+  ASSERT_TRUE(auth_message.has_response());
+  ASSERT_FALSE(auth_message.has_challenge());
+  ASSERT_FALSE(auth_message.has_error());
+  const AuthResponse& auth_response = auth_message.response();
+
+  EXPECT_EQ(expected_auth_response.signature(), auth_response.signature());
+  EXPECT_EQ(expected_auth_response.client_auth_certificate(),
+            auth_response.client_auth_certificate());
+  EXPECT_EQ(expected_auth_response.sender_nonce(),
+            auth_response.sender_nonce());
+  EXPECT_THAT(
+      auth_response.intermediate_certificate(),
+      ElementsAreArray(expected_auth_response.intermediate_certificate()));
+}
+
+TEST_F(DeviceAuthNamespaceHandlerTest, SigningPoolFull) {
+  InitStaticCredentialsFromFiles(
+      &creds_, nullptr, nullptr, data_path_ + "device_key.pem",
+      data_path_ + "device_chain.pem", data_path_ + "device_tls.pem");
+  ThreadSafeTaskQueue task_runner;
+  Gate gate;
+  SigningPool pool(&task_runner, 1, 1);
+  DeviceAuthNamespaceHandler pooled_handler(&creds_, &pool);
+  UseHandler(&pooled_handler);
+
+  // One job occupies the pool's only thread, and another fills its queue.
+  std::atomic<bool> is_started{false};
+  const auto blocking_sign = [&] {
+    is_started = true;
+    gate.Wait();
+    return ErrorOr<std::string>("signature");
+  };
+  const auto ignore_result = [](ErrorOr<std::string> signature) {};
+  ASSERT_TRUE(pool.Sign(blocking_sign, ignore_result));
+  while (!is_started) {
+    std::this_thread::yield();
+  }
+  ASSERT_TRUE(pool.Sign(blocking_sign, ignore_result));
+
+  CastMessage auth_challenge;
+  const std::string auth_challenge_string =
+      ReadEntireFileToString(data_path_ + "auth_challenge.pb");
+  ASSERT_TRUE(auth_challenge.ParseFromString(auth_challenge_string));
+
+  // The challenge cannot be queued, so an error is sent right away.
+  CastMessage challenge_reply;
+  EXPECT_CALL(fake_cast_socket_pair_.mock_peer_client, OnMessage(_, _))
+      .WillOnce(
+          Invoke([&challenge_reply](CastSocket* socket, CastMessage message) {
+            challenge_reply = std::move(message);
+          }));
+  const bool was_sent =
+      fake_cast_socket_pair_.peer_socket->Send(std::move(auth_challenge)).ok();
+  gate.Open();
+  ASSERT_TRUE(was_sent);
+
+  DeviceAuthMessage auth_message;
+  ASSERT_EQ(challenge_reply.payload_type(),
+            ::cast::channel::CastMessage_PayloadType_BINARY);
+  ASSERT_TRUE(auth_message.ParseFromString(challenge_reply.payload_binary()));
+  ASSERT_FALSE(auth_message.has_response());
+  ASSERT_FALSE(auth_message.has_challenge());
+  ASSERT_TRUE(auth_message.has_error());
+  EXPECT_EQ(AuthError::INTERNAL_ERROR, auth_message.error().error_type());
+  EXPECT_EQ(1, pool.GetStats().num_jobs_rejected);
+}
+
+TEST_F(DeviceAuthNamespaceHandlerTest, DropsSignatureAfterHandlerDestroyed) {
+  InitStaticCredentialsFromFiles(
+      &creds_, nullptr, nullptr, data_path_ + "device_key.pem",
+      data_path_ + "device_chain.pem", data_path_ + "device_tls.pem");
+  ThreadSafeTaskQueue task_runner;
+  SigningPool pool(&task_runner, 1);
+  auto pooled_handler =
+      std::make_unique<DeviceAuthNamespaceHandler>(&creds_, &pool);
+  UseHandler(pooled_handler.get());
+
+  CastMessage auth_challenge;
+  const std::string auth_challenge_string =
+      ReadEntireFileToString(data_path_ + "auth_challenge.pb");
+  ASSERT_TRUE(auth_challenge.ParseFromString(auth_challenge_string));
+
+  // The handler is destroyed after the signature has been posted back, but
+  // before it is delivered, so no reply is sent.
+  EXPECT_CALL(fake_cast_socket_pair_.mock_peer_client, OnMessage(_, _))
+      .Times(0);
+  ASSERT_TRUE(
+      fake_cast_socket_pair_.peer_socket->Send(std::move(auth_challenge)).ok());
+  task_runner.WaitForTasks(1);
+  router_.RemoveHandlerForLocalId(kPlatformReceiverId);
+  pooled_handler.reset();
+  task_runner.RunTasks(1);
+}
+
 }  // namespace
 }  // namespace cast
 }  // namespace openscreen
@@ -0,0 +1,99 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/receiver/channel/signing_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+SigningPool::SigningPool(TaskRunner* task_runner,
+                         int num_threads,
+                         int max_queued_jobs)
+    : task_runner_(task_runner), max_queued_jobs_(max_queued_jobs) {
+  OSP_DCHECK(task_runner_);
+  OSP_DCHECK_GT(num_threads, 0);
+  OSP_DCHECK_GT(max_queued_jobs_, 0);
+
+  worker_threads_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    worker_threads_.emplace_back(&SigningPool::RunSigningLoop, this);
+  }
+}
+
+SigningPool::~SigningPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_shutting_down_ = true;
+  }
+  queue_changed_.notify_all();
+  for (std::thread& worker_thread : worker_threads_) {
+    worker_thread.join();
+  }
+}
+
+bool SigningPool::Sign(SignFunction sign, ResultCallback callback) {
+  OSP_DCHECK(task_runner_->IsRunningOnTaskRunner());
+  OSP_DCHECK(sign);
+  OSP_DCHECK(callback);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.num_jobs_submitted;
+    if (static_cast<int>(queue_.size()) >= max_queued_jobs_) {
+      ++stats_.num_jobs_rejected;
+      return false;
+    }
+    queue_.push_back(Job{std::move(sign), std::move(callback)});
+    stats_.max_queue_depth =
+        std::max(stats_.max_queue_depth, static_cast<int>(queue_.size()));
+  }
+  queue_changed_.notify_one();
+  return true;
+}
+
+SigningPool::Stats SigningPool::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void SigningPool::RunSigningLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    queue_changed_.wait(
+        lock, [this] { return is_shutting_down_ || !queue_.empty(); });
+    if (is_shutting_down_) {
+      return;
+    }
+
+    Job job = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+
+    ErrorOr<std::string> result = job.sign();
+
+    lock.lock();
+    ++stats_.num_jobs_completed;
+    // |weak_this| is only checked on the TaskRunner thread, where this
+    // SigningPool is destroyed.
+    task_runner_->PostTask([weak_this = weak_factory_.GetWeakPtr(),
+                            callback = std::move(job.callback),
+                            result = std::move(result)]() mutable {
+      if (weak_this) {
+        callback(std::move(result));
+      }
+    });
+  }
+}
+
+// static
+constexpr int SigningPool::kDefaultNumThreads;
+constexpr int SigningPool::kDefaultMaxQueuedJobs;
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,102 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_RECEIVER_CHANNEL_SIGNING_POOL_H_
+#define CAST_RECEIVER_CHANNEL_SIGNING_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "platform/api/task_runner.h"
+#include "platform/base/error.h"
+#include "util/weak_ptr.h"
+
+namespace openscreen {
+namespace cast {
+
+// Computes signatures on a small pool of worker threads, so that answering a
+// burst of auth challenges (e.g., senders reconnecting after a network blip)
+// does not block the TaskRunner thread, which must also service the packet
+// I/O and RTCP of any streaming sessions. Each signature is posted back to the
+// TaskRunner thread, where its callback is run.
+//
+// At most |num_threads| signatures are computed at once, and at most
+// |max_queued_jobs| wait for a thread; further requests are rejected.
+//
+// All public methods must be called on the TaskRunner thread.
+class SigningPool {
+ public:
+  // Computes a signature. This is run on one of the worker threads.
+  using SignFunction = std::function<ErrorOr<std::string>()>;
+
+  // Called on the TaskRunner thread with the result of a SignFunction.
+  using ResultCallback = std::function<void(ErrorOr<std::string>)>;
+
+  struct Stats {
+    // The number of signing requests passed to Sign(), and the number of them
+    // that were rejected because the queue was full.
+    int num_jobs_submitted = 0;
+    int num_jobs_rejected = 0;
+
+    // The number of signatures computed (successfully or not).
+    int num_jobs_completed = 0;
+
+    // The maximum number of requests that were waiting in the queue.
+    int max_queue_depth = 0;
+  };
+
+  static constexpr int kDefaultNumThreads = 2;
+  static constexpr int kDefaultMaxQueuedJobs = 256;
+
+  SigningPool(TaskRunner* task_runner,
+              int num_threads = kDefaultNumThreads,
+              int max_queued_jobs = kDefaultMaxQueuedJobs);
+  SigningPool(const SigningPool&) = delete;
+  SigningPool& operator=(const SigningPool&) = delete;
+
+  // Waits for any signatures being computed, and drops any queued requests
+  // and pending results without calling their callbacks.
+  ~SigningPool();
+
+  // Queues |sign| to run on a worker thread, and arranges for |callback| to be
+  // called with its result. Returns false, without calling |callback|, if the
+  // queue is full.
+  bool Sign(SignFunction sign, ResultCallback callback);
+
+  // Returns a snapshot of the statistics tracked since construction.
+  Stats GetStats() const;
+
+ private:
+  struct Job {
+    SignFunction sign;
+    ResultCallback callback;
+  };
+
+  // Runs on each worker thread, computing queued signatures until shutdown.
+  void RunSigningLoop();
+
+  TaskRunner* const task_runner_;
+  const int max_queued_jobs_;
+
+  // Guards all of the members below it, which are accessed by all threads.
+  mutable std::mutex mutex_;
+  std::condition_variable queue_changed_;
+  std::deque<Job> queue_;
+  bool is_shutting_down_ = false;
+  Stats stats_;
+
+  std::vector<std::thread> worker_threads_;
+
+  WeakPtrFactory<SigningPool> weak_factory_{this};
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_RECEIVER_CHANNEL_SIGNING_POOL_H_
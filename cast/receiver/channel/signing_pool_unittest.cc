@@ -0,0 +1,122 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/receiver/channel/signing_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cast/receiver/channel/testing/signing_pool_test_helpers.h"
+#include "gtest/gtest.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+TEST(SigningPoolTest, SignsOnWorkerThreadsAndPostsResultsBack) {
+  constexpr int kNumJobs = 10;
+  ThreadSafeTaskQueue task_runner;
+  SigningPool pool(&task_runner, 2);
+
+  const std::thread::id test_thread_id = std::this_thread::get_id();
+  std::atomic<int> num_signed_on_test_thread{0};
+  std::vector<std::string> signatures;
+  for (int i = 0; i < kNumJobs; ++i) {
+    ASSERT_TRUE(pool.Sign(
+        [i, test_thread_id, &num_signed_on_test_thread] {
+          if (std::this_thread::get_id() == test_thread_id) {
+            ++num_signed_on_test_thread;
+          }
+          return ErrorOr<std::string>(std::to_string(i));
+        },
+        [&signatures](ErrorOr<std::string> signature) {
+          ASSERT_TRUE(signature);
+          signatures.push_back(std::move(signature.value()));
+        }));
+  }
+
+  // The results are only delivered by the TaskRunner.
+  task_runner.WaitForTasks(kNumJobs);
+  EXPECT_TRUE(signatures.empty());
+  task_runner.RunTasks(kNumJobs);
+
+  EXPECT_EQ(0, num_signed_on_test_thread);
+  std::sort(signatures.begin(), signatures.end());
+  EXPECT_EQ((std::vector<std::string>{"0", "1", "2", "3", "4", "5", "6", "7",
+                                      "8", "9"}),
+            signatures);
+  const SigningPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(kNumJobs, stats.num_jobs_submitted);
+  EXPECT_EQ(kNumJobs, stats.num_jobs_completed);
+  EXPECT_EQ(0, stats.num_jobs_rejected);
+}
+
+TEST(SigningPoolTest, BoundsConcurrencyAndQueuedJobs) {
+  ThreadSafeTaskQueue task_runner;
+  SigningPool pool(&task_runner, 2, 2);
+
+  Gate gate;
+  std::atomic<int> num_running{0};
+  std::atomic<int> max_running{0};
+  std::atomic<int> num_started{0};
+  const auto blocking_sign = [&] {
+    ++num_started;
+    const int running = ++num_running;
+    int max = max_running;
+    while (running > max && !max_running.compare_exchange_weak(max, running)) {
+    }
+    gate.Wait();
+    --num_running;
+    return ErrorOr<std::string>("signature");
+  };
+  int num_results = 0;
+  const auto count_result = [&num_results](ErrorOr<std::string> signature) {
+    EXPECT_TRUE(signature);
+    ++num_results;
+  };
+
+  // Two jobs occupy both threads, and two more fill the queue.
+  ASSERT_TRUE(pool.Sign(blocking_sign, count_result));
+  ASSERT_TRUE(pool.Sign(blocking_sign, count_result));
+  while (num_started < 2) {
+    std::this_thread::yield();
+  }
+  ASSERT_TRUE(pool.Sign(blocking_sign, count_result));
+  ASSERT_TRUE(pool.Sign(blocking_sign, count_result));
+  EXPECT_FALSE(pool.Sign(blocking_sign, count_result));
+
+  gate.Open();
+  task_runner.RunTasks(4);
+  EXPECT_EQ(4, num_results);
+  EXPECT_EQ(2, max_running);
+
+  const SigningPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(5, stats.num_jobs_submitted);
+  EXPECT_EQ(1, stats.num_jobs_rejected);
+  EXPECT_EQ(4, stats.num_jobs_completed);
+  EXPECT_EQ(2, stats.max_queue_depth);
+}
+
+TEST(SigningPoolTest, DropsResultsPostedBeforeDestruction) {
+  ThreadSafeTaskQueue task_runner;
+  auto pool = std::make_unique<SigningPool>(&task_runner, 1);
+
+  bool was_called = false;
+  ASSERT_TRUE(
+      pool->Sign([] { return ErrorOr<std::string>("signature"); },
+                 [&was_called](ErrorOr<std::string>) { was_called = true; }));
+  task_runner.WaitForTasks(1);
+  pool.reset();
+  task_runner.RunTasks(1);
+  EXPECT_FALSE(was_called);
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
@@ -32,7 +32,7 @@ void InitStaticCredentialsFromFiles(StaticCredentialsProvider* creds,
   ASSERT_TRUE(fake_root);
   certs.pop_back();
   if (fake_trust_store) {
-    fake_trust_store->certs.emplace_back(fake_root.release());
+    fake_trust_store->AddCert(std::move(fake_root));
   }
 
   creds->device_creds = DeviceCredentials{
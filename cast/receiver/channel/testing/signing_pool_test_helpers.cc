@@ -0,0 +1,66 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/receiver/channel/testing/signing_pool_test_helpers.h"
+
+#include <utility>
+
+namespace openscreen {
+namespace cast {
+
+ThreadSafeTaskQueue::ThreadSafeTaskQueue() = default;
+ThreadSafeTaskQueue::~ThreadSafeTaskQueue() = default;
+
+void ThreadSafeTaskQueue::WaitForTasks(size_t count) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  task_posted_.wait(lock, [this, count] { return tasks_.size() >= count; });
+}
+
+void ThreadSafeTaskQueue::RunTasks(size_t count) {
+  WaitForTasks(count);
+  std::deque<Task> tasks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks.swap(tasks_);
+  }
+  for (Task& task : tasks) {
+    task();
+  }
+}
+
+void ThreadSafeTaskQueue::PostPackagedTask(Task task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  task_posted_.notify_all();
+}
+
+void ThreadSafeTaskQueue::PostPackagedTaskWithDelay(Task task,
+                                                    Clock::duration delay) {
+  PostPackagedTask(std::move(task));
+}
+
+bool ThreadSafeTaskQueue::IsRunningOnTaskRunner() {
+  return true;
+}
+
+Gate::Gate() = default;
+Gate::~Gate() = default;
+
+void Gate::Open() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_open_ = true;
+  }
+  opened_.notify_all();
+}
+
+void Gate::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  opened_.wait(lock, [this] { return is_open_; });
+}
+
+}  // namespace cast
+}  // namespace openscreen
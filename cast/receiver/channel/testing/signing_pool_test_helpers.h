@@ -0,0 +1,63 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_RECEIVER_CHANNEL_TESTING_SIGNING_POOL_TEST_HELPERS_H_
+#define CAST_RECEIVER_CHANNEL_TESTING_SIGNING_POOL_TEST_HELPERS_H_
+
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include "platform/api/task_runner.h"
+
+namespace openscreen {
+namespace cast {
+
+// A TaskRunner that may be posted to from any thread, such as by the worker
+// threads of a SigningPool, and whose tasks are run by the test on its own
+// thread.
+class ThreadSafeTaskQueue final : public TaskRunner {
+ public:
+  ThreadSafeTaskQueue();
+  ~ThreadSafeTaskQueue() final;
+
+  // Waits until |count| tasks have been posted, without running them.
+  void WaitForTasks(size_t count);
+
+  // Waits until |count| tasks have been posted, and runs all of the posted
+  // tasks.
+  void RunTasks(size_t count);
+
+  // TaskRunner overrides.
+  void PostPackagedTask(Task task) final;
+  void PostPackagedTaskWithDelay(Task task, Clock::duration delay) final;
+  bool IsRunningOnTaskRunner() final;
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable task_posted_;
+  std::deque<Task> tasks_;
+};
+
+// Blocks the signing functions that wait on it until it is opened.
+class Gate {
+ public:
+  Gate();
+  ~Gate();
+
+  void Open();
+  void Wait();
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable opened_;
+  bool is_open_ = false;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_RECEIVER_CHANNEL_TESTING_SIGNING_POOL_TEST_HELPERS_H_
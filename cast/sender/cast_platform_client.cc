@@ -12,7 +12,6 @@
 #include "cast/common/channel/virtual_connection_router.h"
 #include "cast/common/public/cast_socket.h"
 #include "cast/common/public/service_info.h"
-#include "util/json/json_serialization.h"
 #include "util/osp_logging.h"
 #include "util/stringprintf.h"
 
@@ -120,19 +119,27 @@ void CastPlatformClient::CancelRequest(int request_id) {
 void CastPlatformClient::OnMessage(VirtualConnectionRouter* router,
                                    CastSocket* socket,
                                    ::cast::channel::CastMessage message) {
+  OnMessageWithPayload(router, socket, std::move(message), JsonPayload());
+}
+
+void CastPlatformClient::OnMessageWithPayload(
+    VirtualConnectionRouter* router,
+    CastSocket* socket,
+    ::cast::channel::CastMessage message,
+    const JsonPayload& payload) {
   if (message.payload_type() !=
           ::cast::channel::CastMessage_PayloadType_STRING ||
       message.namespace_() != kReceiverNamespace ||
       message.source_id() != kPlatformReceiverId) {
     return;
   }
-  ErrorOr<Json::Value> dict_or_error = json::Parse(message.payload_utf8());
+  const ErrorOr<Json::Value>& dict_or_error = payload.Parse(message);
   if (dict_or_error.is_error()) {
     OSP_DVLOG << "Failed to deserialize CastMessage payload.";
     return;
   }
 
-  Json::Value& dict = dict_or_error.value();
+  const Json::Value& dict = dict_or_error.value();
   absl::optional<int> request_id =
       MaybeGetInt(dict, JSON_EXPAND_FIND_CONSTANT_ARGS(kMessageKeyRequestId));
   if (request_id) {
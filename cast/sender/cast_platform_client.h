@@ -69,6 +69,10 @@ class CastPlatformClient final : public CastMessageHandler {
   void OnMessage(VirtualConnectionRouter* router,
                  CastSocket* socket,
                  ::cast::channel::CastMessage message) override;
+  void OnMessageWithPayload(VirtualConnectionRouter* router,
+                            CastSocket* socket,
+                            ::cast::channel::CastMessage message,
+                            const JsonPayload& payload) override;
 
   void HandleResponse(const std::string& device_id,
                       int request_id,
@@ -7,11 +7,13 @@
 #include <openssl/rand.h>
 
 #include <algorithm>
+#include <chrono>
 #include <memory>
 
 #include "cast/common/certificate/cast_cert_validator.h"
 #include "cast/common/certificate/cast_cert_validator_internal.h"
 #include "cast/common/certificate/cast_crl.h"
+#include "cast/common/certificate/device_cert_cache.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
 #include "platform/api/time.h"
 #include "platform/base/error.h"
@@ -230,7 +232,8 @@ ErrorOr<CastDeviceCertPolicy> VerifyCredentialsImpl(
     TrustStore* cast_trust_store,
     TrustStore* crl_trust_store,
     const DateTime& verification_time,
-    bool enforce_sha256_checking);
+    bool enforce_sha256_checking,
+    DeviceCertCache* cache);
 
 ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReplyImpl(
     const CastMessage& challenge_reply,
@@ -239,7 +242,8 @@ ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReplyImpl(
     const CRLPolicy& crl_policy,
     TrustStore* cast_trust_store,
     TrustStore* crl_trust_store,
-    const DateTime& verification_time) {
+    const DateTime& verification_time,
+    DeviceCertCache* cache) {
   DeviceAuthMessage auth_message;
   Error result = ParseAuthMessage(challenge_reply, &auth_message);
   if (!result.ok()) {
@@ -276,7 +280,7 @@ ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReplyImpl(
 
   return VerifyCredentialsImpl(response, nonce_plus_peer_cert_der, crl_policy,
                                cast_trust_store, crl_trust_store,
-                               verification_time, false);
+                               verification_time, false, cache);
 }
 
 ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReply(
@@ -286,9 +290,20 @@ ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReply(
   DateTime now = {};
   OSP_CHECK(DateTimeFromSeconds(GetWallTimeSinceUnixEpoch().count(), &now));
   CRLPolicy policy = CRLPolicy::kCrlOptional;
-  return AuthenticateChallengeReplyImpl(
+  DeviceCertCache* const cache = DeviceCertCache::GetInstance();
+  const auto start_time = std::chrono::steady_clock::now();
+  ErrorOr<CastDeviceCertPolicy> result = AuthenticateChallengeReplyImpl(
       challenge_reply, peer_cert, auth_context, policy,
-      /* cast_trust_store */ nullptr, /* crl_trust_store */ nullptr, now);
+      /* cast_trust_store */ nullptr, /* crl_trust_store */ nullptr, now,
+      cache);
+  const DeviceCertCache::Metrics metrics = cache->metrics();
+  OSP_DVLOG << "Authenticating the challenge reply took "
+            << std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - start_time)
+                   .count()
+            << " us (device certificate cache: " << metrics.hits << " hits, "
+            << metrics.misses << " misses).";
+  return result;
 }
 
 ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReplyForTest(
@@ -299,9 +314,11 @@ ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReplyForTest(
     TrustStore* cast_trust_store,
     TrustStore* crl_trust_store,
     const DateTime& verification_time) {
+  // Tests must not share the process-wide cache, or the results of one would
+  // leak into the next.
   return AuthenticateChallengeReplyImpl(
       challenge_reply, peer_cert, auth_context, crl_policy, cast_trust_store,
-      crl_trust_store, verification_time);
+      crl_trust_store, verification_time, /* cache */ nullptr);
 }
 
 // This function does the following
@@ -321,6 +338,9 @@ ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReplyForTest(
 //
 // * Verifies that |response.signature| matches the signature of
 //   |signature_input| by |response.client_auth_certificate|'s public key.
+//
+// Successful certificate verifications are cached in |cache|, if it is
+// non-null.
 ErrorOr<CastDeviceCertPolicy> VerifyCredentialsImpl(
     const AuthResponse& response,
     const std::vector<uint8_t>& signature_input,
@@ -328,7 +348,8 @@ ErrorOr<CastDeviceCertPolicy> VerifyCredentialsImpl(
     TrustStore* cast_trust_store,
     TrustStore* crl_trust_store,
     const DateTime& verification_time,
-    bool enforce_sha256_checking) {
+    bool enforce_sha256_checking,
+    DeviceCertCache* cache) {
   if (response.signature().empty() && !signature_input.empty()) {
     return Error(Error::Code::kCastV2SignatureEmpty, "Signature is empty.");
   }
@@ -351,9 +372,9 @@ ErrorOr<CastDeviceCertPolicy> VerifyCredentialsImpl(
 
   // Perform certificate verification.
   CastDeviceCertPolicy device_policy;
-  Error verify_result =
-      VerifyDeviceCert(cert_chain, verification_time, &verification_context,
-                       &device_policy, crl.get(), crl_policy, cast_trust_store);
+  Error verify_result = VerifyDeviceCert(
+      cert_chain, verification_time, &verification_context, &device_policy,
+      crl.get(), crl_policy, cast_trust_store, cache);
 
   // Handle and report errors.
   Error result = MapToOpenscreenError(verify_result.code(),
@@ -394,7 +415,8 @@ ErrorOr<CastDeviceCertPolicy> VerifyCredentials(
   CRLPolicy policy = (enforce_revocation_checking) ? CRLPolicy::kCrlRequired
                                                    : CRLPolicy::kCrlOptional;
   return VerifyCredentialsImpl(response, signature_input, policy, nullptr,
-                               nullptr, now, enforce_sha256_checking);
+                               nullptr, now, enforce_sha256_checking,
+                               DeviceCertCache::GetInstance());
 }
 
 ErrorOr<CastDeviceCertPolicy> VerifyCredentialsForTest(
@@ -407,7 +429,8 @@ ErrorOr<CastDeviceCertPolicy> VerifyCredentialsForTest(
     bool enforce_sha256_checking) {
   return VerifyCredentialsImpl(response, signature_input, crl_policy,
                                cast_trust_store, crl_trust_store,
-                               verification_time, enforce_sha256_checking);
+                               verification_time, enforce_sha256_checking,
+                               /* cache */ nullptr);
 }
 
 }  // namespace cast
@@ -401,8 +401,8 @@ bool RunTest(const DeviceCertTest& test_case) {
     cast_trust_store = TrustStore::CreateInstanceFromPemFile(
         GetSpecificTestDataPath() + "certificates/cast_test_root_ca.pem");
 
-    EXPECT_FALSE(crl_trust_store.certs.empty());
-    EXPECT_FALSE(cast_trust_store.certs.empty());
+    EXPECT_FALSE(crl_trust_store.certs().empty());
+    EXPECT_FALSE(cast_trust_store.certs().empty());
   }
 
   std::vector<std::string> certificate_chain;
@@ -0,0 +1,50 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/standalone_receiver/benchmark_sink.h"
+
+#include <fstream>
+#include <utility>
+
+#include "util/json/json_serialization.h"
+
+namespace openscreen {
+namespace cast {
+
+BenchmarkSink::BenchmarkSink() = default;
+BenchmarkSink::~BenchmarkSink() = default;
+
+BenchmarkStreamRecorder* BenchmarkSink::AddStream(std::string media_type,
+                                                  std::string codec,
+                                                  Ssrc ssrc) {
+  streams_.push_back(std::make_unique<BenchmarkStreamRecorder>(
+      std::move(media_type), std::move(codec), ssrc));
+  return streams_.back().get();
+}
+
+Error BenchmarkSink::WriteJsonFile(const std::string& path) const {
+  Json::Value streams(Json::arrayValue);
+  for (const auto& stream : streams_) {
+    streams.append(stream->ToJson());
+  }
+  Json::Value root;
+  root["streams"] = std::move(streams);
+
+  ErrorOr<std::string> json = json::Stringify(root);
+  if (json.is_error()) {
+    return std::move(json.error());
+  }
+
+  std::ofstream file(path, std::ios::out | std::ios::trunc);
+  file << json.value() << '\n';
+  file.close();
+  if (!file) {
+    return Error(Error::Code::kIOFailure,
+                 "Failed to write benchmark results to " + path);
+  }
+  return Error::None();
+}
+
+}  // namespace cast
+}  // namespace openscreen
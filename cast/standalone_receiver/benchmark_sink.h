@@ -0,0 +1,46 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STANDALONE_RECEIVER_BENCHMARK_SINK_H_
+#define CAST_STANDALONE_RECEIVER_BENCHMARK_SINK_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cast/streaming/benchmark_payload.h"
+#include "cast/streaming/ssrc.h"
+#include "platform/base/error.h"
+
+namespace openscreen {
+namespace cast {
+
+// Owns the BenchmarkStreamRecorders for all of the streams received while
+// benchmarking (i.e., across all mirroring sessions), and writes their metrics
+// to a JSON file when the benchmark run is over. Together with cast_sender's
+// benchmark mode, this allows receiver performance to be regression-tested
+// without SDL or a display.
+class BenchmarkSink {
+ public:
+  BenchmarkSink();
+  ~BenchmarkSink();
+
+  // Returns the recorder for a new stream, which remains valid for the lifetime
+  // of this BenchmarkSink. |media_type| should be "audio" or "video".
+  BenchmarkStreamRecorder* AddStream(std::string media_type,
+                                     std::string codec,
+                                     Ssrc ssrc);
+
+  // Writes the metrics for all streams, in the order they were added, to the
+  // file at |path| as a JSON object of the form {"streams": [...]}.
+  Error WriteJsonFile(const std::string& path) const;
+
+ private:
+  std::vector<std::unique_ptr<BenchmarkStreamRecorder>> streams_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STANDALONE_RECEIVER_BENCHMARK_SINK_H_
@@ -53,11 +53,17 @@ CastService::CastService(TaskRunner* task_runner,
                          GeneratedCredentials credentials,
                          const std::string& friendly_name,
                          const std::string& model_name,
+                         const StreamingPlaybackController::Options&
+                             playback_options,
                          bool enable_discovery)
     : local_endpoint_(DetermineEndpoint(interface)),
       credentials_(std::move(credentials)),
-      agent_(task_runner, credentials_.provider.get()),
-      mirroring_application_(task_runner, local_endpoint_.address, &agent_),
+      signing_pool_(task_runner),
+      agent_(task_runner, credentials_.provider.get(), &signing_pool_),
+      mirroring_application_(task_runner,
+                             local_endpoint_.address,
+                             &agent_,
+                             playback_options),
       socket_factory_(&agent_, agent_.cast_socket_client()),
       connection_factory_(
           TlsConnectionFactory::CreateFactory(&socket_factory_, task_runner)),
@@ -10,6 +10,7 @@
 
 #include "cast/common/public/service_info.h"
 #include "cast/receiver/application_agent.h"
+#include "cast/receiver/channel/signing_pool.h"
 #include "cast/receiver/channel/static_credentials.h"
 #include "cast/receiver/public/receiver_socket_factory.h"
 #include "cast/standalone_receiver/mirroring_application.h"
@@ -46,6 +47,7 @@ class CastService final : public discovery::ReportingClient {
               GeneratedCredentials credentials,
               const std::string& friendly_name,
               const std::string& model_name,
+              const StreamingPlaybackController::Options& playback_options,
               bool enable_discovery = true);
 
   ~CastService() final;
@@ -62,6 +64,10 @@ class CastService final : public discovery::ReportingClient {
   const IPEndpoint local_endpoint_;
   const GeneratedCredentials credentials_;
 
+  // Signs the replies to auth challenges, so that a burst of them does not
+  // stall the streaming session.
+  SigningPool signing_pool_;
+
   ApplicationAgent agent_;
   MirroringApplication mirroring_application_;
   ReceiverSocketFactory socket_factory_;
@@ -0,0 +1,226 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/standalone_receiver/decode_worker.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "util/osp_logging.h"
+#include "util/trace_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// The maximum number of idle input buffers kept for re-use. Beyond the frames
+// that can be queued, one is being decoded and one is being populated.
+constexpr int kMaxPooledBuffers = DecodeWorker::kMaxQueuedFrames + 2;
+
+}  // namespace
+
+DecodeWorker::Client::Client() = default;
+DecodeWorker::Client::~Client() = default;
+
+DecodeWorker::DecodeWorker(ClockNowFunctionPtr now_function,
+                           TaskRunner* task_runner,
+                           const std::string& codec_name,
+                           Mode mode)
+    : now_(now_function),
+      task_runner_(task_runner),
+      mode_(mode),
+      decoder_(codec_name) {
+  OSP_DCHECK(now_);
+  OSP_DCHECK(task_runner_);
+
+  decoder_.set_client(this);
+  if (mode_ == Mode::kWorkerThread) {
+    // The worker thread absorbs any blocking, so frame threading is safe to
+    // use here.
+    decoder_.set_frame_threading_enabled(true);
+    worker_thread_ = std::thread(&DecodeWorker::RunDecodeLoop, this);
+  }
+}
+
+DecodeWorker::~DecodeWorker() {
+  if (worker_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_shutting_down_ = true;
+    }
+    queue_changed_.notify_one();
+    worker_thread_.join();
+  }
+  decoder_.set_client(nullptr);
+}
+
+bool DecodeWorker::CanAcceptFrame() {
+  OSP_DCHECK(task_runner_->IsRunningOnTaskRunner());
+  if (mode_ == Mode::kCallingThread) {
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (static_cast<int>(queue_.size()) < kMaxQueuedFrames) {
+    return true;
+  }
+  client_waiting_for_space_ = true;
+  return false;
+}
+
+std::unique_ptr<Decoder::Buffer> DecodeWorker::AcquireBuffer() {
+  OSP_DCHECK(task_runner_->IsRunningOnTaskRunner());
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (buffer_pool_.empty()) {
+    return std::make_unique<Decoder::Buffer>();
+  }
+  std::unique_ptr<Decoder::Buffer> buffer = std::move(buffer_pool_.back());
+  buffer_pool_.pop_back();
+  return buffer;
+}
+
+void DecodeWorker::Decode(FrameId frame_id,
+                          std::unique_ptr<Decoder::Buffer> buffer) {
+  OSP_DCHECK(task_runner_->IsRunningOnTaskRunner());
+  OSP_DCHECK(buffer);
+
+  if (mode_ == Mode::kCallingThread) {
+    DecodeAndRecycle(frame_id, std::move(buffer));
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    OSP_DCHECK_LT(static_cast<int>(queue_.size()), kMaxQueuedFrames);
+    queue_.push_back(QueuedFrame{frame_id, std::move(buffer)});
+    stats_.max_queue_depth =
+        std::max(stats_.max_queue_depth, static_cast<int>(queue_.size()));
+  }
+  queue_changed_.notify_one();
+}
+
+DecodeWorker::Stats DecodeWorker::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void DecodeWorker::RunDecodeLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    queue_changed_.wait(
+        lock, [this] { return is_shutting_down_ || !queue_.empty(); });
+    if (is_shutting_down_) {
+      return;
+    }
+
+    QueuedFrame next = std::move(queue_.front());
+    queue_.pop_front();
+    const bool notify_client = client_waiting_for_space_;
+    client_waiting_for_space_ = false;
+    lock.unlock();
+
+    if (notify_client) {
+      PostToClient([](DecodeWorker::Client* client) {
+        client->OnDecodeQueueSpaceAvailable();
+      });
+    }
+    DecodeAndRecycle(next.frame_id, std::move(next.buffer));
+
+    lock.lock();
+  }
+}
+
+void DecodeWorker::DecodeAndRecycle(FrameId frame_id,
+                                    std::unique_ptr<Decoder::Buffer> buffer) {
+  TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneReceiver);
+  const Clock::time_point start_time = now_();
+  decoder_.Decode(frame_id, *buffer);
+  const Clock::duration decode_time = now_() - start_time;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.num_frames_submitted;
+  stats_.total_decode_time += decode_time;
+  if (static_cast<int>(buffer_pool_.size()) < kMaxPooledBuffers) {
+    buffer_pool_.push_back(std::move(buffer));
+  }
+}
+
+template <typename Callback>
+void DecodeWorker::PostToClient(Callback callback) {
+  // The WeakPtr may be created on any thread, but must only be dereferenced on
+  // the TaskRunner thread.
+  task_runner_->PostTask(
+      [weak_this = weak_factory_.GetWeakPtr(),
+       callback = std::move(callback)]() mutable {
+        if (weak_this && weak_this->client_) {
+          callback(weak_this->client_);
+        }
+      });
+}
+
+void DecodeWorker::OnFrameDecoded(FrameId frame_id, const AVFrame& frame) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.num_frames_decoded;
+  }
+
+  if (mode_ == Mode::kCallingThread) {
+    if (client_) {
+      client_->OnFrameDecoded(frame_id, frame);
+    }
+    return;
+  }
+
+  // av_frame_clone() does a shallow copy here, incrementing a ref-count on the
+  // memory backing the frame. This allows the Decoder to continue decoding into
+  // its own AVFrame while the Client processes this one.
+  AVFrameUniquePtr clone(av_frame_clone(&frame));
+  if (!clone) {
+    OnDecodeError(frame_id, "failed to clone decoded frame");
+    return;
+  }
+  PostToClient([frame_id, decoded_frame = std::move(clone)](
+                   DecodeWorker::Client* client) {
+    client->OnFrameDecoded(frame_id, *decoded_frame);
+  });
+}
+
+void DecodeWorker::OnDecodeError(FrameId frame_id, std::string message) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.num_decode_errors;
+  }
+
+  if (mode_ == Mode::kCallingThread) {
+    if (client_) {
+      client_->OnDecodeError(frame_id, std::move(message));
+    }
+    return;
+  }
+
+  PostToClient([frame_id, message = std::move(message)](
+                   DecodeWorker::Client* client) mutable {
+    client->OnDecodeError(frame_id, std::move(message));
+  });
+}
+
+void DecodeWorker::OnFatalError(std::string message) {
+  if (mode_ == Mode::kCallingThread) {
+    if (client_) {
+      client_->OnFatalError(std::move(message));
+    }
+    return;
+  }
+
+  PostToClient(
+      [message = std::move(message)](DecodeWorker::Client* client) mutable {
+        client->OnFatalError(std::move(message));
+      });
+}
+
+// static
+constexpr int DecodeWorker::kMaxQueuedFrames;
+
+}  // namespace cast
+}  // namespace openscreen
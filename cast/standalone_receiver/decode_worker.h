@@ -0,0 +1,148 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STANDALONE_RECEIVER_DECODE_WORKER_H_
+#define CAST_STANDALONE_RECEIVER_DECODE_WORKER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cast/standalone_receiver/avcodec_glue.h"
+#include "cast/standalone_receiver/decoder.h"
+#include "cast/streaming/frame_id.h"
+#include "platform/api/task_runner.h"
+#include "platform/api/time.h"
+#include "util/weak_ptr.h"
+
+namespace openscreen {
+namespace cast {
+
+// Runs a Decoder on a dedicated thread, so that decoding does not block the
+// TaskRunner thread, which must also service the Receiver's packet I/O and
+// send its RTCP reports on time. Encoded frames are queued in pooled input
+// buffers (up to a bounded queue size), and the results are posted back to the
+// TaskRunner thread, where the Client is called.
+//
+// For comparison purposes, decoding can also be done synchronously on the
+// calling thread, in which case the Client is called before Decode() returns
+// (i.e., the same behavior as using a Decoder directly).
+//
+// All public methods must be called on the TaskRunner thread.
+class DecodeWorker final : public Decoder::Client {
+ public:
+  enum class Mode {
+    kWorkerThread,
+    kCallingThread,
+  };
+
+  class Client : public Decoder::Client {
+   public:
+    // Called after CanAcceptFrame() returned false, once there is room in the
+    // input queue for more frames.
+    virtual void OnDecodeQueueSpaceAvailable() = 0;
+
+   protected:
+    Client();
+    ~Client() override;
+  };
+
+  struct Stats {
+    // The number of frames passed to Decode(), and the number of decoded frames
+    // and decode errors that resulted.
+    int num_frames_submitted = 0;
+    int num_frames_decoded = 0;
+    int num_decode_errors = 0;
+
+    // The total time spent decoding, which excludes time spent waiting in the
+    // input queue.
+    Clock::duration total_decode_time{};
+
+    // The maximum number of frames that were waiting in the input queue.
+    int max_queue_depth = 0;
+  };
+
+  // The maximum number of frames that may wait in the input queue.
+  static constexpr int kMaxQueuedFrames = 4;
+
+  // |codec_name| should be the codec_name field from an OFFER message.
+  DecodeWorker(ClockNowFunctionPtr now_function,
+               TaskRunner* task_runner,
+               const std::string& codec_name,
+               Mode mode);
+  ~DecodeWorker() final;
+
+  DecodeWorker::Client* client() const { return client_; }
+  void set_client(DecodeWorker::Client* client) { client_ = client; }
+
+  // Returns true if there is room in the input queue for another frame.
+  // Otherwise, returns false and arranges for the Client to be notified once
+  // there is room.
+  bool CanAcceptFrame();
+
+  // Returns an input buffer to be populated with an encoded frame's data and
+  // then passed to Decode(). Buffers are recycled after each frame is decoded,
+  // so that their memory is re-used.
+  std::unique_ptr<Decoder::Buffer> AcquireBuffer();
+
+  // Queues the data in |buffer|, which should be associated with the given
+  // |frame_id|, for decoding. CanAcceptFrame() must have returned true.
+  void Decode(FrameId frame_id, std::unique_ptr<Decoder::Buffer> buffer);
+
+  // Returns a snapshot of the statistics tracked since construction.
+  Stats GetStats() const;
+
+ private:
+  struct QueuedFrame {
+    FrameId frame_id;
+    std::unique_ptr<Decoder::Buffer> buffer;
+  };
+
+  // Runs on the worker thread, decoding queued frames until shutdown.
+  void RunDecodeLoop();
+
+  // Decodes one frame, timing how long it takes, and then recycles its buffer.
+  void DecodeAndRecycle(FrameId frame_id,
+                        std::unique_ptr<Decoder::Buffer> buffer);
+
+  // Posts a task to the TaskRunner thread that calls |callback| with the
+  // Client, if both this DecodeWorker and the Client still exist by then.
+  template <typename Callback>
+  void PostToClient(Callback callback);
+
+  // Decoder::Client implementation. These are called on the decoding thread.
+  void OnFrameDecoded(FrameId frame_id, const AVFrame& frame) final;
+  void OnDecodeError(FrameId frame_id, std::string message) final;
+  void OnFatalError(std::string message) final;
+
+  const ClockNowFunctionPtr now_;
+  TaskRunner* const task_runner_;
+  const Mode mode_;
+
+  Decoder decoder_;
+
+  DecodeWorker::Client* client_ = nullptr;
+
+  // Guards all of the members below it, which are accessed by both threads.
+  mutable std::mutex mutex_;
+  std::condition_variable queue_changed_;
+  std::deque<QueuedFrame> queue_;
+  std::vector<std::unique_ptr<Decoder::Buffer>> buffer_pool_;
+  bool client_waiting_for_space_ = false;
+  bool is_shutting_down_ = false;
+  Stats stats_;
+
+  std::thread worker_thread_;
+
+  WeakPtrFactory<DecodeWorker> weak_factory_{this};
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STANDALONE_RECEIVER_DECODE_WORKER_H_
@@ -128,16 +128,28 @@ bool Decoder::Initialize() {
     return false;
   }
 
-  // This should always be greater than zero, so that decoding doesn't block the
-  // main thread of this receiver app and cause playback timing issues. The
-  // actual number should be tuned, based on the number of CPU cores.
+  // The thread count should always be greater than zero, so that decoding
+  // doesn't block the calling thread for longer than necessary. The actual
+  // number should be tuned, based on the number of CPU cores.
   //
   // This should also be 16 or less, since the encoder implementations emit
   // warnings about too many encode threads. FFMPEG's VP8 implementation
   // actually silently freezes if this is 10 or more. Thus, 8 is used for the
   // max here, just to be safe.
-  context_->thread_count =
-      std::min(std::max<int>(std::thread::hardware_concurrency(), 1), 8);
+  //
+  // With frame threading, each thread adds one frame of output delay, so fewer
+  // threads are used to bound the added latency. Otherwise, only slice
+  // threading is used, which adds no delay.
+  const int num_cores = std::max<int>(std::thread::hardware_concurrency(), 1);
+  if (frame_threading_enabled_ &&
+      (codec_->capabilities & AV_CODEC_CAP_FRAME_THREADS)) {
+    constexpr int kMaxFrameThreads = 4;
+    context_->thread_type = FF_THREAD_FRAME;
+    context_->thread_count = std::min(num_cores, kMaxFrameThreads);
+  } else {
+    context_->thread_type = FF_THREAD_SLICE;
+    context_->thread_count = std::min(num_cores, 8);
+  }
   const int open_result = avcodec_open2(context_.get(), codec_, nullptr);
   if (open_result < 0) {
     HandleInitializationError("failed to open codec", open_result);
@@ -55,6 +55,16 @@ class Decoder {
   Client* client() const { return client_; }
   void set_client(Client* client) { client_ = client; }
 
+  // Enables FFMPEG frame threading, for codecs that support it. This must be
+  // called before the first Decode() call. Frame threading decodes several
+  // frames in parallel, greatly increasing throughput; but it delays the output
+  // of each frame by up to a few frames, and Decode() may block waiting for a
+  // decoder thread to become free. Thus, it should only be enabled when
+  // decoding is not happening on the main thread (see DecodeWorker).
+  void set_frame_threading_enabled(bool enabled) {
+    frame_threading_enabled_ = enabled;
+  }
+
   // Starts decoding the data in |buffer|, which should be associated with the
   // given |frame_id|. This will synchronously call Client::OnFrameDecoded()
   // and/or Client::OnDecodeError() zero or more times with results. Note that
@@ -87,6 +97,7 @@ class Decoder {
   AVFrameUniquePtr decoded_frame_;
 
   Client* client_ = nullptr;
+  bool frame_threading_enabled_ = false;
 
   // Queue of frames that have been input to the libavcodec decoder, but which
   // have not yet had output generated by it.
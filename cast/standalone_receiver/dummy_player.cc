@@ -5,30 +5,195 @@
 #include "cast/standalone_receiver/dummy_player.h"
 
 #include <chrono>
+#include <utility>
 
 #include "absl/types/span.h"
 #include "cast/streaming/encoded_frame.h"
 #include "util/chrono_helpers.h"
 #include "util/osp_logging.h"
 
+#if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+#include "cast/standalone_receiver/avcodec_glue.h"
+#include "cast/streaming/statistics.h"
+#include "util/alarm.h"
+#endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+
 namespace openscreen {
 namespace cast {
 
+#if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+class DummyPlayer::DecodeBenchmark final : public DecodeWorker::Client {
+ public:
+  DecodeBenchmark(ClockNowFunctionPtr now_function,
+                  TaskRunner* task_runner,
+                  Receiver* receiver,
+                  const std::string& codec_name,
+                  DecodeWorker::Mode decode_mode)
+      : now_(now_function),
+        receiver_(receiver),
+        decode_mode_(decode_mode),
+        decoder_(now_function, task_runner, codec_name, decode_mode),
+        report_alarm_(now_function, task_runner),
+        start_time_(now_()) {
+    decoder_.set_client(this);
+    ScheduleReport();
+  }
+
+  ~DecodeBenchmark() final {
+    decoder_.set_client(nullptr);
+    LogReport();
+  }
+
+  // Consumes the next frame and queues it for decoding, unless the decoder
+  // cannot accept it right now. In that case, the frame is consumed later, from
+  // OnDecodeQueueSpaceAvailable().
+  void ConsumeAndDecode(int buffer_size) {
+    if (has_failed_) {
+      // Keep the stream flowing, even though nothing can be decoded.
+      discard_buffer_.resize(buffer_size);
+      receiver_->ConsumeNextFrame(absl::Span<uint8_t>(discard_buffer_));
+      return;
+    }
+    if (!decoder_.CanAcceptFrame()) {
+      return;
+    }
+    std::unique_ptr<Decoder::Buffer> buffer = decoder_.AcquireBuffer();
+    buffer->Resize(buffer_size);
+    const EncodedFrame frame = receiver_->ConsumeNextFrame(buffer->GetSpan());
+    decoder_.Decode(frame.frame_id, std::move(buffer));
+  }
+
+ private:
+  // DecodeWorker::Client implementation. The decoded frames are discarded,
+  // since the DecodeWorker already tracks the throughput.
+  void OnFrameDecoded(FrameId frame_id, const AVFrame& frame) final {}
+
+  void OnDecodeError(FrameId frame_id, std::string message) final {
+    OSP_LOG_WARN << "[SSRC " << receiver_->ssrc()
+                 << "] Requesting key frame because of error decoding "
+                 << frame_id << ": " << message;
+    receiver_->RequestKeyFrame();
+  }
+
+  void OnFatalError(std::string message) final {
+    OSP_LOG_ERROR << "[SSRC " << receiver_->ssrc()
+                  << "] Decode benchmark halted: " << message;
+    has_failed_ = true;
+  }
+
+  void OnDecodeQueueSpaceAvailable() final {
+    const int buffer_size = receiver_->AdvanceToNextFrame();
+    if (buffer_size != Receiver::kNoFramesReady) {
+      ConsumeAndDecode(buffer_size);
+    }
+  }
+
+  void ScheduleReport() {
+    constexpr auto kReportInterval = seconds(5);
+    report_alarm_.ScheduleFromNow(
+        [this] {
+          LogReport();
+          ScheduleReport();
+        },
+        kReportInterval);
+  }
+
+  void LogReport() const {
+    const DecodeWorker::Stats stats = decoder_.GetStats();
+    const ReceiverStats receiver_stats = receiver_->GetStats();
+    const double elapsed_seconds =
+        std::chrono::duration<double>(now_() - start_time_).count();
+    const auto mean_decode_time =
+        stats.num_frames_submitted > 0
+            ? to_microseconds(stats.total_decode_time).count() /
+                  stats.num_frames_submitted
+            : 0;
+    const FixedBucketHistogram& lateness =
+        receiver_stats.rtcp_send_lateness_ms;
+
+    OSP_LOG_INFO
+        << "[SSRC " << receiver_->ssrc() << "] Decode benchmark ("
+        << (decode_mode_ == DecodeWorker::Mode::kWorkerThread ? "worker thread"
+                                                              : "main thread")
+        << "): " << stats.num_frames_decoded << " frames decoded ("
+        << (elapsed_seconds > 0 ? stats.num_frames_decoded / elapsed_seconds
+                                : 0)
+        << " FPS), " << stats.num_decode_errors
+        << " errors, mean decode time " << mean_decode_time
+        << " µs, max queue depth " << stats.max_queue_depth << "; "
+        << receiver_stats.num_frames_dropped_late
+        << " frames dropped late; RTCP send lateness p50 <= "
+        << lateness.GetApproximatePercentile(0.5) << " ms, p95 <= "
+        << lateness.GetApproximatePercentile(0.95) << " ms, p100 <= "
+        << lateness.GetApproximatePercentile(1.0) << " ms.";
+  }
+
+  const ClockNowFunctionPtr now_;
+  Receiver* const receiver_;
+  const DecodeWorker::Mode decode_mode_;
+  DecodeWorker decoder_;
+  Alarm report_alarm_;
+  const Clock::time_point start_time_;
+
+  bool has_failed_ = false;
+  std::vector<uint8_t> discard_buffer_;
+};
+#endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+
 DummyPlayer::DummyPlayer(Receiver* receiver) : receiver_(receiver) {
   OSP_DCHECK(receiver_);
   receiver_->SetConsumer(this);
 }
 
+DummyPlayer::DummyPlayer(Receiver* receiver, BenchmarkStreamRecorder* recorder)
+    : receiver_(receiver), recorder_(recorder) {
+  OSP_DCHECK(receiver_);
+  OSP_DCHECK(recorder_);
+  receiver_->SetConsumer(this);
+}
+
+#if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+DummyPlayer::DummyPlayer(ClockNowFunctionPtr now_function,
+                         TaskRunner* task_runner,
+                         Receiver* receiver,
+                         const std::string& codec_name,
+                         DecodeWorker::Mode decode_mode)
+    : receiver_(receiver),
+      decode_benchmark_(std::make_unique<DecodeBenchmark>(now_function,
+                                                          task_runner,
+                                                          receiver,
+                                                          codec_name,
+                                                          decode_mode)) {
+  OSP_DCHECK(receiver_);
+  receiver_->SetConsumer(this);
+}
+#endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+
 DummyPlayer::~DummyPlayer() {
   receiver_->SetConsumer(nullptr);
+  if (recorder_) {
+    recorder_->OnReceiverStopped(receiver_->GetStats());
+  }
 }
 
 void DummyPlayer::OnFramesReady(int buffer_size) {
+#if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+  if (decode_benchmark_) {
+    decode_benchmark_->ConsumeAndDecode(buffer_size);
+    return;
+  }
+#endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+
   // Consume the next frame.
   buffer_.resize(buffer_size);
   const EncodedFrame frame =
       receiver_->ConsumeNextFrame(absl::Span<uint8_t>(buffer_));
 
+  if (recorder_) {
+    recorder_->OnFrameConsumed(frame.data, BenchmarkPayloadHeader::Now());
+    return;
+  }
+
   // Convert the RTP timestamp to a human-readable timestamp (in µs) and log
   // some short information about the frame.
   const auto media_timestamp =
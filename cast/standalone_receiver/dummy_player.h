@@ -7,12 +7,19 @@
 
 #include <stdint.h>
 
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "cast/streaming/benchmark_payload.h"
 #include "cast/streaming/receiver.h"
 #include "platform/api/task_runner.h"
 #include "platform/api/time.h"
 
+#if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+#include "cast/standalone_receiver/decode_worker.h"
+#endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+
 namespace openscreen {
 namespace cast {
 
@@ -20,18 +27,53 @@ namespace cast {
 // each one's FrameId, timestamp and size. This is only useful for confirming a
 // Receiver is successfully receiving a stream, for platforms where
 // SDLVideoPlayer cannot be built.
+//
+// Alternatively, as a benchmark sink, it passes each frame to a
+// BenchmarkStreamRecorder, which measures the latency, frame rate stability
+// and losses of a stream whose payloads carry BenchmarkPayloadHeaders.
+//
+// When FFMPEG is available, it can instead act as a headless decode benchmark:
+// Each frame is decoded and then discarded, and the decode throughput is logged
+// periodically, along with how late the Receiver has been in sending its RTCP
+// reports. Comparing runs that decode on a worker thread against ones that
+// decode on the main thread shows the impact of decoding on the timeliness of
+// the feedback sent to the Sender.
 class DummyPlayer final : public Receiver::Consumer {
  public:
   explicit DummyPlayer(Receiver* receiver);
 
+  // Constructs a benchmark sink, which records each frame with |recorder|
+  // instead of logging it. |recorder| must outlive this DummyPlayer.
+  DummyPlayer(Receiver* receiver, BenchmarkStreamRecorder* recorder);
+
+#if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+  // Constructs a headless decode benchmark. |codec_name| should be the
+  // codec_name field from an OFFER message.
+  DummyPlayer(ClockNowFunctionPtr now_function,
+              TaskRunner* task_runner,
+              Receiver* receiver,
+              const std::string& codec_name,
+              DecodeWorker::Mode decode_mode);
+#endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+
   ~DummyPlayer() final;
 
  private:
+#if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+  // Decodes the consumed frames and periodically logs the benchmark results.
+  class DecodeBenchmark;
+#endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+
   // Receiver::Consumer implementation.
   void OnFramesReady(int next_frame_buffer_size) final;
 
   Receiver* const receiver_;
+  BenchmarkStreamRecorder* const recorder_ = nullptr;
   std::vector<uint8_t> buffer_;
+
+#if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+  std::unique_ptr<DecodeBenchmark> decode_benchmark_;
+#endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
 };
 
 }  // namespace cast
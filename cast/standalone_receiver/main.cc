@@ -13,7 +13,9 @@
 
 #include "absl/strings/str_cat.h"
 #include "cast/receiver/channel/static_credentials.h"
+#include "cast/standalone_receiver/benchmark_sink.h"
 #include "cast/standalone_receiver/cast_service.h"
+#include "cast/standalone_receiver/streaming_playback_controller.h"
 #include "platform/api/time.h"
 #include "platform/base/error.h"
 #include "platform/base/ip_address.h"
@@ -62,6 +64,22 @@ options:
 
     -m, --model-name: Model name to be used for device discovery.
 
+    -b, --decode-benchmark: Instead of playing out the streams in a window,
+                            decode and discard each frame, periodically
+                            logging the decode throughput and how late the
+                            RTCP reports to the sender are. Requires FFMPEG.
+
+    -M, --decode-on-main-thread: With -b, decode on the main thread instead of
+                                 a worker thread, for comparison.
+
+    -o, --benchmark-output=path: Instead of playing out the streams in a
+                                 window, consume the synthetic frames sent by
+                                 cast_sender's --benchmark mode, and on exit,
+                                 write each stream's capture-to-consume
+                                 latency, frame rate stability and drop counts
+                                 to the given path as JSON. The sender's and
+                                 receiver's clocks must be synchronized.
+
     -t, --tracing: Enable performance tracing logging.
 
     -v, --verbose: Enable verbose logging.
@@ -95,17 +113,19 @@ InterfaceInfo GetInterfaceInfoFromName(const char* name) {
   return interface_info;
 }
 
-void RunCastService(TaskRunnerImpl* task_runner,
-                    const InterfaceInfo& interface,
-                    GeneratedCredentials creds,
-                    const std::string& friendly_name,
-                    const std::string& model_name,
-                    bool discovery_enabled) {
+void RunCastService(
+    TaskRunnerImpl* task_runner,
+    const InterfaceInfo& interface,
+    GeneratedCredentials creds,
+    const std::string& friendly_name,
+    const std::string& model_name,
+    const StreamingPlaybackController::Options& playback_options,
+    bool discovery_enabled) {
   std::unique_ptr<CastService> service;
   task_runner->PostTask([&] {
-    service = std::make_unique<CastService>(task_runner, interface,
-                                            std::move(creds), friendly_name,
-                                            model_name, discovery_enabled);
+    service = std::make_unique<CastService>(
+        task_runner, interface, std::move(creds), friendly_name, model_name,
+        playback_options, discovery_enabled);
   });
 
   OSP_LOG_INFO << "CastService is running. CTRL-C (SIGINT), or send a "
@@ -142,6 +162,9 @@ int RunStandaloneReceiver(int argc, char* argv[]) {
       {"generate-credentials", no_argument, nullptr, 'g'},
       {"friendly-name", required_argument, nullptr, 'f'},
       {"model-name", required_argument, nullptr, 'm'},
+      {"decode-benchmark", no_argument, nullptr, 'b'},
+      {"decode-on-main-thread", no_argument, nullptr, 'M'},
+      {"benchmark-output", required_argument, nullptr, 'o'},
       {"tracing", no_argument, nullptr, 't'},
       {"verbose", no_argument, nullptr, 'v'},
       {"help", no_argument, nullptr, 'h'},
@@ -158,9 +181,11 @@ int RunStandaloneReceiver(int argc, char* argv[]) {
   std::string friendly_name = "Cast Standalone Receiver";
   std::string model_name = "cast_standalone_receiver";
   bool should_generate_credentials = false;
+  StreamingPlaybackController::Options playback_options;
+  std::string benchmark_output_path;
   std::unique_ptr<TextTraceLoggingPlatform> trace_logger;
   int ch = -1;
-  while ((ch = getopt_long(argc, argv, "p:d:f:m:gtvhx", kArgumentOptions,
+  while ((ch = getopt_long(argc, argv, "p:d:f:m:bMo:gtvhx", kArgumentOptions,
                            nullptr)) != -1) {
     switch (ch) {
       case 'p':
@@ -175,6 +200,15 @@ int RunStandaloneReceiver(int argc, char* argv[]) {
       case 'm':
         model_name = optarg;
         break;
+      case 'b':
+        playback_options.decode_benchmark = true;
+        break;
+      case 'M':
+        playback_options.decode_on_main_thread = true;
+        break;
+      case 'o':
+        benchmark_output_path = optarg;
+        break;
       case 'g':
         should_generate_credentials = true;
         break;
@@ -207,6 +241,11 @@ int RunStandaloneReceiver(int argc, char* argv[]) {
     return 1;
   }
 
+  if (playback_options.decode_benchmark && !benchmark_output_path.empty()) {
+    OSP_LOG_FATAL << "The -b and -o benchmark modes cannot be combined.";
+    return 1;
+  }
+
   const char* interface_name = argv[optind];
   OSP_CHECK(interface_name && strlen(interface_name) > 0)
       << "No interface name provided.";
@@ -229,13 +268,31 @@ int RunStandaloneReceiver(int argc, char* argv[]) {
     discovery_enabled = false;
   }
 
+  // The sink outlives the CastService, so that it collects the final stats of
+  // every stream, which are recorded as the Receivers are destroyed.
+  std::unique_ptr<BenchmarkSink> benchmark_sink;
+  if (!benchmark_output_path.empty()) {
+    benchmark_sink = std::make_unique<BenchmarkSink>();
+    playback_options.benchmark_sink = benchmark_sink.get();
+  }
+
   auto* const task_runner = new TaskRunnerImpl(&Clock::now);
   PlatformClientPosix::Create(milliseconds(50),
                               std::unique_ptr<TaskRunnerImpl>(task_runner));
   RunCastService(task_runner, interface, std::move(creds.value()),
-                 friendly_name, model_name, discovery_enabled);
+                 friendly_name, model_name, playback_options,
+                 discovery_enabled);
   PlatformClientPosix::ShutDown();
 
+  if (benchmark_sink) {
+    const Error result = benchmark_sink->WriteJsonFile(benchmark_output_path);
+    if (!result.ok()) {
+      OSP_LOG_ERROR << result;
+      return 1;
+    }
+    OSP_LOG_INFO << "Wrote benchmark results to " << benchmark_output_path;
+  }
+
   return 0;
 }
 
@@ -20,13 +20,16 @@ const char kMirroringAudioOnlyAppId[] = "85CDB22F";
 const char kMirroringDisplayName[] = "Chrome Mirroring";
 const char kRemotingRpcNamespace[] = "urn:x-cast:com.google.cast.remoting";
 
-MirroringApplication::MirroringApplication(TaskRunner* task_runner,
-                                           const IPAddress& interface_address,
-                                           ApplicationAgent* agent)
+MirroringApplication::MirroringApplication(
+    TaskRunner* task_runner,
+    const IPAddress& interface_address,
+    ApplicationAgent* agent,
+    const StreamingPlaybackController::Options& playback_options)
     : task_runner_(task_runner),
       interface_address_(interface_address),
       app_ids_({kMirroringAppId, kMirroringAudioOnlyAppId}),
-      agent_(agent) {
+      agent_(agent),
+      playback_options_(playback_options) {
   OSP_DCHECK(task_runner_);
   OSP_DCHECK(agent_);
   agent_->RegisterApplication(this);
@@ -53,8 +56,8 @@ bool MirroringApplication::Launch(const std::string& app_id,
   environment_ = std::make_unique<Environment>(
       &Clock::now, task_runner_,
       IPEndpoint{interface_address_, kDefaultCastStreamingPort});
-  controller_ =
-      std::make_unique<StreamingPlaybackController>(task_runner_, this);
+  controller_ = std::make_unique<StreamingPlaybackController>(
+      task_runner_, this, playback_options_);
   current_session_ = std::make_unique<ReceiverSession>(
       controller_.get(), environment_.get(), message_port,
       ReceiverSession::Preferences{});
@@ -33,7 +33,9 @@ class MirroringApplication final : public ApplicationAgent::Application,
  public:
   MirroringApplication(TaskRunner* task_runner,
                        const IPAddress& interface_address,
-                       ApplicationAgent* agent);
+                       ApplicationAgent* agent,
+                       const StreamingPlaybackController::Options&
+                           playback_options);
 
   ~MirroringApplication() final;
 
@@ -56,6 +58,7 @@ class MirroringApplication final : public ApplicationAgent::Application,
   const IPAddress interface_address_;
   const std::vector<std::string> app_ids_;
   ApplicationAgent* const agent_;
+  const StreamingPlaybackController::Options playback_options_;
 
   SerialDeletePtr<ScopedWakeLock> wake_lock_;
   std::unique_ptr<Environment> environment_;
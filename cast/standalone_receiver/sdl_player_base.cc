@@ -5,6 +5,7 @@
 #include "cast/standalone_receiver/sdl_player_base.h"
 
 #include <chrono>
+#include <memory>
 #include <sstream>
 #include <utility>
 
@@ -30,7 +31,10 @@ SDLPlayerBase::SDLPlayerBase(ClockNowFunctionPtr now_function,
       receiver_(receiver),
       error_callback_(std::move(error_callback)),
       media_type_(media_type),
-      decoder_(codec_name),
+      decoder_(now_function,
+               task_runner,
+               codec_name,
+               DecodeWorker::Mode::kWorkerThread),
       decode_alarm_(now_, task_runner),
       render_alarm_(now_, task_runner),
       presentation_alarm_(now_, task_runner) {
@@ -94,15 +98,18 @@ Clock::time_point SDLPlayerBase::ResyncAndDeterminePresentationTime(
 void SDLPlayerBase::OnFramesReady(int buffer_size) {
   TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneReceiver);
   // Do not consume anything if there are too many frames in the pipeline
-  // already.
-  if (static_cast<int>(frames_to_render_.size()) > kMaxFramesInPipeline) {
+  // already, or the decoder's input queue is full. In the latter case,
+  // OnDecodeQueueSpaceAvailable() will be called later.
+  if (static_cast<int>(frames_to_render_.size()) > kMaxFramesInPipeline ||
+      !decoder_.CanAcceptFrame()) {
     return;
   }
 
-  // Consume the next frame.
+  // Consume the next frame into a pooled input buffer.
   const Clock::time_point start_time = now_();
-  buffer_.Resize(buffer_size);
-  EncodedFrame frame = receiver_->ConsumeNextFrame(buffer_.GetSpan());
+  std::unique_ptr<Decoder::Buffer> buffer = decoder_.AcquireBuffer();
+  buffer->Resize(buffer_size);
+  EncodedFrame frame = receiver_->ConsumeNextFrame(buffer->GetSpan());
 
   // Create the tracking state for the frame in the player pipeline.
   OSP_DCHECK_EQ(frames_to_render_.count(frame.frame_id), 0);
@@ -111,9 +118,9 @@ void SDLPlayerBase::OnFramesReady(int buffer_size) {
 
   pending_frame.presentation_time = ResyncAndDeterminePresentationTime(frame);
 
-  // Start decoding the frame. This call may synchronously call back into the
-  // AVCodecDecoder::Client methods in this class.
-  decoder_.Decode(frame.frame_id, buffer_);
+  // Queue the frame for decoding. The results are posted back later, to the
+  // DecodeWorker::Client methods in this class.
+  decoder_.Decode(frame.frame_id, std::move(buffer));
 }
 
 void SDLPlayerBase::OnFrameDecoded(FrameId frame_id, const AVFrame& frame) {
@@ -141,6 +148,10 @@ void SDLPlayerBase::OnDecodeError(FrameId frame_id, std::string message) {
   ResumeDecoding();
 }
 
+void SDLPlayerBase::OnDecodeQueueSpaceAvailable() {
+  ResumeDecoding();
+}
+
 void SDLPlayerBase::RenderAndSchedulePresentation() {
   TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneReceiver);
   // If something has already been scheduled to present at an exact time point,
@@ -11,7 +11,7 @@
 #include <map>
 #include <string>
 
-#include "cast/standalone_receiver/decoder.h"
+#include "cast/standalone_receiver/decode_worker.h"
 #include "cast/standalone_receiver/sdl_glue.h"
 #include "cast/streaming/message_fields.h"
 #include "cast/streaming/receiver.h"
@@ -22,10 +22,11 @@
 namespace openscreen {
 namespace cast {
 
-// Common base class that consumes frames from a Receiver, decodes them, and
-// plays them out via the appropriate SDL subsystem. Subclasses implement the
-// specifics, based on the type of media (audio or video).
-class SDLPlayerBase : public Receiver::Consumer, public Decoder::Client {
+// Common base class that consumes frames from a Receiver, decodes them (on a
+// DecodeWorker thread), and plays them out via the appropriate SDL subsystem.
+// Subclasses implement the specifics, based on the type of media (audio or
+// video).
+class SDLPlayerBase : public Receiver::Consumer, public DecodeWorker::Client {
  public:
   ~SDLPlayerBase() override;
 
@@ -103,10 +104,11 @@ class SDLPlayerBase : public Receiver::Consumer, public Decoder::Client {
   Clock::time_point ResyncAndDeterminePresentationTime(
       const EncodedFrame& frame);
 
-  // AVCodecDecoder::Client implementation. These are called-back from
+  // DecodeWorker::Client implementation. These are called-back from
   // |decoder_| to provide results.
   void OnFrameDecoded(FrameId frame_id, const AVFrame& frame) final;
   void OnDecodeError(FrameId frame_id, std::string message) final;
+  void OnDecodeQueueSpaceAvailable() final;
 
   // Calls RenderNextFrame() on the next available decoded frame, and schedules
   // its presentation. If no decoded frame is available, RenderWhileIdle() is
@@ -143,16 +145,13 @@ class SDLPlayerBase : public Receiver::Consumer, public Decoder::Client {
 
   std::map<FrameId, PendingFrame> frames_to_render_;
 
-  // Buffer for holding EncodedFrame::data.
-  Decoder::Buffer buffer_;
-
   // Associates a RTP timestamp with a local clock time point. This is updated
   // whenever the media (RTP) timestamps drift too much away from the rate at
   // which the local clock ticks. This is important for A/V synchronization.
   RtpTimeTicks last_sync_rtp_timestamp_{};
   Clock::time_point last_sync_reference_time_{};
 
-  Decoder decoder_;
+  DecodeWorker decoder_;
 
   // The decoded frame to be rendered/presented.
   PendingFrame current_frame_;
@@ -10,10 +10,12 @@
 #include "cast/standalone_receiver/sdl_audio_player.h"
 #include "cast/standalone_receiver/sdl_glue.h"
 #include "cast/standalone_receiver/sdl_video_player.h"
-#else
-#include "cast/standalone_receiver/dummy_player.h"
 #endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
 
+#include "cast/standalone_receiver/dummy_player.h"
+#include "cast/streaming/message_fields.h"
+#include "cast/streaming/receiver.h"
+#include "util/osp_logging.h"
 #include "util/trace_logging.h"
 
 namespace openscreen {
@@ -22,9 +24,11 @@ namespace cast {
 #if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
 StreamingPlaybackController::StreamingPlaybackController(
     TaskRunner* task_runner,
-    StreamingPlaybackController::Client* client)
+    StreamingPlaybackController::Client* client,
+    const Options& options)
     : task_runner_(task_runner),
       client_(client),
+      options_(options),
       sdl_event_loop_(task_runner_, [this] {
         client_->OnPlaybackError(this,
                                  Error{Error::Code::kOperationCancelled,
@@ -32,6 +36,9 @@ StreamingPlaybackController::StreamingPlaybackController(
       }) {
   OSP_DCHECK(task_runner_ != nullptr);
   OSP_DCHECK(client_ != nullptr);
+  if (options_.decode_benchmark || options_.benchmark_sink) {
+    return;  // Headless.
+  }
   constexpr int kDefaultWindowWidth = 1280;
   constexpr int kDefaultWindowHeight = 720;
   window_ = MakeUniqueSDLWindow(
@@ -46,18 +53,74 @@ StreamingPlaybackController::StreamingPlaybackController(
 #else
 StreamingPlaybackController::StreamingPlaybackController(
     TaskRunner* task_runner,
-    StreamingPlaybackController::Client* client)
-    : task_runner_(task_runner), client_(client) {
+    StreamingPlaybackController::Client* client,
+    const Options& options)
+    : task_runner_(task_runner), client_(client), options_(options) {
   OSP_DCHECK(task_runner_ != nullptr);
   OSP_DCHECK(client_ != nullptr);
+  OSP_LOG_IF(WARN, options_.decode_benchmark)
+      << "The decode benchmark requires FFMPEG, which is not available in this "
+         "build. Frames will only be logged.";
 }
 #endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
 
+namespace {
+
+std::unique_ptr<DummyPlayer> MakeBenchmarkSinkPlayer(BenchmarkSink* sink,
+                                                     const char* media_type,
+                                                     const char* codec,
+                                                     Receiver* receiver) {
+  return std::make_unique<DummyPlayer>(
+      receiver, sink->AddStream(media_type, codec, receiver->ssrc()));
+}
+
+}  // namespace
+
 void StreamingPlaybackController::OnMirroringNegotiated(
     const ReceiverSession* session,
     ReceiverSession::ConfiguredReceivers receivers) {
   TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneReceiver);
+  if (receivers.audio_receiver) {
+    receivers.audio_receiver->EnableFrameTimelines(this);
+  }
+  if (receivers.video_receiver) {
+    receivers.video_receiver->EnableFrameTimelines(this);
+  }
+
 #if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+  if (options_.benchmark_sink) {
+    if (receivers.audio_receiver) {
+      audio_benchmark_player_ = MakeBenchmarkSinkPlayer(
+          options_.benchmark_sink, "audio",
+          CodecToString(receivers.audio_config.codec),
+          receivers.audio_receiver);
+    }
+    if (receivers.video_receiver) {
+      video_benchmark_player_ = MakeBenchmarkSinkPlayer(
+          options_.benchmark_sink, "video",
+          CodecToString(receivers.video_config.codec),
+          receivers.video_receiver);
+    }
+    return;
+  }
+
+  if (options_.decode_benchmark) {
+    const DecodeWorker::Mode decode_mode =
+        options_.decode_on_main_thread ? DecodeWorker::Mode::kCallingThread
+                                       : DecodeWorker::Mode::kWorkerThread;
+    if (receivers.audio_receiver) {
+      audio_benchmark_player_ = std::make_unique<DummyPlayer>(
+          &Clock::now, task_runner_, receivers.audio_receiver,
+          CodecToString(receivers.audio_config.codec), decode_mode);
+    }
+    if (receivers.video_receiver) {
+      video_benchmark_player_ = std::make_unique<DummyPlayer>(
+          &Clock::now, task_runner_, receivers.video_receiver,
+          CodecToString(receivers.video_config.codec), decode_mode);
+    }
+    return;
+  }
+
   if (receivers.audio_receiver) {
     audio_player_ = std::make_unique<SDLAudioPlayer>(
         &Clock::now, task_runner_, receivers.audio_receiver,
@@ -73,6 +136,22 @@ void StreamingPlaybackController::OnMirroringNegotiated(
         });
   }
 #else
+  if (options_.benchmark_sink) {
+    if (receivers.audio_receiver) {
+      audio_player_ = MakeBenchmarkSinkPlayer(
+          options_.benchmark_sink, "audio",
+          CodecToString(receivers.audio_config.codec),
+          receivers.audio_receiver);
+    }
+    if (receivers.video_receiver) {
+      video_player_ = MakeBenchmarkSinkPlayer(
+          options_.benchmark_sink, "video",
+          CodecToString(receivers.video_config.codec),
+          receivers.video_receiver);
+    }
+    return;
+  }
+
   if (receivers.audio_receiver) {
     audio_player_ = std::make_unique<DummyPlayer>(receivers.audio_receiver);
   }
@@ -88,6 +167,10 @@ void StreamingPlaybackController::OnReceiversDestroying(
     ReceiversDestroyingReason reason) {
   audio_player_.reset();
   video_player_.reset();
+#if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+  audio_benchmark_player_.reset();
+  video_benchmark_player_.reset();
+#endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
 }
 
 void StreamingPlaybackController::OnError(const ReceiverSession* session,
@@ -95,5 +178,10 @@ void StreamingPlaybackController::OnError(const ReceiverSession* session,
   client_->OnPlaybackError(this, error);
 }
 
+void StreamingPlaybackController::OnFrameTimelineFinished(
+    const FrameTimeline& timeline) {
+  OSP_VLOG << "Receiver frame timeline " << timeline;
+}
+
 }  // namespace cast
 }  // namespace openscreen
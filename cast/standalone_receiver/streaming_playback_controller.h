@@ -7,6 +7,9 @@
 
 #include <memory>
 
+#include "cast/standalone_receiver/benchmark_sink.h"
+#include "cast/standalone_receiver/dummy_player.h"
+#include "cast/streaming/frame_timeline.h"
 #include "cast/streaming/receiver_session.h"
 #include "platform/impl/task_runner.h"
 
@@ -14,14 +17,13 @@
 #include "cast/standalone_receiver/sdl_audio_player.h"
 #include "cast/standalone_receiver/sdl_glue.h"
 #include "cast/standalone_receiver/sdl_video_player.h"
-#else
-#include "cast/standalone_receiver/dummy_player.h"
 #endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
 
 namespace openscreen {
 namespace cast {
 
-class StreamingPlaybackController final : public ReceiverSession::Client {
+class StreamingPlaybackController final : public ReceiverSession::Client,
+                                         public FrameTimelineRecorder::Client {
  public:
   class Client {
    public:
@@ -29,8 +31,26 @@ class StreamingPlaybackController final : public ReceiverSession::Client {
                                  Error error) = 0;
   };
 
+  struct Options {
+    // If true, no window is opened and nothing is played out. Instead, frames
+    // are decoded and discarded, and the decode throughput and its impact on
+    // the Receivers' RTCP timeliness are logged periodically. Requires FFMPEG.
+    bool decode_benchmark = false;
+
+    // If true, the decode benchmark decodes on the main thread, rather than on
+    // a worker thread, to measure the difference.
+    bool decode_on_main_thread = false;
+
+    // If set, no window is opened and nothing is played out. Instead, each
+    // frame's payload is expected to start with a BenchmarkPayloadHeader, and
+    // is recorded in this sink for later reporting. Must outlive the
+    // StreamingPlaybackController.
+    BenchmarkSink* benchmark_sink = nullptr;
+  };
+
   StreamingPlaybackController(TaskRunner* task_runner,
-                              StreamingPlaybackController::Client* client);
+                              StreamingPlaybackController::Client* client,
+                              const Options& options);
 
   // ReceiverSession::Client overrides.
   void OnMirroringNegotiated(
@@ -42,9 +62,14 @@ class StreamingPlaybackController final : public ReceiverSession::Client {
 
   void OnError(const ReceiverSession* session, Error error) override;
 
+  // FrameTimelineRecorder::Client overrides. Logs the per-frame latency
+  // breakdowns (at verbose log level).
+  void OnFrameTimelineFinished(const FrameTimeline& timeline) override;
+
  private:
   TaskRunner* const task_runner_;
   StreamingPlaybackController::Client* client_;
+  const Options options_;
 
 #if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
   // NOTE: member ordering is important, since the sub systems must be
@@ -58,6 +83,11 @@ class StreamingPlaybackController final : public ReceiverSession::Client {
   SDLRendererUniquePtr renderer_;
   std::unique_ptr<SDLAudioPlayer> audio_player_;
   std::unique_ptr<SDLVideoPlayer> video_player_;
+
+  // Used instead of the SDL players when running the decode benchmark or
+  // recording to the benchmark sink.
+  std::unique_ptr<DummyPlayer> audio_benchmark_player_;
+  std::unique_ptr<DummyPlayer> video_benchmark_player_;
 #else
   std::unique_ptr<DummyPlayer> audio_player_;
   std::unique_ptr<DummyPlayer> video_player_;
@@ -0,0 +1,139 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/standalone_sender/benchmark_sender.h"
+
+#include <algorithm>
+
+#include "absl/types/span.h"
+#include "cast/streaming/benchmark_payload.h"
+#include "cast/streaming/rtp_time.h"
+#include "util/chrono_helpers.h"
+#include "util/osp_logging.h"
+#include "util/trace_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// Audio is sent in 20 ms frames at the same bitrate LoopingFileSender caps
+// Opus at, and video at 30 FPS using whatever bitrate is left over.
+constexpr milliseconds kAudioFrameDuration{20};
+constexpr int kAudioBitrate = 192 * 1000;
+constexpr int kVideoFramesPerSecond = 30;
+
+// How often the number of frames sent is logged.
+constexpr seconds kLogInterval{5};
+
+int ComputeFrameSize(int bitrate, Clock::duration frame_duration) {
+  const int size = static_cast<int>(
+      bitrate / 8 * std::chrono::duration<double>(frame_duration).count());
+  return std::max(size, BenchmarkPayloadHeader::kSize);
+}
+
+}  // namespace
+
+BenchmarkSender::Stream::Stream(const char* name,
+                                Sender* sender,
+                                Clock::duration frame_duration,
+                                int frame_size,
+                                Environment* environment)
+    : name(name),
+      sender(sender),
+      frame_duration(frame_duration),
+      payload(frame_size),
+      alarm(environment->now_function(), environment->task_runner()) {
+  OSP_DCHECK(sender);
+  // Every frame is independently "decodable," so that no loss or drop ever
+  // stalls the receiver waiting for a frame that will never arrive.
+  frame.dependency = EncodedFrame::KEY_FRAME;
+}
+
+BenchmarkSender::Stream::~Stream() = default;
+
+BenchmarkSender::BenchmarkSender(Environment* environment,
+                                 SenderSession::ConfiguredSenders senders,
+                                 int max_bitrate)
+    : env_(environment),
+      start_time_(env_->now()),
+      audio_("Audio",
+             senders.audio_sender,
+             kAudioFrameDuration,
+             ComputeFrameSize(kAudioBitrate, kAudioFrameDuration),
+             env_),
+      video_("Video",
+             senders.video_sender,
+             Clock::duration(seconds(1)) / kVideoFramesPerSecond,
+             ComputeFrameSize(max_bitrate - kAudioBitrate,
+                              Clock::duration(seconds(1)) /
+                                  kVideoFramesPerSecond),
+             env_),
+      log_alarm_(env_->now_function(), env_->task_runner()) {
+  OSP_LOG_INFO << "Sending benchmark frames: " << audio_.payload.size()
+               << " bytes of audio every "
+               << to_milliseconds(audio_.frame_duration).count() << " ms, and "
+               << video_.payload.size() << " bytes of video every "
+               << to_milliseconds(video_.frame_duration).count() << " ms.";
+
+  audio_.alarm.Schedule([this] { SendNextFrame(&audio_); }, start_time_);
+  video_.alarm.Schedule([this] { SendNextFrame(&video_); }, start_time_);
+  ScheduleProgressLog();
+}
+
+BenchmarkSender::~BenchmarkSender() {
+  LogProgress();
+}
+
+void BenchmarkSender::SendNextFrame(Stream* stream) {
+  TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneSender);
+
+  // Frames are produced on a fixed schedule, measured from the start, so that
+  // any lateness in running this task does not accumulate.
+  const Clock::duration media_time =
+      stream->frame_duration * stream->num_frames_produced;
+
+  BenchmarkPayloadHeader header;
+  header.sequence_number = static_cast<uint32_t>(stream->num_frames_produced);
+  header.capture_time = BenchmarkPayloadHeader::Now();
+  header.WriteTo(absl::Span<uint8_t>(stream->payload));
+
+  EncodedFrame& frame = stream->frame;
+  frame.frame_id = stream->sender->GetNextFrameId();
+  frame.referenced_frame_id = frame.frame_id;
+  frame.rtp_timestamp = RtpTimeTicks::FromTimeSinceOrigin(
+      media_time, stream->sender->rtp_timebase());
+  frame.reference_time = env_->now();
+  frame.data = absl::Span<uint8_t>(stream->payload);
+  if (stream->sender->EnqueueFrame(frame) != Sender::OK) {
+    // The sequence number still advances, so the receiver counts the frame as
+    // missing.
+    ++stream->num_frames_rejected;
+  }
+  ++stream->num_frames_produced;
+
+  stream->alarm.Schedule([this, stream] { SendNextFrame(stream); },
+                         start_time_ + media_time + stream->frame_duration);
+}
+
+void BenchmarkSender::ScheduleProgressLog() {
+  log_alarm_.ScheduleFromNow(
+      [this] {
+        LogProgress();
+        ScheduleProgressLog();
+      },
+      kLogInterval);
+}
+
+void BenchmarkSender::LogProgress() const {
+  for (const Stream* stream : {&audio_, &video_}) {
+    OSP_LOG_INFO << stream->name << " benchmark frames: "
+                 << stream->num_frames_produced << " produced, "
+                 << stream->num_frames_rejected
+                 << " rejected by the Sender.";
+  }
+}
+
+}  // namespace cast
+}  // namespace openscreen
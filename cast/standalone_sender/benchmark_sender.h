@@ -0,0 +1,82 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STANDALONE_SENDER_BENCHMARK_SENDER_H_
+#define CAST_STANDALONE_SENDER_BENCHMARK_SENDER_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/environment.h"
+#include "cast/streaming/sender.h"
+#include "cast/streaming/sender_session.h"
+#include "platform/api/time.h"
+#include "util/alarm.h"
+
+namespace openscreen {
+namespace cast {
+
+// Streams synthetic audio and video frames at a constant rate and bitrate,
+// instead of encoded media, for benchmarking a receiver. Each frame's payload
+// starts with a BenchmarkPayloadHeader, carrying its sequence number and
+// wall-clock capture time, so that the receiver can measure the
+// capture-to-consume latency and count the frames lost (see cast_receiver's
+// --benchmark-output mode). Since nothing is encoded, the sender's own
+// performance has no effect on the results.
+class BenchmarkSender {
+ public:
+  // |max_bitrate| is shared between audio and video in the same way as for
+  // LoopingFileSender.
+  BenchmarkSender(Environment* environment,
+                  SenderSession::ConfiguredSenders senders,
+                  int max_bitrate);
+  ~BenchmarkSender();
+
+ private:
+  struct Stream {
+    Stream(const char* name,
+           Sender* sender,
+           Clock::duration frame_duration,
+           int frame_size,
+           Environment* environment);
+    ~Stream();
+
+    const char* const name;
+    Sender* const sender;
+    const Clock::duration frame_duration;
+
+    // Re-used for every frame, since the Sender copies the payload when it
+    // encrypts it.
+    std::vector<uint8_t> payload;
+    EncodedFrame frame;
+
+    // The number of frames produced, which is also the sequence number of the
+    // next frame; and the number of them that the Sender refused.
+    int64_t num_frames_produced = 0;
+    int num_frames_rejected = 0;
+
+    Alarm alarm;
+  };
+
+  // Produces the next frame for |stream|, and schedules the one after that.
+  void SendNextFrame(Stream* stream);
+
+  // Logs the number of frames produced for, and rejected by, each Sender,
+  // periodically and at destruction.
+  void ScheduleProgressLog();
+  void LogProgress() const;
+
+  Environment* const env_;
+  const Clock::time_point start_time_;
+  Stream audio_;
+  Stream video_;
+  Alarm log_alarm_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STANDALONE_SENDER_BENCHMARK_SENDER_H_
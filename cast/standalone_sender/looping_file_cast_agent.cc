@@ -270,6 +270,13 @@ void LoopingFileCastAgent::CreateAndStartSession() {
 
   environment_ =
       std::make_unique<Environment>(&Clock::now, task_runner_, IPEndpoint{});
+  if (connection_settings_->should_probe_path_mtu) {
+    // This must happen before the SenderSession creates its packet router.
+    const int max_packet_size = environment_->ProbePathMtu(
+        connection_settings_->receiver_endpoint.address);
+    OSP_LOG_INFO << "Using RTP packets of up to " << max_packet_size
+                 << " bytes.";
+  }
   OSP_DCHECK(remote_connection_.has_value());
   current_session_ = std::make_unique<SenderSession>(
       connection_settings_->receiver_endpoint.address, this, environment_.get(),
@@ -304,6 +311,13 @@ void LoopingFileCastAgent::OnMirroringNegotiated(
     return;
   }
 
+  if (connection_settings_->should_send_benchmark_frames) {
+    benchmark_sender_ = std::make_unique<BenchmarkSender>(
+        environment_.get(), std::move(senders),
+        connection_settings_->max_bitrate);
+    return;
+  }
+
   file_sender_ = std::make_unique<LoopingFileSender>(
       environment_.get(), connection_settings_->path_to_file.c_str(), session,
       std::move(senders), connection_settings_->max_bitrate);
@@ -318,6 +332,7 @@ void LoopingFileCastAgent::Shutdown() {
   TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneSender);
 
   file_sender_.reset();
+  benchmark_sender_.reset();
   if (current_session_) {
     OSP_LOG_INFO << "Stopping mirroring session...";
     current_session_.reset();
@@ -19,6 +19,7 @@
 #include "cast/common/channel/virtual_connection_router.h"
 #include "cast/common/public/cast_socket.h"
 #include "cast/sender/public/sender_socket_factory.h"
+#include "cast/standalone_sender/benchmark_sender.h"
 #include "cast/standalone_sender/looping_file_sender.h"
 #include "cast/streaming/environment.h"
 #include "cast/streaming/sender_session.h"
@@ -95,6 +96,15 @@ class LoopingFileCastAgent final
     // Whether we should use the hacky RTP stream IDs for legacy android
     // receivers, or if we should use the proper values.
     bool use_android_rtp_hack = true;
+
+    // Whether the RTP packet size should be computed from the path MTU to the
+    // receiver (see Environment::ProbePathMtu()), instead of assuming standard
+    // Ethernet.
+    bool should_probe_path_mtu = false;
+
+    // Whether to send synthetic benchmark frames (see BenchmarkSender) instead
+    // of the media in |path_to_file|, which is ignored.
+    bool should_send_benchmark_frames = false;
   };
 
   // Connect to a Cast Receiver, and start the workflow to establish a
@@ -183,6 +193,7 @@ class LoopingFileCastAgent final
   std::unique_ptr<Environment> environment_;
   std::unique_ptr<SenderSession> current_session_;
   std::unique_ptr<LoopingFileSender> file_sender_;
+  std::unique_ptr<BenchmarkSender> benchmark_sender_;
 };
 
 }  // namespace cast
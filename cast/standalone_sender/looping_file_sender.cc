@@ -18,6 +18,14 @@ LoopingFileSender::LoopingFileSender(Environment* environment,
       path_(path),
       session_(session),
       max_bitrate_(max_bitrate),
+      video_sender_(senders.video_sender),
+      bitrate_controller_([max_bitrate] {
+        BitrateController::Params params;
+        params.min_bitrate = kMinRequiredBitrate;
+        params.max_bitrate = max_bitrate;
+        params.max_resolution_step = StreamingVp8Encoder::kMaxResolutionStep;
+        return params;
+      }()),
       audio_encoder_(senders.audio_sender->config().channels,
                      StreamingOpusEncoder::kDefaultCastAudioFramesPerSecond,
                      senders.audio_sender),
@@ -33,9 +41,12 @@ LoopingFileSender::LoopingFileSender(Environment* environment,
   OSP_CHECK(senders.video_config.codec == VideoCodec::kVp8);
   OSP_LOG_INFO << "Max allowed media bitrate (audio + video) will be "
                << max_bitrate_;
-  bandwidth_being_utilized_ = max_bitrate_ / 2;
+  bandwidth_being_utilized_ = bitrate_controller_.target_bitrate();
   UpdateEncoderBitrates();
 
+  senders.audio_sender->EnableFrameTimelines(this);
+  senders.video_sender->EnableFrameTimelines(this);
+
   next_task_.Schedule([this] { SendFileAgain(); }, Alarm::kImmediately);
 }
 
@@ -53,36 +64,40 @@ void LoopingFileSender::UpdateEncoderBitrates() {
 
 void LoopingFileSender::ControlForNetworkCongestion() {
   bandwidth_estimate_ = session_->GetEstimatedNetworkBandwidth();
-  if (bandwidth_estimate_ > 0) {
-    // Don't ever try to use *all* of the network bandwidth! However, don't go
-    // below the absolute minimum requirement either.
-    constexpr double kGoodNetworkCitizenFactor = 0.8;
-    const int usable_bandwidth = std::max<int>(
-        kGoodNetworkCitizenFactor * bandwidth_estimate_, kMinRequiredBitrate);
-
-    // See "congestion control" discussion in the class header comments for
-    // BandwidthEstimator.
-    if (usable_bandwidth > bandwidth_being_utilized_) {
-      constexpr double kConservativeIncrease = 1.1;
-      bandwidth_being_utilized_ = std::min<int>(
-          bandwidth_being_utilized_ * kConservativeIncrease, usable_bandwidth);
-    } else {
-      bandwidth_being_utilized_ = usable_bandwidth;
-    }
-
-    // Repsect the user's maximum bitrate setting.
-    bandwidth_being_utilized_ =
-        std::min(bandwidth_being_utilized_, max_bitrate_);
-
-    UpdateEncoderBitrates();
-  } else {
-    // There is no current bandwidth estimate. So, nothing should be adjusted.
-  }
+  bandwidth_being_utilized_ = bitrate_controller_.UpdateTargetBitrate(
+      bandwidth_estimate_, GetVideoInFlightMediaDuration(),
+      video_sender_->GetMaxInFlightMediaDuration());
+  UpdateEncoderBitrates();
 
   next_task_.ScheduleFromNow([this] { ControlForNetworkCongestion(); },
                              kCongestionCheckInterval);
 }
 
+Clock::duration LoopingFileSender::GetVideoInFlightMediaDuration() const {
+  if (last_encoded_video_frame_duration_ == Clock::duration::zero()) {
+    return Clock::duration::zero();  // No video frames encoded yet.
+  }
+  return video_sender_->GetInFlightMediaDuration(
+      last_encoded_video_rtp_timestamp_ +
+      RtpTimeDelta::FromDuration(last_encoded_video_frame_duration_,
+                                 video_sender_->rtp_timebase()));
+}
+
+void LoopingFileSender::OnVideoFrameEncoded(
+    const StreamingVp8Encoder::Stats& stats) {
+  last_encoded_video_rtp_timestamp_ = stats.rtp_timestamp;
+  last_encoded_video_frame_duration_ = stats.frame_duration;
+  ++num_video_frames_encoded_;
+  video_bytes_copied_ += stats.input_bytes_copied + stats.encoded_size;
+
+  BitrateController::EncoderFeedback feedback;
+  feedback.time_utilization = stats.time_utilization();
+  feedback.space_utilization = stats.space_utilization();
+  feedback.entropy_utilization = stats.entropy_utilization();
+  bitrate_controller_.OnFrameEncoded(env_->now(), feedback);
+  video_encoder_.SetResolutionStep(bitrate_controller_.resolution_step());
+}
+
 void LoopingFileSender::SendFileAgain() {
   OSP_LOG_INFO << "Sending " << path_ << " (starts in one second)...";
   TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneSender);
@@ -113,21 +128,41 @@ void LoopingFileSender::OnVideoFrame(const AVFrame& av_frame,
                                      Clock::time_point capture_time) {
   TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneSender);
   latest_frame_time_ = std::max(capture_time, latest_frame_time_);
+  if (bitrate_controller_.ShouldDropFrame(
+          GetVideoInFlightMediaDuration(),
+          video_sender_->GetMaxInFlightMediaDuration())) {
+    OSP_VLOG << "Dropping video frame to reduce the encoding load or data "
+                "volume.";
+    return;
+  }
+
+  // Take a new reference to the decoded frame's buffers, which the decoder will
+  // not reuse while it is held. This allows the encoder to read the planes
+  // in-place, rather than copying them. If this fails, the encoder falls back
+  // to copying from |av_frame| before OnVideoFrame() returns.
+  std::shared_ptr<AVFrame> frame_ref(av_frame_clone(&av_frame),
+                                     [](AVFrame* ref) { av_frame_free(&ref); });
+  const AVFrame& source = frame_ref ? *frame_ref : av_frame;
+
   StreamingVp8Encoder::VideoFrame frame{};
-  frame.width = av_frame.width - av_frame.crop_left - av_frame.crop_right;
-  frame.height = av_frame.height - av_frame.crop_top - av_frame.crop_bottom;
-  frame.yuv_planes[0] = av_frame.data[0] + av_frame.crop_left +
-                        av_frame.linesize[0] * av_frame.crop_top;
-  frame.yuv_planes[1] = av_frame.data[1] + av_frame.crop_left / 2 +
-                        av_frame.linesize[1] * av_frame.crop_top / 2;
-  frame.yuv_planes[2] = av_frame.data[2] + av_frame.crop_left / 2 +
-                        av_frame.linesize[2] * av_frame.crop_top / 2;
+  frame.width = source.width - source.crop_left - source.crop_right;
+  frame.height = source.height - source.crop_top - source.crop_bottom;
+  frame.yuv_planes[0] = source.data[0] + source.crop_left +
+                        source.linesize[0] * source.crop_top;
+  frame.yuv_planes[1] = source.data[1] + source.crop_left / 2 +
+                        source.linesize[1] * source.crop_top / 2;
+  frame.yuv_planes[2] = source.data[2] + source.crop_left / 2 +
+                        source.linesize[2] * source.crop_top / 2;
   for (int i = 0; i < 3; ++i) {
-    frame.yuv_strides[i] = av_frame.linesize[i];
+    frame.yuv_strides[i] = source.linesize[i];
   }
+  frame.buffer_owner = std::move(frame_ref);
   // TODO(miu): Add performance metrics visual overlay (based on Stats
   // callback).
-  video_encoder_.EncodeAndSend(frame, capture_time, {});
+  video_encoder_.EncodeAndSend(frame, capture_time,
+                               [this](StreamingVp8Encoder::Stats stats) {
+                                 OnVideoFrameEncoded(stats);
+                               });
 }
 
 void LoopingFileSender::UpdateStatusOnConsole() {
@@ -141,9 +176,18 @@ void LoopingFileSender::UpdateStatusOnConsole() {
   // partially overwritten).
   fprintf(stdout,
           "\r\x1b[2K\rLoopingFileSender: At %01" PRId64
-          ".%03ds in file (est. network bandwidth: %d kbps). \n",
+          ".%03ds in file (est. network bandwidth: %d kbps, target: %d kbps, "
+          "resolution step: %d, frames dropped: %d, copied: %d KB/frame). "
+          "\n",
           static_cast<int64_t>(seconds_part.count()),
-          static_cast<int>(millis_part.count()), bandwidth_estimate_ / 1024);
+          static_cast<int>(millis_part.count()), bandwidth_estimate_ / 1024,
+          bandwidth_being_utilized_ / 1024,
+          bitrate_controller_.resolution_step(),
+          bitrate_controller_.num_frames_dropped(),
+          num_video_frames_encoded_ > 0
+              ? static_cast<int>(video_bytes_copied_ /
+                                 num_video_frames_encoded_ / 1024)
+              : 0);
   fflush(stdout);
 
   console_update_task_.ScheduleFromNow([this] { UpdateStatusOnConsole(); },
@@ -183,5 +227,9 @@ const char* LoopingFileSender::ToTrackName(SimulatedCapturer* capturer) const {
   return which;
 }
 
+void LoopingFileSender::OnFrameTimelineFinished(const FrameTimeline& timeline) {
+  OSP_VLOG << "Sender frame timeline " << timeline;
+}
+
 }  // namespace cast
 }  // namespace openscreen
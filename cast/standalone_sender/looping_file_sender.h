@@ -5,13 +5,19 @@
 #ifndef CAST_STANDALONE_SENDER_LOOPING_FILE_SENDER_H_
 #define CAST_STANDALONE_SENDER_LOOPING_FILE_SENDER_H_
 
+#include <stdint.h>
+
 #include <algorithm>
+#include <memory>
 #include <string>
 
 #include "cast/standalone_sender/constants.h"
 #include "cast/standalone_sender/simulated_capturer.h"
 #include "cast/standalone_sender/streaming_opus_encoder.h"
 #include "cast/standalone_sender/streaming_vp8_encoder.h"
+#include "cast/streaming/bitrate_controller.h"
+#include "cast/streaming/frame_timeline.h"
+#include "cast/streaming/rtp_time.h"
 #include "cast/streaming/sender_session.h"
 
 namespace openscreen {
@@ -20,7 +26,8 @@ namespace cast {
 // Plays the media file at a given path over and over again, transcoding and
 // streaming its audio/video.
 class LoopingFileSender final : public SimulatedAudioCapturer::Client,
-                                public SimulatedVideoCapturer::Client {
+                                public SimulatedVideoCapturer::Client,
+                                public FrameTimelineRecorder::Client {
  public:
   LoopingFileSender(Environment* environment,
                     const char* path,
@@ -33,6 +40,14 @@ class LoopingFileSender final : public SimulatedAudioCapturer::Client,
  private:
   void UpdateEncoderBitrates();
   void ControlForNetworkCongestion();
+
+  // Returns the video in-flight media duration that would result from
+  // enqueuing one more frame, extrapolated from the last frame encoded.
+  Clock::duration GetVideoInFlightMediaDuration() const;
+
+  // Feeds the |stats| for each encoded video frame to the
+  // |bitrate_controller_|, and applies its choice of resolution.
+  void OnVideoFrameEncoded(const StreamingVp8Encoder::Stats& stats);
   void SendFileAgain();
 
   // SimulatedAudioCapturer overrides.
@@ -52,6 +67,10 @@ class LoopingFileSender final : public SimulatedAudioCapturer::Client,
 
   const char* ToTrackName(SimulatedCapturer* capturer) const;
 
+  // FrameTimelineRecorder::Client overrides. Logs the per-frame latency
+  // breakdowns (at verbose log level).
+  void OnFrameTimelineFinished(const FrameTimeline& timeline) final;
+
   // Holds the required injected dependencies (clock, task runner) used for Cast
   // Streaming, and owns the UDP socket over which all communications occur with
   // the remote's Receivers.
@@ -66,9 +85,26 @@ class LoopingFileSender final : public SimulatedAudioCapturer::Client,
   // User provided maximum bitrate (from command line argument).
   const int max_bitrate_;
 
+  // The video Sender, queried for its in-flight media duration.
+  Sender* const video_sender_;
+
+  // Decides the total (audio + video) bitrate, which video frames to drop, and
+  // the video resolution.
+  BitrateController bitrate_controller_;
+
   int bandwidth_estimate_ = 0;
   int bandwidth_being_utilized_;
 
+  // The RTP timestamp and duration of the last video frame encoded.
+  RtpTimeTicks last_encoded_video_rtp_timestamp_;
+  Clock::duration last_encoded_video_frame_duration_{};
+
+  // The number of video frames encoded, and the total number of bytes the
+  // video encoder copied for them (input images and encoded payloads), to
+  // monitor the memory traffic per frame.
+  int num_video_frames_encoded_ = 0;
+  int64_t video_bytes_copied_ = 0;
+
   StreamingOpusEncoder audio_encoder_;
   StreamingVp8Encoder video_encoder_;
 
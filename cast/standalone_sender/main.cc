@@ -50,6 +50,8 @@ usage: %s <options> addr[:port] media_file
    discover Cast Receivers, and instead connect directly to the Cast Receiver at
    addr:[port] (e.g., 192.168.1.22, 192.168.1.22:%d or [::1]:%d).
 
+   The media_file may be omitted when using --benchmark.
+
       -m, --max-bitrate=N
            Specifies the maximum bits per second for the media streams.
 
@@ -70,6 +72,17 @@ usage: %s <options> addr[:port] media_file
            Use the wrong RTP payload types, for compatibility with older Android
            TV receivers.
 
+      -p, --probe-path-mtu:
+           Size RTP packets from the path MTU to the receiver, as reported by
+           the operating system, instead of assuming standard Ethernet.
+
+      -b, --benchmark:
+           Instead of the media file, send synthetic frames that carry their
+           capture timestamps, at a constant frame rate and the maximum
+           bitrate. Run cast_receiver with --benchmark-output to measure its
+           glass-to-glass latency, frame rate stability and drops. The sender's
+           and receiver's clocks must be synchronized.
+
       -t, --tracing: Enable performance tracing logging.
 
       -v, --verbose: Enable verbose logging.
@@ -111,6 +124,8 @@ int StandaloneSenderMain(int argc, char* argv[]) {
     {"developer-certificate", required_argument, nullptr, 'd'},
 #endif
     {"android-hack", no_argument, nullptr, 'a'},
+    {"probe-path-mtu", no_argument, nullptr, 'p'},
+    {"benchmark", no_argument, nullptr, 'b'},
     {"tracing", no_argument, nullptr, 't'},
     {"verbose", no_argument, nullptr, 'v'},
     {"help", no_argument, nullptr, 'h'},
@@ -120,10 +135,12 @@ int StandaloneSenderMain(int argc, char* argv[]) {
   bool is_verbose = false;
   std::string developer_certificate_path;
   bool use_android_rtp_hack = false;
+  bool should_probe_path_mtu = false;
+  bool should_send_benchmark_frames = false;
   int max_bitrate = kDefaultMaxBitrate;
   std::unique_ptr<TextTraceLoggingPlatform> trace_logger;
   int ch = -1;
-  while ((ch = getopt_long(argc, argv, "m:d:atvh", kArgumentOptions,
+  while ((ch = getopt_long(argc, argv, "m:d:apbtvh", kArgumentOptions,
                            nullptr)) != -1) {
     switch (ch) {
       case 'm':
@@ -143,6 +160,12 @@ int StandaloneSenderMain(int argc, char* argv[]) {
       case 'a':
         use_android_rtp_hack = true;
         break;
+      case 'p':
+        should_probe_path_mtu = true;
+        break;
+      case 'b':
+        should_send_benchmark_frames = true;
+        break;
       case 't':
         trace_logger = std::make_unique<TextTraceLoggingPlatform>();
         break;
@@ -159,13 +182,14 @@ int StandaloneSenderMain(int argc, char* argv[]) {
                                      : openscreen::LogLevel::kInfo);
   // The second to last command line argument must be one of: 1) the network
   // interface name or 2) a specific IP address (port is optional). The last
-  // argument must be the path to the file.
-  if (optind != (argc - 2)) {
+  // argument must be the path to the file, unless sending benchmark frames.
+  const bool has_path = (optind == (argc - 2));
+  if (!has_path && !(should_send_benchmark_frames && optind == (argc - 1))) {
     LogUsage(argv[0]);
     return 1;
   }
   const char* const iface_or_endpoint = argv[optind++];
-  const char* const path = argv[optind];
+  const char* const path = has_path ? argv[optind] : "";
 
 #if defined(CAST_ALLOW_DEVELOPER_CERTIFICATE)
   if (!developer_certificate_path.empty()) {
@@ -207,7 +231,8 @@ int StandaloneSenderMain(int argc, char* argv[]) {
         task_runner, [&] { task_runner->RequestStopSoon(); });
     cast_agent->Connect({remote_endpoint, path, max_bitrate,
                          true /* should_include_video */,
-                         use_android_rtp_hack});
+                         use_android_rtp_hack, should_probe_path_mtu,
+                         should_send_benchmark_frames});
   });
 
   // Run the event loop until SIGINT (e.g., CTRL-C at the console) or
@@ -36,6 +36,11 @@ constexpr int kBytesPerKilobyte = 1024;
 constexpr Clock::duration kMinFrameDuration = milliseconds(1);
 constexpr Clock::duration kMaxFrameDuration = milliseconds(125);
 
+// The maximum number of recycled input images and payload buffers to keep
+// around for later frames. This is enough to cover the typical encode queue
+// depth, while bounding the memory held by idle buffers.
+constexpr size_t kMaxPooledBuffers = 4;
+
 // Highest/lowest allowed encoding speed set to the encoder. The valid range is
 // [4, 16], but experiments show that with speed higher than 12, the saving of
 // the encoding time is not worth the dropping of the quality. And, with speed
@@ -132,6 +137,19 @@ void StreamingVp8Encoder::SetTargetBitrate(int new_bitrate) {
   }
 }
 
+int StreamingVp8Encoder::GetResolutionStep() const {
+  // Note: No need to lock the |mutex_| since this method should be called on
+  // the same thread as SetResolutionStep().
+  return resolution_step_;
+}
+
+void StreamingVp8Encoder::SetResolutionStep(int new_step) {
+  OSP_DCHECK_GE(new_step, 0);
+  OSP_DCHECK_LE(new_step, kMaxResolutionStep);
+  std::unique_lock<std::mutex> lock(mutex_);
+  resolution_step_ = new_step;
+}
+
 void StreamingVp8Encoder::EncodeAndSend(
     const VideoFrame& frame,
     Clock::time_point reference_time,
@@ -182,7 +200,17 @@ void StreamingVp8Encoder::EncodeAndSend(
 
   last_enqueued_rtp_timestamp_ = work_unit.rtp_timestamp;
 
-  work_unit.image = CloneAsVpxImage(frame);
+  work_unit.image = WrapAsVpxImage(frame);
+  if (work_unit.image) {
+    work_unit.image_owner = frame.buffer_owner;
+    work_unit.input_bytes_copied = 0;
+  } else {
+    work_unit.image = CloneAsVpxImage(frame);
+    // The luma plane, plus two chroma planes of half the width and height.
+    work_unit.input_bytes_copied =
+        frame.width * frame.height +
+        2 * ((frame.width + 1) / 2) * ((frame.height + 1) / 2);
+  }
   work_unit.reference_time = reference_time;
   work_unit.stats_callback = std::move(stats_callback);
   const bool force_key_frame = sender_->NeedsKeyFrame();
@@ -212,6 +240,7 @@ void StreamingVp8Encoder::ProcessWorkUnitsUntilTimeToQuit() {
     WorkUnitWithResults work_unit{};
     bool force_key_frame;
     int target_bitrate;
+    int resolution_step;
     {
       std::unique_lock<std::mutex> lock(mutex_);
       if (target_bitrate_ <= 0) {
@@ -228,14 +257,17 @@ void StreamingVp8Encoder::ProcessWorkUnitsUntilTimeToQuit() {
       force_key_frame = needs_key_frame_;
       needs_key_frame_ = false;
       target_bitrate = target_bitrate_;
+      resolution_step = resolution_step_;
     }
 
     // Clock::now() is being called directly, instead of using a
     // dependency-injected "now function," since actual wall time is being
     // measured.
     const Clock::time_point encode_start_time = Clock::now();
-    PrepareEncoder(work_unit.image->d_w, work_unit.image->d_h, target_bitrate);
+    PrepareEncoder(work_unit.image->d_w, work_unit.image->d_h, target_bitrate,
+                   resolution_step);
     EncodeFrame(force_key_frame, &work_unit);
+    RecycleImage(&work_unit);
     ComputeFrameEncodeStats(Clock::now() - encode_start_time, target_bitrate,
                             &work_unit);
     UpdateSpeedSettingForNextFrame(work_unit.stats);
@@ -251,7 +283,8 @@ void StreamingVp8Encoder::ProcessWorkUnitsUntilTimeToQuit() {
 
 void StreamingVp8Encoder::PrepareEncoder(int width,
                                          int height,
-                                         int target_bitrate) {
+                                         int target_bitrate,
+                                         int resolution_step) {
   OSP_DCHECK_EQ(std::this_thread::get_id(), encode_thread_.get_id());
 
   const int target_kbps = target_bitrate / kBytesPerKilobyte;
@@ -299,8 +332,9 @@ void StreamingVp8Encoder::PrepareEncoder(int width,
         vpx_codec_control(&encoder_, VP8E_SET_STATIC_THRESHOLD, 1);
     OSP_CHECK_EQ(ctl_result, VPX_CODEC_OK);
 
-    // Ensure the speed will be set (below).
+    // Ensure the speed and scaling mode will be set (below).
     current_speed_setting_ = ~speed;
+    current_resolution_step_ = ~resolution_step;
   } else if (static_cast<int>(config_.rc_target_bitrate) != target_kbps ||
              static_cast<int>(config_.rc_min_quantizer) != min_quantizer) {
     config_.rc_target_bitrate = target_kbps;
@@ -318,6 +352,18 @@ void StreamingVp8Encoder::PrepareEncoder(int width,
     OSP_CHECK_EQ(ctl_result, VPX_CODEC_OK);
     current_speed_setting_ = speed;
   }
+
+  if (current_resolution_step_ != resolution_step) {
+    constexpr VPX_SCALING_MODE kScalingModes[kMaxResolutionStep + 1] = {
+        VP8E_NORMAL, VP8E_FOURFIVE, VP8E_THREEFIVE, VP8E_ONETWO};
+    vpx_scaling_mode_t scaling_mode{};
+    scaling_mode.h_scaling_mode = kScalingModes[resolution_step];
+    scaling_mode.v_scaling_mode = kScalingModes[resolution_step];
+    const auto ctl_result =
+        vpx_codec_control(&encoder_, VP8E_SET_SCALEMODE, &scaling_mode);
+    OSP_CHECK_EQ(ctl_result, VPX_CODEC_OK);
+    current_resolution_step_ = resolution_step;
+  }
 }
 
 void StreamingVp8Encoder::EncodeFrame(bool force_key_frame,
@@ -347,9 +393,11 @@ void StreamingVp8Encoder::EncodeFrame(bool force_key_frame,
   }
 
   // A copy of the payload data is being made here. That's okay since it has to
-  // be copied at some point anyway, to be passed back to the main thread.
+  // be copied at some point anyway, to be passed back to the main thread. A
+  // pooled buffer is used, so this usually does not allocate.
   auto* const begin = static_cast<const uint8_t*>(pkt->data.frame.buf);
   auto* const end = begin + pkt->data.frame.sz;
+  work_unit->payload = TakePayloadBuffer();
   work_unit->payload.assign(begin, end);
   work_unit->is_key_frame = !!(pkt->data.frame.flags & VPX_FRAME_IS_KEY);
 }
@@ -367,6 +415,7 @@ void StreamingVp8Encoder::ComputeFrameEncodeStats(
   stats.encode_wall_time = encode_wall_time;
   stats.frame_duration = work_unit->duration;
   stats.encoded_size = work_unit->payload.size();
+  stats.input_bytes_copied = work_unit->input_bytes_copied;
 
   constexpr double kBytesPerBit = 1.0 / CHAR_BIT;
   constexpr double kSecondsPerClockTick =
@@ -431,11 +480,19 @@ void StreamingVp8Encoder::SendEncodedFrame(WorkUnitWithResults results) {
   frame.reference_time = results.reference_time;
   frame.data = absl::Span<uint8_t>(results.payload);
 
-  if (sender_->EnqueueFrame(frame) != Sender::OK) {
-    // Since the frame will not be sent, the encoder's frame dependency chain
-    // has been broken. Force a key frame for the next frame.
+  const bool was_enqueued = sender_->EnqueueFrame(frame) == Sender::OK;
+  {
     std::unique_lock<std::mutex> lock(mutex_);
-    needs_key_frame_ = true;
+    if (!was_enqueued) {
+      // Since the frame will not be sent, the encoder's frame dependency chain
+      // has been broken. Force a key frame for the next frame.
+      needs_key_frame_ = true;
+    }
+    // The Sender made its own (encrypted) copy of the payload, so the buffer
+    // can be reused for a later frame.
+    if (payload_pool_.size() < kMaxPooledBuffers) {
+      payload_pool_.push_back(std::move(results.payload));
+    }
   }
 
   if (results.stats_callback) {
@@ -444,6 +501,35 @@ void StreamingVp8Encoder::SendEncodedFrame(WorkUnitWithResults results) {
   }
 }
 
+void StreamingVp8Encoder::RecycleImage(WorkUnit* work_unit) {
+  OSP_DCHECK_EQ(std::this_thread::get_id(), encode_thread_.get_id());
+
+  if (work_unit->image_owner) {
+    work_unit->image.reset();
+    work_unit->image_owner.reset();
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (image_pool_.size() < kMaxPooledBuffers) {
+      image_pool_.push_back(std::move(work_unit->image));
+      return;
+    }
+  }
+  work_unit->image.reset();
+}
+
+std::vector<uint8_t> StreamingVp8Encoder::TakePayloadBuffer() {
+  std::vector<uint8_t> buffer;
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!payload_pool_.empty()) {
+    buffer = std::move(payload_pool_.back());
+    payload_pool_.pop_back();
+  }
+  return buffer;
+}
+
 namespace {
 void CopyPlane(const uint8_t* src,
                int src_stride,
@@ -464,6 +550,35 @@ void CopyPlane(const uint8_t* src,
 }  // namespace
 
 // static
+StreamingVp8Encoder::VpxImageUniquePtr StreamingVp8Encoder::WrapAsVpxImage(
+    const VideoFrame& frame) {
+  if (!frame.buffer_owner) {
+    return nullptr;
+  }
+
+  // libvpx assumes both chroma planes have the same stride, and negative
+  // (bottom-up) strides are not supported.
+  const int chroma_width = (frame.width + 1) / 2;
+  if (frame.yuv_strides[0] < frame.width ||
+      frame.yuv_strides[1] < chroma_width ||
+      frame.yuv_strides[1] != frame.yuv_strides[2]) {
+    return nullptr;
+  }
+
+  // vpx_img_wrap() computes the plane pointers and strides for a contiguous
+  // buffer, so they are overwritten here to reference the frame's planes.
+  constexpr int kNoAlignment = 1;
+  VpxImageUniquePtr image(
+      vpx_img_wrap(nullptr, VPX_IMG_FMT_I420, frame.width, frame.height,
+                   kNoAlignment, const_cast<uint8_t*>(frame.yuv_planes[0])));
+  OSP_CHECK(image);
+  for (int i = 0; i < 3; ++i) {
+    image->planes[i] = const_cast<uint8_t*>(frame.yuv_planes[i]);
+    image->stride[i] = frame.yuv_strides[i];
+  }
+  return image;
+}
+
 StreamingVp8Encoder::VpxImageUniquePtr StreamingVp8Encoder::CloneAsVpxImage(
     const VideoFrame& frame) {
   OSP_DCHECK_GE(frame.width, 0);
@@ -472,10 +587,29 @@ StreamingVp8Encoder::VpxImageUniquePtr StreamingVp8Encoder::CloneAsVpxImage(
   OSP_DCHECK_GE(frame.yuv_strides[1], 0);
   OSP_DCHECK_GE(frame.yuv_strides[2], 0);
 
-  constexpr int kAlignment = 32;
-  VpxImageUniquePtr image(vpx_img_alloc(nullptr, VPX_IMG_FMT_I420, frame.width,
-                                        frame.height, kAlignment));
-  OSP_CHECK(image);
+  VpxImageUniquePtr image;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (auto it = image_pool_.begin(); it != image_pool_.end(); ++it) {
+      if (static_cast<int>((*it)->d_w) == frame.width &&
+          static_cast<int>((*it)->d_h) == frame.height) {
+        image = std::move(*it);
+        image_pool_.erase(it);
+        break;
+      }
+    }
+    if (!image) {
+      // The frame size has changed, so the pooled images are of no further
+      // use.
+      image_pool_.clear();
+    }
+  }
+  if (!image) {
+    constexpr int kAlignment = 32;
+    image.reset(vpx_img_alloc(nullptr, VPX_IMG_FMT_I420, frame.width,
+                              frame.height, kAlignment));
+    OSP_CHECK(image);
+  }
 
   CopyPlane(frame.yuv_planes[0], frame.yuv_strides[0], frame.height,
             image->planes[VPX_PLANE_Y], image->stride[VPX_PLANE_Y]);
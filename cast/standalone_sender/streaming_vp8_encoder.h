@@ -89,11 +89,17 @@ class StreamingVp8Encoder {
     int height;
 
     // I420 format image pointers and row strides (the number of bytes between
-    // the start of successive rows). The pointers only need to remain valid
-    // until the EncodeAndSend() call returns.
+    // the start of successive rows). Unless |buffer_owner| is set, the pointers
+    // only need to remain valid until the EncodeAndSend() call returns.
     const uint8_t* yuv_planes[3];
     int yuv_strides[3];
 
+    // Optional reference to whatever owns the memory the |yuv_planes| point
+    // into (e.g., a reference-counted AVFrame). If set, and the strides are
+    // compatible with libvpx, the planes are encoded in-place rather than being
+    // copied, and the reference is held until the encode has completed.
+    std::shared_ptr<const void> buffer_owner;
+
     // How long this frame will be held before the next frame will be displayed,
     // or zero if unknown. The frame duration is passed to the VP8 codec,
     // affecting a number of important behaviors, including: per-frame
@@ -124,9 +130,17 @@ class StreamingVp8Encoder {
     // provided in the VideoFrame.
     Clock::duration frame_duration;
 
-    // The encoded frame's size in bytes.
+    // The encoded frame's size in bytes. The encoded frame is copied once, out
+    // of libvpx's internal buffer, into a pooled buffer that is passed to the
+    // Sender.
     int encoded_size;
 
+    // The number of bytes of image data copied before encoding, which is zero
+    // if the input frame was encoded in-place. Together with |encoded_size|,
+    // this accounts for the memory traffic the encoder adds on top of libvpx's
+    // own.
+    int input_bytes_copied;
+
     // The average size of an encoded frame in bytes, having this
     // |frame_duration| and current target bitrate.
     double target_size;
@@ -172,6 +186,16 @@ class StreamingVp8Encoder {
   int GetTargetBitrate() const;
   void SetTargetBitrate(int new_bitrate);
 
+  // Get/Set the resolution step, where zero means full resolution, and steps
+  // one through three scale each dimension by 4/5, 3/5, and 1/2, respectively.
+  // This uses VP8's internal scaling, so the frames passed to EncodeAndSend()
+  // remain at full size. This may be changed at any time, and it will take
+  // effect internally as soon as possible.
+  int GetResolutionStep() const;
+  void SetResolutionStep(int new_step);
+
+  static constexpr int kMaxResolutionStep = 3;
+
   // Encode |frame| using the VP8 encoder, assemble an EncodedFrame, and enqueue
   // into the Sender. The frame may be dropped if too many frames are in-flight.
   // If provided, the |stats_callback| is run after the frame is enqueued in the
@@ -195,6 +219,12 @@ class StreamingVp8Encoder {
   // EncodeAndSend(), and passed to the encode thread via the |encode_queue_|.
   struct WorkUnit {
     VpxImageUniquePtr image;
+
+    // If set, |image| wraps memory owned by this (see VideoFrame::buffer_owner)
+    // instead of being from the |image_pool_|.
+    std::shared_ptr<const void> image_owner;
+    int input_bytes_copied;
+
     Clock::duration duration;
     Clock::time_point reference_time;
     RtpTimeTicks rtp_timestamp;
@@ -219,10 +249,14 @@ class StreamingVp8Encoder {
   void ProcessWorkUnitsUntilTimeToQuit();
 
   // If the |encoder_| is live, attempt reconfiguration to allow it to encode
-  // frames at a new frame size, target bitrate, or "CPU encoding speed." If
+  // frames at a new frame size, target bitrate, resolution step, or "CPU
+  // encoding speed." If
   // reconfiguration is not possible, destroy the existing instance and
   // re-create a new |encoder_| instance.
-  void PrepareEncoder(int width, int height, int target_bitrate);
+  void PrepareEncoder(int width,
+                      int height,
+                      int target_bitrate,
+                      int resolution_step);
 
   // Wraps the complex libvpx vpx_codec_encode() call using inputs from
   // |work_unit| and populating results there.
@@ -241,8 +275,23 @@ class StreamingVp8Encoder {
   // Assembles and enqueues an EncodedFrame with the Sender on the main thread.
   void SendEncodedFrame(WorkUnitWithResults results);
 
-  // Allocates a vpx_image_t and copies the content from |frame| to it.
-  static VpxImageUniquePtr CloneAsVpxImage(const VideoFrame& frame);
+  // Returns a vpx_image_t that references the planes of |frame| in-place, if
+  // |frame| has a buffer owner and libvpx can accept its strides. Otherwise,
+  // returns null.
+  static VpxImageUniquePtr WrapAsVpxImage(const VideoFrame& frame);
+
+  // Copies the content from |frame| to a vpx_image_t from the |image_pool_|,
+  // or a newly-allocated one if none of the right size are available.
+  VpxImageUniquePtr CloneAsVpxImage(const VideoFrame& frame);
+
+  // Returns the |image| from a completed WorkUnit to the |image_pool_|, or
+  // releases it (and its owner) if it was wrapping external memory.
+  void RecycleImage(WorkUnit* work_unit);
+
+  // Returns a buffer from the |payload_pool_|, or an empty one. Its capacity
+  // is retained from previous frames, so assigning the encoded output usually
+  // does not allocate.
+  std::vector<uint8_t> TakePayloadBuffer();
 
   const Parameters params_;
   TaskRunner* const main_task_runner_;
@@ -268,6 +317,13 @@ class StreamingVp8Encoder {
   // wait until some later WorkUnit is processed.
   bool needs_key_frame_ ABSL_GUARDED_BY(mutex_) = true;
   int target_bitrate_ ABSL_GUARDED_BY(mutex_) = 2 << 20;  // Default: 2 Mbps.
+  int resolution_step_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  // Recycled input images and encoded payload buffers, used to avoid
+  // allocating and freeing several megabytes per frame. Images are recycled on
+  // the encode thread, and payloads on the main thread.
+  std::vector<VpxImageUniquePtr> image_pool_ ABSL_GUARDED_BY(mutex_);
+  std::vector<std::vector<uint8_t>> payload_pool_ ABSL_GUARDED_BY(mutex_);
 
   // The queue of frame encodes. The size of this queue is implicitly bounded by
   // EncodeAndSend(), where it checks for the total in-flight media duration and
@@ -288,6 +344,10 @@ class StreamingVp8Encoder {
   double ideal_speed_setting_;  // A time-weighted average, from measurements.
   int current_speed_setting_;   // Current |encoder_| speed setting.
 
+  // The resolution step the |encoder_| is currently configured for. Only the
+  // encode thread accesses this.
+  int current_resolution_step_ = 0;
+
   // libvpx VP8 encoder instance. Only the encode thread accesses this.
   vpx_codec_ctx_t encoder_;
 
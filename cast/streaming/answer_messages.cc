@@ -120,6 +120,9 @@ static constexpr char kReceiverGetStatus[] = "receiverGetStatus";
 // If this optional field is present the receiver supports the specific
 // RTP extensions (such as adaptive playout delay).
 static constexpr char kRtpExtensions[] = "rtpExtensions";
+// Optional array of numbers specifying the indexes of streams for which the
+// receiver accepts the FEC packets offered by the sender.
+static constexpr char kFecEnabledIndexes[] = "fecEnabledIndexes";
 
 Json::Value AspectRatioConstraintToJson(AspectRatioConstraint aspect_ratio) {
   switch (aspect_ratio) {
@@ -424,6 +427,8 @@ bool Answer::ParseAndValidate(const Json::Value& root, Answer* out) {
                                  &(out->receiver_rtcp_dscp));
   json::ParseAndValidateStringArray(root[kRtpExtensions],
                                     &(out->rtp_extensions));
+  json::ParseAndValidateIntArray(root[kFecEnabledIndexes],
+                                 &(out->fec_enabled_indexes));
 
   return out->IsValid();
 }
@@ -474,6 +479,9 @@ Json::Value Answer::ToJson() const {
   if (!rtp_extensions.empty()) {
     root[kRtpExtensions] = PrimitiveVectorToJson(rtp_extensions);
   }
+  if (!fec_enabled_indexes.empty()) {
+    root[kFecEnabledIndexes] = PrimitiveVectorToJson(fec_enabled_indexes);
+  }
   return root;
 }
 
@@ -127,6 +127,9 @@ struct Answer {
 
   // RTP extensions should be empty, but not null.
   std::vector<std::string> rtp_extensions = {};
+
+  // Indexes of the offered streams for which the receiver accepts FEC packets.
+  std::vector<int> fec_enabled_indexes;
 };
 
 }  // namespace cast
@@ -64,7 +64,8 @@ constexpr char kValidAnswerJson[] = R"({
   "receiverRtcpEventLog": [0, 1],
   "receiverRtcpDscp": [234, 567],
   "receiverGetStatus": true,
-  "rtpExtensions": ["adaptive_playout_delay"]
+  "rtpExtensions": ["adaptive_playout_delay"],
+  "fecEnabledIndexes": [3]
 })";
 
 const Answer kValidAnswer{
@@ -106,10 +107,11 @@ const Answer kValidAnswer{
         absl::optional<AspectRatioConstraint>(
             AspectRatioConstraint::kFixed),  // scaling
     }),
-    std::vector<int>{7, 8, 9},              // receiver_rtcp_event_log
-    std::vector<int>{11, 12, 13},           // receiver_rtcp_dscp
-    true,                                   // receiver_get_status
-    std::vector<std::string>{"foo", "bar"}  // rtp_extensions
+    std::vector<int>{7, 8, 9},               // receiver_rtcp_event_log
+    std::vector<int>{11, 12, 13},            // receiver_rtcp_dscp
+    true,                                    // receiver_get_status
+    std::vector<std::string>{"foo", "bar"},  // rtp_extensions
+    std::vector<int>{2}                      // fec_enabled_indexes
 };
 
 constexpr int kValidMaxPixelsPerSecond = 1920 * 1080 * 30;
@@ -162,6 +164,7 @@ void ExpectEqualsValidAnswerJson(const Answer& answer) {
   EXPECT_THAT(answer.receiver_rtcp_dscp, ElementsAre(234, 567));
   EXPECT_TRUE(answer.supports_wifi_status_reporting);
   EXPECT_THAT(answer.rtp_extensions, ElementsAre("adaptive_playout_delay"));
+  EXPECT_THAT(answer.fec_enabled_indexes, ElementsAre(3));
 }
 
 void ExpectFailureOnParse(absl::string_view raw_json) {
@@ -264,6 +267,10 @@ TEST(AnswerMessagesTest, ProperlyPopulatedAnswerSerializesProperly) {
   EXPECT_EQ(rtp_extensions.type(), Json::ValueType::arrayValue);
   EXPECT_EQ(rtp_extensions[0], "foo");
   EXPECT_EQ(rtp_extensions[1], "bar");
+
+  Json::Value fec_enabled_indexes = std::move(root["fecEnabledIndexes"]);
+  EXPECT_EQ(fec_enabled_indexes.type(), Json::ValueType::arrayValue);
+  EXPECT_EQ(fec_enabled_indexes[0], 2);
 }
 
 TEST(AnswerMessagesTest, EmptyArraysOmitted) {
@@ -284,6 +291,12 @@ TEST(AnswerMessagesTest, EmptyArraysOmitted) {
   ASSERT_TRUE(missing_extensions.IsValid());
   root = missing_extensions.ToJson();
   EXPECT_FALSE(root["rtpExtensions"]);
+
+  Answer missing_fec = kValidAnswer;
+  missing_fec.fec_enabled_indexes.clear();
+  ASSERT_TRUE(missing_fec.IsValid());
+  root = missing_fec.ToJson();
+  EXPECT_FALSE(root["fecEnabledIndexes"]);
 }
 
 TEST(AnswerMessagesTest, InvalidDimensionsCauseInvalid) {
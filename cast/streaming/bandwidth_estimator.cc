@@ -74,7 +74,23 @@ void BandwidthEstimator::OnPayloadReceived(
                                ack_arrival_time - estimated_round_trip_time);
 }
 
+void BandwidthEstimator::OnPacketArrival(Ssrc ssrc,
+                                         Clock::time_point send_time,
+                                         Clock::time_point arrival_time) {
+  delay_controller_.OnPacketArrival(ssrc, send_time, arrival_time,
+                                    ComputeThroughput());
+}
+
 int BandwidthEstimator::ComputeNetworkBandwidth() const {
+  const int throughput = ComputeThroughput();
+  const int delay_based_target = delay_controller_.target_bitrate();
+  if (throughput == 0 || delay_based_target == 0) {
+    return throughput;
+  }
+  return std::min(throughput, delay_based_target);
+}
+
+int BandwidthEstimator::ComputeThroughput() const {
   // Determine whether the |burst_history_| time window overlaps with the
   // |feedback_history_| time window by at least half. The time windows don't
   // have to overlap entirely because the calculations are averaging all the
@@ -9,6 +9,8 @@
 
 #include <limits>
 
+#include "cast/streaming/delay_based_congestion_controller.h"
+#include "cast/streaming/ssrc.h"
 #include "platform/api/time.h"
 
 namespace openscreen {
@@ -48,6 +50,11 @@ namespace cast {
 // network's capacity. However, those under-estimates will still be far larger
 // than the current transmission rate.
 //
+// To react to congestion before packets are lost, the BandwidthEstimator also
+// accepts per-packet send/arrival times and feeds them into a
+// DelayBasedCongestionController. When that controller has computed a target,
+// the estimate is capped by it.
+//
 // Thus, these estimates can be used effectively as a control signal for
 // congestion control in upstream code modules. The logic computing the media's
 // encoding target bitrate should be adjusted in realtime using a TCP-like
@@ -94,11 +101,22 @@ class BandwidthEstimator {
                          Clock::time_point ack_arrival_time,
                          Clock::duration estimated_round_trip_time);
 
+  // Records that a packet of the stream identified by |ssrc|, sent at
+  // |send_time|, was received at |arrival_time| (according to the Receiver's
+  // clock). This should be called in order of arrival.
+  void OnPacketArrival(Ssrc ssrc,
+                       Clock::time_point send_time,
+                       Clock::time_point arrival_time);
+
   // Computes the current network bandwith estimate. Returns 0 if this cannot be
   // determined due to a lack of sufficiently-recent data.
   int ComputeNetworkBandwidth() const;
 
  private:
+  // Computes the network bandwidth from the recent flow history alone. Returns
+  // 0 if this cannot be determined due to a lack of sufficiently-recent data.
+  int ComputeThroughput() const;
+
   // FlowTracker (below) manages a ring buffer of size 256. It simplifies the
   // index calculations to use an integer data type where all arithmetic is mod
   // 256.
@@ -162,6 +180,9 @@ class BandwidthEstimator {
   // are in terms of when packets have left the Senders.
   FlowTracker burst_history_;
   FlowTracker feedback_history_;
+
+  // Detects queuing delay build-up from packet arrival times.
+  DelayBasedCongestionController delay_controller_;
 };
 
 }  // namespace cast
@@ -227,6 +227,48 @@ TEST_F(BandwidthEstimatorTest, ClampsEstimateToMaxInt) {
   EXPECT_EQ(std::numeric_limits<int>::max(), last_estimate);
 }
 
+// Tests that the estimate is unaffected by packet arrival times while the
+// network delay is stable, but drops below the measured throughput once the
+// arrival times indicate a queue is building up along the network path.
+TEST_F(BandwidthEstimatorTest, CapsEstimateWhenQueuingDelayGrows) {
+  const Clock::duration kRoundTripTime = milliseconds(10);
+  constexpr Ssrc kSsrc = 1;
+  constexpr int kReceivedBytesPerSecond = 256000;
+  constexpr int kReceivedBytesPerTimeslice =
+      kReceivedBytesPerSecond / kTimeslicesPerSecond;
+  constexpr int kExpectedThroughput = kReceivedBytesPerSecond * CHAR_BIT;
+
+  // For each burst, simulate its packets arriving at the Receiver after the
+  // one-way trip time plus |queuing_delay|, which grows by |delay_growth| each
+  // burst.
+  const auto simulate = [&](Clock::time_point* now,
+                            Clock::duration* queuing_delay,
+                            Clock::duration delay_growth) {
+    const Clock::time_point end = *now + estimator()->history_window();
+    for (; *now < end; *now += kTimesliceDuration) {
+      estimator()->OnBurstComplete(kMaxPacketsPerTimeslice, *now);
+      *queuing_delay += delay_growth;
+      for (int i = 0; i < kMaxPacketsPerTimeslice; ++i) {
+        estimator()->OnPacketArrival(
+            kSsrc, *now, *now + kRoundTripTime / 2 + *queuing_delay);
+      }
+      const Clock::time_point rtcp_arrival_time = *now + kRoundTripTime;
+      estimator()->OnPayloadReceived(kReceivedBytesPerTimeslice,
+                                     rtcp_arrival_time, kRoundTripTime);
+      estimator()->OnRtcpReceived(rtcp_arrival_time, kRoundTripTime);
+    }
+  };
+
+  Clock::time_point now = kStartTime;
+  Clock::duration queuing_delay = Clock::duration::zero();
+  simulate(&now, &queuing_delay, Clock::duration::zero());
+  EXPECT_EQ(kExpectedThroughput, estimator()->ComputeNetworkBandwidth());
+
+  // Grow the queuing delay by 25% of the time elapsed.
+  simulate(&now, &queuing_delay, kTimesliceDuration / 4);
+  EXPECT_LT(estimator()->ComputeNetworkBandwidth(), kExpectedThroughput);
+}
+
 }  // namespace
 }  // namespace cast
 }  // namespace openscreen
@@ -0,0 +1,168 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/benchmark_payload.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "util/big_endian.h"
+#include "util/chrono_helpers.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// Identifies a payload as starting with a BenchmarkPayloadHeader ("OSBM").
+constexpr uint32_t kMagic = 0x4f53424d;
+
+// The ranges of the latency and frame interval histograms, with 5 ms buckets.
+constexpr int64_t kMaxLatencyMs = 2000;
+constexpr int64_t kMaxFrameIntervalMs = 500;
+constexpr int64_t kBucketWidthMs = 5;
+
+}  // namespace
+
+// static
+constexpr int BenchmarkPayloadHeader::kSize;
+
+// static
+std::chrono::microseconds BenchmarkPayloadHeader::Now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+}
+
+void BenchmarkPayloadHeader::WriteTo(absl::Span<uint8_t> payload) const {
+  OSP_DCHECK_GE(payload.size(), static_cast<size_t>(kSize));
+  uint8_t* const out = payload.data();
+  WriteBigEndian<uint32_t>(kMagic, out);
+  WriteBigEndian<uint32_t>(sequence_number, out + 4);
+  WriteBigEndian<int64_t>(capture_time.count(), out + 8);
+}
+
+// static
+absl::optional<BenchmarkPayloadHeader> BenchmarkPayloadHeader::Parse(
+    absl::Span<const uint8_t> payload) {
+  if (payload.size() < static_cast<size_t>(kSize) ||
+      ReadBigEndian<uint32_t>(payload.data()) != kMagic) {
+    return absl::nullopt;
+  }
+  BenchmarkPayloadHeader header;
+  header.sequence_number = ReadBigEndian<uint32_t>(payload.data() + 4);
+  header.capture_time =
+      std::chrono::microseconds(ReadBigEndian<int64_t>(payload.data() + 8));
+  return header;
+}
+
+BenchmarkStreamRecorder::BenchmarkStreamRecorder(std::string media_type,
+                                                 std::string codec,
+                                                 Ssrc ssrc)
+    : media_type_(std::move(media_type)),
+      codec_(std::move(codec)),
+      ssrc_(ssrc),
+      latency_ms_(0, kMaxLatencyMs, kMaxLatencyMs / kBucketWidthMs),
+      frame_interval_ms_(0,
+                         kMaxFrameIntervalMs,
+                         kMaxFrameIntervalMs / kBucketWidthMs) {}
+
+BenchmarkStreamRecorder::~BenchmarkStreamRecorder() = default;
+
+void BenchmarkStreamRecorder::OnFrameConsumed(
+    absl::Span<const uint8_t> payload,
+    std::chrono::microseconds consume_time) {
+  ++num_frames_consumed_;
+
+  if (last_consume_time_) {
+    const int64_t interval_ms =
+        to_milliseconds(consume_time - *last_consume_time_).count();
+    frame_interval_ms_.Add(interval_ms);
+    sum_of_squared_intervals_ +=
+        static_cast<double>(interval_ms) * interval_ms;
+    max_frame_interval_ms_ = std::max(max_frame_interval_ms_, interval_ms);
+  } else {
+    first_consume_time_ = consume_time;
+  }
+  last_consume_time_ = consume_time;
+
+  const absl::optional<BenchmarkPayloadHeader> header =
+      BenchmarkPayloadHeader::Parse(payload);
+  if (!header) {
+    ++num_frames_without_header_;
+    return;
+  }
+
+  const int64_t latency_ms =
+      to_milliseconds(consume_time - header->capture_time).count();
+  latency_ms_.Add(latency_ms);
+  max_latency_ms_ = std::max(max_latency_ms_, latency_ms);
+
+  // Unsigned arithmetic accounts for the sequence numbers wrapping around. A
+  // frame arriving out-of-order (which the Receiver should never allow) does
+  // not count as a gap.
+  if (last_sequence_number_) {
+    const uint32_t gap = header->sequence_number - *last_sequence_number_ - 1;
+    if (gap < (uint32_t{1} << 31)) {
+      num_frames_missing_ += static_cast<int>(gap);
+    }
+  }
+  last_sequence_number_ = header->sequence_number;
+}
+
+void BenchmarkStreamRecorder::OnReceiverStopped(
+    const ReceiverStats& receiver_stats) {
+  num_frames_dropped_late_ = receiver_stats.num_frames_dropped_late;
+}
+
+double BenchmarkStreamRecorder::GetFrameIntervalStandardDeviation() const {
+  const int count = frame_interval_ms_.count();
+  if (count == 0) {
+    return 0.0;
+  }
+  const double mean = frame_interval_ms_.mean();
+  const double variance = sum_of_squared_intervals_ / count - mean * mean;
+  return variance > 0.0 ? std::sqrt(variance) : 0.0;
+}
+
+Json::Value BenchmarkStreamRecorder::ToJson() const {
+  Json::Value latency;
+  latency["mean"] = latency_ms_.mean();
+  latency["p50"] = Json::Int64(latency_ms_.GetApproximatePercentile(0.5));
+  latency["p90"] = Json::Int64(latency_ms_.GetApproximatePercentile(0.9));
+  latency["p95"] = Json::Int64(latency_ms_.GetApproximatePercentile(0.95));
+  latency["p99"] = Json::Int64(latency_ms_.GetApproximatePercentile(0.99));
+  latency["max"] = Json::Int64(max_latency_ms_);
+
+  Json::Value frame_rate;
+  double mean_fps = 0.0;
+  if (first_consume_time_ && *last_consume_time_ > *first_consume_time_) {
+    mean_fps = (num_frames_consumed_ - 1) /
+               std::chrono::duration<double>(*last_consume_time_ -
+                                             *first_consume_time_)
+                   .count();
+  }
+  frame_rate["mean_fps"] = mean_fps;
+  frame_rate["interval_mean_ms"] = frame_interval_ms_.mean();
+  frame_rate["interval_stddev_ms"] = GetFrameIntervalStandardDeviation();
+  frame_rate["interval_p99_ms"] =
+      Json::Int64(frame_interval_ms_.GetApproximatePercentile(0.99));
+  frame_rate["interval_max_ms"] = Json::Int64(max_frame_interval_ms_);
+
+  Json::Value root;
+  root["media_type"] = media_type_;
+  root["codec"] = codec_;
+  root["ssrc"] = Json::UInt(ssrc_);
+  root["frames_consumed"] = num_frames_consumed_;
+  root["frames_missing"] = num_frames_missing_;
+  root["frames_without_header"] = num_frames_without_header_;
+  root["frames_dropped_late"] = num_frames_dropped_late_;
+  root["latency_ms"] = std::move(latency);
+  root["frame_rate"] = std::move(frame_rate);
+  return root;
+}
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,114 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_BENCHMARK_PAYLOAD_H_
+#define CAST_STREAMING_BENCHMARK_PAYLOAD_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <string>
+
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "cast/streaming/ssrc.h"
+#include "cast/streaming/statistics.h"
+#include "json/value.h"
+
+namespace openscreen {
+namespace cast {
+
+// Benchmark streams carry synthetic frame payloads, each beginning with this
+// header, rather than encoded media. This allows a receiver-side sink to
+// measure the capture-to-consume latency of every frame without decoding it,
+// and to count the frames lost anywhere in the pipeline.
+//
+// Capture times are wall-clock times (i.e., from std::chrono::system_clock,
+// not Clock), so the measured latencies are only meaningful if the sender's and
+// receiver's system clocks are synchronized (e.g., both run on the same host,
+// or both are NTP-synced).
+struct BenchmarkPayloadHeader {
+  // The serialized size, in bytes.
+  static constexpr int kSize = 16;
+
+  // Incremented for each frame produced for a stream, including any that were
+  // not sent (e.g., because the Sender was backlogged).
+  uint32_t sequence_number = 0;
+
+  // When the frame was produced, relative to the Unix epoch.
+  std::chrono::microseconds capture_time{};
+
+  // Returns the current wall-clock time, relative to the Unix epoch.
+  static std::chrono::microseconds Now();
+
+  // Writes this header to the start of |payload|, which must be at least
+  // |kSize| bytes.
+  void WriteTo(absl::Span<uint8_t> payload) const;
+
+  // Returns the header at the start of |payload|, or nullopt if |payload| does
+  // not start with one.
+  static absl::optional<BenchmarkPayloadHeader> Parse(
+      absl::Span<const uint8_t> payload);
+};
+
+// Accumulates the metrics for one benchmark stream, as each frame is consumed
+// from a Receiver.
+class BenchmarkStreamRecorder {
+ public:
+  // |media_type| and |codec| are only used to label the results.
+  BenchmarkStreamRecorder(std::string media_type, std::string codec, Ssrc ssrc);
+  ~BenchmarkStreamRecorder();
+
+  // Records the consumption of a frame with the given |payload|, at the given
+  // wall-clock time (see BenchmarkPayloadHeader::Now()).
+  void OnFrameConsumed(absl::Span<const uint8_t> payload,
+                       std::chrono::microseconds consume_time);
+
+  // Records the final statistics of the Receiver, which account for the frames
+  // it dropped because they would have been played out too late.
+  void OnReceiverStopped(const ReceiverStats& receiver_stats);
+
+  int num_frames_consumed() const { return num_frames_consumed_; }
+  int num_frames_missing() const { return num_frames_missing_; }
+  int num_frames_without_header() const { return num_frames_without_header_; }
+  const FixedBucketHistogram& latency_ms() const { return latency_ms_; }
+  const FixedBucketHistogram& frame_interval_ms() const {
+    return frame_interval_ms_;
+  }
+
+  // Returns the standard deviation of the intervals between consecutive frames,
+  // as a measure of frame rate stability.
+  double GetFrameIntervalStandardDeviation() const;
+
+  // Returns all of the metrics as a JSON object.
+  Json::Value ToJson() const;
+
+ private:
+  const std::string media_type_;
+  const std::string codec_;
+  const Ssrc ssrc_;
+
+  // The frames consumed; the frames never consumed, as indicated by gaps in
+  // the sequence numbers; and the frames whose payloads had no header.
+  int num_frames_consumed_ = 0;
+  int num_frames_missing_ = 0;
+  int num_frames_without_header_ = 0;
+  int num_frames_dropped_late_ = 0;
+
+  absl::optional<uint32_t> last_sequence_number_;
+  absl::optional<std::chrono::microseconds> first_consume_time_;
+  absl::optional<std::chrono::microseconds> last_consume_time_;
+
+  FixedBucketHistogram latency_ms_;
+  int64_t max_latency_ms_ = 0;
+
+  FixedBucketHistogram frame_interval_ms_;
+  double sum_of_squared_intervals_ = 0.0;
+  int64_t max_frame_interval_ms_ = 0;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_BENCHMARK_PAYLOAD_H_
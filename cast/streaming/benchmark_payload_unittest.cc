@@ -0,0 +1,105 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/benchmark_payload.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+std::vector<uint8_t> MakePayload(uint32_t sequence_number,
+                                 microseconds capture_time) {
+  std::vector<uint8_t> payload(BenchmarkPayloadHeader::kSize + 100, 0xab);
+  BenchmarkPayloadHeader header;
+  header.sequence_number = sequence_number;
+  header.capture_time = capture_time;
+  header.WriteTo(absl::Span<uint8_t>(payload));
+  return payload;
+}
+
+TEST(BenchmarkPayloadTest, WritesAndParsesHeaders) {
+  const microseconds now = BenchmarkPayloadHeader::Now();
+  const std::vector<uint8_t> payload = MakePayload(0xfffffffe, now);
+  const absl::optional<BenchmarkPayloadHeader> header =
+      BenchmarkPayloadHeader::Parse(payload);
+  ASSERT_TRUE(header);
+  EXPECT_EQ(0xfffffffeu, header->sequence_number);
+  EXPECT_EQ(now, header->capture_time);
+
+  // Payloads that are too short, or that are not benchmark payloads, have no
+  // header.
+  EXPECT_FALSE(BenchmarkPayloadHeader::Parse(absl::Span<const uint8_t>(
+      payload.data(), BenchmarkPayloadHeader::kSize - 1)));
+  const std::vector<uint8_t> media(100, 0);
+  EXPECT_FALSE(BenchmarkPayloadHeader::Parse(media));
+}
+
+TEST(BenchmarkPayloadTest, RecordsLatencyGapsAndFrameIntervals) {
+  BenchmarkStreamRecorder recorder("video", "vp8", 42);
+  const microseconds start = BenchmarkPayloadHeader::Now();
+
+  // Frames 0 through 9 are captured 100 ms apart and consumed 30 ms later,
+  // except that frames 3 and 7 never arrive, and the consumer falls a further
+  // 200 ms behind from frame 8 onwards.
+  for (uint32_t i = 0; i < 10; ++i) {
+    if (i == 3 || i == 7) {
+      continue;
+    }
+    const microseconds capture_time = start + milliseconds(100) * i;
+    const milliseconds stall = (i >= 8) ? milliseconds(200) : milliseconds(0);
+    recorder.OnFrameConsumed(MakePayload(i, capture_time),
+                             capture_time + milliseconds(30) + stall);
+  }
+
+  // A frame without a header counts, but contributes no latency.
+  const std::vector<uint8_t> media(100, 0);
+  recorder.OnFrameConsumed(media, start + milliseconds(1200));
+
+  ReceiverStats receiver_stats;
+  receiver_stats.num_frames_dropped_late = 1;
+  recorder.OnReceiverStopped(receiver_stats);
+
+  EXPECT_EQ(9, recorder.num_frames_consumed());
+  EXPECT_EQ(2, recorder.num_frames_missing());
+  EXPECT_EQ(1, recorder.num_frames_without_header());
+  EXPECT_EQ(8, recorder.latency_ms().count());
+  EXPECT_EQ(30 * 6 + 230 * 2, recorder.latency_ms().sum());
+  EXPECT_EQ(8, recorder.frame_interval_ms().count());
+  EXPECT_GT(recorder.GetFrameIntervalStandardDeviation(), 0.0);
+
+  const Json::Value json = recorder.ToJson();
+  EXPECT_EQ("video", json["media_type"].asString());
+  EXPECT_EQ("vp8", json["codec"].asString());
+  EXPECT_EQ(42u, json["ssrc"].asUInt());
+  EXPECT_EQ(9, json["frames_consumed"].asInt());
+  EXPECT_EQ(2, json["frames_missing"].asInt());
+  EXPECT_EQ(1, json["frames_dropped_late"].asInt());
+  EXPECT_EQ(230, json["latency_ms"]["max"].asInt64());
+  EXPECT_EQ(400, json["frame_rate"]["interval_max_ms"].asInt64());
+  EXPECT_NEAR(8.0 / 1.17, json["frame_rate"]["mean_fps"].asDouble(), 0.01);
+}
+
+TEST(BenchmarkPayloadTest, StableFrameRateHasNoIntervalDeviation) {
+  BenchmarkStreamRecorder recorder("audio", "opus", 1);
+  const microseconds start = BenchmarkPayloadHeader::Now();
+  for (uint32_t i = 0; i < 50; ++i) {
+    const microseconds capture_time = start + milliseconds(20) * i;
+    recorder.OnFrameConsumed(MakePayload(i, capture_time),
+                             capture_time + milliseconds(5));
+  }
+  EXPECT_EQ(0, recorder.num_frames_missing());
+  EXPECT_EQ(0.0, recorder.GetFrameIntervalStandardDeviation());
+  EXPECT_EQ(20.0, recorder.frame_interval_ms().mean());
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
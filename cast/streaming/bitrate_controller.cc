@@ -0,0 +1,139 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/bitrate_controller.h"
+
+#include <algorithm>
+
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// The weight given to each new sample in the moving averages of the encoder's
+// utilization.
+constexpr double kUtilizationSmoothingFactor = 1.0 / 8;
+
+// Above this average quality utilization, the encoder is "redlining" and the
+// resolution is stepped down. Below the headroom threshold, it is stepped back
+// up (but only after twice the usual interval, to avoid oscillating).
+constexpr double kRedlineUtilization = 1.0;
+constexpr double kHeadroomUtilization = 0.6;
+
+// At the maximum in-flight media duration, the target bitrate is backed off
+// by this fraction per update.
+constexpr double kMaxBackoff = 0.5;
+
+double ComputeFraction(Clock::duration part, Clock::duration whole) {
+  if (whole <= Clock::duration::zero()) {
+    return 0.0;
+  }
+  return static_cast<double>(part.count()) / whole.count();
+}
+
+}  // namespace
+
+BitrateController::BitrateController(const Params& params)
+    : params_(params),
+      target_bitrate_(std::max(params.max_bitrate / 2, params.min_bitrate)) {
+  OSP_DCHECK_GT(params_.min_bitrate, 0);
+  OSP_DCHECK_LE(params_.min_bitrate, params_.max_bitrate);
+  OSP_DCHECK_GT(params_.network_utilization, 0.0);
+  OSP_DCHECK_GE(params_.max_increase_factor, 1.0);
+  OSP_DCHECK_LT(params_.in_flight_backoff_threshold,
+                params_.in_flight_drop_threshold);
+  OSP_DCHECK_GE(params_.max_resolution_step, 0);
+}
+
+BitrateController::~BitrateController() = default;
+
+int BitrateController::UpdateTargetBitrate(
+    int bandwidth_estimate,
+    Clock::duration in_flight_duration,
+    Clock::duration max_in_flight_duration) {
+  double target = target_bitrate_;
+  const double usable_bandwidth =
+      params_.network_utilization * bandwidth_estimate;
+
+  const double in_flight_fraction =
+      ComputeFraction(in_flight_duration, max_in_flight_duration);
+  if (in_flight_fraction > params_.in_flight_backoff_threshold) {
+    // The network is not keeping up, whatever the estimate says. Back off in
+    // proportion to how close the in-flight media is to the maximum.
+    const double excess =
+        std::min((in_flight_fraction - params_.in_flight_backoff_threshold) /
+                     (1.0 - params_.in_flight_backoff_threshold),
+                 1.0);
+    target *= 1.0 - kMaxBackoff * excess;
+    if (bandwidth_estimate > 0) {
+      target = std::min(target, usable_bandwidth);
+    }
+  } else if (bandwidth_estimate > 0) {
+    if (usable_bandwidth > target) {
+      target = std::min(target * params_.max_increase_factor, usable_bandwidth);
+    } else {
+      target = usable_bandwidth;
+    }
+  }
+
+  target_bitrate_ = static_cast<int>(
+      std::min(std::max(target, static_cast<double>(params_.min_bitrate)),
+               static_cast<double>(params_.max_bitrate)));
+  return target_bitrate_;
+}
+
+bool BitrateController::ShouldDropFrame(
+    Clock::duration in_flight_duration,
+    Clock::duration max_in_flight_duration) {
+  bool drop;
+  if (ComputeFraction(in_flight_duration, max_in_flight_duration) >=
+      params_.in_flight_drop_threshold) {
+    drop = true;
+  } else {
+    // If the encoder cannot keep up in real time, halve the frame rate.
+    drop = time_utilization_ > kRedlineUtilization && !dropped_last_frame_;
+  }
+
+  dropped_last_frame_ = drop;
+  if (drop) {
+    ++num_frames_dropped_;
+  }
+  return drop;
+}
+
+void BitrateController::OnFrameEncoded(Clock::time_point now,
+                                       const EncoderFeedback& feedback) {
+  const double quality_utilization =
+      std::max(feedback.space_utilization, feedback.entropy_utilization);
+  if (last_resolution_change_time_ == Clock::time_point::min()) {
+    time_utilization_ = feedback.time_utilization;
+    quality_utilization_ = quality_utilization;
+    last_resolution_change_time_ = now;
+    return;
+  }
+  time_utilization_ += kUtilizationSmoothingFactor *
+                       (feedback.time_utilization - time_utilization_);
+  quality_utilization_ += kUtilizationSmoothingFactor *
+                          (quality_utilization - quality_utilization_);
+
+  const Clock::duration since_last_change = now - last_resolution_change_time_;
+  if (since_last_change < params_.min_resolution_step_interval) {
+    return;
+  }
+  if (quality_utilization_ > kRedlineUtilization &&
+      resolution_step_ < params_.max_resolution_step) {
+    ++resolution_step_;
+    last_resolution_change_time_ = now;
+  } else if (quality_utilization_ < kHeadroomUtilization &&
+             resolution_step_ > 0 &&
+             since_last_change >= 2 * params_.min_resolution_step_interval) {
+    --resolution_step_;
+    last_resolution_change_time_ = now;
+  }
+}
+
+}  // namespace cast
+}  // namespace openscreen
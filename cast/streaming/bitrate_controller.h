@@ -0,0 +1,123 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_BITRATE_CONTROLLER_H_
+#define CAST_STREAMING_BITRATE_CONTROLLER_H_
+
+#include <chrono>
+
+#include "platform/api/time.h"
+
+namespace openscreen {
+namespace cast {
+
+// Closed-loop control of the data volume produced by a video encoder feeding a
+// Sender. Three signals are combined:
+//
+//   1. The network bandwidth estimate (see BandwidthEstimator), which sets the
+//      ceiling for the target bitrate.
+//   2. The in-flight media duration (see Sender::GetInFlightMediaDuration()),
+//      which indicates the network is not keeping up, regardless of what the
+//      estimate says. The target bitrate is backed off as it grows, and frames
+//      are dropped before encoding once it nears the maximum (rather than
+//      being encoded only to be rejected by the Sender).
+//   3. The encoder's utilization feedback for each frame (e.g., from
+//      StreamingVp8Encoder::Stats). When the encoder cannot keep up in real
+//      time, every other frame is dropped to halve the frame rate. When it is
+//      "redlining" on quality (i.e., the content needs more bits than the
+//      target bitrate allows), the resolution is stepped down; and then back
+//      up once there is plenty of headroom.
+//
+// The target bitrate is increased conservatively, but decreased immediately,
+// per the "congestion control" discussion in the BandwidthEstimator class
+// comments.
+class BitrateController {
+ public:
+  struct Params {
+    // The range of target bitrates, in bits per second.
+    int min_bitrate = 384 << 10;
+    int max_bitrate = 10 << 20;
+
+    // The fraction of the network bandwidth estimate to use. Using all of it
+    // would leave no room for re-transmits or other traffic.
+    double network_utilization = 0.8;
+
+    // The maximum factor by which the target bitrate may increase per
+    // UpdateTargetBitrate() call.
+    double max_increase_factor = 1.1;
+
+    // Fractions of the maximum in-flight media duration: Above the first, the
+    // target bitrate is backed off; and above the second, frames are dropped.
+    double in_flight_backoff_threshold = 0.5;
+    double in_flight_drop_threshold = 0.8;
+
+    // The number of resolution steps below full resolution, and the minimum
+    // time between steps, allowing the effects of each to be measured.
+    int max_resolution_step = 3;
+    Clock::duration min_resolution_step_interval = std::chrono::seconds(2);
+  };
+
+  // The utilization metrics for one encoded frame, where 1.0 means the entire
+  // budget for the frame was exhausted. See StreamingVp8Encoder::Stats.
+  struct EncoderFeedback {
+    double time_utilization = 0.0;
+    double space_utilization = 0.0;
+    double entropy_utilization = 0.0;
+  };
+
+  explicit BitrateController(const Params& params);
+  ~BitrateController();
+
+  const Params& params() const { return params_; }
+
+  // Returns the current target bitrate, in bits per second.
+  int target_bitrate() const { return target_bitrate_; }
+
+  // Returns the current resolution step, in the range [0,max_resolution_step],
+  // where zero means full resolution. The mapping of steps to frame sizes is up
+  // to the client (e.g., 4/5, 3/5, and 1/2 scaling per dimension for VP8).
+  int resolution_step() const { return resolution_step_; }
+
+  int num_frames_dropped() const { return num_frames_dropped_; }
+
+  // Recomputes and returns the target bitrate, given the current network
+  // |bandwidth_estimate| (zero if not yet known), and the current and maximum
+  // in-flight media durations. This should be called periodically (e.g., a few
+  // times per second).
+  int UpdateTargetBitrate(int bandwidth_estimate,
+                          Clock::duration in_flight_duration,
+                          Clock::duration max_in_flight_duration);
+
+  // Returns true if the next frame should not be encoded, given the in-flight
+  // media duration that would result from enqueuing it. This should be called
+  // once for each frame produced by the capturer.
+  bool ShouldDropFrame(Clock::duration in_flight_duration,
+                       Clock::duration max_in_flight_duration);
+
+  // Called with the |feedback| for each encoded frame, which may step the
+  // resolution up or down.
+  void OnFrameEncoded(Clock::time_point now, const EncoderFeedback& feedback);
+
+ private:
+  const Params params_;
+
+  int target_bitrate_;
+  int resolution_step_ = 0;
+
+  // Exponentially-weighted moving averages of the encoder's time utilization,
+  // and the greater of its space and entropy utilizations.
+  double time_utilization_ = 0.0;
+  double quality_utilization_ = 0.0;
+
+  // When the resolution was last stepped (or the first frame was encoded).
+  Clock::time_point last_resolution_change_time_ = Clock::time_point::min();
+
+  bool dropped_last_frame_ = false;
+  int num_frames_dropped_ = 0;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_BITRATE_CONTROLLER_H_
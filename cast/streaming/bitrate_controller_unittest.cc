@@ -0,0 +1,203 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/bitrate_controller.h"
+
+#include <chrono>
+#include <string>
+
+#include "cast/streaming/testing/streaming_simulation.h"
+#include "gtest/gtest.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+constexpr int kMinBitrate = 500000;
+constexpr int kMaxBitrate = 8000000;
+constexpr milliseconds kMaxInFlight{400};
+constexpr milliseconds kFrameDuration{33};
+
+BitrateController::Params MakeParams() {
+  BitrateController::Params params;
+  params.min_bitrate = kMinBitrate;
+  params.max_bitrate = kMaxBitrate;
+  return params;
+}
+
+BitrateController::EncoderFeedback MakeFeedback(double time_utilization,
+                                                double quality_utilization) {
+  BitrateController::EncoderFeedback feedback;
+  feedback.time_utilization = time_utilization;
+  feedback.space_utilization = quality_utilization;
+  feedback.entropy_utilization = quality_utilization;
+  return feedback;
+}
+
+TEST(BitrateControllerTest, IncreasesConservativelyUpToTheUsableBandwidth) {
+  BitrateController controller(MakeParams());
+  EXPECT_EQ(kMaxBitrate / 2, controller.target_bitrate());
+
+  // With no estimate, nothing changes.
+  EXPECT_EQ(kMaxBitrate / 2, controller.UpdateTargetBitrate(
+                                 0, milliseconds(0), kMaxInFlight));
+
+  // Increases are limited to 10% per update, and then to 80% of the estimate.
+  EXPECT_EQ(4400000, controller.UpdateTargetBitrate(6000000, milliseconds(0),
+                                                    kMaxInFlight));
+  EXPECT_EQ(4800000, controller.UpdateTargetBitrate(6000000, milliseconds(0),
+                                                    kMaxInFlight));
+
+  // Decreases take effect immediately.
+  EXPECT_EQ(4000000, controller.UpdateTargetBitrate(5000000, milliseconds(0),
+                                                    kMaxInFlight));
+
+  // The target never exceeds the maximum, nor goes below the minimum.
+  for (int i = 0; i < 20; ++i) {
+    controller.UpdateTargetBitrate(100000000, milliseconds(0), kMaxInFlight);
+  }
+  EXPECT_EQ(kMaxBitrate, controller.target_bitrate());
+  EXPECT_EQ(kMinBitrate, controller.UpdateTargetBitrate(
+                             100000, milliseconds(0), kMaxInFlight));
+}
+
+TEST(BitrateControllerTest, BacksOffAsInFlightMediaGrows) {
+  BitrateController controller(MakeParams());
+  const int initial = controller.target_bitrate();
+
+  // Below the backoff threshold, the estimate alone determines the target.
+  EXPECT_EQ(initial, controller.UpdateTargetBitrate(
+                         initial * 10 / 8, kMaxInFlight / 2, kMaxInFlight));
+
+  // Halfway between the backoff threshold and the maximum, the target is
+  // reduced by a quarter, despite the estimate suggesting an increase.
+  EXPECT_EQ(initial * 3 / 4,
+            controller.UpdateTargetBitrate(kMaxBitrate * 2,
+                                           kMaxInFlight * 3 / 4, kMaxInFlight));
+
+  // At the maximum, the target is halved.
+  EXPECT_EQ(initial * 3 / 8, controller.UpdateTargetBitrate(
+                                 kMaxBitrate * 2, kMaxInFlight, kMaxInFlight));
+}
+
+TEST(BitrateControllerTest, DropsFramesNearTheMaxInFlightDuration) {
+  BitrateController controller(MakeParams());
+  EXPECT_FALSE(controller.ShouldDropFrame(kMaxInFlight / 2, kMaxInFlight));
+  EXPECT_FALSE(controller.ShouldDropFrame(kMaxInFlight * 7 / 10, kMaxInFlight));
+  EXPECT_TRUE(controller.ShouldDropFrame(kMaxInFlight * 8 / 10, kMaxInFlight));
+  EXPECT_TRUE(controller.ShouldDropFrame(kMaxInFlight, kMaxInFlight));
+  EXPECT_EQ(2, controller.num_frames_dropped());
+}
+
+TEST(BitrateControllerTest, HalvesFrameRateWhileEncoderCannotKeepUp) {
+  BitrateController controller(MakeParams());
+  Clock::time_point now = Clock::now();
+  for (int i = 0; i < 30; ++i) {
+    controller.OnFrameEncoded(now, MakeFeedback(1.5, 0.8));
+    now += kFrameDuration;
+  }
+
+  int num_dropped = 0;
+  for (int i = 0; i < 10; ++i) {
+    const bool dropped =
+        controller.ShouldDropFrame(milliseconds(0), kMaxInFlight);
+    EXPECT_EQ(i % 2 == 0, dropped);
+    num_dropped += dropped ? 1 : 0;
+  }
+  EXPECT_EQ(5, num_dropped);
+
+  // Once the encoder is keeping up again, no more frames are dropped.
+  for (int i = 0; i < 30; ++i) {
+    controller.OnFrameEncoded(now, MakeFeedback(0.5, 0.8));
+    now += kFrameDuration;
+  }
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_FALSE(controller.ShouldDropFrame(milliseconds(0), kMaxInFlight));
+  }
+}
+
+TEST(BitrateControllerTest, StepsResolutionDownWhenRedliningAndBackUp) {
+  const BitrateController::Params params = MakeParams();
+  BitrateController controller(params);
+  Clock::time_point now = Clock::now();
+  const auto simulate_frames = [&](Clock::duration how_long,
+                                   double quality_utilization) {
+    for (const Clock::time_point end = now + how_long; now < end;
+         now += kFrameDuration) {
+      controller.OnFrameEncoded(now, MakeFeedback(0.5, quality_utilization));
+    }
+  };
+
+  // Stepping down happens at most once per interval, down to the limit.
+  simulate_frames(params.min_resolution_step_interval - kFrameDuration, 1.5);
+  EXPECT_EQ(0, controller.resolution_step());
+  simulate_frames(kFrameDuration * 2, 1.5);
+  EXPECT_EQ(1, controller.resolution_step());
+  simulate_frames(params.min_resolution_step_interval * 10, 1.5);
+  EXPECT_EQ(params.max_resolution_step, controller.resolution_step());
+
+  // With modest headroom, the resolution is left alone.
+  simulate_frames(params.min_resolution_step_interval * 10, 0.8);
+  EXPECT_EQ(params.max_resolution_step, controller.resolution_step());
+
+  // With plenty of headroom, it is stepped back up, more slowly.
+  simulate_frames(params.min_resolution_step_interval * 4, 0.3);
+  EXPECT_EQ(params.max_resolution_step - 2, controller.resolution_step());
+  simulate_frames(params.min_resolution_step_interval * 10, 0.3);
+  EXPECT_EQ(0, controller.resolution_step());
+}
+
+// Evaluates the BitrateController against the fixed "fraction of the estimate"
+// policy by streaming over a simulated link whose capacity drops well below the
+// content's needs for a while, and then recovers. See
+// cast/test:streaming_simulation_benchmark for a longer comparison.
+TEST(BitrateControllerTest, OutperformsFixedPolicyInSimulation) {
+  StreamingSimulation::Params params;
+  params.duration = seconds(30);
+  params.forward_link.propagation_delay = milliseconds(20);
+  params.reverse_link.propagation_delay = milliseconds(20);
+  params.forward_link.capacity_trace = {
+      {seconds(0), 6000000}, {seconds(10), 1000000}, {seconds(20), 6000000}};
+  params.min_bitrate = kMinBitrate;
+  params.max_bitrate = kMaxBitrate;
+
+  const StreamingSimulation::Results fixed = StreamingSimulation(params).Run();
+
+  params.bitrate_controller = MakeParams();
+  const StreamingSimulation::Results controlled =
+      StreamingSimulation(params).Run();
+
+  for (const auto* results : {&fixed, &controlled}) {
+    const char* const prefix = results == &fixed ? "fixed_" : "controlled_";
+    ::testing::Test::RecordProperty(
+        std::string(prefix) + "frames_consumed", results->num_frames_consumed);
+    ::testing::Test::RecordProperty(
+        std::string(prefix) + "frames_rejected", results->num_frames_rejected);
+    ::testing::Test::RecordProperty(
+        std::string(prefix) + "frames_dropped", results->num_frames_dropped);
+    ::testing::Test::RecordProperty(
+        std::string(prefix) + "frame_latency_p95_ms",
+        static_cast<int>(
+            results->frame_latency_ms.GetApproximatePercentile(0.95)));
+  }
+
+  // The controller should have dropped frames before encoding them, rather than
+  // encoding frames only to have the Sender reject them.
+  EXPECT_GT(controlled.num_frames_dropped, 0);
+  EXPECT_GT(controlled.num_frames_consumed, fixed.num_frames_consumed);
+  EXPECT_LE(controlled.num_frames_rejected, fixed.num_frames_rejected);
+  EXPECT_LE(controlled.frame_latency_ms.GetApproximatePercentile(0.95),
+            fixed.frame_latency_ms.GetApproximatePercentile(0.95));
+
+  // The content needs more than the link could carry, so the resolution should
+  // have been stepped down.
+  EXPECT_GT(controlled.max_resolution_step, 0);
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
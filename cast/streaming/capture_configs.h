@@ -33,6 +33,10 @@ struct AudioCaptureConfig {
 
   // Target playout delay in milliseconds.
   std::chrono::milliseconds target_playout_delay = kDefaultTargetPlayoutDelay;
+
+  // Number of RTP packets protected by each FEC packet, or zero to not offer
+  // FEC. FEC is only used if the receiver accepts it.
+  int fec_group_size = 0;
 };
 
 // Display resolution in pixels.
@@ -75,6 +79,10 @@ struct VideoCaptureConfig {
 
   // Target playout delay in milliseconds.
   std::chrono::milliseconds target_playout_delay = kDefaultTargetPlayoutDelay;
+
+  // Number of RTP packets protected by each FEC packet, or zero to not offer
+  // FEC. FEC is only used if the receiver accepts it.
+  int fec_group_size = 0;
 };
 
 }  // namespace cast
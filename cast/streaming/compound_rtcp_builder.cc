@@ -83,6 +83,11 @@ void CompoundRtcpBuilder::IncludeFeedbackInNextPacket(
 #endif
 }
 
+void CompoundRtcpBuilder::IncludePacketArrivalsInNextPacket(
+    std::vector<PacketArrival> arrivals) {
+  arrivals_for_next_packet_ = std::move(arrivals);
+}
+
 absl::Span<uint8_t> CompoundRtcpBuilder::BuildPacket(
     Clock::time_point send_time,
     absl::Span<uint8_t> buffer) {
@@ -110,6 +115,12 @@ absl::Span<uint8_t> CompoundRtcpBuilder::BuildPacket(
   // the remaning space available in the buffer will allow for.
   AppendCastFeedbackPacket(&buffer);
 
+  // Packet Arrival Report: Lowest priority, so only as many arrivals as will
+  // fit in the remaining space are included.
+  if (!arrivals_for_next_packet_.empty()) {
+    AppendPacketArrivalReportPacket(send_time, &buffer);
+  }
+
   uint8_t* const packet_end = buffer.data();
   return absl::Span<uint8_t>(packet_begin, packet_end - packet_begin);
 }
@@ -325,5 +336,51 @@ void CompoundRtcpBuilder::AppendCastFeedbackAckFields(
   acks_for_next_packet_.clear();
 }
 
+void CompoundRtcpBuilder::AppendPacketArrivalReportPacket(
+    Clock::time_point send_time,
+    absl::Span<uint8_t>* buffer) {
+  constexpr int kOverheadSize = kRtcpCommonHeaderSize +
+                                kRtcpExtendedReportHeaderSize +
+                                kRtcpExtendedReportBlockHeaderSize;
+  // The 16-bit "Block Length" field limits the number of entries, as does the
+  // remaining space in the buffer.
+  constexpr int kMaxEntriesForBlockLength =
+      std::numeric_limits<uint16_t>::max() /
+      (kRtcpPacketArrivalReportEntrySize / sizeof(uint32_t));
+  const int num_entries =
+      std::min({static_cast<int>(arrivals_for_next_packet_.size()),
+                (static_cast<int>(buffer->size()) - kOverheadSize) /
+                    kRtcpPacketArrivalReportEntrySize,
+                kMaxEntriesForBlockLength});
+  if (num_entries <= 0) {
+    arrivals_for_next_packet_.clear();
+    return;
+  }
+
+  const int block_data_size = num_entries * kRtcpPacketArrivalReportEntrySize;
+  RtcpCommonHeader header;
+  header.packet_type = RtcpPacketType::kExtendedReports;
+  header.payload_size = kRtcpExtendedReportHeaderSize +
+                        kRtcpExtendedReportBlockHeaderSize + block_data_size;
+  header.AppendFields(buffer);
+  AppendField<uint32_t>(session_->receiver_ssrc(), buffer);
+  AppendField<uint8_t>(kRtcpPacketArrivalReportBlockType, buffer);
+  AppendField<uint8_t>(0 /* reserved/unused byte */, buffer);
+  AppendField<uint16_t>(block_data_size / sizeof(uint32_t), buffer);
+  for (int i = 0; i < num_entries; ++i) {
+    const PacketArrival& arrival = arrivals_for_next_packet_[i];
+    AppendField<uint8_t>(arrival.frame_id.lower_8_bits(), buffer);
+    AppendField<uint8_t>(0 /* reserved/unused byte */, buffer);
+    AppendField<uint16_t>(arrival.packet_id, buffer);
+    AppendField<uint32_t>(
+        static_cast<uint32_t>(
+            RtcpReportBlock::ToClampedDelay(send_time - arrival.arrival_time)
+                .count()),
+        buffer);
+  }
+
+  arrivals_for_next_packet_.clear();
+}
+
 }  // namespace cast
 }  // namespace openscreen
@@ -88,6 +88,14 @@ class CompoundRtcpBuilder {
   void IncludeFeedbackInNextPacket(std::vector<PacketNack> packet_nacks,
                                    std::vector<FrameId> frame_acks);
 
+  // Include the arrival times of recently-received RTP packets in ONLY the next
+  // built RTCP packet. These are used by the Sender for delay-based congestion
+  // control, and so they are included in a best-effort fashion after all other
+  // data, depending on the remaining space in the |buffer| passed to the next
+  // call to BuildPacket(). This replaces prior arrivals if BuildPacket() was
+  // not called in the meantime. The elements should be in order of arrival.
+  void IncludePacketArrivalsInNextPacket(std::vector<PacketArrival> arrivals);
+
   // Builds a compound RTCP packet and returns the portion of the |buffer| that
   // was used. The buffer's size must be at least kRequiredBufferSize, but
   // should generally be the maximum packet size (see discussion in
@@ -116,6 +124,8 @@ class CompoundRtcpBuilder {
   void AppendCastFeedbackPacket(absl::Span<uint8_t>* buffer);
   int AppendCastFeedbackLossFields(absl::Span<uint8_t>* buffer);
   void AppendCastFeedbackAckFields(absl::Span<uint8_t>* buffer);
+  void AppendPacketArrivalReportPacket(Clock::time_point send_time,
+                                       absl::Span<uint8_t>* buffer);
 
   RtcpSession* const session_;
 
@@ -125,6 +135,7 @@ class CompoundRtcpBuilder {
   absl::optional<RtcpReportBlock> receiver_report_for_next_packet_;
   std::vector<PacketNack> nacks_for_next_packet_;
   std::vector<FrameId> acks_for_next_packet_;
+  std::vector<PacketArrival> arrivals_for_next_packet_;
   bool picture_loss_indicator_ = false;
 
   // An 8-bit wrap-around counter that tracks how many times Cast Feedback has
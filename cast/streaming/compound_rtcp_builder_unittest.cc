@@ -367,6 +367,63 @@ TEST_F(CompoundRtcpBuilderTest, WithEverythingThatCanFit) {
   Mock::VerifyAndClearExpectations(client());
 }
 
+// Tests that the builder includes as many packet arrivals as will fit in the
+// remaining space, after all other data, and only in the next-built RTCP
+// packet.
+TEST_F(CompoundRtcpBuilderTest, WithPacketArrivals) {
+  const FrameId checkpoint = FrameId::first() + 300;
+  builder()->SetCheckpointFrame(checkpoint);
+  const auto playout_delay = builder()->playout_delay();
+
+  const auto send_time = Clock::now();
+  constexpr int kArrivalCount = 40;
+  std::vector<PacketArrival> arrivals;
+  for (int i = 0; i < kArrivalCount; ++i) {
+    arrivals.push_back(PacketArrival{
+        checkpoint + 1 + (i / 8), static_cast<FramePacketId>(i % 8),
+        send_time - milliseconds(100) + milliseconds(2 * i)});
+  }
+  builder()->IncludePacketArrivalsInNextPacket(arrivals);
+
+  uint8_t buffer[CompoundRtcpBuilder::kRequiredBufferSize];
+  const auto packet = builder()->BuildPacket(send_time, buffer);
+  ASSERT_TRUE(packet.data());
+
+  const auto max_feedback_frame_id = checkpoint + 10;
+  EXPECT_CALL(*(client()), OnReceiverReferenceTimeAdvanced(
+                               ViaNtpTimestampTranslation(send_time)));
+  EXPECT_CALL(*(client()), OnReceiverCheckpoint(checkpoint, playout_delay));
+  std::vector<PacketArrival> parsed;
+  EXPECT_CALL(*(client()), OnReceiverPacketArrivals(_))
+      .WillOnce(SaveArg<0>(&parsed));
+  ASSERT_TRUE(parser()->Parse(packet, max_feedback_frame_id));
+  Mock::VerifyAndClearExpectations(client());
+
+  // The buffer is too small for all of the arrivals, so only the first N should
+  // have been included. The arrival times are lossy because of the wire format.
+  ASSERT_LT(0, static_cast<int>(parsed.size()));
+  ASSERT_GT(kArrivalCount, static_cast<int>(parsed.size()));
+  constexpr auto kMaxError = microseconds(20);
+  for (size_t i = 0; i < parsed.size(); ++i) {
+    EXPECT_EQ(arrivals[i].frame_id, parsed[i].frame_id);
+    EXPECT_EQ(arrivals[i].packet_id, parsed[i].packet_id);
+    EXPECT_NEAR(arrivals[i].arrival_time.time_since_epoch().count(),
+                parsed[i].arrival_time.time_since_epoch().count(),
+                Clock::to_duration(kMaxError).count());
+  }
+
+  // Build again, but this time the builder should not include the arrivals.
+  const auto second_send_time = send_time + milliseconds(500);
+  const auto second_packet = builder()->BuildPacket(second_send_time, buffer);
+  ASSERT_TRUE(second_packet.data());
+  EXPECT_CALL(*(client()), OnReceiverReferenceTimeAdvanced(
+                               ViaNtpTimestampTranslation(second_send_time)));
+  EXPECT_CALL(*(client()), OnReceiverCheckpoint(checkpoint, playout_delay));
+  EXPECT_CALL(*(client()), OnReceiverPacketArrivals(_)).Times(0);
+  ASSERT_TRUE(parser()->Parse(second_packet, max_feedback_frame_id));
+  Mock::VerifyAndClearExpectations(client());
+}
+
 }  // namespace
 }  // namespace cast
 }  // namespace openscreen
@@ -97,6 +97,7 @@ bool CompoundRtcpParser::Parse(absl::Span<const uint8_t> buffer,
   std::chrono::milliseconds target_playout_delay{};
   std::vector<FrameId> received_frames;
   std::vector<PacketNack> packet_nacks;
+  std::vector<PacketArrival> packet_arrivals;
   bool picture_loss_indicator = false;
 
   // The data contained in |buffer| can be a "compound packet," which means that
@@ -144,7 +145,9 @@ bool CompoundRtcpParser::Parse(absl::Span<const uint8_t> buffer,
         break;
 
       case RtcpPacketType::kExtendedReports:
-        if (!ParseExtendedReports(payload, &receiver_reference_time)) {
+        if (!ParseExtendedReports(payload, max_feedback_frame_id,
+                                  &receiver_reference_time,
+                                  &packet_arrivals)) {
           return false;
         }
         break;
@@ -179,6 +182,17 @@ bool CompoundRtcpParser::Parse(absl::Span<const uint8_t> buffer,
   if (receiver_report) {
     client_->OnReceiverReport(*receiver_report);
   }
+  // Packet arrival times are reported relative to the reference time, and so
+  // are meaningless without it. They are dispatched before the ACK/NACK
+  // feedback, since the Client may discard its send-time records for
+  // acknowledged frames.
+  if (receiver_reference_time != kNullTimePoint && !packet_arrivals.empty()) {
+    for (PacketArrival& arrival : packet_arrivals) {
+      arrival.arrival_time = receiver_reference_time +
+                             (arrival.arrival_time - Clock::time_point{});
+    }
+    client_->OnReceiverPacketArrivals(std::move(packet_arrivals));
+  }
   if (!checkpoint_frame_id.is_null()) {
     client_->OnReceiverCheckpoint(checkpoint_frame_id, target_playout_delay);
   }
@@ -311,7 +325,9 @@ bool CompoundRtcpParser::ParseFeedback(
 
 bool CompoundRtcpParser::ParseExtendedReports(
     absl::Span<const uint8_t> in,
-    Clock::time_point* receiver_reference_time) {
+    FrameId max_feedback_frame_id,
+    Clock::time_point* receiver_reference_time,
+    std::vector<PacketArrival>* packet_arrivals) {
   if (static_cast<int>(in.size()) < kRtcpExtendedReportHeaderSize) {
     return false;
   }
@@ -337,6 +353,25 @@ bool CompoundRtcpParser::ParseExtendedReports(
       }
       *receiver_reference_time = session_->ntp_converter().ToLocalTime(
           ReadBigEndian<uint64_t>(in.data()));
+    } else if (block_type == kRtcpPacketArrivalReportBlockType) {
+      if (block_data_size % kRtcpPacketArrivalReportEntrySize != 0) {
+        return false;
+      }
+      // Until the reference time is known, the arrival times are stored as
+      // negative offsets from the zero time_point.
+      packet_arrivals->clear();
+      absl::Span<const uint8_t> entries = in.subspan(0, block_data_size);
+      while (!entries.empty()) {
+        const FrameId frame_id = max_feedback_frame_id.ExpandLessThanOrEqual(
+            ConsumeField<uint8_t>(&entries));
+        entries.remove_prefix(sizeof(uint8_t));  // Skip the "reserved" byte.
+        const FramePacketId packet_id = ConsumeField<uint16_t>(&entries);
+        const RtcpReportBlock::Delay delay(ConsumeField<uint32_t>(&entries));
+        packet_arrivals->push_back(PacketArrival{
+            frame_id, packet_id,
+            Clock::time_point{} -
+                std::chrono::duration_cast<Clock::duration>(delay)});
+      }
     } else {
       // Ignore any other type of extended report.
     }
@@ -374,6 +409,8 @@ void CompoundRtcpParser::Client::OnReceiverHasFrames(
     std::vector<FrameId> acks) {}
 void CompoundRtcpParser::Client::OnReceiverIsMissingPackets(
     std::vector<PacketNack> nacks) {}
+void CompoundRtcpParser::Client::OnReceiverPacketArrivals(
+    std::vector<PacketArrival> arrivals) {}
 
 }  // namespace cast
 }  // namespace openscreen
@@ -70,6 +70,12 @@ class CompoundRtcpParser {
     // kAllPacketsLost indicates that all the packets are missing for a frame.
     // The argument's elements are in monotonically increasing order.
     virtual void OnReceiverIsMissingPackets(std::vector<PacketNack> nacks);
+
+    // Called to provide the times at which the Receiver received specific
+    // packets, according to the Receiver's clock translated into the local
+    // clock's timebase. This is called before any of the ACK/NACK callbacks for
+    // the same RTCP packet. The argument's elements are in order of arrival.
+    virtual void OnReceiverPacketArrivals(std::vector<PacketArrival> arrivals);
   };
 
   // |session| and |client| must be non-null and must outlive the
@@ -102,7 +108,9 @@ class CompoundRtcpParser {
                      std::vector<FrameId>* received_frames,
                      std::vector<PacketNack>* packet_nacks);
   bool ParseExtendedReports(absl::Span<const uint8_t> in,
-                            Clock::time_point* receiver_reference_time);
+                            FrameId max_feedback_frame_id,
+                            Clock::time_point* receiver_reference_time,
+                            std::vector<PacketArrival>* packet_arrivals);
   bool ParsePictureLossIndicator(absl::Span<const uint8_t> in,
                                  bool* picture_loss_indicator);
 
@@ -44,6 +44,10 @@ constexpr std::chrono::milliseconds kRtcpReportInterval(500);
 // logic can handle wrap around and compare two frame IDs meaningfully.
 constexpr int kMaxUnackedFrames = 120;
 
+// The smallest in-flight frame window a Sender or Receiver is configured with.
+// See ComputeMaxUnackedFrames() in session_config.h.
+constexpr int kMinUnackedFrames = 16;
+
 // The network must support a packet size of at least this many bytes.
 constexpr int kRequiredNetworkPacketSize = 256;
 
@@ -65,6 +69,11 @@ constexpr int kDefaultAudioSampleRate = 48000;
 // The default audio number of channels is set to stereo.
 constexpr int kDefaultAudioChannels = 2;
 
+// Audio frames typically span 10 to 20 ms of samples, so this is the highest
+// frame rate to assume for audio streams when sizing their in-flight windows
+// (see ComputeMaxUnackedFrames() in session_config.h).
+constexpr int kMaxAudioFrameRate = 100;
+
 // Codecs known and understood by cast senders and receivers. Note: receivers
 // are required to implement the following codecs to be Cast V2 compliant: H264,
 // VP8, AAC, Opus. Senders have to implement at least one codec for audio and
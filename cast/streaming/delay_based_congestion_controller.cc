@@ -0,0 +1,281 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/delay_based_congestion_controller.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "util/osp_logging.h"
+#include "util/saturate_cast.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// The number of delay samples used to fit the trend line.
+constexpr int kTrendWindowSize = 20;
+
+// Smoothing coefficient for the exponentially-weighted moving average of the
+// accumulated delay.
+constexpr double kDelaySmoothingCoefficient = 0.9;
+
+// The trend line's slope is scaled by the number of delay samples seen (up to
+// this limit) and a fixed gain before it is compared to the threshold. The
+// scaling makes the detector less sensitive while only a few samples are
+// available.
+constexpr int kMaxSamplesForTrendScaling = 60;
+constexpr double kTrendGain = 4.0;
+
+// The threshold (in scaled milliseconds) the trend must exceed to indicate
+// over-use, or fall below (when negated) to indicate under-use.
+constexpr double kTrendThreshold = 12.5;
+
+// How long the trend must remain above the threshold before over-use is
+// signalled. This prevents reacting to short-lived delay spikes.
+constexpr Clock::duration kOveruseTimeThreshold = std::chrono::milliseconds(10);
+
+// Rate control parameters: On over-use, the target is reduced to this fraction
+// of the measured throughput, but no more than once per interval (about one
+// round trip) to allow the effect of the prior decrease to be observed.
+// Otherwise, the target is grown by a fixed fraction per second.
+constexpr double kDecreaseFactor = 0.85;
+constexpr Clock::duration kMinDecreaseInterval = std::chrono::milliseconds(200);
+constexpr double kIncreaseFractionPerSecond = 0.08;
+
+// The target is not allowed to grow beyond this multiple of the measured
+// throughput.
+constexpr double kMaxTargetOverMeasured = 1.5;
+
+// A stream having no packets arrive for this long is forgotten, so that its
+// stale usage no longer affects the others' (e.g., after it was stopped).
+constexpr Clock::duration kStreamTimeout = std::chrono::seconds(1);
+
+double ToMilliseconds(Clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Returns the slope of the least-squares linear fit of the given (x, y)
+// |samples|, or |fallback| if the slope is undefined.
+double ComputeLinearFitSlope(
+    const std::deque<std::pair<double, double>>& samples,
+    double fallback) {
+  OSP_DCHECK(!samples.empty());
+  double sum_x = 0.0;
+  double sum_y = 0.0;
+  for (const auto& sample : samples) {
+    sum_x += sample.first;
+    sum_y += sample.second;
+  }
+  const double mean_x = sum_x / samples.size();
+  const double mean_y = sum_y / samples.size();
+
+  double numerator = 0.0;
+  double denominator = 0.0;
+  for (const auto& sample : samples) {
+    const double dx = sample.first - mean_x;
+    numerator += dx * (sample.second - mean_y);
+    denominator += dx * dx;
+  }
+  if (denominator == 0.0) {
+    return fallback;
+  }
+  return numerator / denominator;
+}
+
+}  // namespace
+
+DelayBasedCongestionController::DelayBasedCongestionController() = default;
+DelayBasedCongestionController::~DelayBasedCongestionController() = default;
+
+void DelayBasedCongestionController::OnPacketArrival(
+    Ssrc ssrc,
+    Clock::time_point send_time,
+    Clock::time_point arrival_time,
+    int measured_bitrate) {
+  OSP_DCHECK_GE(measured_bitrate, 0);
+
+  StreamState& stream = streams_[ssrc];
+  if (stream.current_group.is_valid()) {
+    if (send_time < stream.current_group.send_time) {
+      // Ignore reordered packets and re-transmits of older packets, since they
+      // would corrupt the inter-arrival measurements.
+      return;
+    }
+    if (send_time == stream.current_group.send_time) {
+      stream.current_group.last_arrival_time =
+          std::max(stream.current_group.last_arrival_time, arrival_time);
+      return;
+    }
+    OnGroupComplete(&stream, measured_bitrate);
+    stream.previous_group = stream.current_group;
+  }
+
+  stream.current_group.send_time = send_time;
+  stream.current_group.first_arrival_time = arrival_time;
+  stream.current_group.last_arrival_time = arrival_time;
+}
+
+void DelayBasedCongestionController::OnGroupComplete(StreamState* stream,
+                                                     int measured_bitrate) {
+  const PacketGroup& current = stream->current_group;
+  const PacketGroup& previous = stream->previous_group;
+  if (previous.is_valid()) {
+    const Clock::duration inter_departure_time =
+        current.send_time - previous.send_time;
+    const Clock::duration inter_arrival_time =
+        current.last_arrival_time - previous.last_arrival_time;
+    stream->usage =
+        UpdateTrend(stream, inter_arrival_time - inter_departure_time,
+                    inter_departure_time, current.last_arrival_time);
+  }
+  UpdateUsage(current.last_arrival_time);
+  UpdateTargetBitrate(current.send_time, measured_bitrate);
+}
+
+// static
+DelayBasedCongestionController::NetworkUsage
+DelayBasedCongestionController::UpdateTrend(
+    StreamState* stream,
+    Clock::duration delay_gradient,
+    Clock::duration inter_departure_time,
+    Clock::time_point arrival_time) {
+  if (stream->first_arrival_time == Clock::time_point::min()) {
+    stream->first_arrival_time = arrival_time;
+  }
+
+  // Accumulate and smooth the delay, and add the result to the trend window.
+  ++stream->num_gradients;
+  stream->accumulated_delay_ms += ToMilliseconds(delay_gradient);
+  stream->smoothed_delay_ms =
+      kDelaySmoothingCoefficient * stream->smoothed_delay_ms +
+      (1.0 - kDelaySmoothingCoefficient) * stream->accumulated_delay_ms;
+  std::deque<std::pair<double, double>>& samples = stream->trend_samples;
+  samples.emplace_back(
+      ToMilliseconds(arrival_time - stream->first_arrival_time),
+      stream->smoothed_delay_ms);
+  if (static_cast<int>(samples.size()) > kTrendWindowSize) {
+    samples.pop_front();
+  }
+  if (static_cast<int>(samples.size()) < kTrendWindowSize) {
+    return stream->usage;  // Not enough samples yet.
+  }
+
+  const double trend = ComputeLinearFitSlope(samples, stream->previous_trend);
+  const double scaled_trend =
+      std::min(stream->num_gradients, kMaxSamplesForTrendScaling) * trend *
+      kTrendGain;
+
+  NetworkUsage usage = stream->usage;
+  if (scaled_trend > kTrendThreshold) {
+    // Start the over-use timer at half the inter-departure time, since the
+    // trend could have crossed the threshold at any point since the last
+    // sample.
+    stream->time_overusing += (stream->overuse_count == 0)
+                                  ? (inter_departure_time / 2)
+                                  : inter_departure_time;
+    ++stream->overuse_count;
+    if (stream->time_overusing > kOveruseTimeThreshold &&
+        stream->overuse_count > 1 && trend >= stream->previous_trend) {
+      stream->time_overusing = Clock::duration::zero();
+      stream->overuse_count = 0;
+      usage = NetworkUsage::kOverusing;
+    }
+  } else {
+    stream->time_overusing = Clock::duration::zero();
+    stream->overuse_count = 0;
+    usage = (scaled_trend < -kTrendThreshold) ? NetworkUsage::kUnderusing
+                                              : NetworkUsage::kNormal;
+  }
+  stream->previous_trend = trend;
+  return usage;
+}
+
+void DelayBasedCongestionController::UpdateUsage(
+    Clock::time_point latest_arrival_time) {
+  // The streams share the path's queues: If any stream sees them growing, the
+  // path is over-used. Otherwise, if any sees them draining, hold steady.
+  usage_ = NetworkUsage::kNormal;
+  for (auto it = streams_.begin(); it != streams_.end();) {
+    const StreamState& stream = it->second;
+    if ((latest_arrival_time - stream.current_group.last_arrival_time) >
+        kStreamTimeout) {
+      it = streams_.erase(it);
+      continue;
+    }
+    if (stream.usage == NetworkUsage::kOverusing) {
+      usage_ = NetworkUsage::kOverusing;
+    } else if (stream.usage == NetworkUsage::kUnderusing &&
+               usage_ == NetworkUsage::kNormal) {
+      usage_ = NetworkUsage::kUnderusing;
+    }
+    ++it;
+  }
+}
+
+void DelayBasedCongestionController::UpdateTargetBitrate(
+    Clock::time_point now,
+    int measured_bitrate) {
+  if (target_bitrate_ == 0) {
+    if (measured_bitrate == 0) {
+      return;  // Nothing to start from yet.
+    }
+    target_bitrate_ = measured_bitrate;
+    last_rate_update_time_ = now;
+  }
+
+  switch (usage_) {
+    case NetworkUsage::kOverusing:
+      if (last_decrease_time_ == Clock::time_point::min() ||
+          (now - last_decrease_time_) >= kMinDecreaseInterval) {
+        const int base = (measured_bitrate > 0)
+                             ? std::min(target_bitrate_, measured_bitrate)
+                             : target_bitrate_;
+        target_bitrate_ = std::max(kMinTargetBitrate,
+                                   saturate_cast<int>(base * kDecreaseFactor));
+        last_decrease_time_ = now;
+      }
+      break;
+
+    case NetworkUsage::kUnderusing:
+      // Hold steady while the network queues drain.
+      break;
+
+    case NetworkUsage::kNormal: {
+      // The groups of different streams complete in send time order only
+      // approximately, so |now| might be slightly before the last update.
+      const double elapsed_seconds = std::max(
+          0.0, std::min(1.0, std::chrono::duration<double>(
+                                 now - last_rate_update_time_)
+                                 .count()));
+      double increased = target_bitrate_ * (1.0 + kIncreaseFractionPerSecond *
+                                                      elapsed_seconds);
+      if (measured_bitrate > 0) {
+        increased =
+            std::min(increased, measured_bitrate * kMaxTargetOverMeasured);
+        // Until the first over-use, there is no evidence of where the network's
+        // limit is. So, follow the measured throughput upwards, like a TCP
+        // "slow start."
+        if (last_decrease_time_ == Clock::time_point::min()) {
+          increased =
+              std::max(increased, static_cast<double>(measured_bitrate));
+        }
+      }
+      // Never decrease the target here, even if the measured throughput has
+      // dropped (e.g., because the media content became less complex).
+      target_bitrate_ =
+          std::max(target_bitrate_, saturate_cast<int>(increased));
+      break;
+    }
+  }
+
+  last_rate_update_time_ = std::max(last_rate_update_time_, now);
+}
+
+// static
+constexpr int DelayBasedCongestionController::kMinTargetBitrate;
+
+}  // namespace cast
+}  // namespace openscreen
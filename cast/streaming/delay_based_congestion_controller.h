@@ -0,0 +1,140 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_DELAY_BASED_CONGESTION_CONTROLLER_H_
+#define CAST_STREAMING_DELAY_BASED_CONGESTION_CONTROLLER_H_
+
+#include <deque>
+#include <map>
+#include <utility>
+
+#include "cast/streaming/ssrc.h"
+#include "platform/api/time.h"
+
+namespace openscreen {
+namespace cast {
+
+// Computes a target bitrate from the one-way queuing delay trend observed in
+// packet arrival times, so that congestion can be detected (and the bitrate
+// reduced) before the bottleneck link's queue overflows and packets are lost.
+//
+// Packets are grouped by send time: All packets sent in the same burst (see
+// SenderPacketRouter) form one group. For each pair of consecutive groups, the
+// "delay gradient" is the difference between the inter-arrival time and the
+// inter-departure time. Positive gradients mean a queue is building somewhere
+// along the network path. The accumulated gradients are smoothed, and a
+// least-squares trend line is fit over a recent window. The slope of that line
+// is compared against a threshold to classify the network as under-used,
+// normally-used, or over-used.
+//
+// The target bitrate is then controlled using AIMD (additive-increase,
+// multiplicative-decrease): It is decreased whenever over-use is detected, held
+// steady while the queues are draining (under-use), and otherwise slowly
+// increased. Until the first over-use, the target simply follows the measured
+// throughput provided by the caller upwards. It never strays far above the
+// measured throughput, since there is no evidence the network could sustain
+// more.
+//
+// Each RTP stream (e.g., the audio and video of one session) sharing the
+// network path is tracked separately, since the send times of one stream's
+// packets interleave with those of the others: Packet groups, delay gradients
+// and the trend line are all computed per SSRC. Because the streams share the
+// bottleneck queue, over-use seen in any one stream is over-use of the path.
+//
+// Only the differences between arrival times matter, so the offset between the
+// Sender's and Receiver's clocks is irrelevant. Clock drift between the two
+// will be interpreted as a (tiny) delay trend.
+class DelayBasedCongestionController {
+ public:
+  enum class NetworkUsage {
+    kUnderusing,
+    kNormal,
+    kOverusing,
+  };
+
+  DelayBasedCongestionController();
+  ~DelayBasedCongestionController();
+
+  NetworkUsage usage() const { return usage_; }
+
+  // Returns the current target bitrate, in bits per second, or 0 if not enough
+  // information has been provided to compute one.
+  int target_bitrate() const { return target_bitrate_; }
+
+  // Records that a packet of the stream identified by |ssrc|, sent at
+  // |send_time| (according to the Sender's clock), arrived at |arrival_time|
+  // (according to the Receiver's clock). This should be called in order of
+  // arrival. |measured_bitrate| is the current network throughput estimate, or
+  // 0 if not known.
+  void OnPacketArrival(Ssrc ssrc,
+                       Clock::time_point send_time,
+                       Clock::time_point arrival_time,
+                       int measured_bitrate);
+
+  // Below this bitrate, the target is never decreased further.
+  static constexpr int kMinTargetBitrate = 64000;
+
+ private:
+  // Tracks the departure and arrival times of one group of packets.
+  struct PacketGroup {
+    Clock::time_point send_time = Clock::time_point::min();
+    Clock::time_point first_arrival_time;
+    Clock::time_point last_arrival_time;
+
+    bool is_valid() const { return send_time != Clock::time_point::min(); }
+  };
+
+  // The packet grouping, trend estimation, and over-use detection state of one
+  // stream.
+  struct StreamState {
+    PacketGroup previous_group;
+    PacketGroup current_group;
+
+    // Trend line estimation state. The samples are (arrival time in ms since
+    // |first_arrival_time|, smoothed accumulated delay in ms) pairs.
+    Clock::time_point first_arrival_time = Clock::time_point::min();
+    int num_gradients = 0;
+    double accumulated_delay_ms = 0.0;
+    double smoothed_delay_ms = 0.0;
+    std::deque<std::pair<double, double>> trend_samples;
+    double previous_trend = 0.0;
+
+    // Over-use detection state.
+    Clock::duration time_overusing = Clock::duration::zero();
+    int overuse_count = 0;
+    NetworkUsage usage = NetworkUsage::kNormal;
+  };
+
+  // Called once no more packets will be added to the |stream|'s current group.
+  void OnGroupComplete(StreamState* stream, int measured_bitrate);
+
+  // Updates the |stream|'s trend line with the latest delay gradient, and
+  // returns the newly-computed network usage for that stream.
+  static NetworkUsage UpdateTrend(StreamState* stream,
+                                  Clock::duration delay_gradient,
+                                  Clock::duration inter_departure_time,
+                                  Clock::time_point arrival_time);
+
+  // Combines the usage of each stream that has recently had packets arrive
+  // into |usage_|, discarding the state of streams that have gone quiet.
+  void UpdateUsage(Clock::time_point latest_arrival_time);
+
+  // Adjusts the |target_bitrate_| based on the |usage_|.
+  void UpdateTargetBitrate(Clock::time_point now, int measured_bitrate);
+
+  std::map<Ssrc, StreamState> streams_;
+
+  // The combined usage of all streams.
+  NetworkUsage usage_ = NetworkUsage::kNormal;
+
+  // Rate control state.
+  int target_bitrate_ = 0;
+  Clock::time_point last_rate_update_time_ = Clock::time_point::min();
+  Clock::time_point last_decrease_time_ = Clock::time_point::min();
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_DELAY_BASED_CONGESTION_CONTROLLER_H_
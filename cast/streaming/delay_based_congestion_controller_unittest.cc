@@ -0,0 +1,265 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/delay_based_congestion_controller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "gtest/gtest.h"
+#include "platform/api/time.h"
+#include "util/chrono_helpers.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using NetworkUsage = DelayBasedCongestionController::NetworkUsage;
+
+// Use a fake, fixed start time.
+constexpr Clock::time_point kStartTime =
+    Clock::time_point() + Clock::duration(1234567890);
+
+constexpr Ssrc kAudioSsrc = 1;
+constexpr Ssrc kVideoSsrc = 2;
+
+// Matches the burst interval of SenderPacketRouter.
+constexpr Clock::duration kBurstInterval = milliseconds(10);
+
+constexpr int kPacketSize = 1200;
+constexpr int kLinkCapacity = 4000000;  // 4 Mbps.
+constexpr Clock::duration kPropagationDelay = milliseconds(20);
+constexpr Clock::duration kMaxQueueDelay = milliseconds(250);
+
+// Models a network path with a bottleneck link of fixed capacity, having a
+// drop-tail FIFO queue in front of it.
+class BottleneckLink {
+ public:
+  // Returns the time the packet arrives at the Receiver, or nullopt if the
+  // packet was dropped because the queue was full.
+  absl::optional<Clock::time_point> Transmit(Clock::time_point send_time) {
+    const Clock::time_point start = std::max(send_time, link_free_time_);
+    if ((start - send_time) > kMaxQueueDelay) {
+      return absl::nullopt;
+    }
+    link_free_time_ = start + std::chrono::duration_cast<Clock::duration>(
+                                  seconds(kPacketSize * CHAR_BIT)) /
+                                  kLinkCapacity;
+    return link_free_time_ + kPropagationDelay;
+  }
+
+  Clock::duration GetQueueDelay(Clock::time_point now) const {
+    return std::max(Clock::duration::zero(), link_free_time_ - now);
+  }
+
+ private:
+  Clock::time_point link_free_time_ = Clock::time_point::min();
+};
+
+// Drives a DelayBasedCongestionController with packets sent through a
+// BottleneckLink, one burst every kBurstInterval.
+class Simulation {
+ public:
+  // Sends one burst of packets at the given |send_rate|, and returns the number
+  // of packets that were dropped.
+  int SendBurst(int send_rate) {
+    const int bytes =
+        static_cast<int>(static_cast<int64_t>(send_rate) *
+                         to_microseconds(kBurstInterval).count() /
+                         (CHAR_BIT * 1000000));
+    const int num_packets = std::max(1, bytes / kPacketSize);
+    // The throughput a BandwidthEstimator would measure: The rate at which
+    // bytes are being successfully delivered.
+    const int measured_bitrate = std::min(send_rate, kLinkCapacity);
+    int num_dropped = 0;
+    for (int i = 0; i < num_packets; ++i) {
+      const absl::optional<Clock::time_point> arrival_time =
+          link_.Transmit(now_);
+      if (arrival_time) {
+        controller_.OnPacketArrival(kVideoSsrc, now_, *arrival_time,
+                                    measured_bitrate);
+      } else {
+        ++num_dropped;
+      }
+    }
+    now_ += kBurstInterval;
+    return num_dropped;
+  }
+
+  DelayBasedCongestionController* controller() { return &controller_; }
+  const BottleneckLink& link() const { return link_; }
+  Clock::time_point now() const { return now_; }
+
+ private:
+  DelayBasedCongestionController controller_;
+  BottleneckLink link_;
+  Clock::time_point now_ = kStartTime;
+};
+
+TEST(DelayBasedCongestionControllerTest, HasNoTargetWithoutMeasuredBitrate) {
+  DelayBasedCongestionController controller;
+  Clock::time_point now = kStartTime;
+  for (int i = 0; i < 100; ++i) {
+    controller.OnPacketArrival(kVideoSsrc, now, now + kPropagationDelay, 0);
+    now += kBurstInterval;
+  }
+  EXPECT_EQ(0, controller.target_bitrate());
+  EXPECT_EQ(NetworkUsage::kNormal, controller.usage());
+}
+
+// Tests that sending below the link capacity is detected as normal usage, and
+// that the target bitrate is allowed to grow beyond the send rate.
+TEST(DelayBasedCongestionControllerTest, IncreasesTargetWhileUnderCapacity) {
+  constexpr int kSendRate = kLinkCapacity * 8 / 10;
+  Simulation sim;
+  for (int i = 0; i < 500; ++i) {
+    ASSERT_EQ(0, sim.SendBurst(kSendRate));
+    ASSERT_NE(NetworkUsage::kOverusing, sim.controller()->usage());
+  }
+  EXPECT_GT(sim.controller()->target_bitrate(), kSendRate);
+}
+
+// Tests that sending above the link capacity is detected from the growing
+// queuing delay, long before the queue overflows and packets are lost. A
+// throughput-only estimate cannot detect this: Until packets are dropped, the
+// full link capacity is being successfully used.
+TEST(DelayBasedCongestionControllerTest, DetectsOveruseBeforePacketLoss) {
+  constexpr int kSendRate = kLinkCapacity * 5 / 4;
+  Simulation sim;
+  int num_bursts = 0;
+  while (sim.controller()->usage() != NetworkUsage::kOverusing) {
+    ASSERT_EQ(0, sim.SendBurst(kSendRate)) << "Packets dropped before overuse";
+    ASSERT_LT(++num_bursts, 1000);
+  }
+  EXPECT_LT(sim.link().GetQueueDelay(sim.now()), kMaxQueueDelay / 2);
+  EXPECT_LT(sim.controller()->target_bitrate(), kLinkCapacity);
+}
+
+// Simulates a Sender that always sends at the target bitrate, and tests that
+// the feedback loop converges near the link capacity without building up a
+// queue long enough to cause packet loss.
+TEST(DelayBasedCongestionControllerTest, ConvergesNearCapacityWithoutLoss) {
+  constexpr Clock::duration kWarmUpTime = seconds(3);
+  constexpr Clock::duration kSimulationTime = seconds(30);
+
+  Simulation sim;
+  int send_rate = kLinkCapacity * 2;
+  int num_dropped = 0;
+  int64_t total_sent_bits = 0;
+  Clock::duration max_queue_delay = Clock::duration::zero();
+  while (sim.now() < kStartTime + kSimulationTime) {
+    const bool warmed_up = sim.now() >= kStartTime + kWarmUpTime;
+    const int dropped = sim.SendBurst(send_rate);
+    if (warmed_up) {
+      num_dropped += dropped;
+      total_sent_bits += static_cast<int64_t>(send_rate) *
+                         to_microseconds(kBurstInterval).count() / 1000000;
+      max_queue_delay =
+          std::max(max_queue_delay, sim.link().GetQueueDelay(sim.now()));
+    }
+    if (sim.controller()->target_bitrate() > 0) {
+      send_rate = sim.controller()->target_bitrate();
+    }
+  }
+
+  EXPECT_EQ(0, num_dropped);
+  EXPECT_LT(max_queue_delay, kMaxQueueDelay / 2);
+  const int average_send_rate = static_cast<int>(
+      total_sent_bits / to_seconds(kSimulationTime - kWarmUpTime).count());
+  EXPECT_GT(average_send_rate, kLinkCapacity * 7 / 10);
+  EXPECT_LT(average_send_rate, kLinkCapacity * 11 / 10);
+}
+
+// Tests that packets sent before the most-recent group (e.g., re-transmits or
+// network reordering) do not affect the delay trend.
+TEST(DelayBasedCongestionControllerTest, IgnoresOutOfOrderSendTimes) {
+  DelayBasedCongestionController controller;
+  Clock::time_point now = kStartTime;
+  for (int i = 0; i < 100; ++i) {
+    controller.OnPacketArrival(kVideoSsrc, now, now + kPropagationDelay,
+                               kLinkCapacity);
+    // A stale packet, sent long ago, arrives with a huge apparent delay.
+    controller.OnPacketArrival(kVideoSsrc, now - seconds(1),
+                               now + kPropagationDelay, kLinkCapacity);
+    now += kBurstInterval;
+  }
+  EXPECT_EQ(NetworkUsage::kNormal, controller.usage());
+  EXPECT_GE(controller.target_bitrate(), kLinkCapacity);
+}
+
+// Tests that the arrivals of two streams sharing the path, whose send times
+// interleave, are each used to detect congestion. The Sender learns of each
+// stream's arrivals from that stream's own RTCP reports, which arrive at
+// different times. So, a batch of one stream's arrivals routinely includes
+// packets sent before the latest packet of the other stream.
+TEST(DelayBasedCongestionControllerTest, TracksInterleavedStreamsSeparately) {
+  constexpr int kAudioPacketsPerBurst = 1;
+  constexpr int kVideoReportInterval = 5;  // In bursts.
+
+  const auto run = [](int video_send_rate, int* num_dropped) {
+    DelayBasedCongestionController controller;
+    BottleneckLink link;
+    std::vector<std::pair<Clock::time_point, Clock::time_point>>
+        unreported_video_arrivals;
+    const int video_packets_per_burst = std::max(
+        1, static_cast<int>(static_cast<int64_t>(video_send_rate) *
+                            to_microseconds(kBurstInterval).count() /
+                            (CHAR_BIT * 1000000) / kPacketSize));
+    const int measured_bitrate = std::min(video_send_rate, kLinkCapacity);
+    Clock::time_point now = kStartTime;
+    *num_dropped = 0;
+    for (int burst = 0; burst < 500; ++burst) {
+      // Audio is sent first in each burst, and is reported right away.
+      for (int i = 0; i < kAudioPacketsPerBurst; ++i) {
+        const absl::optional<Clock::time_point> arrival_time =
+            link.Transmit(now);
+        if (arrival_time) {
+          controller.OnPacketArrival(kAudioSsrc, now, *arrival_time,
+                                     measured_bitrate);
+        } else {
+          ++*num_dropped;
+        }
+      }
+      for (int i = 0; i < video_packets_per_burst; ++i) {
+        const absl::optional<Clock::time_point> arrival_time =
+            link.Transmit(now);
+        if (arrival_time) {
+          unreported_video_arrivals.emplace_back(now, *arrival_time);
+        } else {
+          ++*num_dropped;
+        }
+      }
+      // Video is reported less often, so its batches lag behind the audio.
+      if (burst % kVideoReportInterval == kVideoReportInterval - 1) {
+        for (const auto& arrival : unreported_video_arrivals) {
+          controller.OnPacketArrival(kVideoSsrc, arrival.first, arrival.second,
+                                     measured_bitrate);
+        }
+        unreported_video_arrivals.clear();
+      }
+      if (controller.usage() == NetworkUsage::kOverusing) {
+        break;
+      }
+      now += kBurstInterval;
+    }
+    return std::make_pair(controller.usage(), link.GetQueueDelay(now));
+  };
+
+  int num_dropped = 0;
+  EXPECT_EQ(NetworkUsage::kNormal,
+            run(kLinkCapacity * 7 / 10, &num_dropped).first);
+  EXPECT_EQ(0, num_dropped);
+
+  const auto result = run(kLinkCapacity * 5 / 4, &num_dropped);
+  EXPECT_EQ(NetworkUsage::kOverusing, result.first);
+  EXPECT_EQ(0, num_dropped);
+  EXPECT_LT(result.second, kMaxQueueDelay / 2);
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
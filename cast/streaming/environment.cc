@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <utility>
 
+#include "cast/streaming/constants.h"
 #include "cast/streaming/rtp_defines.h"
 #include "platform/api/task_runner.h"
 #include "util/osp_logging.h"
@@ -17,11 +18,21 @@ namespace cast {
 Environment::Environment(ClockNowFunctionPtr now_function,
                          TaskRunner* task_runner,
                          const IPEndpoint& local_endpoint)
+    : Environment(now_function,
+                  task_runner,
+                  local_endpoint,
+                  &UdpSocket::Create) {}
+
+Environment::Environment(ClockNowFunctionPtr now_function,
+                         TaskRunner* task_runner,
+                         const IPEndpoint& local_endpoint,
+                         const SocketFactory& socket_factory)
     : now_function_(now_function), task_runner_(task_runner) {
   OSP_DCHECK(now_function_);
   OSP_DCHECK(task_runner_);
+  OSP_DCHECK(socket_factory);
   ErrorOr<std::unique_ptr<UdpSocket>> result =
-      UdpSocket::Create(task_runner_, this, local_endpoint);
+      socket_factory(task_runner_, this, local_endpoint);
   if (result.is_error()) {
     OSP_LOG_ERROR << "Unable to create a UDP socket bound to " << local_endpoint
                   << ": " << result.error();
@@ -56,10 +67,14 @@ void Environment::DropIncomingPackets() {
 }
 
 int Environment::GetMaxPacketSize() const {
+  if (probed_max_packet_size_ > 0) {
+    return probed_max_packet_size_;
+  }
+
   // Return hard-coded values for UDP over wired Ethernet (which is a smaller
-  // MTU than typical defaults for UDP over 802.11 wireless). Performance would
-  // be more-optimized if the network were probed for the actual value. See
-  // discussion in rtp_defines.h.
+  // MTU than typical defaults for UDP over 802.11 wireless). Performance is
+  // more-optimized if the network is probed for the actual value, via
+  // ProbePathMtu(). See discussion in rtp_defines.h.
   switch (remote_endpoint_.address.version()) {
     case IPAddress::Version::kV4:
       return kMaxRtpPacketSizeForIpv4UdpOnEthernet;
@@ -70,6 +85,34 @@ int Environment::GetMaxPacketSize() const {
   }
 }
 
+int Environment::ProbePathMtu(const IPAddress& remote_address) {
+  if (socket_) {
+    const ErrorOr<int> path_mtu = socket_->GetPathMtu(remote_address);
+    if (path_mtu.is_value()) {
+      probed_max_packet_size_ =
+          ComputeMaxPacketSize(path_mtu.value(), remote_address.version());
+      OSP_VLOG << "Path MTU to " << remote_address << " is "
+               << path_mtu.value() << " bytes; using RTP packets of up to "
+               << probed_max_packet_size_ << " bytes.";
+    } else {
+      OSP_VLOG << "Unable to probe the path MTU to " << remote_address << ": "
+               << path_mtu.error();
+    }
+  }
+  return GetMaxPacketSize();
+}
+
+// static
+int Environment::ComputeMaxPacketSize(int path_mtu,
+                                      IPAddress::Version version) {
+  const int headers_size =
+      ((version == IPAddress::Version::kV4) ? kIpv4HeaderSize
+                                            : kIpv6HeaderSize) +
+      kUdpHeaderSize;
+  return std::max(kRequiredNetworkPacketSize,
+                  std::min(path_mtu, kMaxJumboFrameMtu) - headers_size);
+}
+
 void Environment::SendPacket(absl::Span<const uint8_t> packet) {
   OSP_DCHECK(remote_endpoint_.address);
   OSP_DCHECK_NE(remote_endpoint_.port, 0);
@@ -71,6 +71,21 @@ class Environment : public UdpSocket::Client {
               TaskRunner* task_runner,
               const IPEndpoint& local_endpoint = IPEndpoint::kAnyV6());
 
+  // Creates the internally-owned UdpSocket. Has the same signature as
+  // UdpSocket::Create().
+  using SocketFactory = std::function<ErrorOr<std::unique_ptr<UdpSocket>>(
+      TaskRunner*,
+      UdpSocket::Client*,
+      const IPEndpoint&)>;
+
+  // Like the above, but uses the given |socket_factory| to create the socket.
+  // This allows the socket to be decorated, for example to simulate network
+  // impairments for testing and benchmarking.
+  Environment(ClockNowFunctionPtr now_function,
+              TaskRunner* task_runner,
+              const IPEndpoint& local_endpoint,
+              const SocketFactory& socket_factory);
+
   ~Environment() override;
 
   ClockNowFunctionPtr now_function() const { return now_function_; }
@@ -111,9 +126,25 @@ class Environment : public UdpSocket::Client {
   void DropIncomingPackets();
 
   // Returns the maximum packet size for the network. This will always return a
-  // value of at least kRequiredNetworkPacketSize.
+  // value of at least kRequiredNetworkPacketSize. Unless the path MTU has been
+  // probed, this assumes UDP over standard Ethernet.
   int GetMaxPacketSize() const;
 
+  // Optionally called to query the platform for the path MTU to the given
+  // |remote_address| (see UdpSocket::GetPathMtu()). On success, the value
+  // returned by GetMaxPacketSize() is computed from it instead, allowing larger
+  // packets on jumbo-frame LANs and avoiding IP fragmentation on links with a
+  // smaller MTU (e.g., VPNs and tunnels). On failure, the defaults remain in
+  // effect. Because the SenderPacketRouter, Senders, and Receivers size their
+  // buffers and packets when they are constructed, this should be called
+  // before creating them. Returns the resulting maximum packet size.
+  int ProbePathMtu(const IPAddress& remote_address);
+
+  // Returns the maximum RTP/RTCP packet size for the given |path_mtu|,
+  // accounting for the IP and UDP headers, and clamped to the range
+  // [kRequiredNetworkPacketSize, the size for a kMaxJumboFrameMtu].
+  static int ComputeMaxPacketSize(int path_mtu, IPAddress::Version version);
+
   // Sends the given |packet| to the remote endpoint, best-effort.
   // set_remote_endpoint() must be called beforehand with a valid IPEndpoint.
   //
@@ -145,6 +176,10 @@ class Environment : public UdpSocket::Client {
   IPEndpoint remote_endpoint_{};
   PacketConsumer* packet_consumer_ = nullptr;
   SocketState state_ = SocketState::kStarting;
+
+  // The maximum packet size computed by ProbePathMtu(), or zero to use the
+  // defaults.
+  int probed_max_packet_size_ = 0;
   SocketSubscriber* socket_subscriber_ = nullptr;
 };
 
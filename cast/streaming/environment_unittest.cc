@@ -0,0 +1,108 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/environment.h"
+
+#include <memory>
+#include <utility>
+
+#include "cast/streaming/constants.h"
+#include "cast/streaming/rtp_defines.h"
+#include "gtest/gtest.h"
+#include "platform/test/fake_clock.h"
+#include "platform/test/fake_task_runner.h"
+#include "platform/test/fake_udp_socket.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using IPVersion = IPAddress::Version;
+
+TEST(EnvironmentTest, ComputesMaxPacketSizeFromPathMtu) {
+  // Standard Ethernet.
+  EXPECT_EQ(kMaxRtpPacketSizeForIpv4UdpOnEthernet,
+            Environment::ComputeMaxPacketSize(1500, IPVersion::kV4));
+  EXPECT_EQ(kMaxRtpPacketSizeForIpv6UdpOnEthernet,
+            Environment::ComputeMaxPacketSize(1500, IPVersion::kV6));
+
+  // A VPN or tunnel link with a smaller MTU.
+  EXPECT_EQ(1400 - 20 - 8,
+            Environment::ComputeMaxPacketSize(1400, IPVersion::kV4));
+
+  // Jumbo frames, and larger MTUs (e.g., loopback), which are capped.
+  EXPECT_EQ(9000 - 40 - 8,
+            Environment::ComputeMaxPacketSize(9000, IPVersion::kV6));
+  EXPECT_EQ(9000 - 20 - 8,
+            Environment::ComputeMaxPacketSize(65536, IPVersion::kV4));
+
+  // Never less than the required packet size.
+  EXPECT_EQ(kRequiredNetworkPacketSize,
+            Environment::ComputeMaxPacketSize(68, IPVersion::kV4));
+}
+
+// Creates an Environment on a FakeUdpSocket whose GetPathMtu() returns
+// |path_mtu| (or fails, if zero).
+class EnvironmentWithFakeSocket {
+ public:
+  explicit EnvironmentWithFakeSocket(int path_mtu)
+      : clock_(Clock::now()),
+        task_runner_(&clock_),
+        environment_(
+            &FakeClock::now,
+            &task_runner_,
+            IPEndpoint{},
+            [path_mtu](TaskRunner* task_runner, UdpSocket::Client* client,
+                       const IPEndpoint& local_endpoint)
+                -> ErrorOr<std::unique_ptr<UdpSocket>> {
+              auto socket =
+                  std::make_unique<FakeUdpSocket>(task_runner, client);
+              socket->EnqueueBindResult(Error::None());
+              socket->set_path_mtu(path_mtu);
+              return std::unique_ptr<UdpSocket>(std::move(socket));
+            }) {}
+
+  Environment* get() { return &environment_; }
+
+ private:
+  FakeClock clock_;
+  FakeTaskRunner task_runner_;
+  Environment environment_;
+};
+
+// Tests that a successful probe changes the maximum packet size, both for links
+// with a smaller MTU and for jumbo-frame LANs.
+TEST(EnvironmentTest, UsesProbedPathMtu) {
+  {
+    EnvironmentWithFakeSocket vpn(1400);
+    EXPECT_EQ(kMaxRtpPacketSizeForIpv4UdpOnEthernet,
+              vpn.get()->GetMaxPacketSize());
+    EXPECT_EQ(1400 - 20 - 8,
+              vpn.get()->ProbePathMtu(IPAddress(192, 168, 1, 2)));
+    EXPECT_EQ(1400 - 20 - 8, vpn.get()->GetMaxPacketSize());
+  }
+
+  {
+    EnvironmentWithFakeSocket jumbo(9000);
+    EXPECT_EQ(9000 - 20 - 8,
+              jumbo.get()->ProbePathMtu(IPAddress(192, 168, 1, 2)));
+    EXPECT_EQ(9000 - 20 - 8, jumbo.get()->GetMaxPacketSize());
+  }
+}
+
+// Tests that the conservative defaults remain in effect when the path MTU
+// cannot be probed.
+TEST(EnvironmentTest, FallsBackToEthernetDefaultsIfProbingFails) {
+  EnvironmentWithFakeSocket environment(0);
+  environment.get()->set_remote_endpoint(
+      IPEndpoint{IPAddress(192, 168, 1, 2), 2344});
+  EXPECT_EQ(kMaxRtpPacketSizeForIpv4UdpOnEthernet,
+            environment.get()->ProbePathMtu(IPAddress(192, 168, 1, 2)));
+  EXPECT_EQ(kMaxRtpPacketSizeForIpv4UdpOnEthernet,
+            environment.get()->GetMaxPacketSize());
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
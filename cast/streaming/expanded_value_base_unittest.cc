@@ -4,6 +4,7 @@
 
 #include "cast/streaming/expanded_value_base.h"
 
+#include "cast/streaming/constants.h"
 #include "gtest/gtest.h"
 
 namespace openscreen {
@@ -104,5 +105,36 @@ TEST(ExpandedValueBaseTest, TruncationAndExpansion) {
   }
 }
 
+// Tests that 8-bit truncated values, such as the FrameIds in RTP and RTCP
+// packets, are always re-expanded correctly for every span of values up to
+// kMaxUnackedFrames, including spans that wrap around the 8-bit range several
+// times. The Sender expands the Receiver's checkpoint and ACKs relative to its
+// own checkpoint, and the Receiver expands RTP FrameIds relative to the latest
+// frame it expects.
+TEST(ExpandedValueBaseTest, ExpandsAllValuesWithinInFlightWindow) {
+  static_assert(kMaxUnackedFrames <=
+                    TestValue::max_distance_for_expansion<uint8_t>(),
+                "kMaxUnackedFrames must allow unambiguous 8-bit expansion");
+
+  for (int64_t checkpoint = -300; checkpoint <= 300; ++checkpoint) {
+    const TestValue oldest(checkpoint);
+    const TestValue latest(checkpoint + kMaxUnackedFrames);
+    for (int64_t i = 0; i <= kMaxUnackedFrames; ++i) {
+      const TestValue original_value(checkpoint + i);
+      const uint8_t truncated = original_value.lower_8_bits();
+      ASSERT_EQ(original_value, latest.ExpandLessThanOrEqual(truncated))
+          << "checkpoint=" << checkpoint << ", i=" << i;
+      ASSERT_EQ(original_value, oldest.Expand(truncated))
+          << "checkpoint=" << checkpoint << ", i=" << i;
+      ASSERT_EQ(original_value, latest.Expand(truncated))
+          << "checkpoint=" << checkpoint << ", i=" << i;
+      if (i > 0) {
+        ASSERT_EQ(original_value, oldest.ExpandGreaterThan(truncated))
+            << "checkpoint=" << checkpoint << ", i=" << i;
+      }
+    }
+  }
+}
+
 }  // namespace cast
 }  // namespace openscreen
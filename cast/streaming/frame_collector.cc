@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <limits>
 #include <numeric>
+#include <utility>
 
 #include "cast/streaming/frame_id.h"
 #include "cast/streaming/rtp_defines.h"
@@ -31,36 +32,14 @@ bool FrameCollector::CollectRtpPacket(const RtpPacketParser::ParseResult& part,
                                       std::vector<uint8_t>* buffer) {
   OSP_DCHECK(!frame_.frame_id.is_null());
 
-  if (part.frame_id != frame_.frame_id) {
-    OSP_LOG_WARN
-        << "Ignoring potentially corrupt packet (frame ID mismatch). Expected: "
-        << frame_.frame_id << " Got: " << part.frame_id;
+  if (!ValidatePart(part)) {
     return false;
   }
 
-  const int frame_packet_count = static_cast<int>(part.max_packet_id) + 1;
-  if (num_missing_packets_ == kUnknownNumberOfPackets) {
-    // This is the first packet being processed for the frame.
-    num_missing_packets_ = frame_packet_count;
-    chunks_.resize(num_missing_packets_);
-  } else {
-    // Since this is not the first packet being processed, sanity-check that the
-    // "frame ID" and "max packet ID" are the expected values.
-    if (frame_packet_count != static_cast<int>(chunks_.size())) {
-      OSP_LOG_WARN << "Ignoring potentially corrupt packet (packet count "
-                      "mismatch). packet_count="
-                   << chunks_.size() << " is not equal to 1 + max_packet_id="
-                   << part.max_packet_id;
-      return false;
-    }
-  }
-
-  // The packet ID must not be greater than the max packet ID.
-  if (part.packet_id >= chunks_.size()) {
-    OSP_LOG_WARN
-        << "Ignoring potentially corrupt packet having invalid packet ID "
-        << part.packet_id << " (should be less than " << chunks_.size() << ").";
-    return false;
+  if (part.fec_protected_packet_count > 0) {
+    CollectFecPacket(part, buffer);
+    RecoverFromFecPackets();
+    return true;
   }
 
   // Don't process duplicate packets.
@@ -73,16 +52,7 @@ bool FrameCollector::CollectRtpPacket(const RtpPacketParser::ParseResult& part,
   // Populate metadata from packet 0 only, which is the only packet that must
   // contain a complete set of values.
   if (part.packet_id == FramePacketId{0}) {
-    if (part.is_key_frame) {
-      frame_.dependency = EncodedFrame::KEY_FRAME;
-    } else if (part.frame_id == part.referenced_frame_id) {
-      frame_.dependency = EncodedFrame::INDEPENDENTLY_DECODABLE;
-    } else {
-      frame_.dependency = EncodedFrame::DEPENDS_ON_ANOTHER;
-    }
-    frame_.referenced_frame_id = part.referenced_frame_id;
-    frame_.rtp_timestamp = part.rtp_timestamp;
-    frame_.new_playout_delay = part.new_playout_delay;
+    ApplyFirstPacketMetadata(part);
   }
 
   // Take ownership of the contents of the |buffer| (no copy!), and record the
@@ -98,6 +68,10 @@ bool FrameCollector::CollectRtpPacket(const RtpPacketParser::ParseResult& part,
   // Success!
   --num_missing_packets_;
   OSP_DCHECK_GE(num_missing_packets_, 0);
+
+  if (!fec_chunks_.empty()) {
+    RecoverFromFecPackets();
+  }
   return true;
 }
 
@@ -151,10 +125,154 @@ void FrameCollector::Reset() {
   frame_.owned_data_.shrink_to_fit();
   frame_.data = absl::Span<uint8_t>();
   chunks_.clear();
+  fec_chunks_.clear();
+}
+
+bool FrameCollector::ValidatePart(const RtpPacketParser::ParseResult& part) {
+  if (part.frame_id != frame_.frame_id) {
+    OSP_LOG_WARN
+        << "Ignoring potentially corrupt packet (frame ID mismatch). Expected: "
+        << frame_.frame_id << " Got: " << part.frame_id;
+    return false;
+  }
+
+  const int frame_packet_count = static_cast<int>(part.max_packet_id) + 1;
+  if (num_missing_packets_ == kUnknownNumberOfPackets) {
+    // This is the first packet being processed for the frame.
+    num_missing_packets_ = frame_packet_count;
+    chunks_.resize(num_missing_packets_);
+  } else {
+    // Since this is not the first packet being processed, sanity-check that the
+    // "frame ID" and "max packet ID" are the expected values.
+    if (frame_packet_count != static_cast<int>(chunks_.size())) {
+      OSP_LOG_WARN << "Ignoring potentially corrupt packet (packet count "
+                      "mismatch). packet_count="
+                   << chunks_.size() << " is not equal to 1 + max_packet_id="
+                   << part.max_packet_id;
+      return false;
+    }
+  }
+
+  // The packet ID must not be greater than the max packet ID.
+  if (part.packet_id >= chunks_.size()) {
+    OSP_LOG_WARN
+        << "Ignoring potentially corrupt packet having invalid packet ID "
+        << part.packet_id << " (should be less than " << chunks_.size() << ").";
+    return false;
+  }
+
+  return true;
+}
+
+void FrameCollector::ApplyFirstPacketMetadata(
+    const RtpPacketParser::ParseResult& part) {
+  if (part.is_key_frame) {
+    frame_.dependency = EncodedFrame::KEY_FRAME;
+  } else if (part.frame_id == part.referenced_frame_id) {
+    frame_.dependency = EncodedFrame::INDEPENDENTLY_DECODABLE;
+  } else {
+    frame_.dependency = EncodedFrame::DEPENDS_ON_ANOTHER;
+  }
+  frame_.referenced_frame_id = part.referenced_frame_id;
+  frame_.rtp_timestamp = part.rtp_timestamp;
+  frame_.new_playout_delay = part.new_playout_delay;
+}
+
+void FrameCollector::CollectFecPacket(const RtpPacketParser::ParseResult& part,
+                                      std::vector<uint8_t>* buffer) {
+  // Ignore duplicates, and FEC packets for groups that are already complete.
+  for (const FecChunk& fec_chunk : fec_chunks_) {
+    if (fec_chunk.part.packet_id == part.packet_id) {
+      return;
+    }
+  }
+
+  FecChunk fec_chunk;
+  fec_chunk.buffer.swap(*buffer);
+  fec_chunk.part = part;
+  OSP_DCHECK_GE(fec_chunk.part.payload.data(), fec_chunk.buffer.data());
+  OSP_DCHECK_LE(fec_chunk.part.payload.data() + fec_chunk.part.payload.size(),
+                fec_chunk.buffer.data() + fec_chunk.buffer.size());
+  fec_chunks_.push_back(std::move(fec_chunk));
+}
+
+void FrameCollector::RecoverFromFecPackets() {
+  for (auto it = fec_chunks_.begin(); it != fec_chunks_.end();) {
+    const RtpPacketParser::ParseResult& fec_part = it->part;
+    const int first = fec_part.packet_id;
+    const int end = first + fec_part.fec_protected_packet_count;
+    OSP_DCHECK_LE(end, static_cast<int>(chunks_.size()));
+
+    int missing_packet_id = -1;
+    int num_missing = 0;
+    for (int i = first; i < end; ++i) {
+      if (!chunks_[i].has_data()) {
+        missing_packet_id = i;
+        ++num_missing;
+      }
+    }
+    if (num_missing > 1) {
+      ++it;  // Not recoverable yet. Keep the FEC packet around.
+      continue;
+    }
+
+    if (num_missing == 1) {
+      // The missing payload's size is the XOR of all the other sizes, and its
+      // data is the XOR of the parity payload with all the other payloads.
+      size_t size = fec_part.fec_payload_size_xor;
+      for (int i = first; i < end; ++i) {
+        if (i != missing_packet_id) {
+          size ^= chunks_[i].payload.size();
+        }
+      }
+      if (size > fec_part.payload.size()) {
+        OSP_LOG_WARN << "Ignoring corrupt FEC packet for packet IDs [" << first
+                     << ',' << end << ").";
+        it = fec_chunks_.erase(it);
+        continue;
+      }
+      std::vector<uint8_t> recovered(fec_part.payload.begin(),
+                                     fec_part.payload.begin() + size);
+      // Note: Always allocate at least one byte, so that zero-length payloads
+      // still have a non-null data pointer (see PayloadChunk::has_data()).
+      // The FEC packet's payload may itself be empty, so this must not read
+      // past its end.
+      recovered.resize(std::max(size, size_t{1}));
+      for (int i = first; i < end; ++i) {
+        if (i == missing_packet_id) {
+          continue;
+        }
+        const absl::Span<const uint8_t> other = chunks_[i].payload;
+        const size_t overlap = std::min(size, other.size());
+        for (size_t j = 0; j < overlap; ++j) {
+          recovered[j] ^= other[j];
+        }
+      }
+
+      if (missing_packet_id == 0) {
+        // The FEC packet carries the same header fields as packet 0.
+        ApplyFirstPacketMetadata(fec_part);
+      }
+      PayloadChunk& chunk = chunks_[missing_packet_id];
+      chunk.buffer = std::move(recovered);
+      chunk.payload = absl::Span<const uint8_t>(chunk.buffer.data(), size);
+      --num_missing_packets_;
+      OSP_DCHECK_GE(num_missing_packets_, 0);
+    }
+
+    // All the packets protected by this FEC packet are now present.
+    it = fec_chunks_.erase(it);
+  }
 }
 
 FrameCollector::PayloadChunk::PayloadChunk() = default;
 FrameCollector::PayloadChunk::~PayloadChunk() = default;
 
+FrameCollector::FecChunk::FecChunk() = default;
+FrameCollector::FecChunk::FecChunk(FecChunk&& other) noexcept = default;
+FrameCollector::FecChunk& FrameCollector::FecChunk::operator=(
+    FecChunk&& other) noexcept = default;
+FrameCollector::FecChunk::~FecChunk() = default;
+
 }  // namespace cast
 }  // namespace openscreen
@@ -5,6 +5,7 @@
 #ifndef CAST_STREAMING_FRAME_COLLECTOR_H_
 #define CAST_STREAMING_FRAME_COLLECTOR_H_
 
+#include <chrono>
 #include <vector>
 
 #include "absl/types/span.h"
@@ -12,6 +13,7 @@
 #include "cast/streaming/frame_id.h"
 #include "cast/streaming/rtcp_common.h"
 #include "cast/streaming/rtp_packet_parser.h"
+#include "cast/streaming/rtp_time.h"
 
 namespace openscreen {
 namespace cast {
@@ -39,6 +41,17 @@ class FrameCollector {
   // assembled.
   bool is_complete() const { return num_missing_packets_ == 0; }
 
+  // Returns true once the first packet of the frame has been collected (or
+  // recovered via FEC), at which point the frame metadata accessors below are
+  // valid.
+  bool has_first_packet() const {
+    return !chunks_.empty() && chunks_.front().has_data();
+  }
+  RtpTimeTicks rtp_timestamp() const { return frame_.rtp_timestamp; }
+  std::chrono::milliseconds new_playout_delay() const {
+    return frame_.new_playout_delay;
+  }
+
   // Appends zero or more elements to |nacks| representing which packets are not
   // yet collected. If all packets for the frame are missing, this appends a
   // single element containing the special kAllPacketsLost packet ID. Otherwise,
@@ -69,6 +82,33 @@ class FrameCollector {
     bool has_data() const { return !!payload.data(); }
   };
 
+  // An FEC packet, held until it can be used to recover a lost packet, or
+  // until all the packets it protects have been collected.
+  struct FecChunk {
+    std::vector<uint8_t> buffer;
+    RtpPacketParser::ParseResult part;  // |part.payload| is within |buffer|.
+
+    FecChunk();
+    FecChunk(FecChunk&& other) noexcept;
+    FecChunk& operator=(FecChunk&& other) noexcept;
+    ~FecChunk();
+  };
+
+  // Sanity-checks that the |part| belongs to this frame, and sizes |chunks_|
+  // when the first part is processed. Returns false if |part| is invalid.
+  bool ValidatePart(const RtpPacketParser::ParseResult& part);
+
+  // Populates the frame metadata from the first packet of the frame.
+  void ApplyFirstPacketMetadata(const RtpPacketParser::ParseResult& part);
+
+  // Collects an FEC packet. Called by CollectRtpPacket().
+  void CollectFecPacket(const RtpPacketParser::ParseResult& part,
+                        std::vector<uint8_t>* buffer);
+
+  // Recovers any packet that is the only one missing from an FEC group, and
+  // discards any FEC packets no longer needed.
+  void RecoverFromFecPackets();
+
   // Storage for frame metadata and data. Once the frame has been completely
   // collected and assembled, |frame_.data| is set to non-null, and this is
   // exposed externally (read-only).
@@ -82,6 +122,9 @@ class FrameCollector {
   // correspond 1:1 with packet IDs. When the first part is collected, this is
   // resized to match the total number of packets being expected.
   std::vector<PayloadChunk> chunks_;
+
+  // FEC packets that have been collected, but not yet used.
+  std::vector<FecChunk> fec_chunks_;
 };
 
 }  // namespace cast
@@ -7,11 +7,15 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <numeric>
+#include <random>
 #include <vector>
 
 #include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/frame_crypto.h"
 #include "cast/streaming/frame_id.h"
 #include "cast/streaming/rtcp_common.h"
+#include "cast/streaming/rtp_packetizer.h"
 #include "cast/streaming/rtp_time.h"
 #include "gtest/gtest.h"
 
@@ -206,6 +210,245 @@ TEST(FrameCollectorTest, RejectsInvalidParts) {
   ASSERT_TRUE(buffer.size() == 1 && buffer[0] == 'A');
 }
 
+constexpr Ssrc kSenderSsrc = 1;
+
+// Generates the media and FEC packets for frames, and parses them for
+// collection, as a Sender and Receiver would.
+class FecPacketSource {
+ public:
+  explicit FecPacketSource(int fec_group_size)
+      : packetizer_(RtpPayloadType::kVideoVp8,
+                    kSenderSsrc,
+                    kMaxRtpPacketSizeForIpv4UdpOnEthernet,
+                    fec_group_size),
+        parser_(kSenderSsrc) {}
+
+  // Starts the next frame, of the given |payload_size|, and returns the total
+  // number of packets (media + FEC) generated for it. The FEC packets always
+  // follow the media packets.
+  int StartFrame(FrameId frame_id, int payload_size) {
+    frame_data_.resize(payload_size);
+    for (int i = 0; i < payload_size; ++i) {
+      frame_data_[i] = static_cast<uint8_t>(i * 31 + frame_id.lower_8_bits());
+    }
+    frame_.dependency = EncodedFrame::KEY_FRAME;
+    frame_.frame_id = frame_id;
+    frame_.referenced_frame_id = frame_id;
+    frame_.rtp_timestamp = kSomeRtpTimestamp;
+    frame_.new_playout_delay = std::chrono::milliseconds(321);
+    frame_.data = absl::Span<uint8_t>(frame_data_);
+    num_media_packets_ = packetizer_.ComputeNumberOfPackets(frame_);
+    return num_media_packets_ +
+           packetizer_.ComputeNumberOfFecPackets(num_media_packets_);
+  }
+
+  int num_media_packets() const { return num_media_packets_; }
+  const std::vector<uint8_t>& frame_data() const { return frame_data_; }
+
+  // Generates the |index|'th packet of the current frame, and passes it to the
+  // |collector|.
+  bool SendPacketTo(int index, FrameCollector* collector) {
+    std::vector<uint8_t> buffer(kMaxRtpPacketSizeForIpv4UdpOnEthernet);
+    const absl::Span<uint8_t> packet =
+        (index < num_media_packets_)
+            ? packetizer_.GeneratePacket(frame_,
+                                         static_cast<FramePacketId>(index),
+                                         absl::Span<uint8_t>(buffer))
+            : packetizer_.GenerateFecPacket(frame_, index - num_media_packets_,
+                                            absl::Span<uint8_t>(buffer));
+    buffer.resize(packet.size());
+    const absl::optional<RtpPacketParser::ParseResult> part =
+        parser_.Parse(buffer);
+    return part && collector->CollectRtpPacket(*part, &buffer);
+  }
+
+ private:
+  RtpPacketizer packetizer_;
+  RtpPacketParser parser_;
+  std::vector<uint8_t> frame_data_;
+  EncryptedFrame frame_;
+  int num_media_packets_ = 0;
+};
+
+// Tests that one lost packet per FEC group is recovered without any NACKs,
+// including the first packet and its metadata.
+TEST(FrameCollectorTest, RecoversLostPacketsUsingFec) {
+  FecPacketSource source(4);
+  FrameCollector collector;
+  collector.set_frame_id(kSomeFrameId);
+  // 10 media packets, in groups of 4, 4, and 2, plus 3 FEC packets.
+  const int num_packets = source.StartFrame(kSomeFrameId, 13000);
+  ASSERT_EQ(10, source.num_media_packets());
+  ASSERT_EQ(13, num_packets);
+
+  for (int i = 0; i < num_packets; ++i) {
+    if (i == 0 || i == 6 || i == 9) {
+      continue;  // Lost in transit.
+    }
+    EXPECT_TRUE(source.SendPacketTo(i, &collector)) << "i=" << i;
+  }
+
+  EXPECT_TRUE(collector.is_complete());
+  EXPECT_HAS_NACKS(std::vector<PacketNack>(), collector);
+  EXPECT_TRUE(collector.has_first_packet());
+  const auto& frame = collector.PeekAtAssembledFrame();
+  EXPECT_EQ(EncodedFrame::KEY_FRAME, frame.dependency);
+  EXPECT_EQ(kSomeFrameId, frame.referenced_frame_id);
+  EXPECT_EQ(kSomeRtpTimestamp, frame.rtp_timestamp);
+  EXPECT_EQ(std::chrono::milliseconds(321), frame.new_playout_delay);
+  EXPECT_EQ(absl::Span<const uint8_t>(source.frame_data()),
+            absl::Span<const uint8_t>(frame.data));
+}
+
+// Tests that a group with two lost packets is NACKed, and that it is recovered
+// once either of those packets is re-transmitted.
+TEST(FrameCollectorTest, RecoversFromFecAfterRetransmit) {
+  FecPacketSource source(4);
+  FrameCollector collector;
+  collector.set_frame_id(kSomeFrameId);
+  const int num_packets = source.StartFrame(kSomeFrameId, 5000);
+  ASSERT_EQ(4, source.num_media_packets());
+  ASSERT_EQ(5, num_packets);
+
+  // The FEC packet arrives first, but is not enough on its own.
+  EXPECT_TRUE(source.SendPacketTo(4, &collector));
+  EXPECT_TRUE(source.SendPacketTo(0, &collector));
+  EXPECT_TRUE(source.SendPacketTo(3, &collector));
+  EXPECT_FALSE(collector.is_complete());
+  EXPECT_HAS_NACKS((std::vector<PacketNack>{{kSomeFrameId, 1},
+                                            {kSomeFrameId, 2}}),
+                   collector);
+
+  EXPECT_TRUE(source.SendPacketTo(2, &collector));
+  EXPECT_TRUE(collector.is_complete());
+  EXPECT_EQ(absl::Span<const uint8_t>(source.frame_data()),
+            absl::Span<const uint8_t>(collector.PeekAtAssembledFrame().data));
+}
+
+// Tests that an empty packet is recovered from an FEC packet whose payload is
+// also empty, without reading past the end of the FEC packet's payload.
+TEST(FrameCollectorTest, RecoversEmptyPacketFromEmptyFecPayload) {
+  FrameCollector collector;
+  collector.set_frame_id(kSomeFrameId);
+
+  RtpPacketParser::ParseResult part{};
+  part.rtp_timestamp = kSomeRtpTimestamp;
+  part.is_key_frame = true;
+  part.frame_id = kSomeFrameId;
+  part.packet_id = 0;
+  part.max_packet_id = 1;
+  part.referenced_frame_id = kSomeFrameId;
+  std::vector<uint8_t> buffer(3, 'A');
+  part.payload = absl::Span<uint8_t>(buffer);
+  EXPECT_TRUE(collector.CollectRtpPacket(part, &buffer));
+  EXPECT_FALSE(collector.is_complete());
+
+  // Packet 1 is lost. It was empty, so the parity payload is only as long as
+  // packet 0's, but here it is truncated to nothing. The size XOR still says
+  // that packet 1 was empty.
+  part.fec_protected_packet_count = 2;
+  part.fec_payload_size_xor = 3;
+  std::vector<uint8_t> fec_buffer(1);
+  part.payload = absl::Span<uint8_t>(fec_buffer.data(), 0);
+  EXPECT_TRUE(collector.CollectRtpPacket(part, &fec_buffer));
+
+  EXPECT_TRUE(collector.is_complete());
+  EXPECT_EQ(absl::Span<const uint8_t>(std::vector<uint8_t>(3, 'A')),
+            absl::Span<const uint8_t>(collector.PeekAtAssembledFrame().data));
+}
+
+// Simulates sending frames over a lossy network, with NACK-based re-transmits,
+// to compare frame completion latency with and without FEC. The results are
+// recorded as test properties (see --gtest_output).
+TEST(FrameCollectorTest, FecReducesFrameCompletionLatencyUnderLoss) {
+  constexpr double kPacketLossRate = 0.05;
+  constexpr int kOneWayDelayMs = 20;
+  // A Receiver NACKs once the frame's packets should have arrived, and the
+  // re-transmits take another round trip.
+  constexpr int kRetransmitRoundTripMs = 2 * kOneWayDelayMs;
+  constexpr int kNumFrames = 1000;
+  constexpr int kFramePayloadSize = 14000;  // 10 packets.
+
+  struct Result {
+    double mean_latency_ms;
+    int max_latency_ms;
+    int num_frames_retransmitted;
+    int num_packets_sent;
+  };
+  const auto Simulate = [&](int fec_group_size) {
+    std::minstd_rand generator(42);
+    std::bernoulli_distribution is_lost(kPacketLossRate);
+    FecPacketSource source(fec_group_size);
+    FrameCollector collector;
+    Result result{};
+    std::vector<int> latencies;
+    for (int i = 0; i < kNumFrames; ++i) {
+      const FrameId frame_id = FrameId::first() + i;
+      collector.set_frame_id(frame_id);
+      const int num_packets = source.StartFrame(frame_id, kFramePayloadSize);
+      for (int j = 0; j < num_packets; ++j) {
+        ++result.num_packets_sent;
+        if (!is_lost(generator)) {
+          EXPECT_TRUE(source.SendPacketTo(j, &collector));
+        }
+      }
+      int latency_ms = kOneWayDelayMs;
+      if (!collector.is_complete()) {
+        ++result.num_frames_retransmitted;
+      }
+      while (!collector.is_complete()) {
+        std::vector<PacketNack> nacks;
+        collector.GetMissingPackets(&nacks);
+        std::vector<int> packet_ids;
+        for (const PacketNack& nack : nacks) {
+          if (nack.packet_id == kAllPacketsLost) {
+            packet_ids.resize(source.num_media_packets());
+            std::iota(packet_ids.begin(), packet_ids.end(), 0);
+          } else {
+            packet_ids.push_back(nack.packet_id);
+          }
+        }
+        for (int packet_id : packet_ids) {
+          ++result.num_packets_sent;
+          if (!is_lost(generator)) {
+            EXPECT_TRUE(source.SendPacketTo(packet_id, &collector));
+          }
+        }
+        latency_ms += kRetransmitRoundTripMs;
+      }
+      latencies.push_back(latency_ms);
+      collector.Reset();
+    }
+    result.mean_latency_ms =
+        std::accumulate(latencies.begin(), latencies.end(), 0.0) / kNumFrames;
+    result.max_latency_ms =
+        *std::max_element(latencies.begin(), latencies.end());
+    return result;
+  };
+
+  const Result without_fec = Simulate(0);
+  const Result with_fec = Simulate(4);
+  RecordProperty("mean_latency_us_without_fec",
+                 static_cast<int>(without_fec.mean_latency_ms * 1000));
+  RecordProperty("mean_latency_us_with_fec",
+                 static_cast<int>(with_fec.mean_latency_ms * 1000));
+  RecordProperty("frames_retransmitted_without_fec",
+                 without_fec.num_frames_retransmitted);
+  RecordProperty("frames_retransmitted_with_fec",
+                 with_fec.num_frames_retransmitted);
+  RecordProperty("packets_sent_without_fec", without_fec.num_packets_sent);
+  RecordProperty("packets_sent_with_fec", with_fec.num_packets_sent);
+
+  // Without FEC, about 40% of the frames need at least one re-transmit round
+  // trip. With one FEC packet per 4 media packets, only about 5% do, at the
+  // cost of about 30% more packets sent.
+  EXPECT_GT(without_fec.num_frames_retransmitted, kNumFrames / 4);
+  EXPECT_LT(with_fec.num_frames_retransmitted, kNumFrames / 15);
+  EXPECT_LT(with_fec.mean_latency_ms, without_fec.mean_latency_ms * 0.8);
+  EXPECT_LE(with_fec.max_latency_ms, without_fec.max_latency_ms);
+  EXPECT_LT(with_fec.num_packets_sent, without_fec.num_packets_sent * 3 / 2);
+}
+
 }  // namespace
 }  // namespace cast
 }  // namespace openscreen
@@ -17,6 +17,20 @@
 namespace openscreen {
 namespace cast {
 
+namespace {
+
+// Adds |count| to the 128-bit big-endian AES-CTR |counter|, the same way that
+// AES_ctr128_encrypt() increments it after each block.
+void AdvanceCounter(uint64_t count, std::array<uint8_t, 16>* counter) {
+  for (int i = counter->size() - 1; i >= 0 && count > 0; --i) {
+    const uint64_t sum = (*counter)[i] + (count & 0xff);
+    (*counter)[i] = static_cast<uint8_t>(sum);
+    count = (count >> 8) + (sum >> 8);
+  }
+}
+
+}  // namespace
+
 EncryptedFrame::EncryptedFrame() {
   data = absl::Span<uint8_t>(owned_data_);
 }
@@ -64,10 +78,17 @@ EncryptedFrame FrameCrypto::Encrypt(const EncodedFrame& encoded_frame) const {
   encoded_frame.CopyMetadataTo(&result);
   result.owned_data_.resize(encoded_frame.data.size());
   result.data = absl::Span<uint8_t>(result.owned_data_);
-  EncryptCommon(encoded_frame.frame_id, encoded_frame.data, result.data);
+  EncryptCommon(encoded_frame.frame_id, 0, encoded_frame.data, result.data);
   return result;
 }
 
+void FrameCrypto::EncryptPart(FrameId frame_id,
+                              int offset,
+                              absl::Span<const uint8_t> in,
+                              absl::Span<uint8_t> out) const {
+  EncryptCommon(frame_id, offset, in, out);
+}
+
 void FrameCrypto::Decrypt(const EncryptedFrame& encrypted_frame,
                           EncodedFrame* encoded_frame) const {
   encrypted_frame.CopyMetadataTo(encoded_frame);
@@ -77,14 +98,16 @@ void FrameCrypto::Decrypt(const EncryptedFrame& encrypted_frame,
     encoded_frame->data = absl::Span<uint8_t>(encoded_frame->data.data(),
                                               encrypted_frame.data.size());
   }
-  EncryptCommon(encrypted_frame.frame_id, encrypted_frame.data,
+  EncryptCommon(encrypted_frame.frame_id, 0, encrypted_frame.data,
                 encoded_frame->data);
 }
 
 void FrameCrypto::EncryptCommon(FrameId frame_id,
+                                int offset,
                                 absl::Span<const uint8_t> in,
                                 absl::Span<uint8_t> out) const {
   OSP_DCHECK(!frame_id.is_null());
+  OSP_DCHECK_GE(offset, 0);
   OSP_DCHECK_EQ(in.size(), out.size());
 
   // Compute the AES nonce for Cast Streaming payload encryption, which is based
@@ -97,8 +120,16 @@ void FrameCrypto::EncryptCommon(FrameId frame_id,
     aes_nonce[i] ^= cast_iv_mask_[i];
   }
 
+  // Skip the counter ahead to the block containing |offset|. If |offset| is
+  // part-way into that block, generate the block's key stream and advance past
+  // it, as AES_ctr128_encrypt() would have done had it started at offset 0.
+  AdvanceCounter(offset / AES_BLOCK_SIZE, &aes_nonce);
   std::array<uint8_t, 16> ecount_buf{/* zero initialized */};
-  unsigned int block_offset = 0;
+  unsigned int block_offset = offset % AES_BLOCK_SIZE;
+  if (block_offset != 0) {
+    AES_encrypt(aes_nonce.data(), ecount_buf.data(), &aes_key_);
+    AdvanceCounter(1, &aes_nonce);
+  }
   AES_ctr128_encrypt(in.data(), out.data(), in.size(), &aes_key_,
                      aes_nonce.data(), ecount_buf.data(), &block_offset);
 }
@@ -57,6 +57,15 @@ class FrameCrypto {
 
   EncryptedFrame Encrypt(const EncodedFrame& encoded_frame) const;
 
+  // Encrypts the part of a frame's payload that begins |offset| bytes into it,
+  // writing the same bytes to |out| that Encrypt() would produce at that
+  // position. This allows the payload to be encrypted incrementally, such as
+  // one packet at a time.
+  void EncryptPart(FrameId frame_id,
+                   int offset,
+                   absl::Span<const uint8_t> in,
+                   absl::Span<uint8_t> out) const;
+
   // Decrypt the given |encrypted_frame| into the output |encoded_frame|. The
   // caller must provide a sufficiently-sized data buffer (see
   // GetPlaintextSize()).
@@ -81,9 +90,11 @@ class FrameCrypto {
   // initialization vector for each frame.
   const std::array<uint8_t, 16> cast_iv_mask_;
 
-  // AES-CTR is symmetric. Thus, the "meat" of both Encrypt() and Decrypt() is
-  // the same.
+  // AES-CTR is symmetric. Thus, the "meat" of Encrypt(), EncryptPart() and
+  // Decrypt() is the same. |offset| is the position of |in| within the frame's
+  // payload.
   void EncryptCommon(FrameId frame_id,
+                     int offset,
                      absl::Span<const uint8_t> in,
                      absl::Span<uint8_t> out) const;
 };
@@ -4,6 +4,7 @@
 
 #include "cast/streaming/frame_crypto.h"
 
+#include <algorithm>
 #include <array>
 #include <cstring>
 #include <vector>
@@ -76,6 +77,41 @@ TEST(FrameCryptoTest, EncryptsAndDecryptsFrames) {
                       frame1.data.size()));
 }
 
+// Tests that encrypting parts of a payload, starting at any offset, produces
+// the same bytes as encrypting the whole payload at once.
+TEST(FrameCryptoTest, EncryptsPartsOfFrames) {
+  std::vector<uint8_t> buffer(70000);
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    buffer[i] = static_cast<uint8_t>(i * 7);
+  }
+  EncodedFrame frame;
+  frame.frame_id = FrameId::first() + 42;
+  frame.data = absl::Span<uint8_t>(buffer);
+
+  // An IV mask of all ones forces carries across every byte of the counter.
+  std::array<uint8_t, 16> all_ones_mask;
+  all_ones_mask.fill(0xff);
+  for (const std::array<uint8_t, 16>& iv_mask :
+       {GenerateRandomBytes16(), all_ones_mask}) {
+    const FrameCrypto crypto(GenerateRandomBytes16(), iv_mask);
+    const EncryptedFrame encrypted_frame = crypto.Encrypt(frame);
+
+    constexpr int kOffsets[] = {0, 1, 15, 16, 17, 1000, 1472, 4096, 69999};
+    for (int offset : kOffsets) {
+      SCOPED_TRACE(testing::Message() << "offset=" << offset);
+      const int size = std::min(1500, static_cast<int>(buffer.size()) - offset);
+      std::vector<uint8_t> part(size);
+      const absl::Span<const uint8_t> plaintext =
+          absl::Span<const uint8_t>(buffer).subspan(offset, size);
+      crypto.EncryptPart(frame.frame_id, offset, plaintext,
+                         absl::Span<uint8_t>(part));
+      EXPECT_EQ(absl::Span<const uint8_t>(encrypted_frame.data)
+                    .subspan(offset, size),
+                absl::Span<const uint8_t>(part));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace cast
 }  // namespace openscreen
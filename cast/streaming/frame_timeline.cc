@@ -0,0 +1,195 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/frame_timeline.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "util/osp_logging.h"
+#include "util/trace_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+const char* FrameStageToString(FrameStage stage) {
+  switch (stage) {
+    case FrameStage::kCaptured:
+      return "captured";
+    case FrameStage::kEnqueued:
+      return "enqueued";
+    case FrameStage::kFirstPacketSent:
+      return "first packet sent";
+    case FrameStage::kLastPacketSent:
+      return "last packet sent";
+    case FrameStage::kAcked:
+      return "ACKed";
+    case FrameStage::kFirstPacketReceived:
+      return "first packet received";
+    case FrameStage::kCompleted:
+      return "completed";
+    case FrameStage::kReady:
+      return "ready";
+    case FrameStage::kConsumed:
+      return "consumed";
+  }
+  OSP_NOTREACHED();
+  return "";
+}
+
+FrameTimeline::FrameTimeline() {
+  stage_times.fill(kNotReached);
+}
+FrameTimeline::FrameTimeline(const FrameTimeline& other) = default;
+FrameTimeline& FrameTimeline::operator=(const FrameTimeline& other) = default;
+FrameTimeline::~FrameTimeline() = default;
+
+absl::optional<Clock::duration> FrameTimeline::GetDuration(
+    FrameStage from,
+    FrameStage to) const {
+  if (!HasReached(from) || !HasReached(to)) {
+    return absl::nullopt;
+  }
+  return time_of(to) - time_of(from);
+}
+
+std::ostream& operator<<(std::ostream& out, const FrameTimeline& timeline) {
+  using DoubleMillis = std::chrono::duration<double, std::milli>;
+
+  // Output the stages in the order they were reached, each with the time
+  // elapsed since the prior one.
+  std::array<FrameStage, kNumFrameStages> stages;
+  int num_reached = 0;
+  for (int i = 0; i < kNumFrameStages; ++i) {
+    const FrameStage stage = static_cast<FrameStage>(i);
+    if (timeline.HasReached(stage)) {
+      stages[num_reached++] = stage;
+    }
+  }
+  std::stable_sort(stages.begin(), stages.begin() + num_reached,
+                   [&](FrameStage a, FrameStage b) {
+                     return timeline.time_of(a) < timeline.time_of(b);
+                   });
+
+  out << timeline.frame_id << ':';
+  for (int i = 0; i < num_reached; ++i) {
+    out << ' ' << FrameStageToString(stages[i]);
+    if (i > 0) {
+      out << " +"
+          << DoubleMillis(timeline.time_of(stages[i]) -
+                          timeline.time_of(stages[i - 1]))
+                 .count()
+          << " ms";
+    }
+    out << ',';
+  }
+  if (num_reached > 1) {
+    out << " total "
+        << DoubleMillis(timeline.time_of(stages[num_reached - 1]) -
+                        timeline.time_of(stages[0]))
+               .count()
+        << " ms";
+  }
+  if (timeline.was_dropped) {
+    out << " (dropped)";
+  }
+  return out;
+}
+
+// static
+constexpr Clock::time_point FrameTimeline::kNotReached;
+
+FrameTimelineRecorder::FrameTimelineRecorder(const char* span_name,
+                                             Ssrc ssrc,
+                                             int capacity,
+                                             Client* client)
+    : span_name_(span_name), ssrc_(ssrc), client_(client), ring_(capacity) {
+  OSP_DCHECK(span_name_);
+  OSP_DCHECK_GT(capacity, 0);
+}
+
+FrameTimelineRecorder::~FrameTimelineRecorder() {
+  for (const Entry& entry : ring_) {
+    CancelSpanIfUnfinished(entry);
+  }
+}
+
+void FrameTimelineRecorder::RecordStage(FrameId frame_id,
+                                        FrameStage stage,
+                                        Clock::time_point when) {
+  Entry& entry = GetEntry(frame_id);
+  if (!entry.is_active || entry.timeline.frame_id != frame_id) {
+    // Evict whatever older frame was in this slot, and start a new timeline.
+    CancelSpanIfUnfinished(entry);
+    entry = Entry{};
+    entry.timeline.frame_id = frame_id;
+    entry.is_active = true;
+    TRACE_ASYNC_START(TraceCategory::kStreaming, span_name_,
+                      GetTraceId(frame_id));
+  } else if (entry.is_finished) {
+    return;
+  }
+
+  Clock::time_point& stage_time =
+      entry.timeline.stage_times[static_cast<int>(stage)];
+  if (stage_time == FrameTimeline::kNotReached) {
+    stage_time = when;
+  }
+}
+
+void FrameTimelineRecorder::FinishFrame(FrameId frame_id, bool was_dropped) {
+  Entry& entry = GetEntry(frame_id);
+  if (!entry.is_active || entry.timeline.frame_id != frame_id ||
+      entry.is_finished) {
+    return;
+  }
+
+  entry.is_finished = true;
+  entry.timeline.was_dropped = was_dropped;
+  TRACE_ASYNC_END(TraceCategory::kStreaming, GetTraceId(frame_id),
+                  was_dropped ? Error::Code::kOperationCancelled
+                              : Error::Code::kNone);
+  if (client_) {
+    client_->OnFrameTimelineFinished(entry.timeline);
+  }
+}
+
+const FrameTimeline* FrameTimelineRecorder::GetTimeline(
+    FrameId frame_id) const {
+  const Entry& entry = GetEntry(frame_id);
+  if (!entry.is_active || entry.timeline.frame_id != frame_id) {
+    return nullptr;
+  }
+  return &entry.timeline;
+}
+
+const FrameTimelineRecorder::Entry& FrameTimelineRecorder::GetEntry(
+    FrameId frame_id) const {
+  return const_cast<FrameTimelineRecorder*>(this)->GetEntry(frame_id);
+}
+
+FrameTimelineRecorder::Entry& FrameTimelineRecorder::GetEntry(
+    FrameId frame_id) {
+  return ring_[(frame_id - FrameId::first()) % ring_.size()];
+}
+
+void FrameTimelineRecorder::CancelSpanIfUnfinished(const Entry& entry) const {
+  // Frames that were lost, or dropped before they could be canceled, never
+  // finish. End their spans so that they are not left open forever.
+  if (entry.is_active && !entry.is_finished) {
+    TRACE_ASYNC_END(TraceCategory::kStreaming,
+                    GetTraceId(entry.timeline.frame_id),
+                    Error::Code::kOperationCancelled);
+  }
+}
+
+TraceId FrameTimelineRecorder::GetTraceId(FrameId frame_id) const {
+  // The upper bits identify the stream, and the lower bits the frame.
+  return (static_cast<TraceId>(ssrc_) << 32) | frame_id.lower_32_bits();
+}
+
+FrameTimelineRecorder::Client::~Client() = default;
+
+}  // namespace cast
+}  // namespace openscreen
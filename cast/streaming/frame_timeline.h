@@ -0,0 +1,148 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_FRAME_TIMELINE_H_
+#define CAST_STREAMING_FRAME_TIMELINE_H_
+
+#include <array>
+#include <ostream>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "cast/streaming/frame_id.h"
+#include "cast/streaming/ssrc.h"
+#include "platform/api/time.h"
+#include "platform/base/trace_logging_types.h"
+
+namespace openscreen {
+namespace cast {
+
+// The stages in the lifecycle of a frame, in the order they are normally
+// reached. A Sender records the stages from kCaptured through kAcked, and a
+// Receiver records kCaptured and the stages from kFirstPacketReceived through
+// kConsumed. All times are in terms of the local clock; at the Receiver, the
+// capture time is the estimate translated from the Sender's clock.
+enum class FrameStage {
+  kCaptured = 0,  // The frame's reference time.
+  kEnqueued,      // Sender::EnqueueFrame(), just after encoding completed.
+  kFirstPacketSent,
+  kLastPacketSent,  // All of the frame's packets have been sent once.
+  kAcked,
+  kFirstPacketReceived,
+  kCompleted,  // All of the frame's packets have been received.
+  kReady,      // The Consumer was notified via OnFramesReady().
+  kConsumed,
+};
+constexpr int kNumFrameStages = static_cast<int>(FrameStage::kConsumed) + 1;
+
+const char* FrameStageToString(FrameStage stage);
+
+// The times at which one frame reached each stage of its lifecycle.
+struct FrameTimeline {
+  FrameTimeline();
+  FrameTimeline(const FrameTimeline& other);
+  FrameTimeline& operator=(const FrameTimeline& other);
+  ~FrameTimeline();
+
+  bool HasReached(FrameStage stage) const {
+    return stage_times[static_cast<int>(stage)] != kNotReached;
+  }
+  Clock::time_point time_of(FrameStage stage) const {
+    return stage_times[static_cast<int>(stage)];
+  }
+
+  // Returns the time elapsed from stage |from| to stage |to|, or nullopt if
+  // either stage was not reached.
+  absl::optional<Clock::duration> GetDuration(FrameStage from,
+                                              FrameStage to) const;
+
+  FrameId frame_id;
+
+  // Indexed by FrameStage. Stages not reached are set to |kNotReached|.
+  std::array<Clock::time_point, kNumFrameStages> stage_times;
+
+  // Whether the frame was canceled (at the Sender) or dropped (at the
+  // Receiver) instead of finishing its lifecycle normally.
+  bool was_dropped = false;
+
+  static constexpr Clock::time_point kNotReached = Clock::time_point::min();
+};
+
+// Outputs a human-readable breakdown, with the time elapsed between each of
+// the stages reached, for logging.
+std::ostream& operator<<(std::ostream& out, const FrameTimeline& timeline);
+
+// Records the FrameTimelines of the most recent frames of one stream into a
+// bounded ring, and emits each frame's lifecycle as an asynchronous trace span
+// (TRACE_ASYNC_START/TRACE_ASYNC_END). An optional Client is notified as each
+// frame's lifecycle finishes.
+class FrameTimelineRecorder {
+ public:
+  class Client {
+   public:
+    // Called when the lifecycle of a frame has finished: at the Sender, when it
+    // is ACKed or canceled; and, at the Receiver, when it is consumed or
+    // dropped.
+    virtual void OnFrameTimelineFinished(const FrameTimeline& timeline) = 0;
+
+   protected:
+    virtual ~Client();
+  };
+
+  // |span_name| names the trace spans, and must outlive this instance. The
+  // |ssrc| is used to make the trace IDs unique across streams. |capacity| is
+  // the number of recent frames whose timelines are retained.
+  FrameTimelineRecorder(const char* span_name,
+                        Ssrc ssrc,
+                        int capacity,
+                        Client* client);
+
+  // Ends the trace spans of any frames that have not finished, as canceled.
+  ~FrameTimelineRecorder();
+
+  // Records that the given frame reached |stage| at time |when|. Only the first
+  // time a stage is reached is recorded, and nothing is recorded after the
+  // frame's lifecycle has finished. The first stage recorded for a frame starts
+  // its trace span. If that evicts an older frame that never finished, the
+  // older frame's trace span is ended as canceled (without notifying the
+  // Client).
+  void RecordStage(FrameId frame_id, FrameStage stage, Clock::time_point when);
+
+  // Marks the end of the given frame's lifecycle, ending its trace span and
+  // notifying the Client. This is ignored if no stages were recorded for the
+  // frame, or if it has already finished.
+  void FinishFrame(FrameId frame_id, bool was_dropped);
+
+  // Returns the timeline of the given frame, or nullptr if no stages were
+  // recorded for it or it has since been evicted from the ring.
+  const FrameTimeline* GetTimeline(FrameId frame_id) const;
+
+ private:
+  struct Entry {
+    FrameTimeline timeline;
+    bool is_active = false;  // At least one stage was recorded.
+    bool is_finished = false;
+  };
+
+  const Entry& GetEntry(FrameId frame_id) const;
+  Entry& GetEntry(FrameId frame_id);
+  TraceId GetTraceId(FrameId frame_id) const;
+
+  // Ends the trace span of the frame in |entry| as canceled, if the frame's
+  // lifecycle had started but not finished. This is called when the entry is
+  // about to be evicted.
+  void CancelSpanIfUnfinished(const Entry& entry) const;
+
+  const char* const span_name_;
+  const Ssrc ssrc_;
+  Client* const client_;
+
+  // The frame having FrameId x is slotted at position x % ring_.size().
+  std::vector<Entry> ring_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_FRAME_TIMELINE_H_
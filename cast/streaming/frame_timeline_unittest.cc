@@ -0,0 +1,170 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/frame_timeline.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "platform/test/trace_logging_helpers.h"
+#include "util/chrono_helpers.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::StrictMock;
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+// Use a fake, fixed start time.
+constexpr Clock::time_point kStartTime =
+    Clock::time_point() + Clock::duration(1234567890);
+
+constexpr Ssrc kSsrc = 42;
+constexpr int kCapacity = 4;
+
+class MockClient : public FrameTimelineRecorder::Client {
+ public:
+  MOCK_METHOD1(OnFrameTimelineFinished, void(const FrameTimeline& timeline));
+};
+
+TEST(FrameTimelineRecorderTest, RecordsStagesUntilFinished) {
+  StrictMock<MockClient> client;
+  FrameTimelineRecorder recorder("Frame", kSsrc, kCapacity, &client);
+  const FrameId frame_id = FrameId::first() + 2;
+  EXPECT_EQ(nullptr, recorder.GetTimeline(frame_id));
+
+  recorder.RecordStage(frame_id, FrameStage::kCaptured, kStartTime);
+  recorder.RecordStage(frame_id, FrameStage::kEnqueued,
+                       kStartTime + milliseconds(5));
+  // Only the first time a stage is reached is recorded.
+  recorder.RecordStage(frame_id, FrameStage::kEnqueued,
+                       kStartTime + milliseconds(6));
+  recorder.RecordStage(frame_id, FrameStage::kAcked,
+                       kStartTime + milliseconds(25));
+
+  EXPECT_CALL(client, OnFrameTimelineFinished(_))
+      .WillOnce(Invoke([&](const FrameTimeline& timeline) {
+        EXPECT_EQ(frame_id, timeline.frame_id);
+        EXPECT_FALSE(timeline.was_dropped);
+        EXPECT_EQ(Clock::duration(milliseconds(5)),
+                  timeline.GetDuration(FrameStage::kCaptured,
+                                       FrameStage::kEnqueued));
+        EXPECT_EQ(Clock::duration(milliseconds(25)),
+                  timeline.GetDuration(FrameStage::kCaptured,
+                                       FrameStage::kAcked));
+        EXPECT_FALSE(timeline.HasReached(FrameStage::kFirstPacketSent));
+        EXPECT_FALSE(timeline.GetDuration(FrameStage::kCaptured,
+                                          FrameStage::kFirstPacketSent));
+      }));
+  recorder.FinishFrame(frame_id, false);
+  // Finishing again, and recording stages after finishing, has no effect.
+  recorder.FinishFrame(frame_id, true);
+  recorder.RecordStage(frame_id, FrameStage::kConsumed,
+                       kStartTime + milliseconds(30));
+
+  const FrameTimeline* const timeline = recorder.GetTimeline(frame_id);
+  ASSERT_TRUE(timeline);
+  EXPECT_FALSE(timeline->was_dropped);
+  EXPECT_FALSE(timeline->HasReached(FrameStage::kConsumed));
+}
+
+TEST(FrameTimelineRecorderTest, RetainsOnlyTheMostRecentFrames) {
+  FrameTimelineRecorder recorder("Frame", kSsrc, kCapacity, nullptr);
+  for (int i = 0; i < 2 * kCapacity; ++i) {
+    recorder.RecordStage(FrameId::first() + i, FrameStage::kCaptured,
+                         kStartTime + i * milliseconds(10));
+  }
+  for (int i = 0; i < kCapacity; ++i) {
+    EXPECT_EQ(nullptr, recorder.GetTimeline(FrameId::first() + i));
+  }
+  for (int i = kCapacity; i < 2 * kCapacity; ++i) {
+    const FrameTimeline* const timeline =
+        recorder.GetTimeline(FrameId::first() + i);
+    ASSERT_TRUE(timeline);
+    EXPECT_EQ(kStartTime + i * milliseconds(10),
+              timeline->time_of(FrameStage::kCaptured));
+  }
+
+  // Finishing an evicted frame is ignored.
+  recorder.FinishFrame(FrameId::first(), true);
+  EXPECT_EQ(nullptr, recorder.GetTimeline(FrameId::first()));
+}
+
+#if defined(ENABLE_TRACE_LOGGING)
+// Tests that the trace span of each frame that never finished (e.g., because it
+// was lost) is ended as canceled once the frame is evicted from the ring, or
+// the recorder is destroyed.
+TEST(FrameTimelineRecorderTest, EndsSpansOfUnfinishedFrames) {
+  NiceMock<MockLoggingPlatform> platform;
+  const auto trace_id_of = [](FrameId frame_id) {
+    return (TraceId{kSsrc} << 32) | frame_id.lower_32_bits();
+  };
+
+  auto recorder = std::make_unique<FrameTimelineRecorder>("Frame", kSsrc,
+                                                          kCapacity, nullptr);
+  // The first frame finishes, and the second does not.
+  EXPECT_CALL(platform,
+              LogAsyncEnd(_, _, _, trace_id_of(FrameId::first()),
+                          Error::Code::kNone))
+      .Times(1);
+  recorder->RecordStage(FrameId::first(), FrameStage::kCaptured, kStartTime);
+  recorder->FinishFrame(FrameId::first(), false);
+  recorder->RecordStage(FrameId::first() + 1, FrameStage::kCaptured,
+                        kStartTime + milliseconds(10));
+  testing::Mock::VerifyAndClearExpectations(&platform);
+
+  // Evicting the finished frame does not end its span again, but evicting the
+  // unfinished one does.
+  EXPECT_CALL(platform, LogAsyncEnd(_, _, _, _, _)).Times(0);
+  recorder->RecordStage(FrameId::first() + kCapacity, FrameStage::kCaptured,
+                        kStartTime + milliseconds(40));
+  testing::Mock::VerifyAndClearExpectations(&platform);
+  EXPECT_CALL(platform,
+              LogAsyncEnd(_, _, _, trace_id_of(FrameId::first() + 1),
+                          Error::Code::kOperationCancelled))
+      .Times(1);
+  recorder->RecordStage(FrameId::first() + kCapacity + 1,
+                        FrameStage::kCaptured, kStartTime + milliseconds(50));
+  testing::Mock::VerifyAndClearExpectations(&platform);
+
+  // Destroying the recorder ends the spans of the two frames still in flight.
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_CALL(platform,
+                LogAsyncEnd(_, _, _,
+                            trace_id_of(FrameId::first() + kCapacity + i),
+                            Error::Code::kOperationCancelled))
+        .Times(1);
+  }
+  recorder.reset();
+}
+#endif  // defined(ENABLE_TRACE_LOGGING)
+
+TEST(FrameTimelineTest, OutputsBreakdownInStageOrder) {
+  FrameTimeline timeline;
+  timeline.frame_id = FrameId::first();
+  timeline.stage_times[static_cast<int>(FrameStage::kCaptured)] = kStartTime;
+  timeline.stage_times[static_cast<int>(FrameStage::kFirstPacketReceived)] =
+      kStartTime + milliseconds(20);
+  timeline.stage_times[static_cast<int>(FrameStage::kCompleted)] =
+      kStartTime + milliseconds(30);
+  timeline.stage_times[static_cast<int>(FrameStage::kConsumed)] =
+      kStartTime + milliseconds(100);
+
+  std::ostringstream oss;
+  oss << timeline;
+  EXPECT_EQ(
+      "F0: captured, first packet received +20 ms, completed +10 ms, consumed "
+      "+70 ms, total 100 ms",
+      oss.str());
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
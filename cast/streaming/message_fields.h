@@ -41,6 +41,10 @@ constexpr char kErrorDescription[] = "description";
 
 // Other message fields.
 constexpr char kRpcMessageBody[] = "rpc";
+// Set on JSON RPC messages by an end point able to receive RPC messages as
+// binary Cast messages, which avoids the base64 and JSON encoding overhead.
+// This is an extension to the specification, ignored by other end points.
+constexpr char kAcceptsBinaryRpc[] = "acceptsBinaryRpc";
 constexpr char kCapabilitiesMessageBody[] = "capabilities";
 constexpr char kStatusMessageBody[] = "status";
 
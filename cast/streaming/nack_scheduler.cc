@@ -0,0 +1,245 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/nack_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "util/osp_logging.h"
+#include "util/std_util.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// If no packets have arrived out-of-order for this long, assume the network
+// path is no longer reordering packets.
+constexpr Clock::duration kReorderingMemory = std::chrono::seconds(2);
+
+// The re-NACK interval is the smoothed round trip time plus this many times
+// the round trip time variation, to allow for retransmits that take a little
+// longer than average to arrive.
+constexpr int kRoundTripTimeVariationMultiplier = 2;
+
+}  // namespace
+
+NackScheduler::NackScheduler() = default;
+NackScheduler::~NackScheduler() = default;
+
+void NackScheduler::OnPacketArrived(Clock::time_point arrival_time,
+                                    uint16_t sequence_number) {
+  RecentArrival& entry =
+      recent_arrivals_[sequence_number % recent_arrivals_.size()];
+
+  if (!has_seen_packet_) {
+    has_seen_packet_ = true;
+    highest_sequence_number_ = sequence_number;
+    entry = RecentArrival{sequence_number, arrival_time};
+    return;
+  }
+
+  const int delta =
+      static_cast<int16_t>(sequence_number - highest_sequence_number_);
+  if (delta == 0) {
+    return;  // Duplicate packet.
+  }
+  if (delta > 0) {
+    highest_sequence_number_ = sequence_number;
+    entry = RecentArrival{sequence_number, arrival_time};
+    if (last_reordering_time_ != Clock::time_point::min() &&
+        (arrival_time - last_reordering_time_) > kReorderingMemory) {
+      reordering_allowance_ = Clock::duration::zero();
+      reordering_depth_ = 0;
+      last_reordering_time_ = Clock::time_point::min();
+    }
+    return;
+  }
+
+  // The packet arrived late. Determine how late by finding when the first of
+  // the packets sequenced after it arrived (i.e., when it was first possible to
+  // notice this packet was missing).
+  const int depth = -delta;
+  if (depth >= static_cast<int>(recent_arrivals_.size())) {
+    return;  // Too far out-of-order to reason about.
+  }
+  Clock::time_point noticed_missing_time = Clock::time_point::max();
+  for (uint16_t s = sequence_number + 1;
+       s != static_cast<uint16_t>(highest_sequence_number_ + 1); ++s) {
+    const RecentArrival& later = recent_arrivals_[s % recent_arrivals_.size()];
+    if (later.sequence_number == s &&
+        later.arrival_time >= arrival_time - kReorderingMemory) {
+      noticed_missing_time = std::min(noticed_missing_time, later.arrival_time);
+    }
+  }
+  entry = RecentArrival{sequence_number, arrival_time};
+  if (noticed_missing_time == Clock::time_point::max()) {
+    return;
+  }
+
+  reordering_allowance_ =
+      std::min(kMaxReorderingAllowance,
+               std::max(reordering_allowance_,
+                        arrival_time - noticed_missing_time));
+  reordering_depth_ = std::max(reordering_depth_, depth);
+  last_reordering_time_ = arrival_time;
+}
+
+void NackScheduler::OnPacketCollected(Clock::time_point arrival_time,
+                                      FrameId frame_id,
+                                      FramePacketId packet_id) {
+  const auto FindEntry = [this](const PacketNack& nack) {
+    const auto it = std::lower_bound(
+        missing_packets_.begin(), missing_packets_.end(), nack,
+        [](const MissingPacket& a, const PacketNack& b) { return a.nack < b; });
+    return (it != missing_packets_.end() && it->nack == nack)
+               ? it
+               : missing_packets_.end();
+  };
+
+  auto it = FindEntry(PacketNack{frame_id, packet_id});
+  if (it != missing_packets_.end()) {
+    RecordRecovery(arrival_time, &(*it));
+    missing_packets_.erase(it);
+    return;
+  }
+
+  // If the whole frame was NACKed, the first of its packets to arrive measures
+  // the recovery. The entry is kept, so that any of the frame's packets that
+  // are still missing inherit its NACK timing in the next FilterNacks() call.
+  it = FindEntry(PacketNack{frame_id, kAllPacketsLost});
+  if (it != missing_packets_.end()) {
+    RecordRecovery(arrival_time, &(*it));
+  }
+}
+
+void NackScheduler::FilterNacks(Clock::time_point now,
+                                std::vector<PacketNack>* nacks) {
+  OSP_DCHECK(nacks);
+  OSP_DCHECK(AreElementsSortedAndUnique(*nacks));
+
+  std::vector<MissingPacket> still_missing;
+  still_missing.reserve(nacks->size());
+  auto old_it = missing_packets_.begin();
+  size_t num_to_send = 0;
+  for (size_t i = 0; i < nacks->size(); ++i) {
+    const PacketNack nack = (*nacks)[i];
+
+    // Both lists are sorted, so walk them together to carry over the state of
+    // packets that were already known to be missing. Entries for packets that
+    // are no longer missing are dropped.
+    while (old_it != missing_packets_.end() && old_it->nack < nack) {
+      ++old_it;
+    }
+    MissingPacket packet;
+    if (old_it != missing_packets_.end() && old_it->nack == nack) {
+      packet = *old_it;
+    } else {
+      packet.nack = nack;
+      packet.first_missing_time = now;
+      // If the whole frame had been NACKed before, this packet was requested at
+      // that time too.
+      if (nack.packet_id != kAllPacketsLost) {
+        const PacketNack whole_frame{nack.frame_id, kAllPacketsLost};
+        const auto frame_it = std::find_if(
+            old_it, missing_packets_.end(),
+            [&](const MissingPacket& p) { return !(p.nack < whole_frame); });
+        if (frame_it != missing_packets_.end() &&
+            frame_it->nack == whole_frame) {
+          packet.first_missing_time = frame_it->first_missing_time;
+          packet.first_nack_time = frame_it->first_nack_time;
+          packet.last_nack_time = frame_it->last_nack_time;
+        }
+      }
+    }
+
+    if (now >= ComputeNackTime(packet)) {
+      if (packet.first_nack_time == Clock::time_point::min()) {
+        packet.first_nack_time = now;
+        ++stats_.num_packets_nacked;
+      }
+      packet.last_nack_time = now;
+      packet.awaiting_retransmit = true;
+      (*nacks)[num_to_send++] = nack;
+    } else if (packet.last_nack_time != Clock::time_point::min()) {
+      ++stats_.num_redundant_nacks_avoided;
+    }
+    still_missing.push_back(packet);
+  }
+
+  nacks->resize(num_to_send);
+  missing_packets_ = std::move(still_missing);
+}
+
+Clock::time_point NackScheduler::GetNextNackTime() const {
+  Clock::time_point next = Clock::time_point::max();
+  for (const MissingPacket& packet : missing_packets_) {
+    next = std::min(next, ComputeNackTime(packet));
+  }
+  return next;
+}
+
+Clock::time_point NackScheduler::ComputeNackTime(
+    const MissingPacket& packet) const {
+  if (packet.last_nack_time == Clock::time_point::min()) {
+    return packet.first_missing_time + reordering_allowance_;
+  }
+  return packet.last_nack_time + GetRenackInterval();
+}
+
+Clock::duration NackScheduler::GetRenackInterval() const {
+  if (round_trip_time_ == Clock::duration::zero()) {
+    return kDefaultRenackInterval;
+  }
+  return std::min(
+      kMaxRenackInterval,
+      std::max(kMinRenackInterval,
+               round_trip_time_ + kRoundTripTimeVariationMultiplier *
+                                      round_trip_time_variation_));
+}
+
+void NackScheduler::AddRoundTripTimeMeasurement(Clock::duration measurement) {
+  if (round_trip_time_ == Clock::duration::zero()) {
+    round_trip_time_ = measurement;
+    round_trip_time_variation_ = measurement / 2;
+    return;
+  }
+  const Clock::duration error = (round_trip_time_ > measurement)
+                                    ? (round_trip_time_ - measurement)
+                                    : (measurement - round_trip_time_);
+  round_trip_time_variation_ = (3 * round_trip_time_variation_ + error) / 4;
+  round_trip_time_ = (7 * round_trip_time_ + measurement) / 8;
+}
+
+void NackScheduler::RecordRecovery(Clock::time_point arrival_time,
+                                   MissingPacket* packet) {
+  if (!packet->awaiting_retransmit) {
+    return;
+  }
+  packet->awaiting_retransmit = false;
+
+  const Clock::duration latency = arrival_time - packet->first_missing_time;
+  ++stats_.num_packets_recovered;
+  stats_.total_recovery_latency += latency;
+  stats_.max_recovery_latency = std::max(stats_.max_recovery_latency, latency);
+
+  // If the packet was NACKed more than once, it is not known which NACK the
+  // retransmit was a response to. Measuring from the last one could
+  // drastically underestimate the round trip time, and so the first one is
+  // used. The resulting overestimates (when a retransmit is lost) are clamped,
+  // so that they do not skew the estimate too much.
+  AddRoundTripTimeMeasurement(std::max(
+      Clock::duration(1),
+      std::min(arrival_time - packet->first_nack_time, kMaxRenackInterval)));
+}
+
+// static
+constexpr Clock::duration NackScheduler::kDefaultRenackInterval;
+constexpr Clock::duration NackScheduler::kMinRenackInterval;
+constexpr Clock::duration NackScheduler::kMaxRenackInterval;
+constexpr Clock::duration NackScheduler::kMaxReorderingAllowance;
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,165 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_NACK_SCHEDULER_H_
+#define CAST_STREAMING_NACK_SCHEDULER_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include "cast/streaming/frame_id.h"
+#include "cast/streaming/rtcp_common.h"
+#include "cast/streaming/rtp_defines.h"
+#include "platform/api/time.h"
+
+namespace openscreen {
+namespace cast {
+
+// Decides which of a Receiver's missing packets should be NACKed, and when,
+// based on the measured round trip time and the amount of packet reordering
+// occurring on the network.
+//
+// A packet is not NACKed the moment it is found to be missing: If the network
+// has recently been reordering packets, the packet is given a short allowance
+// to show up late first. Once NACKed, a packet is not NACKed again until its
+// retransmit should have arrived (i.e., about one round trip later). This
+// prevents frequent feedback from triggering redundant retransmits when the
+// round trip time is long.
+//
+// The Receiver has no direct measurement of the round trip time. Instead, it is
+// estimated from the time elapsed between first NACKing a packet and receiving
+// it, which also accounts for the Sender's own queuing and pacing delays.
+class NackScheduler {
+ public:
+  struct Stats {
+    // The number of packets (or whole frames) that were NACKed at least once.
+    int num_packets_nacked = 0;
+
+    // The number of times a NACK was held back because a retransmit of the
+    // same packet was likely already in-flight.
+    int num_redundant_nacks_avoided = 0;
+
+    // The number of NACKed packets that were later received, and the total and
+    // maximum time from first noticing each was missing until it arrived.
+    int num_packets_recovered = 0;
+    Clock::duration total_recovery_latency = Clock::duration::zero();
+    Clock::duration max_recovery_latency = Clock::duration::zero();
+  };
+
+  NackScheduler();
+  ~NackScheduler();
+
+  // Returns the smoothed round trip time estimate, or zero if not known yet.
+  Clock::duration round_trip_time() const { return round_trip_time_; }
+
+  // Returns how long a missing packet is given to arrive late before it is
+  // NACKed for the first time.
+  Clock::duration reordering_allowance() const {
+    return reordering_allowance_;
+  }
+
+  // Returns the maximum number of sequence numbers by which a packet has
+  // recently arrived out-of-order.
+  int reordering_depth() const { return reordering_depth_; }
+
+  const Stats& stats() const { return stats_; }
+
+  // Called for every valid RTP packet received, in order of arrival, to track
+  // reordering.
+  void OnPacketArrived(Clock::time_point arrival_time,
+                       uint16_t sequence_number);
+
+  // Called when a media packet (i.e., not a FEC packet) is collected, to
+  // measure recovery latency and round trip time if it had been NACKed.
+  void OnPacketCollected(Clock::time_point arrival_time,
+                         FrameId frame_id,
+                         FramePacketId packet_id);
+
+  // Given the sorted list of all currently-missing packets, removes those that
+  // should not be NACKed at this time, and records the rest as NACKed.
+  void FilterNacks(Clock::time_point now, std::vector<PacketNack>* nacks);
+
+  // Returns the time at which the next of the missing packets passed to the
+  // last FilterNacks() call should be NACKed, or Clock::time_point::max() if
+  // there were none.
+  Clock::time_point GetNextNackTime() const;
+
+  // The default amount of time to wait before NACKing a packet again, used
+  // until a round trip time measurement is available.
+  static constexpr Clock::duration kDefaultRenackInterval =
+      std::chrono::milliseconds(30);
+
+  // Bounds on the amount of time to wait before NACKing a packet again.
+  static constexpr Clock::duration kMinRenackInterval =
+      std::chrono::milliseconds(10);
+  static constexpr Clock::duration kMaxRenackInterval =
+      std::chrono::milliseconds(200);
+
+  // Upper-bound on the reordering allowance.
+  static constexpr Clock::duration kMaxReorderingAllowance =
+      std::chrono::milliseconds(40);
+
+ private:
+  // Tracks the NACK state of one missing packet (or whole frame).
+  struct MissingPacket {
+    PacketNack nack;
+
+    // When the packet was first found to be missing.
+    Clock::time_point first_missing_time;
+
+    // When the packet was first and last NACKed, or min() if it has not been.
+    Clock::time_point first_nack_time = Clock::time_point::min();
+    Clock::time_point last_nack_time = Clock::time_point::min();
+
+    // Whether a retransmit is still expected for the last NACK. This only
+    // matters for whole-frame NACKs, which remain tracked until all the frame's
+    // packets are accounted for.
+    bool awaiting_retransmit = false;
+  };
+
+  // An entry in the ring buffer of recent packet arrivals.
+  struct RecentArrival {
+    uint16_t sequence_number = 0;
+    Clock::time_point arrival_time = Clock::time_point::min();
+  };
+
+  // Returns when the given |packet| should next be NACKed.
+  Clock::time_point ComputeNackTime(const MissingPacket& packet) const;
+
+  // Returns how long to wait before NACKing a packet again.
+  Clock::duration GetRenackInterval() const;
+
+  // Updates the round trip time estimate with a new |measurement|.
+  void AddRoundTripTimeMeasurement(Clock::duration measurement);
+
+  // Records that a NACKed packet was received.
+  void RecordRecovery(Clock::time_point arrival_time, MissingPacket* packet);
+
+  // The currently-missing packets, sorted by PacketNack.
+  std::vector<MissingPacket> missing_packets_;
+
+  // Round trip time estimate, smoothed as in TCP (RFC 6298).
+  Clock::duration round_trip_time_ = Clock::duration::zero();
+  Clock::duration round_trip_time_variation_ = Clock::duration::zero();
+
+  // Reordering state. |recent_arrivals_| is indexed by sequence number, modulo
+  // its size, and is used to determine how long after its successors a late
+  // packet arrived.
+  std::array<RecentArrival, 64> recent_arrivals_;
+  bool has_seen_packet_ = false;
+  uint16_t highest_sequence_number_ = 0;
+  Clock::time_point last_reordering_time_ = Clock::time_point::min();
+  Clock::duration reordering_allowance_ = Clock::duration::zero();
+  int reordering_depth_ = 0;
+
+  Stats stats_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_NACK_SCHEDULER_H_
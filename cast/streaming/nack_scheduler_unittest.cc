@@ -0,0 +1,187 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/nack_scheduler.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "platform/api/time.h"
+#include "util/chrono_helpers.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+// Use a fake, fixed start time.
+constexpr Clock::time_point kStartTime =
+    Clock::time_point() + Clock::duration(1234567890);
+
+const FrameId kFrame = FrameId::first() + 5;
+
+// Returns the NACKs the |scheduler| would send at time |now|, given that
+// |missing| are all the packets currently missing.
+std::vector<PacketNack> FilterAt(NackScheduler* scheduler,
+                                 Clock::time_point now,
+                                 std::vector<PacketNack> missing) {
+  scheduler->FilterNacks(now, &missing);
+  return missing;
+}
+
+TEST(NackSchedulerTest, NacksMissingPacketsImmediatelyWithoutReordering) {
+  NackScheduler scheduler;
+  for (int i = 0; i < 10; ++i) {
+    scheduler.OnPacketArrived(kStartTime + milliseconds(i), i);
+  }
+  EXPECT_EQ(Clock::duration::zero(), scheduler.reordering_allowance());
+
+  const std::vector<PacketNack> missing = {{kFrame, FramePacketId{1}},
+                                           {kFrame + 1, kAllPacketsLost}};
+  EXPECT_EQ(missing, FilterAt(&scheduler, kStartTime, missing));
+  EXPECT_EQ(2, scheduler.stats().num_packets_nacked);
+}
+
+// Tests that, until a round trip time measurement is available, missing
+// packets are re-NACKed on a fixed interval.
+TEST(NackSchedulerTest, RenacksOnDefaultIntervalWithoutRoundTripTime) {
+  NackScheduler scheduler;
+  const std::vector<PacketNack> missing = {{kFrame, FramePacketId{2}}};
+  ASSERT_EQ(missing, FilterAt(&scheduler, kStartTime, missing));
+  EXPECT_EQ(kStartTime + NackScheduler::kDefaultRenackInterval,
+            scheduler.GetNextNackTime());
+
+  // Feedback sent for other reasons should not repeat the NACK.
+  EXPECT_TRUE(FilterAt(&scheduler, kStartTime + milliseconds(5), missing)
+                  .empty());
+  EXPECT_EQ(1, scheduler.stats().num_redundant_nacks_avoided);
+
+  EXPECT_EQ(missing,
+            FilterAt(&scheduler,
+                     kStartTime + NackScheduler::kDefaultRenackInterval,
+                     missing));
+  EXPECT_EQ(1, scheduler.stats().num_packets_nacked);
+
+  // Once the packet is no longer missing, there is nothing left to NACK.
+  EXPECT_TRUE(FilterAt(&scheduler, kStartTime + milliseconds(40), {}).empty());
+  EXPECT_EQ(Clock::time_point::max(), scheduler.GetNextNackTime());
+}
+
+// Tests that the time between NACKing a packet and receiving it is used to
+// measure the round trip time, and that re-NACKs are then spaced-out by it.
+TEST(NackSchedulerTest, RenacksBasedOnMeasuredRoundTripTime) {
+  constexpr Clock::duration kRoundTripTime = milliseconds(80);
+  NackScheduler scheduler;
+  Clock::time_point now = kStartTime;
+  for (int i = 0; i < 20; ++i) {
+    const PacketNack nack{kFrame + i, FramePacketId{3}};
+    ASSERT_EQ(std::vector<PacketNack>{nack}, FilterAt(&scheduler, now, {nack}));
+    now += kRoundTripTime;
+    scheduler.OnPacketCollected(now, nack.frame_id, nack.packet_id);
+  }
+  EXPECT_EQ(kRoundTripTime, scheduler.round_trip_time());
+
+  EXPECT_EQ(20, scheduler.stats().num_packets_recovered);
+  EXPECT_EQ(kRoundTripTime, scheduler.stats().max_recovery_latency);
+  EXPECT_EQ(20 * kRoundTripTime, scheduler.stats().total_recovery_latency);
+
+  // A packet that is lost is NACKed again only after its retransmit should
+  // have arrived.
+  const std::vector<PacketNack> missing = {{kFrame + 20, FramePacketId{0}}};
+  ASSERT_EQ(missing, FilterAt(&scheduler, now, missing));
+  EXPECT_GE(scheduler.GetNextNackTime(), now + kRoundTripTime);
+  for (Clock::duration t = milliseconds(10); t < kRoundTripTime;
+       t += milliseconds(10)) {
+    EXPECT_TRUE(FilterAt(&scheduler, now + t, missing).empty());
+  }
+  EXPECT_EQ(missing,
+            FilterAt(&scheduler, scheduler.GetNextNackTime(), missing));
+}
+
+// Tests that, when the network is reordering packets, missing packets are
+// given a chance to arrive late before they are NACKed.
+TEST(NackSchedulerTest, DelaysNacksWhileNetworkReordersPackets) {
+  NackScheduler scheduler;
+  Clock::time_point now = kStartTime;
+  scheduler.OnPacketArrived(now, 65534);
+  scheduler.OnPacketArrived(now, 1);
+  now += milliseconds(3);
+  scheduler.OnPacketArrived(now, 0);
+  scheduler.OnPacketArrived(now, 65535);  // Two sequence numbers late.
+  EXPECT_EQ(milliseconds(3), scheduler.reordering_allowance());
+  EXPECT_EQ(2, scheduler.reordering_depth());
+
+  const std::vector<PacketNack> missing = {{kFrame, FramePacketId{7}}};
+  EXPECT_TRUE(FilterAt(&scheduler, now, missing).empty());
+  EXPECT_EQ(0, scheduler.stats().num_redundant_nacks_avoided);
+  EXPECT_EQ(now + milliseconds(3), scheduler.GetNextNackTime());
+  EXPECT_EQ(missing, FilterAt(&scheduler, now + milliseconds(3), missing));
+
+  // The reordering allowance is forgotten once the network stops reordering
+  // packets.
+  for (int i = 2; i < 100; ++i) {
+    now += milliseconds(50);
+    scheduler.OnPacketArrived(now, i);
+  }
+  EXPECT_EQ(Clock::duration::zero(), scheduler.reordering_allowance());
+  EXPECT_EQ(0, scheduler.reordering_depth());
+}
+
+// Tests that, once the first packet of a frame NACKed as a whole arrives, its
+// other missing packets are not immediately NACKed again, since the whole-frame
+// NACK already requested them.
+TEST(NackSchedulerTest, PacketsInheritWholeFrameNackTiming) {
+  NackScheduler scheduler;
+  const std::vector<PacketNack> whole_frame = {{kFrame, kAllPacketsLost}};
+  ASSERT_EQ(whole_frame, FilterAt(&scheduler, kStartTime, whole_frame));
+
+  const Clock::time_point arrival_time = kStartTime + milliseconds(20);
+  scheduler.OnPacketCollected(arrival_time, kFrame, FramePacketId{0});
+  EXPECT_EQ(1, scheduler.stats().num_packets_recovered);
+  EXPECT_EQ(milliseconds(20), scheduler.round_trip_time());
+
+  const std::vector<PacketNack> remaining = {{kFrame, FramePacketId{1}},
+                                             {kFrame, FramePacketId{2}}};
+  EXPECT_TRUE(FilterAt(&scheduler, arrival_time, remaining).empty());
+  EXPECT_EQ(remaining,
+            FilterAt(&scheduler, scheduler.GetNextNackTime(), remaining));
+  EXPECT_EQ(1, scheduler.stats().num_packets_nacked);
+}
+
+// Simulates a high-latency network path where one in every ten packets is
+// lost, and compares the amount of NACK feedback against that of re-NACKing all
+// missing packets with every report, as sent on a fixed 30 ms interval.
+TEST(NackSchedulerTest, ReducesRedundantNacksOnHighLatencyPath) {
+  constexpr Clock::duration kRoundTripTime = milliseconds(120);
+  constexpr Clock::duration kFeedbackInterval = milliseconds(30);
+  constexpr int kNumLostPackets = 100;
+
+  NackScheduler scheduler;
+  Clock::time_point now = kStartTime;
+  int num_nacks_sent = 0;
+  int num_nacks_sent_without_scheduler = 0;
+  for (int i = 0; i < kNumLostPackets; ++i) {
+    const PacketNack lost{kFrame + i, FramePacketId{9}};
+    const Clock::time_point recovery_time = now + kRoundTripTime;
+    while (now < recovery_time) {
+      num_nacks_sent += FilterAt(&scheduler, now, {lost}).size();
+      ++num_nacks_sent_without_scheduler;
+      now += kFeedbackInterval;
+    }
+    scheduler.OnPacketCollected(recovery_time, lost.frame_id, lost.packet_id);
+  }
+
+  ::testing::Test::RecordProperty("nacks_sent_fixed_interval",
+                                  num_nacks_sent_without_scheduler);
+  ::testing::Test::RecordProperty("nacks_sent_scheduled", num_nacks_sent);
+  EXPECT_EQ(4 * kNumLostPackets, num_nacks_sent_without_scheduler);
+  // Only the first few losses, while the round trip time is unknown, should
+  // have been NACKed more than once.
+  EXPECT_LT(num_nacks_sent, kNumLostPackets + 10);
+  EXPECT_EQ(kNumLostPackets, scheduler.stats().num_packets_nacked);
+  EXPECT_EQ(kNumLostPackets, scheduler.stats().num_packets_recovered);
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
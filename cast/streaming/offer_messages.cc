@@ -147,6 +147,14 @@ ErrorOr<Stream> ParseStream(const Json::Value& value, Stream::Type type) {
 
   auto receiver_rtcp_event_log = json::ParseBool(value, "receiverRtcpEventLog");
   auto receiver_rtcp_dscp = json::ParseString(value, "receiverRtcpDscp");
+
+  // FEC is optional. An out-of-range group size just disables it.
+  auto fec_group_size = json::ParseInt(value, "fecGroupSize");
+  int fec_group_size_value = 0;
+  if (fec_group_size && fec_group_size.value() >= 1 &&
+      fec_group_size.value() <= kMaxFecGroupSize) {
+    fec_group_size_value = fec_group_size.value();
+  }
   return Stream{index.value(),
                 type,
                 channels.value(type == Stream::Type::kAudioSource
@@ -159,7 +167,8 @@ ErrorOr<Stream> ParseStream(const Json::Value& value, Stream::Type type) {
                 aes_iv_mask.value(),
                 receiver_rtcp_event_log.value({}),
                 receiver_rtcp_dscp.value({}),
-                rtp_timebase.value()};
+                rtp_timebase.value(),
+                fec_group_size_value};
 }
 
 ErrorOr<AudioStream> ParseAudioStream(const Json::Value& value) {
@@ -288,7 +297,8 @@ EnumNameTable<CastMode, 2> kCastModeNames{
 ErrorOr<Json::Value> Stream::ToJson() const {
   if (channels < 1 || index < 0 || target_delay.count() <= 0 ||
       target_delay.count() > std::numeric_limits<int>::max() ||
-      rtp_timebase < 1) {
+      rtp_timebase < 1 || fec_group_size < 0 ||
+      fec_group_size > kMaxFecGroupSize) {
     return json::CreateParameterError("Stream");
   }
 
@@ -309,6 +319,9 @@ ErrorOr<Json::Value> Stream::ToJson() const {
   root["receiverRtcpEventLog"] = receiver_rtcp_event_log;
   root["receiverRtcpDscp"] = receiver_rtcp_dscp;
   root["timeBase"] = "1/" + std::to_string(rtp_timebase);
+  if (fec_group_size > 0) {
+    root["fecGroupSize"] = fec_group_size;
+  }
   return root;
 }
 
@@ -33,6 +33,10 @@ constexpr auto kMaxTargetPlayoutDelay = std::chrono::milliseconds(5000);
 // be set to kDefaultMaxFrameRate.
 constexpr int kDefaultMaxFrameRate = 30;
 
+// If the FEC group size provided by the sender is not bounded by
+// [1, kMaxFecGroupSize], FEC will not be used for the stream.
+constexpr int kMaxFecGroupSize = 64;
+
 constexpr int kDefaultNumVideoChannels = 1;
 constexpr int kDefaultNumAudioChannels = 2;
 
@@ -63,6 +67,11 @@ struct Stream {
   bool receiver_rtcp_event_log = {};
   std::string receiver_rtcp_dscp = {};
   int rtp_timebase = 0;
+
+  // The number of RTP packets protected by each FEC packet the sender proposes
+  // to send, or zero if the sender does not offer FEC for this stream. The
+  // receiver accepts FEC via Answer::fec_enabled_indexes.
+  int fec_group_size = 0;
 };
 
 struct AudioStream {
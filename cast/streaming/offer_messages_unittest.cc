@@ -62,6 +62,7 @@ constexpr char kValidOffer[] = R"({
       "ssrc": 19088744,
       "maxFrameRate": "30000/1001",
       "targetDelay": 1000,
+      "fecGroupSize": 8,
       "timeBase": "1/90000",
       "maxBitRate": 5000000,
       "profile": "main",
@@ -121,6 +122,7 @@ void ExpectEqualsValidOffer(const Offer& offer) {
   EXPECT_EQ(5000000, vs_one.max_bit_rate);
   EXPECT_EQ("main", vs_one.profile);
   EXPECT_EQ("4", vs_one.level);
+  EXPECT_EQ(0, vs_one.stream.fec_group_size);
   EXPECT_THAT(vs_one.stream.aes_key,
               ElementsAre(0x04, 0x0d, 0x75, 0x67, 0x91, 0x71, 0x1f, 0xd3, 0xad,
                           0xb9, 0x39, 0x06, 0x6e, 0x6d, 0x86, 0x90));
@@ -153,6 +155,7 @@ void ExpectEqualsValidOffer(const Offer& offer) {
   EXPECT_EQ(5000000, vs_two.max_bit_rate);
   EXPECT_EQ("main", vs_two.profile);
   EXPECT_EQ("5", vs_two.level);
+  EXPECT_EQ(8, vs_two.stream.fec_group_size);
   EXPECT_THAT(vs_two.stream.aes_key,
               ElementsAre(0xbb, 0xf1, 0x09, 0xbf, 0x84, 0x51, 0x3b, 0x45, 0x6b,
                           0x13, 0xa1, 0x84, 0x45, 0x3b, 0x66, 0xce));
@@ -276,6 +279,31 @@ TEST(OfferTest, CanParseValidZeroBitRateAudioOffer) {
   EXPECT_TRUE(offer.is_value()) << offer.error();
 }
 
+TEST(OfferTest, IgnoresOutOfRangeFecGroupSize) {
+  ErrorOr<Json::Value> root = json::Parse(R"({
+    "castMode": "mirroring",
+    "supportedStreams": [{
+      "index": 2,
+      "type": "audio_source",
+      "codecName": "opus",
+      "rtpProfile": "cast",
+      "rtpPayloadType": 96,
+      "ssrc": 19088743,
+      "bitRate": 124000,
+      "timeBase": "1/48000",
+      "channels": 2,
+      "fecGroupSize": 1000,
+      "aesKey": "51027e4e2347cbcb49d57ef10177aebc",
+      "aesIvMask": "7f12a19be62a36c04ae4116caaeff6d1"
+    }]
+  })");
+  ASSERT_TRUE(root.is_value());
+  const ErrorOr<Offer> offer = Offer::Parse(std::move(root.value()));
+  ASSERT_TRUE(offer.is_value()) << offer.error();
+  ASSERT_EQ(1u, offer.value().audio_streams.size());
+  EXPECT_EQ(0, offer.value().audio_streams[0].stream.fec_group_size);
+}
+
 TEST(OfferTest, ErrorOnInvalidRtpTimebase) {
   ExpectFailureOnParse(R"({
     "castMode": "mirroring",
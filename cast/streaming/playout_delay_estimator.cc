@@ -0,0 +1,164 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/playout_delay_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+using std::chrono::milliseconds;
+
+namespace {
+
+// The percentile of the recent frames' needed delays that must be covered
+// before the delay is increased, and the extra margin added on top of it. The
+// delay is only decreased as far as it would still cover all recent frames.
+constexpr double kNeededDelayPercentile = 0.99;
+constexpr milliseconds kSafetyMargin{10};
+
+// If more than this fraction of recent frames were dropped, escalate the delay
+// by at least this factor.
+constexpr double kMaxLateFrameRate = 0.01;
+constexpr double kEscalationFactor = 1.25;
+
+// A decrease is only proposed if it would be at least this fraction of the
+// current delay, and only once this much time has passed since the last change.
+// Each decrease is limited to this fraction of the current delay, so that the
+// playout times of consecutive frames do not jump backwards by much.
+constexpr double kMinDecreaseFraction = 0.05;
+constexpr Clock::duration kMinTimeBeforeDecrease = std::chrono::seconds(1);
+constexpr double kMaxDecreaseFraction = 0.1;
+
+// Marks a dropped frame in |frame_outcomes_|.
+constexpr Clock::duration kDroppedFrame{-1};
+
+// Converts |duration| to whole milliseconds, rounding up.
+milliseconds CeilToMilliseconds(
+    std::chrono::duration<double, std::milli> duration) {
+  return milliseconds(
+      static_cast<milliseconds::rep>(std::ceil(duration.count())));
+}
+
+}  // namespace
+
+PlayoutDelayEstimator::PlayoutDelayEstimator(milliseconds min_delay,
+                                             milliseconds max_delay)
+    : min_delay_(min_delay), max_delay_(max_delay) {
+  OSP_DCHECK_GT(min_delay_, milliseconds::zero());
+  OSP_DCHECK_LE(min_delay_, max_delay_);
+}
+
+PlayoutDelayEstimator::~PlayoutDelayEstimator() = default;
+
+void PlayoutDelayEstimator::OnFrameCompleted(Clock::duration needed_delay) {
+  AddFrameOutcome(std::max(needed_delay, Clock::duration::zero()));
+}
+
+void PlayoutDelayEstimator::OnFrameDropped() {
+  ++num_dropped_in_window_;
+  AddFrameOutcome(kDroppedFrame);
+}
+
+double PlayoutDelayEstimator::GetLateFrameRate() const {
+  if (frame_outcomes_.empty()) {
+    return 0.0;
+  }
+  return static_cast<double>(num_dropped_in_window_) / frame_outcomes_.size();
+}
+
+milliseconds PlayoutDelayEstimator::ProposeDelay(Clock::time_point now,
+                                                 milliseconds current_delay) {
+  if (static_cast<int>(frame_outcomes_.size()) < kMinFramesForProposal) {
+    return current_delay;
+  }
+
+  // Determine the delay needed to cover nearly all of the recent frames, and to
+  // cover all of them. The delay that would have been needed by a dropped frame
+  // is unknown, but it was certainly more than the current delay.
+  const Clock::duration escalated_delay =
+      std::chrono::duration_cast<Clock::duration>(current_delay *
+                                                  kEscalationFactor);
+  std::vector<Clock::duration> needed_delays(frame_outcomes_.begin(),
+                                             frame_outcomes_.end());
+  std::replace(needed_delays.begin(), needed_delays.end(), kDroppedFrame,
+               escalated_delay);
+  const auto percentile_it =
+      needed_delays.begin() +
+      static_cast<int>((needed_delays.size() - 1) * kNeededDelayPercentile);
+  std::nth_element(needed_delays.begin(), percentile_it, needed_delays.end());
+  milliseconds increase_target =
+      CeilToMilliseconds(*percentile_it) + kSafetyMargin;
+  if (GetLateFrameRate() > kMaxLateFrameRate) {
+    increase_target =
+        std::max(increase_target, CeilToMilliseconds(escalated_delay));
+  }
+  const milliseconds decrease_target =
+      CeilToMilliseconds(
+          *std::max_element(percentile_it, needed_delays.end())) +
+      kSafetyMargin;
+
+  const auto ClampToRange = [this](milliseconds delay) {
+    return std::min(max_delay_, std::max(min_delay_, delay));
+  };
+  milliseconds proposal;
+  if (current_delay < min_delay_ || current_delay > max_delay_) {
+    // Immediately bring the current delay into the configured range (e.g.,
+    // when the Sender requested a delay outside of it).
+    proposal = ClampToRange(std::max(increase_target, decrease_target));
+  } else if (increase_target > current_delay) {
+    proposal = ClampToRange(increase_target);
+  } else if (decrease_target < current_delay) {
+    // Rate-limit decreases, and ignore insignificant ones.
+    if (last_change_time_ != Clock::time_point::min() &&
+        (now - last_change_time_) < kMinTimeBeforeDecrease) {
+      return current_delay;
+    }
+    proposal = ClampToRange(decrease_target);
+    if ((current_delay - proposal) < current_delay * kMinDecreaseFraction &&
+        proposal != min_delay_) {
+      return current_delay;
+    }
+    proposal = std::max(
+        proposal,
+        CeilToMilliseconds(current_delay * (1.0 - kMaxDecreaseFraction)));
+  } else {
+    return current_delay;
+  }
+  if (proposal == current_delay) {
+    return current_delay;
+  }
+
+  // The dropped frames were dropped under the prior delay setting, and should
+  // not cause further escalation. However, the needed delays of the completed
+  // frames remain valid measurements of the network.
+  frame_outcomes_.erase(std::remove(frame_outcomes_.begin(),
+                                    frame_outcomes_.end(), kDroppedFrame),
+                        frame_outcomes_.end());
+  num_dropped_in_window_ = 0;
+  last_change_time_ = now;
+  return proposal;
+}
+
+void PlayoutDelayEstimator::AddFrameOutcome(Clock::duration outcome) {
+  frame_outcomes_.push_back(outcome);
+  if (static_cast<int>(frame_outcomes_.size()) > kWindowSize) {
+    if (frame_outcomes_.front() == kDroppedFrame) {
+      --num_dropped_in_window_;
+    }
+    frame_outcomes_.pop_front();
+  }
+}
+
+// static
+constexpr int PlayoutDelayEstimator::kWindowSize;
+constexpr int PlayoutDelayEstimator::kMinFramesForProposal;
+
+}  // namespace cast
+}  // namespace openscreen
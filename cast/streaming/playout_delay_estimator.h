@@ -0,0 +1,82 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_PLAYOUT_DELAY_ESTIMATOR_H_
+#define CAST_STREAMING_PLAYOUT_DELAY_ESTIMATOR_H_
+
+#include <chrono>
+#include <deque>
+
+#include "platform/api/time.h"
+
+namespace openscreen {
+namespace cast {
+
+// Proposes the minimal target playout delay, within a configured range, that
+// allows nearly all frames to be completely received in time for playout.
+//
+// For each frame, the "needed delay" is how long after its capture the frame
+// was completely received (plus the player's own processing time). The
+// variation of this ("jitter") over a recent window of frames determines the
+// proposed delay: It is increased as soon as a high percentile of the needed
+// delays, plus a safety margin, exceeds it. If frames are being dropped because
+// they arrive too late, it is escalated more aggressively.
+//
+// Decreases are proposed gradually, only after the delay has been stable for a
+// while, and only as far as would still have covered all of the recent frames.
+// This avoids oscillating, and limits how far backwards the playout times of
+// consecutive frames can jump.
+class PlayoutDelayEstimator {
+ public:
+  PlayoutDelayEstimator(std::chrono::milliseconds min_delay,
+                        std::chrono::milliseconds max_delay);
+  ~PlayoutDelayEstimator();
+
+  std::chrono::milliseconds min_delay() const { return min_delay_; }
+  std::chrono::milliseconds max_delay() const { return max_delay_; }
+
+  // Records that a frame was completely received, and the |needed_delay| that
+  // would have allowed it to play out on-time.
+  void OnFrameCompleted(Clock::duration needed_delay);
+
+  // Records that a frame was dropped because it was not completely received in
+  // time for playout.
+  void OnFrameDropped();
+
+  // Returns the fraction of the frames in the recent window that were dropped.
+  double GetLateFrameRate() const;
+
+  // Returns the target playout delay that should be used from now on, given
+  // the |current_delay|. If no change is warranted, |current_delay| is
+  // returned.
+  std::chrono::milliseconds ProposeDelay(
+      Clock::time_point now,
+      std::chrono::milliseconds current_delay);
+
+  // The number of recent frames considered, and the minimum number needed
+  // before any change will be proposed.
+  static constexpr int kWindowSize = 300;
+  static constexpr int kMinFramesForProposal = 30;
+
+ private:
+  // Adds the |outcome| of one frame to the window, evicting the oldest one if
+  // the window is full.
+  void AddFrameOutcome(Clock::duration outcome);
+
+  // The outcomes of the recent frames: Either each frame's needed delay, or a
+  // negative value indicating it was dropped.
+  std::deque<Clock::duration> frame_outcomes_;
+  int num_dropped_in_window_ = 0;
+
+  const std::chrono::milliseconds min_delay_;
+  const std::chrono::milliseconds max_delay_;
+
+  // When the last change was proposed.
+  Clock::time_point last_change_time_ = Clock::time_point::min();
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_PLAYOUT_DELAY_ESTIMATOR_H_
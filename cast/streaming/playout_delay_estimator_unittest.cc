@@ -0,0 +1,138 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/playout_delay_estimator.h"
+
+#include <algorithm>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "platform/api/time.h"
+#include "util/chrono_helpers.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+// Use a fake, fixed start time.
+constexpr Clock::time_point kStartTime =
+    Clock::time_point() + Clock::duration(1234567890);
+
+constexpr Clock::duration kFrameInterval = milliseconds(33);
+constexpr milliseconds kMinDelay{50};
+constexpr milliseconds kMaxDelay{1000};
+
+TEST(PlayoutDelayEstimatorTest, DoesNotProposeChangesWithoutEnoughFrames) {
+  PlayoutDelayEstimator estimator(kMinDelay, kMaxDelay);
+  Clock::time_point now = kStartTime;
+  for (int i = 1; i < PlayoutDelayEstimator::kMinFramesForProposal; ++i) {
+    estimator.OnFrameCompleted(milliseconds(300));
+    EXPECT_EQ(milliseconds(100),
+              estimator.ProposeDelay(now, milliseconds(100)));
+    now += kFrameInterval;
+  }
+}
+
+// Tests that the delay is increased immediately to cover nearly all the frames,
+// and by more if frames have been dropped.
+TEST(PlayoutDelayEstimatorTest, IncreasesDelayToCoverJitter) {
+  PlayoutDelayEstimator estimator(kMinDelay, kMaxDelay);
+  for (int i = 0; i < 100; ++i) {
+    estimator.OnFrameCompleted(milliseconds(50 + (i % 20) * 10));
+  }
+  // The 99th percentile is 240 ms, plus a safety margin.
+  EXPECT_EQ(milliseconds(250), estimator.ProposeDelay(kStartTime, kMinDelay));
+
+  // Once the delay covers the window, no further change is proposed.
+  EXPECT_EQ(milliseconds(250),
+            estimator.ProposeDelay(kStartTime, milliseconds(250)));
+
+  for (int i = 0; i < 40; ++i) {
+    if (i % 10 == 0) {
+      estimator.OnFrameDropped();
+    } else {
+      estimator.OnFrameCompleted(milliseconds(100));
+    }
+  }
+  EXPECT_DOUBLE_EQ(4.0 / 140, estimator.GetLateFrameRate());
+  EXPECT_GE(estimator.ProposeDelay(kStartTime, milliseconds(250)),
+            milliseconds(300));
+}
+
+// Tests that the delay is decreased gradually once the network is stable, and
+// never outside of the configured range.
+TEST(PlayoutDelayEstimatorTest, DecreasesDelayGraduallyWithinRange) {
+  PlayoutDelayEstimator estimator(kMinDelay, kMaxDelay);
+  milliseconds delay{2000};
+  Clock::time_point now = kStartTime;
+  Clock::time_point last_change_time = Clock::time_point::min();
+  int num_changes = 0;
+  for (int i = 0; i < 10000 && delay != kMinDelay; ++i) {
+    estimator.OnFrameCompleted(milliseconds(20));
+    const milliseconds proposal = estimator.ProposeDelay(now, delay);
+    if (proposal != delay) {
+      if (num_changes > 0) {
+        EXPECT_LE(seconds(1), now - last_change_time);
+        EXPECT_LE(delay - proposal, delay / 10 + milliseconds(1));
+      }
+      ++num_changes;
+      last_change_time = now;
+      delay = proposal;
+      ASSERT_LE(delay, kMaxDelay);
+      ASSERT_GE(delay, kMinDelay);
+    }
+    now += kFrameInterval;
+  }
+  EXPECT_EQ(kMinDelay, delay);
+  EXPECT_LT(now - kStartTime, seconds(60));
+}
+
+// Simulates a jittery network path, where frames usually take 40-80 ms to be
+// received, but about one in 50 takes much longer. Compares the adaptive delay
+// against the Sender's conservative default of 400 ms.
+TEST(PlayoutDelayEstimatorTest, ConvergesToMinimalDelayOnJitteryNetwork) {
+  constexpr milliseconds kDefaultDelay{400};
+  constexpr int kNumFrames = 30 * 120;  // Two minutes at 30 FPS.
+
+  std::minstd_rand random(42);
+  std::uniform_int_distribution<int> base_delay_ms(40, 80);
+  std::uniform_int_distribution<int> spike_delay_ms(100, 180);
+  std::uniform_int_distribution<int> percent(0, 99);
+
+  PlayoutDelayEstimator estimator(kMinDelay, kMaxDelay);
+  milliseconds delay = kDefaultDelay;
+  Clock::time_point now = kStartTime;
+  int num_dropped = 0;
+  int64_t total_delay_ms = 0;
+  for (int i = 0; i < kNumFrames; ++i) {
+    const milliseconds needed_delay(percent(random) < 2
+                                        ? spike_delay_ms(random)
+                                        : base_delay_ms(random));
+    if (needed_delay > delay) {
+      ++num_dropped;
+      estimator.OnFrameDropped();
+    } else {
+      estimator.OnFrameCompleted(needed_delay);
+    }
+    total_delay_ms += delay.count();
+    delay = estimator.ProposeDelay(now, delay);
+    now += kFrameInterval;
+  }
+
+  const double average_delay_ms =
+      static_cast<double>(total_delay_ms) / kNumFrames;
+  ::testing::Test::RecordProperty("average_delay_ms",
+                                  static_cast<int>(average_delay_ms));
+  ::testing::Test::RecordProperty("final_delay_ms",
+                                  static_cast<int>(delay.count()));
+  ::testing::Test::RecordProperty("frames_dropped", num_dropped);
+  EXPECT_LT(average_delay_ms, kDefaultDelay.count() / 2);
+  EXPECT_GT(delay, milliseconds(80));
+  EXPECT_LT(delay, milliseconds(200));
+  EXPECT_LT(num_dropped, kNumFrames / 100);
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
@@ -45,12 +45,15 @@ Receiver::Receiver(Environment* environment,
       rtcp_buffer_(new uint8_t[rtcp_buffer_capacity_]),
       rtcp_alarm_(environment->now_function(), environment->task_runner()),
       smoothed_clock_offset_(ClockDriftSmoother::kDefaultTimeConstant),
+      pending_frames_(config.max_unacked_frames),
       consumption_alarm_(environment->now_function(),
                          environment->task_runner()) {
   OSP_DCHECK(packet_router_);
   OSP_DCHECK_EQ(checkpoint_frame(), FrameId::leader());
   OSP_CHECK_GT(rtcp_buffer_capacity_, 0);
   OSP_CHECK(rtcp_buffer_);
+  OSP_DCHECK_GE(config.max_unacked_frames, kMinUnackedFrames);
+  OSP_DCHECK_LE(config.max_unacked_frames, kMaxUnackedFrames);
 
   rtcp_builder_.SetPlayoutDelay(config.target_playout_delay);
   playout_delay_changes_.emplace_back(FrameId::leader(),
@@ -63,6 +66,17 @@ Receiver::~Receiver() {
   packet_router_->OnReceiverDestroyed(rtcp_session_.sender_ssrc());
 }
 
+void Receiver::EnableFrameTimelines(FrameTimelineRecorder::Client* client) {
+  frame_timelines_.emplace("Receiver::Frame", ssrc(),
+                           static_cast<int>(pending_frames_.size()), client);
+}
+
+ReceiverStats Receiver::GetStats() const {
+  ReceiverStats stats = stats_;
+  stats.round_trip_time = nack_scheduler_.round_trip_time();
+  return stats;
+}
+
 void Receiver::SetConsumer(Consumer* consumer) {
   consumer_ = consumer;
   ScheduleFrameReadyCheck();
@@ -72,6 +86,11 @@ void Receiver::SetPlayerProcessingTime(Clock::duration needed_time) {
   player_processing_time_ = std::max(Clock::duration::zero(), needed_time);
 }
 
+void Receiver::EnableAdaptivePlayoutDelay(milliseconds min_delay,
+                                          milliseconds max_delay) {
+  playout_delay_estimator_.emplace(min_delay, max_delay);
+}
+
 void Receiver::RequestKeyFrame() {
   // If we don't have picture loss indication enabled, we should not request
   // any key frames.
@@ -141,12 +160,21 @@ EncodedFrame Receiver::ConsumeNextFrame(absl::Span<uint8_t> buffer) {
   const FrameId frame_id = last_frame_consumed_ + 1;
   OSP_CHECK_LE(frame_id, checkpoint_frame());
 
-  // Decrypt the frame, populating the given output |frame|.
+  // Decrypt the frame, populating the given output |frame|. The decrypt time is
+  // measured using the real clock, since it is CPU time and not media time.
   PendingFrame& entry = GetQueueEntry(frame_id);
   OSP_DCHECK(entry.collector.is_complete());
   EncodedFrame frame;
   frame.data = buffer;
+  const Clock::time_point decrypt_start_time = Clock::now();
   crypto_.Decrypt(entry.collector.PeekAtAssembledFrame(), &frame);
+  stats_.decrypt_time_us.Add(
+      to_microseconds(Clock::now() - decrypt_start_time).count());
+  ++stats_.num_frames_consumed;
+  if (frame_timelines_) {
+    frame_timelines_->RecordStage(frame_id, FrameStage::kConsumed, now_());
+    frame_timelines_->FinishFrame(frame_id, false);
+  }
   OSP_DCHECK(entry.estimated_capture_time);
   frame.reference_time =
       *entry.estimated_capture_time + ResolveTargetPlayoutDelay(frame_id);
@@ -182,6 +210,8 @@ void Receiver::OnReceivedRtpPacket(Clock::time_point arrival_time,
   }
   stats_tracker_.OnReceivedValidRtpPacket(part->sequence_number,
                                           part->rtp_timestamp, arrival_time);
+  ++stats_.num_packets_received;
+  nack_scheduler_.OnPacketArrived(arrival_time, part->sequence_number);
 
   // Ignore packets for frames the Receiver is no longer interested in.
   if (part->frame_id <= checkpoint_frame()) {
@@ -193,7 +223,7 @@ void Receiver::OnReceivedRtpPacket(Clock::time_point arrival_time,
   // newly-discovered frames.
   if (part->frame_id > latest_frame_expected_) {
     const FrameId max_allowed_frame_id =
-        last_frame_consumed_ + kMaxUnackedFrames;
+        last_frame_consumed_ + static_cast<int>(pending_frames_.size());
     if (part->frame_id > max_allowed_frame_id) {
       RECEIVER_VLOG << "Dropping RTP packet for " << part->frame_id
                     << ": Too many frames are already in-flight.";
@@ -233,12 +263,33 @@ void Receiver::OnReceivedRtpPacket(Clock::time_point arrival_time,
   if (!collector.CollectRtpPacket(*part, &packet)) {
     return;  // Bad data in the parsed packet. Ignore it.
   }
+  if (!pending_frame.first_packet_arrival_time) {
+    pending_frame.first_packet_arrival_time = arrival_time;
+    if (frame_timelines_) {
+      frame_timelines_->RecordStage(
+          part->frame_id, FrameStage::kFirstPacketReceived, arrival_time);
+    }
+  }
+  if (part->fec_protected_packet_count == 0) {
+    nack_scheduler_.OnPacketCollected(arrival_time, part->frame_id,
+                                      part->packet_id);
+  }
+
+  // Record the packet's arrival time, to be reported to the Sender for its
+  // delay-based congestion control. If too many have accumulated since the last
+  // RTCP packet was sent, just drop the information.
+  // FEC packets are excluded, since the Sender does not track their send times.
+  if (part->fec_protected_packet_count == 0 &&
+      static_cast<int>(packet_arrivals_.size()) < kMaxPacketArrivalsPerReport) {
+    packet_arrivals_.push_back(
+        PacketArrival{part->frame_id, part->packet_id, arrival_time});
+  }
 
   // The first packet in a frame contains timing information critical for
   // computing this frame's (and all future frames') playout time. Process that,
-  // but only once.
-  if (part->packet_id == FramePacketId{0} &&
-      !pending_frame.estimated_capture_time) {
+  // but only once. Note that the first packet may also have just been recovered
+  // via FEC.
+  if (collector.has_first_packet() && !pending_frame.estimated_capture_time) {
     // Estimate the original capture time of this frame (at the Sender), in
     // terms of the Receiver's clock: First, start with a reference time point
     // from the Sender's clock (the one from the last Sender Report). Then,
@@ -248,15 +299,20 @@ void Receiver::OnReceivedRtpPacket(Clock::time_point arrival_time,
     // this frame to determine what the original capture time of this frame was.
     pending_frame.estimated_capture_time =
         last_sender_report_->reference_time + smoothed_clock_offset_.Current() +
-        (part->rtp_timestamp - last_sender_report_->rtp_timestamp)
+        (collector.rtp_timestamp() - last_sender_report_->rtp_timestamp)
             .ToDuration<Clock::duration>(rtp_timebase_);
+    if (frame_timelines_) {
+      frame_timelines_->RecordStage(part->frame_id, FrameStage::kCaptured,
+                                    *pending_frame.estimated_capture_time);
+    }
 
     // If a target playout delay change was included in this packet, record it.
-    if (part->new_playout_delay > milliseconds::zero()) {
+    if (collector.new_playout_delay() > milliseconds::zero()) {
       RECEIVER_VLOG << "Target playout delay changes to "
-                    << part->new_playout_delay.count() << " ms, as of "
+                    << collector.new_playout_delay().count() << " ms, as of "
                     << part->frame_id;
-      RecordNewTargetPlayoutDelay(part->frame_id, part->new_playout_delay);
+      RecordNewTargetPlayoutDelay(part->frame_id,
+                                  collector.new_playout_delay());
     }
 
     // Now that the estimated capture time is known, other frames may have just
@@ -268,6 +324,23 @@ void Receiver::OnReceivedRtpPacket(Clock::time_point arrival_time,
     return;  // Wait for the rest of the packets to come in.
   }
   const EncryptedFrame& encrypted_frame = collector.PeekAtAssembledFrame();
+  ++stats_.num_frames_completed;
+  stats_.frame_completion_latency_ms.Add(
+      to_milliseconds(arrival_time - *pending_frame.first_packet_arrival_time)
+          .count());
+  if (frame_timelines_) {
+    frame_timelines_->RecordStage(part->frame_id, FrameStage::kCompleted,
+                                  arrival_time);
+  }
+
+  // Track how long after capture the frame was completed, for adapting the
+  // target playout delay.
+  if (playout_delay_estimator_ && pending_frame.estimated_capture_time) {
+    playout_delay_estimator_->OnFrameCompleted(
+        arrival_time - *pending_frame.estimated_capture_time +
+        player_processing_time_);
+    MaybeAdaptTargetPlayoutDelay(arrival_time);
+  }
 
   // Whenever a key frame has been received, the decoder has what it needs to
   // recover. In this case, clear the PLI condition.
@@ -339,11 +412,21 @@ void Receiver::SendRtcp() {
     }
   }
 
+  // Only NACK those missing packets that are not likely to arrive late, or to
+  // already have a retransmit in-flight.
+  const bool has_missing_packets = !packet_nacks.empty();
+  last_rtcp_send_time_ = now_();
+  nack_scheduler_.FilterNacks(last_rtcp_send_time_, &packet_nacks);
+  stats_.num_nacks_sent += static_cast<int>(packet_nacks.size());
+  if (rtcp_builder_.is_picture_loss_indicator_set()) {
+    ++stats_.num_plis_sent;
+  }
+
   // Build and send a compound RTCP packet.
-  const bool no_nacks = packet_nacks.empty();
   rtcp_builder_.IncludeFeedbackInNextPacket(std::move(packet_nacks),
                                             std::move(frame_acks));
-  last_rtcp_send_time_ = now_();
+  rtcp_builder_.IncludePacketArrivalsInNextPacket(std::move(packet_arrivals_));
+  packet_arrivals_.clear();
   packet_router_->SendRtcpPacket(rtcp_builder_.BuildPacket(
       last_rtcp_send_time_,
       absl::Span<uint8_t>(rtcp_buffer_.get(), rtcp_buffer_capacity_)));
@@ -351,11 +434,25 @@ void Receiver::SendRtcp() {
 
   // Schedule the automatic sending of another RTCP packet, if this method is
   // not called within some bounded amount of time. While incomplete frames
-  // exist in the queue, send RTCP packets (with ACK/NACK feedback) frequently.
-  // When there are no incomplete frames, use a longer "keepalive" interval.
-  const Clock::duration interval =
-      (no_nacks ? kRtcpReportInterval : kNackFeedbackInterval);
-  rtcp_alarm_.Schedule([this] { SendRtcp(); }, last_rtcp_send_time_ + interval);
+  // exist in the queue, send RTCP packets (with ACK/NACK feedback) as soon as
+  // the next NACK is due. When there are no incomplete frames, use a longer
+  // "keepalive" interval.
+  Clock::time_point next_send_time = last_rtcp_send_time_ + kRtcpReportInterval;
+  if (has_missing_packets) {
+    next_send_time =
+        std::max(last_rtcp_send_time_ + kMinNackFeedbackInterval,
+                 std::min(next_send_time, nack_scheduler_.GetNextNackTime()));
+  }
+  rtcp_alarm_.Schedule(
+      [this, next_send_time] {
+        // Track how late this RTCP packet is being sent. Consistent lateness
+        // means the TaskRunner is being starved by other work (e.g., decoding
+        // on the same thread), which delays the Sender's feedback.
+        stats_.rtcp_send_lateness_ms.Add(
+            to_milliseconds(now_() - next_send_time).count());
+        SendRtcp();
+      },
+      next_send_time);
 }
 
 const Receiver::PendingFrame& Receiver::GetQueueEntry(FrameId frame_id) const {
@@ -412,6 +509,23 @@ milliseconds Receiver::ResolveTargetPlayoutDelay(FrameId frame_id) const {
   return it->second;
 }
 
+void Receiver::MaybeAdaptTargetPlayoutDelay(Clock::time_point now) {
+  OSP_DCHECK(playout_delay_estimator_);
+  const milliseconds current_delay = playout_delay_changes_.back().second;
+  const milliseconds new_delay =
+      playout_delay_estimator_->ProposeDelay(now, current_delay);
+  if (new_delay == current_delay) {
+    return;
+  }
+  // Frames already seen keep their current playout delay setting, since their
+  // playout times may already have been communicated to the Consumer.
+  const FrameId as_of_frame = latest_frame_expected_ + 1;
+  RECEIVER_LOG(INFO) << "Adapting target playout delay from "
+                     << current_delay.count() << " to " << new_delay.count()
+                     << " ms, as of " << as_of_frame;
+  RecordNewTargetPlayoutDelay(as_of_frame, new_delay);
+}
+
 void Receiver::AdvanceCheckpoint(FrameId new_checkpoint) {
   OSP_DCHECK_GT(new_checkpoint, checkpoint_frame());
   OSP_DCHECK_LE(new_checkpoint, latest_frame_expected_);
@@ -444,9 +558,19 @@ void Receiver::DropAllFramesBefore(FrameId first_kept_frame) {
     // Pedantic sanity-check: Ensure the "target playout delay change" data
     // dependency was satisfied. See comments in AdvanceToNextFrame().
     OSP_DCHECK(entry.estimated_capture_time);
+    if (playout_delay_estimator_ && !entry.collector.is_complete()) {
+      playout_delay_estimator_->OnFrameDropped();
+    }
+    ++stats_.num_frames_dropped_late;
+    if (frame_timelines_) {
+      frame_timelines_->FinishFrame(f, true);
+    }
     entry.Reset();
   }
   last_frame_consumed_ = first_kept_frame - 1;
+  if (playout_delay_estimator_) {
+    MaybeAdaptTargetPlayoutDelay(now_());
+  }
 
   RECEIVER_LOG(INFO) << "Artificially advancing checkpoint after skipping.";
   AdvanceCheckpoint(first_kept_frame);
@@ -458,6 +582,10 @@ void Receiver::ScheduleFrameReadyCheck(Clock::time_point when) {
         if (consumer_) {
           const int next_frame_buffer_size = AdvanceToNextFrame();
           if (next_frame_buffer_size != kNoFramesReady) {
+            if (frame_timelines_) {
+              frame_timelines_->RecordStage(last_frame_consumed_ + 1,
+                                            FrameStage::kReady, now_());
+            }
             consumer_->OnFramesReady(next_frame_buffer_size);
           }
         }
@@ -473,12 +601,14 @@ Receiver::PendingFrame::~PendingFrame() = default;
 void Receiver::PendingFrame::Reset() {
   collector.Reset();
   estimated_capture_time = absl::nullopt;
+  first_packet_arrival_time = absl::nullopt;
 }
 
 // static
 constexpr milliseconds Receiver::kDefaultPlayerProcessingTime;
 constexpr int Receiver::kNoFramesReady;
-constexpr milliseconds Receiver::kNackFeedbackInterval;
+constexpr milliseconds Receiver::kMinNackFeedbackInterval;
+constexpr int Receiver::kMaxPacketArrivalsPerReport;
 
 }  // namespace cast
 }  // namespace openscreen
@@ -7,7 +7,6 @@
 
 #include <stdint.h>
 
-#include <array>
 #include <chrono>
 #include <memory>
 #include <utility>
@@ -20,13 +19,17 @@
 #include "cast/streaming/environment.h"
 #include "cast/streaming/frame_collector.h"
 #include "cast/streaming/frame_id.h"
+#include "cast/streaming/frame_timeline.h"
+#include "cast/streaming/nack_scheduler.h"
 #include "cast/streaming/packet_receive_stats_tracker.h"
+#include "cast/streaming/playout_delay_estimator.h"
 #include "cast/streaming/rtcp_common.h"
 #include "cast/streaming/rtcp_session.h"
 #include "cast/streaming/rtp_packet_parser.h"
 #include "cast/streaming/sender_report_parser.h"
 #include "cast/streaming/session_config.h"
 #include "cast/streaming/ssrc.h"
+#include "cast/streaming/statistics.h"
 #include "platform/api/time.h"
 #include "util/alarm.h"
 
@@ -132,6 +135,26 @@ class Receiver {
   int rtp_timebase() const { return rtp_timebase_; }
   Ssrc ssrc() const { return rtcp_session_.receiver_ssrc(); }
 
+  // Returns statistics about the NACK feedback sent to the Sender, and the
+  // latency of recovering the missing packets.
+  const NackScheduler::Stats& nack_stats() const {
+    return nack_scheduler_.stats();
+  }
+
+  // Returns a snapshot of the statistics tracked since this Receiver was
+  // created. This is cheap enough to be polled periodically.
+  ReceiverStats GetStats() const;
+
+  // Starts recording the FrameTimeline of each frame, from the arrival of its
+  // first packet until it is consumed (or dropped), and emitting these as trace
+  // spans. If |client| is not null, it is notified as each frame's timeline is
+  // finished. The timelines of the most recent frames can be inspected via
+  // frame_timelines().
+  void EnableFrameTimelines(FrameTimelineRecorder::Client* client);
+  const FrameTimelineRecorder* frame_timelines() const {
+    return frame_timelines_ ? &*frame_timelines_ : nullptr;
+  }
+
   // Set the Consumer receiving notifications when new frames are ready for
   // consumption. Frames received before this method is called will remain in
   // the queue indefinitely.
@@ -146,6 +169,16 @@ class Receiver {
   // Default setting: kDefaultPlayerProcessingTime
   void SetPlayerProcessingTime(Clock::duration needed_time);
 
+  // Enables adaptive playout delay: The Receiver tracks how long after capture
+  // each frame is completely received, and how many frames are dropped for
+  // being late, and adjusts the target playout delay to the minimum (within the
+  // given range) that allows nearly all frames to play out on-time. Each change
+  // takes effect as of the next frame not yet seen, and is communicated to the
+  // Sender in the RTCP feedback. Changes requested by the Sender still take
+  // effect, but may be re-adjusted later.
+  void EnableAdaptivePlayoutDelay(std::chrono::milliseconds min_delay,
+                                  std::chrono::milliseconds max_delay);
+
   // Propagates a "picture loss indicator" notification to the Sender,
   // requesting a key frame so that decode/playout can recover. It is safe to
   // call this redundantly. The Receiver will clear the picture loss condition
@@ -207,6 +240,10 @@ class Receiver {
     // playout time.
     absl::optional<Clock::time_point> estimated_capture_time;
 
+    // When the first packet of this frame was collected. Used for measuring the
+    // frame completion latency.
+    absl::optional<Clock::time_point> first_packet_arrival_time;
+
     PendingFrame();
     ~PendingFrame();
 
@@ -243,6 +280,11 @@ class Receiver {
   // in-effect for the given frame.
   std::chrono::milliseconds ResolveTargetPlayoutDelay(FrameId frame_id) const;
 
+  // When adaptive playout delay is enabled, asks the PlayoutDelayEstimator
+  // whether the target playout delay should change, and records the change as
+  // of the next frame not yet seen.
+  void MaybeAdaptTargetPlayoutDelay(Clock::time_point now);
+
   // Called to move the checkpoint forward. This scans the queue, starting from
   // |new_checkpoint|, to find the latest in a contiguous sequence of completed
   // frames. Then, it records that frame as the new checkpoint, and immediately
@@ -269,6 +311,7 @@ class Receiver {
   SenderReportParser rtcp_parser_;
   CompoundRtcpBuilder rtcp_builder_;
   PacketReceiveStatsTracker stats_tracker_;  // Tracks transmission stats.
+  NackScheduler nack_scheduler_;  // Decides what to NACK, and when.
   RtpPacketParser rtp_parser_;
   const int rtp_timebase_;    // RTP timestamp ticks per second.
   const FrameCrypto crypto_;  // Decrypts assembled frames.
@@ -292,6 +335,10 @@ class Receiver {
   absl::optional<SenderReportParser::SenderReportWithId> last_sender_report_;
   Clock::time_point last_sender_report_arrival_time_;
 
+  // The arrival times of the RTP packets received since the last RTCP packet
+  // was sent. These are reported to the Sender in the next RTCP packet.
+  std::vector<PacketArrival> packet_arrivals_;
+
   // Tracks the offset between the Receiver's [local] clock and the Sender's
   // clock. This is invalid until the first Sender Report has been successfully
   // processed (i.e., |last_sender_report_| is not nullopt).
@@ -317,13 +364,15 @@ class Receiver {
   //
   // Use GetQueueEntry() to access a slot. The currently-active slots are those
   // for the frames after |last_frame_consumed_| and up-to/including
-  // |latest_frame_expected_|.
-  std::array<PendingFrame, kMaxUnackedFrames> pending_frames_{};
+  // |latest_frame_expected_|. The queue is sized to the session's
+  // |max_unacked_frames|.
+  std::vector<PendingFrame> pending_frames_;
 
   // Tracks the recent changes to the target playout delay, which is controlled
-  // by the Sender. The FrameId indicates the first frame where a new delay
-  // setting takes effect. This vector is never empty, is kept sorted, and is
-  // pruned to remain as small as possible.
+  // by the Sender (or adapted by this Receiver; see
+  // EnableAdaptivePlayoutDelay()). The FrameId indicates the first frame where
+  // a new delay setting takes effect. This vector is never empty, is kept
+  // sorted, and is pruned to remain as small as possible.
   //
   // The target playout delay is the amount of time between a frame's
   // capture/recording on the Sender and when it should be played-out at the
@@ -331,6 +380,10 @@ class Receiver {
   std::vector<std::pair<FrameId, std::chrono::milliseconds>>
       playout_delay_changes_;
 
+  // Proposes target playout delay changes when adaptive playout delay is
+  // enabled. See EnableAdaptivePlayoutDelay().
+  absl::optional<PlayoutDelayEstimator> playout_delay_estimator_;
+
   // The consumer to notify when there are one or more frames completed and
   // ready to be consumed.
   Consumer* consumer_ = nullptr;
@@ -343,12 +396,21 @@ class Receiver {
   // notify the Consumer via OnFramesReady().
   Alarm consumption_alarm_;
 
-  // The interval between sending ACK/NACK feedback RTCP messages while
-  // incomplete frames exist in the queue.
-  //
-  // TODO(miu): This should be a function of the current target playout delay,
-  // similar to the Sender's kickstart interval logic.
-  static constexpr std::chrono::milliseconds kNackFeedbackInterval{30};
+  // Counters and histograms returned by GetStats(). The |round_trip_time| field
+  // is filled-in only when a snapshot is taken.
+  ReceiverStats stats_;
+
+  // Records per-frame timelines, if enabled. See EnableFrameTimelines().
+  absl::optional<FrameTimelineRecorder> frame_timelines_;
+
+  // The minimum interval between sending ACK/NACK feedback RTCP messages while
+  // incomplete frames exist in the queue. Otherwise, the NackScheduler
+  // determines when feedback is next needed.
+  static constexpr std::chrono::milliseconds kMinNackFeedbackInterval{10};
+
+  // The maximum number of packet arrivals to accumulate for the next RTCP
+  // packet. Fewer may be included if there is not enough space in the packet.
+  static constexpr int kMaxPacketArrivalsPerReport = 64;
 };
 
 }  // namespace cast
@@ -25,8 +25,8 @@ ReceiverPacketRouter::~ReceiverPacketRouter() {
 
 void ReceiverPacketRouter::OnReceiverCreated(Ssrc sender_ssrc,
                                              Receiver* receiver) {
-  OSP_DCHECK(receivers_.find(sender_ssrc) == receivers_.end());
-  receivers_.emplace_back(sender_ssrc, receiver);
+  const bool inserted = receivers_.emplace(sender_ssrc, receiver).second;
+  OSP_DCHECK(inserted);
 
   // If there were no Receiver instances before, resume receiving packets for
   // dispatch. Reset/Clear the remote endpoint, in preparation for later setting
@@ -38,7 +38,7 @@ void ReceiverPacketRouter::OnReceiverCreated(Ssrc sender_ssrc,
 }
 
 void ReceiverPacketRouter::OnReceiverDestroyed(Ssrc sender_ssrc) {
-  receivers_.erase_key(sender_ssrc);
+  receivers_.erase(sender_ssrc);
   // If there are no longer any Receivers, suspend receiving packets.
   if (receivers_.empty()) {
     environment_->DropIncomingPackets();
@@ -7,13 +7,13 @@
 
 #include <stdint.h>
 
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "absl/types/span.h"
 #include "cast/streaming/environment.h"
 #include "cast/streaming/ssrc.h"
-#include "util/flat_map.h"
 
 namespace openscreen {
 namespace cast {
@@ -52,7 +52,10 @@ class ReceiverPacketRouter final : public Environment::PacketConsumer {
 
   Environment* const environment_;
 
-  FlatMap<Ssrc, Receiver*> receivers_;
+  // The Receivers, keyed by the SSRC of the Sender they receive from. This
+  // provides O(1) routing of each packet, even when many streams share one
+  // Environment.
+  std::unordered_map<Ssrc, Receiver*> receivers_;
 };
 
 }  // namespace cast
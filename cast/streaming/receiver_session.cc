@@ -99,6 +99,17 @@ ReceiverSession::~ReceiverSession() {
   ResetReceivers(Client::kEndOfSession);
 }
 
+ReceiverSession::Stats ReceiverSession::GetStats() const {
+  Stats stats;
+  if (current_audio_receiver_) {
+    stats.audio = current_audio_receiver_->GetStats();
+  }
+  if (current_video_receiver_) {
+    stats.video = current_video_receiver_->GetStats();
+  }
+  return stats;
+}
+
 void ReceiverSession::OnSocketReady() {
   if (pending_session_) {
     InitializeSession(*pending_session_);
@@ -208,6 +219,12 @@ std::unique_ptr<Receiver> ReceiverSession::ConstructReceiver(
                           stream.rtp_timebase, stream.channels,
                           stream.target_delay, stream.aes_key,
                           stream.aes_iv_mask,  /* is_pli_enabled */ true};
+  if (preferences_.is_fec_supported) {
+    config.fec_group_size = stream.fec_group_size;
+  }
+  // The OFFER does not convey the Sender's in-flight frame window, and
+  // Senders other than this library's assume kMaxUnackedFrames. So, keep the
+  // default window, the largest any Sender may use.
   return std::make_unique<Receiver>(environment_, &packet_router_,
                                     std::move(config));
 }
@@ -264,14 +281,22 @@ Answer ReceiverSession::ConstructAnswer(const SessionProperties& properties) {
 
   std::vector<int> stream_indexes;
   std::vector<Ssrc> stream_ssrcs;
+  std::vector<int> fec_enabled_indexes;
+  const auto AcceptFecIfOffered = [&](const Stream& stream) {
+    if (preferences_.is_fec_supported && stream.fec_group_size > 0) {
+      fec_enabled_indexes.push_back(stream.index);
+    }
+  };
   if (properties.selected_audio) {
     stream_indexes.push_back(properties.selected_audio->stream.index);
     stream_ssrcs.push_back(properties.selected_audio->stream.ssrc + 1);
+    AcceptFecIfOffered(properties.selected_audio->stream);
   }
 
   if (properties.selected_video) {
     stream_indexes.push_back(properties.selected_video->stream.index);
     stream_ssrcs.push_back(properties.selected_video->stream.ssrc + 1);
+    AcceptFecIfOffered(properties.selected_video->stream);
   }
 
   absl::optional<Constraints> constraints;
@@ -285,7 +310,7 @@ Answer ReceiverSession::ConstructAnswer(const SessionProperties& properties) {
         absl::optional<DisplayDescription>(*preferences_.display_description);
   }
 
-  return Answer{environment_->GetBoundLocalEndpoint().port,
+  Answer answer{environment_->GetBoundLocalEndpoint().port,
                 std::move(stream_indexes),
                 std::move(stream_ssrcs),
                 std::move(constraints),
@@ -293,6 +318,8 @@ Answer ReceiverSession::ConstructAnswer(const SessionProperties& properties) {
                 std::vector<int>{},  // receiver_rtcp_event_log
                 std::vector<int>{},  // receiver_rtcp_dscp
                 supports_wifi_status_reporting_};
+  answer.fec_enabled_indexes = std::move(fec_enabled_indexes);
+  return answer;
 }
 
 void ReceiverSession::SendErrorAnswerReply(int sequence_number,
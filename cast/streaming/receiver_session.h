@@ -10,6 +10,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "cast/common/public/message_port.h"
 #include "cast/streaming/answer_messages.h"
 #include "cast/streaming/capture_configs.h"
@@ -18,6 +19,7 @@
 #include "cast/streaming/sender_message.h"
 #include "cast/streaming/session_config.h"
 #include "cast/streaming/session_messager.h"
+#include "cast/streaming/statistics.h"
 #include "util/json/json_serialization.h"
 
 namespace openscreen {
@@ -50,6 +52,13 @@ class ReceiverSession final : public Environment::SocketSubscriber {
     VideoCaptureConfig video_config;
   };
 
+  // A snapshot of the statistics of the currently-configured receivers. A
+  // field is nullopt if there is no receiver for that stream.
+  struct Stats {
+    absl::optional<ReceiverStats> audio;
+    absl::optional<ReceiverStats> video;
+  };
+
   // The embedder should provide a client for handling connections.
   // When a connection is established, the OnMirroringNegotiated callback is
   // called.
@@ -103,6 +112,10 @@ class ReceiverSession final : public Environment::SocketSubscriber {
     // senders during the offer/answer exchange. If nullptr, these are ignored.
     std::unique_ptr<Constraints> constraints;
     std::unique_ptr<DisplayDescription> display_description;
+
+    // Whether FEC packets should be accepted, for the streams on which the
+    // sender offers them.
+    bool is_fec_supported = true;
   };
 
   ReceiverSession(Client* const client,
@@ -117,6 +130,10 @@ class ReceiverSession final : public Environment::SocketSubscriber {
 
   const std::string& session_id() const { return session_id_; }
 
+  // Returns the statistics of the currently-configured receivers. This is
+  // cheap enough to be polled periodically.
+  Stats GetStats() const;
+
   // Environment::SocketSubscriber event callbacks.
   void OnSocketReady() override;
   void OnSocketInvalid(Error error) override;
@@ -66,6 +66,7 @@ constexpr char kValidOfferMessage[] = R"({
         "maxFrameRate": "60000/1000",
         "timeBase": "1/90000",
         "maxBitRate": 5000000,
+        "fecGroupSize": 4,
         "profile": "main",
         "level": "4",
         "aesKey": "040d756791711fd3adb939066e6d8690",
@@ -323,6 +324,11 @@ TEST_F(ReceiverSessionTest, CanNegotiateWithDefaultPreferences) {
         EXPECT_EQ(cr.audio_receiver->config().receiver_ssrc, 19088748u);
         EXPECT_EQ(cr.audio_receiver->config().channels, 2);
         EXPECT_EQ(cr.audio_receiver->config().rtp_timebase, 48000);
+        EXPECT_EQ(cr.audio_receiver->config().fec_group_size, 0);
+        // The Sender's in-flight frame window is not negotiated, so the
+        // Receivers must allow for the largest one.
+        EXPECT_EQ(cr.audio_receiver->config().max_unacked_frames,
+                  kMaxUnackedFrames);
 
         // We should have chosen opus
         EXPECT_EQ(cr.audio_config.codec, AudioCodec::kOpus);
@@ -332,6 +338,9 @@ TEST_F(ReceiverSessionTest, CanNegotiateWithDefaultPreferences) {
         EXPECT_EQ(cr.video_receiver->config().receiver_ssrc, 19088746u);
         EXPECT_EQ(cr.video_receiver->config().channels, 1);
         EXPECT_EQ(cr.video_receiver->config().rtp_timebase, 90000);
+        EXPECT_EQ(cr.video_receiver->config().fec_group_size, 4);
+        EXPECT_EQ(cr.video_receiver->config().max_unacked_frames,
+                  kMaxUnackedFrames);
 
         // We should have chosen vp8
         EXPECT_EQ(cr.video_config.codec, VideoCodec::kVp8);
@@ -364,6 +373,10 @@ TEST_F(ReceiverSessionTest, CanNegotiateWithDefaultPreferences) {
   EXPECT_LT(0, answer_body["udpPort"].asInt());
   EXPECT_GT(65535, answer_body["udpPort"].asInt());
 
+  // FEC was only offered for the video stream.
+  ASSERT_EQ(1u, answer_body["fecEnabledIndexes"].size());
+  EXPECT_EQ(31338, answer_body["fecEnabledIndexes"][0].asInt());
+
   // Get status should always be false, as we have no plans to implement it.
   EXPECT_EQ(false, answer_body["receiverGetStatus"].asBool());
 
@@ -148,7 +148,10 @@ class MockSender : public CompoundRtcpParser::Client {
         sender_report_builder_(&rtcp_session_),
         rtcp_parser_(&rtcp_session_, this),
         crypto_(kAesKey, kCastIvMask),
-        rtp_packetizer_(kRtpPayloadType, kSenderSsrc, kMaxRtpPacketSize) {}
+        rtp_packetizer_(kRtpPayloadType,
+                        kSenderSsrc,
+                        kMaxRtpPacketSize,
+                        /*fec_group_size=*/0) {}
 
   ~MockSender() override = default;
 
@@ -427,6 +430,7 @@ TEST_F(ReceiverTest, ReceivesAndSendsRtcpPackets) {
 TEST_F(ReceiverTest, ReceivesFramesInOrder) {
   const Clock::time_point start_time = FakeClock::now();
   ExchangeInitialReportPackets();
+  receiver()->EnableFrameTimelines(nullptr);
 
   EXPECT_CALL(*consumer(), OnFramesReady(Gt(0))).Times(10);
   for (int i = 0; i <= 9; ++i) {
@@ -465,6 +469,37 @@ TEST_F(ReceiverTest, ReceivesFramesInOrder) {
 
   ConsumeAndVerifyFrames(0, 9, start_time);
   EXPECT_EQ(Receiver::kNoFramesReady, receiver()->AdvanceToNextFrame());
+
+  const ReceiverStats stats = receiver()->GetStats();
+  EXPECT_EQ(10, stats.num_frames_completed);
+  EXPECT_EQ(10, stats.num_frames_consumed);
+  EXPECT_EQ(0, stats.num_frames_dropped_late);
+  EXPECT_EQ(0, stats.num_nacks_sent);
+  EXPECT_EQ(0, stats.num_plis_sent);
+  EXPECT_LE(10, stats.num_packets_received);
+  EXPECT_EQ(10, stats.frame_completion_latency_ms.count());
+  EXPECT_EQ(10, stats.decrypt_time_us.count());
+  // The periodic "ping" was sent exactly on time.
+  EXPECT_LE(1, stats.rtcp_send_lateness_ms.count());
+  EXPECT_EQ(0, stats.rtcp_send_lateness_ms.sum());
+
+  // Each frame's timeline should have progressed through the Receiver stages,
+  // in order. Only the first frame was reported via OnFramesReady(), since the
+  // others were not consumed until the end.
+  for (int i = 0; i <= 9; ++i) {
+    const FrameTimeline* const timeline =
+        receiver()->frame_timelines()->GetTimeline(FrameId::first() + i);
+    ASSERT_TRUE(timeline);
+    EXPECT_FALSE(timeline->was_dropped);
+    EXPECT_TRUE(timeline->HasReached(FrameStage::kCaptured));
+    EXPECT_EQ(i == 0, timeline->HasReached(FrameStage::kReady));
+    EXPECT_LE(Clock::duration::zero(),
+              *timeline->GetDuration(FrameStage::kFirstPacketReceived,
+                                     FrameStage::kCompleted));
+    EXPECT_LE(Clock::duration::zero(),
+              *timeline->GetDuration(FrameStage::kCompleted,
+                                     FrameStage::kConsumed));
+  }
 }
 
 // Tests that the Receiver processes RTP packets, can receive frames out of
@@ -661,6 +696,8 @@ TEST_F(ReceiverTest, RequestsKeyFrameToRectifyPictureLoss) {
   receiver()->RequestKeyFrame();
   AdvanceClockAndRunTasks(kOneWayNetworkDelay);
   testing::Mock::VerifyAndClearExpectations(sender());
+
+  EXPECT_LE(3, receiver()->GetStats().num_plis_sent);
 }
 
 TEST_F(ReceiverTest, PLICanBeDisabled) {
@@ -849,6 +886,46 @@ TEST_F(ReceiverTest, DropsLateFrames) {
   AdvanceClockAndRunTasks(kOneWayNetworkDelay);
   testing::Mock::VerifyAndClearExpectations(consumer());
   testing::Mock::VerifyAndClearExpectations(sender());
+
+  const ReceiverStats stats = receiver()->GetStats();
+  EXPECT_EQ(6, stats.num_frames_dropped_late);
+  EXPECT_EQ(2, stats.num_frames_consumed);
+}
+
+// Tests that, when adaptive playout delay is enabled, the Receiver lowers the
+// Sender's overly-conservative target playout delay on a low-jitter network,
+// and signals the change to the Sender in its checkpoint feedback.
+TEST_F(ReceiverTest, AdaptsPlayoutDelayToNetworkConditions) {
+  constexpr milliseconds kMinDelay{20};
+  constexpr milliseconds kMaxDelay{1000};
+  constexpr int kNumFrames = 500;  // Five seconds of frames.
+
+  receiver()->EnableAdaptivePlayoutDelay(kMinDelay, kMaxDelay);
+  const Clock::time_point start_time = FakeClock::now();
+  ExchangeInitialReportPackets();
+
+  milliseconds last_signaled_delay = kTargetPlayoutDelay;
+  EXPECT_CALL(*sender(), OnReceiverCheckpoint(_, _))
+      .WillRepeatedly(SaveArg<1>(&last_signaled_delay));
+  for (int i = 0; i < kNumFrames; ++i) {
+    sender()->SetFrameBeingSent(SimulatedFrame(start_time, i));
+    sender()->SendRtpPackets(sender()->GetAllPacketIds(0));
+    AdvanceClockAndRunTasks(kRoundTripNetworkDelay);
+
+    const int payload_size = receiver()->AdvanceToNextFrame();
+    ASSERT_NE(Receiver::kNoFramesReady, payload_size);
+    std::vector<uint8_t> buffer(payload_size);
+    const EncodedFrame frame =
+        receiver()->ConsumeNextFrame(absl::Span<uint8_t>(buffer));
+    ASSERT_EQ(FrameId::first() + i, frame.frame_id);
+
+    AdvanceClockAndRunTasks(SimulatedFrame::kFrameDuration -
+                            kRoundTripNetworkDelay);
+  }
+
+  // The Sender's increase to 800 ms should have been gradually walked back.
+  EXPECT_LT(last_signaled_delay, SimulatedFrame::kTargetPlayoutDelayChange);
+  EXPECT_GE(last_signaled_delay, kMinDelay);
 }
 
 }  // namespace
@@ -182,6 +182,12 @@ void RtcpReportBlock::SetCumulativePacketsLost(int64_t num_apparently_sent,
 
 void RtcpReportBlock::SetDelaySinceLastReport(
     Clock::duration local_clock_delay) {
+  delay_since_last_report = ToClampedDelay(local_clock_delay);
+}
+
+// static
+RtcpReportBlock::Delay RtcpReportBlock::ToClampedDelay(
+    Clock::duration local_clock_delay) {
   // Clamp to valid range supported by the wire format (and RTP spec). The
   // bounds checking is done in terms of Clock::duration, since doing the checks
   // after the duration_cast may allow overflow to occur in the duration_cast
@@ -190,18 +196,15 @@ void RtcpReportBlock::SetDelaySinceLastReport(
   constexpr auto kMaxValidLocalClockDelay =
       Clock::to_duration(kMaxValidReportedDelay);
   if (local_clock_delay > kMaxValidLocalClockDelay) {
-    delay_since_last_report = kMaxValidReportedDelay;
-    return;
+    return kMaxValidReportedDelay;
   }
   if (local_clock_delay <= Clock::duration::zero()) {
-    delay_since_last_report = Delay::zero();
-    return;
+    return Delay::zero();
   }
 
   // If this point is reached, then the |local_clock_delay| is representable as
   // a Delay within the valid range.
-  delay_since_last_report =
-      std::chrono::duration_cast<Delay>(local_clock_delay);
+  return std::chrono::duration_cast<Delay>(local_clock_delay);
 }
 
 // static
@@ -118,6 +118,10 @@ struct RtcpReportBlock {
   // |delay_since_last_report|.
   void SetDelaySinceLastReport(Clock::duration local_clock_delay);
 
+  // Converts the given |local_clock_delay| to the Delay timebase, clamping it
+  // to the valid range supported by the wire format.
+  static Delay ToClampedDelay(Clock::duration local_clock_delay);
+
   // Serializes this report block in the first |kRtcpReportBlockSize| bytes of
   // the given |buffer| and adjusts |buffer| to point to the first byte after
   // it.
@@ -177,6 +181,21 @@ struct PacketNack {
   }
 };
 
+// Reports when a specific packet of a frame arrived at the Receiver. The
+// |arrival_time| is only meaningful relative to the other PacketArrivals from
+// the same Receiver, since the offset between the Sender's and Receiver's
+// clocks is unknown.
+struct PacketArrival {
+  FrameId frame_id;
+  FramePacketId packet_id;
+  Clock::time_point arrival_time;
+
+  constexpr bool operator==(const PacketArrival& other) const {
+    return frame_id == other.frame_id && packet_id == other.packet_id &&
+           arrival_time == other.arrival_time;
+  }
+};
+
 }  // namespace cast
 }  // namespace openscreen
 
@@ -40,6 +40,15 @@ constexpr FramePacketId kMaxAllowedFramePacketId = kAllPacketsLost - 1;
 constexpr int kMaxRtpPacketSizeForIpv4UdpOnEthernet = 1500 - 20 - 8;
 constexpr int kMaxRtpPacketSizeForIpv6UdpOnEthernet = 1500 - 40 - 8;
 
+// When the path MTU is probed (see Environment::ProbePathMtu()), the maximum
+// packet size is computed from it, up to this limit for "jumbo frame" Ethernet
+// LANs. Larger MTUs (e.g., the loopback interface's) gain little, since the
+// per-packet overhead is already small relative to the payload.
+constexpr int kMaxJumboFrameMtu = 9000;
+constexpr int kIpv4HeaderSize = 20;
+constexpr int kIpv6HeaderSize = 40;
+constexpr int kUdpHeaderSize = 8;
+
 // The Cast RTP packet header:
 //
 //  0                   1                   2                   3
@@ -137,6 +146,26 @@ constexpr uint8_t kRtpExtensionCountMask = 0b00111111;
 constexpr uint8_t kAdaptiveLatencyRtpExtensionType = 1;
 constexpr int kNumExtensionDataSizeFieldBits = 10;
 
+// This implementation also supports an optional Forward Error Correction (FEC)
+// extension, for use only when both Sender and Receiver have agreed to it
+// during OFFER/ANSWER negotiation:
+//
+//  0                   1                   2                   3
+//  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// | TYPE = 10 | Ext data SIZE = 4 |   Number of protected packets |
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// |    XOR of payload sizes       |
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+// Its presence marks the RTP packet as an XOR parity packet protecting a range
+// of consecutive packets of the same frame. The PID field in the Cast header
+// holds the first protected packet's ID, and Max PID is that of the frame. The
+// payload is the XOR of all the protected packets' payloads (zero-padded to the
+// longest one). If exactly one of the protected packets is lost, it can be
+// recovered from the others and the parity packet, without a re-transmit.
+constexpr uint8_t kFecRtpExtensionType = 10;
+
 // RTCP Common Header:
 //
 //  0                   1                   2                   3
@@ -341,6 +370,28 @@ constexpr int kRtcpExtendedReportBlockHeaderSize = 4;
 // +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 constexpr uint8_t kRtcpReceiverReferenceTimeReportBlockType = 4;
 constexpr int kRtcpReceiverReferenceTimeReportBlockSize = 8;
+//
+// This implementation also optionally includes a Packet Arrival Report block,
+// an extension (from the unassigned range of block types) that a Sender uses
+// for delay-based congestion control. Senders that do not understand the block
+// type will ignore it. The block contains one or more 8-byte entries:
+//
+//  0                   1                   2                   3
+//  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// | Block Type=200| Reserved = 0  |  Block Length = 2 * # entries |
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// |   Frame ID    | Reserved = 0  |        Frame Packet ID        |
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// |    Arrival time before report time (1/65536 sec timebase)     |
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+// The "Frame ID" is truncated to its lower 8 bits, and should be expanded in
+// the same way as the "Checkpoint Frame ID" of the Cast Feedback message. The
+// arrival time is relative to the NTP timestamp in the Receiver Reference Time
+// Report included in the same compound RTCP packet.
+constexpr uint8_t kRtcpPacketArrivalReportBlockType = 200;
+constexpr int kRtcpPacketArrivalReportEntrySize = 8;
 
 // Cast Picture Loss Indicator Message:
 //
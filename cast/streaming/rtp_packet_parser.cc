@@ -93,6 +93,20 @@ absl::optional<RtpPacketParser::ParseResult> RtpPacketParser::Parse(
       }
       result.new_playout_delay =
           std::chrono::milliseconds(ReadBigEndian<uint16_t>(buffer.data()));
+    } else if (type == kFecRtpExtensionType) {
+      if (size != 2 * sizeof(uint16_t)) {
+        return absl::nullopt;
+      }
+      result.fec_protected_packet_count =
+          ReadBigEndian<uint16_t>(buffer.data());
+      result.fec_payload_size_xor =
+          ReadBigEndian<uint16_t>(buffer.data() + sizeof(uint16_t));
+      // The protected range must be non-empty and lie within the frame.
+      if (result.fec_protected_packet_count == 0 ||
+          (int{result.packet_id} + result.fec_protected_packet_count - 1) >
+              int{result.max_packet_id}) {
+        return absl::nullopt;
+      }
     }
     buffer.remove_prefix(size);
   }
@@ -42,6 +42,12 @@ class RtpPacketParser {
     FrameId referenced_frame_id;  // ID of frame required to decode this one.
     std::chrono::milliseconds new_playout_delay{};  // Ignore if non-positive.
 
+    // Elements from the optional FEC extension. If |fec_protected_packet_count|
+    // is non-zero, this is an FEC packet: |packet_id| is the first of the
+    // protected packets, and |payload| is their XOR parity.
+    int fec_protected_packet_count = 0;
+    uint16_t fec_payload_size_xor = 0;
+
     // Portion of the |packet| that was passed into Parse() that contains the
     // payload. WARNING: This memory region is only valid while the original
     // |packet| memory remains valid.
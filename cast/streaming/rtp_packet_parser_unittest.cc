@@ -202,6 +202,46 @@ TEST(RtpPacketParserTest, ParsesPacketWithMultipleExtensions) {
   EXPECT_TRUE(expected_payload == result->payload);
 }
 
+// Tests that the parser recognizes the FEC extension, and rejects FEC packets
+// whose protected range extends beyond the end of the frame.
+TEST(RtpPacketParserTest, ParsesPacketWithFecExtension) {
+  // clang-format off
+  uint8_t input[] = {
+    0b10000000,  // Version/Padding byte.
+    96,  // Payload type byte.
+    0xde, 0xad,  // Sequence number.
+    2, 4, 6, 8,  // RTP timestamp.
+    0, 0, 1, 1,  // SSRC.
+    0b01000001,  // Has ref frame ID; has 1 extension.
+    64,  // Frame ID.
+    0x0, 0x8,  // Packet ID.
+    0x0, 0xc,  // Max packet ID.
+    63,  // Reference Frame ID.
+    40, 4, 0, 5, 0x12, 0x34,  // Cast FEC Extension data.
+    1, 3, 5, 7, 9, 11, 13, 15  // Payload.
+  };
+  // clang-format on
+  const Ssrc kSenderSsrc = 0x00000101;
+
+  RtpPacketParser parser(kSenderSsrc);
+  const auto result = parser.Parse(input);
+  ASSERT_TRUE(result);
+  EXPECT_FALSE(result->is_key_frame);
+  EXPECT_EQ(FramePacketId{0x0008}, result->packet_id);
+  EXPECT_EQ(FramePacketId{0x000c}, result->max_packet_id);
+  EXPECT_EQ(5, result->fec_protected_packet_count);
+  EXPECT_EQ(UINT16_C(0x1234), result->fec_payload_size_xor);
+  EXPECT_EQ(absl::Span<const uint8_t>(input + 25, 8), result->payload);
+
+  // Protecting packets 8 through 13, when the max packet ID is 12, is invalid.
+  input[22] = 6;
+  EXPECT_FALSE(parser.Parse(input));
+
+  // Protecting zero packets is also invalid.
+  input[22] = 0;
+  EXPECT_FALSE(parser.Parse(input));
+}
+
 // Tests that the parser ignores packets from an unknown source.
 TEST(RtpPacketParserTest, IgnoresPacketWithWrongSsrc) {
   // clang-format off
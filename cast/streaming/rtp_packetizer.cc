@@ -38,13 +38,16 @@ uint16_t GenerateRandomSequenceNumberStart() {
 
 RtpPacketizer::RtpPacketizer(RtpPayloadType payload_type,
                              Ssrc sender_ssrc,
-                             int max_packet_size)
+                             int max_packet_size,
+                             int fec_group_size)
     : payload_type_7bits_(static_cast<uint8_t>(payload_type)),
       sender_ssrc_(sender_ssrc),
       max_packet_size_(max_packet_size),
+      fec_group_size_(fec_group_size),
       sequence_number_(GenerateRandomSequenceNumberStart()) {
   OSP_DCHECK(IsRtpPayloadType(payload_type_7bits_));
-  OSP_DCHECK_GT(max_packet_size_, kMaxRtpHeaderSize);
+  OSP_DCHECK_GE(fec_group_size_, 0);
+  OSP_DCHECK_GT(max_packet_size_, kMaxFecRtpHeaderSize);
 }
 
 RtpPacketizer::~RtpPacketizer() = default;
@@ -52,6 +55,36 @@ RtpPacketizer::~RtpPacketizer() = default;
 absl::Span<uint8_t> RtpPacketizer::GeneratePacket(const EncryptedFrame& frame,
                                                   FramePacketId packet_id,
                                                   absl::Span<uint8_t> buffer) {
+  return GeneratePacketCommon(frame, nullptr, packet_id, buffer);
+}
+
+absl::Span<uint8_t> RtpPacketizer::GenerateFecPacket(
+    const EncryptedFrame& frame,
+    int fec_index,
+    absl::Span<uint8_t> buffer) {
+  return GenerateFecPacketCommon(frame, nullptr, fec_index, buffer);
+}
+
+absl::Span<uint8_t> RtpPacketizer::GeneratePacket(const EncodedFrame& frame,
+                                                  const FrameCrypto& crypto,
+                                                  FramePacketId packet_id,
+                                                  absl::Span<uint8_t> buffer) {
+  return GeneratePacketCommon(frame, &crypto, packet_id, buffer);
+}
+
+absl::Span<uint8_t> RtpPacketizer::GenerateFecPacket(
+    const EncodedFrame& frame,
+    const FrameCrypto& crypto,
+    int fec_index,
+    absl::Span<uint8_t> buffer) {
+  return GenerateFecPacketCommon(frame, &crypto, fec_index, buffer);
+}
+
+absl::Span<uint8_t> RtpPacketizer::GeneratePacketCommon(
+    const EncodedFrame& frame,
+    const FrameCrypto* crypto,
+    FramePacketId packet_id,
+    absl::Span<uint8_t> buffer) {
   OSP_CHECK_GE(static_cast<int>(buffer.size()), max_packet_size_);
 
   const int num_packets = ComputeNumberOfPackets(frame);
@@ -67,46 +100,18 @@ absl::Span<uint8_t> RtpPacketizer::GeneratePacket(const EncryptedFrame& frame,
       (packet_id == 0 &&
        frame.new_playout_delay > std::chrono::milliseconds(0));
   if (include_adaptive_latency_change) {
-    OSP_DCHECK_LE(frame.new_playout_delay.count(),
-                  int{std::numeric_limits<uint16_t>::max()});
     packet_size += kAdaptiveLatencyHeaderSize;
   }
-  int data_chunk_size = max_payload_size();
-  const int data_chunk_start = data_chunk_size * int{packet_id};
-  if (is_last_packet) {
-    data_chunk_size = static_cast<int>(frame.data.size()) - data_chunk_start;
-  }
+  const int data_chunk_size =
+      static_cast<int>(GetPacketPayload(frame, packet_id).size());
   packet_size += data_chunk_size;
   OSP_DCHECK_LE(packet_size, max_packet_size_);
   const absl::Span<uint8_t> packet(buffer.data(), packet_size);
 
-  // RTP Header.
-  AppendField<uint8_t>(kRtpRequiredFirstByte, &buffer);
-  AppendField<uint8_t>(
-      (is_last_packet ? kRtpMarkerBitMask : 0) | payload_type_7bits_, &buffer);
-  AppendField<uint16_t>(sequence_number_++, &buffer);
-  AppendField<uint32_t>(frame.rtp_timestamp.lower_32_bits(), &buffer);
-  AppendField<uint32_t>(sender_ssrc_, &buffer);
-
-  // Cast Header.
-  AppendField<uint8_t>(
-      ((frame.dependency == EncodedFrame::KEY_FRAME) ? kRtpKeyFrameBitMask
-                                                     : 0) |
-          kRtpHasReferenceFrameIdBitMask |
-          (include_adaptive_latency_change ? 1 : 0),
-      &buffer);
-  AppendField<uint8_t>(frame.frame_id.lower_8_bits(), &buffer);
-  AppendField<uint16_t>(packet_id, &buffer);
-  AppendField<uint16_t>(num_packets - 1, &buffer);
-  AppendField<uint8_t>(frame.referenced_frame_id.lower_8_bits(), &buffer);
-
-  // Extension of Cast Header for Adaptive Latency change.
+  AppendHeaderFields(frame, packet_id, num_packets, is_last_packet,
+                     include_adaptive_latency_change ? 1 : 0, &buffer);
   if (include_adaptive_latency_change) {
-    AppendField<uint16_t>(
-        (kAdaptiveLatencyRtpExtensionType << kNumExtensionDataSizeFieldBits) |
-            sizeof(uint16_t),
-        &buffer);
-    AppendField<uint16_t>(frame.new_playout_delay.count(), &buffer);
+    AppendAdaptiveLatencyExtension(frame, &buffer);
   }
 
   // Sanity-check the pointer math, to ensure the packet is being entirely
@@ -114,12 +119,89 @@ absl::Span<uint8_t> RtpPacketizer::GeneratePacket(const EncryptedFrame& frame,
   OSP_DCHECK_EQ(buffer.data() + data_chunk_size, packet.end());
 
   // Copy the encrypted payload data into the packet.
-  memcpy(buffer.data(), frame.data.data() + data_chunk_start, data_chunk_size);
+  CopyPacketPayload(frame, crypto, packet_id, buffer.data());
 
   return packet;
 }
 
-int RtpPacketizer::ComputeNumberOfPackets(const EncryptedFrame& frame) const {
+absl::Span<uint8_t> RtpPacketizer::GenerateFecPacketCommon(
+    const EncodedFrame& frame,
+    const FrameCrypto* crypto,
+    int fec_index,
+    absl::Span<uint8_t> buffer) {
+  OSP_CHECK_GE(static_cast<int>(buffer.size()), max_packet_size_);
+
+  const int num_packets = ComputeNumberOfPackets(frame);
+  OSP_DCHECK_GT(num_packets, 0);
+  OSP_DCHECK_GE(fec_index, 0);
+  OSP_DCHECK_LT(fec_index, ComputeNumberOfFecPackets(num_packets));
+  const int first_packet_id = fec_index * fec_group_size_;
+  const int num_protected =
+      std::min(fec_group_size_, num_packets - first_packet_id);
+
+  // The FEC packet carries the same Adaptive Latency information as the first
+  // packet, if it protects that packet, so that it can be fully recovered.
+  int packet_size = kBaseRtpHeaderSize + kFecHeaderSize;
+  const bool include_adaptive_latency_change =
+      (first_packet_id == 0 &&
+       frame.new_playout_delay > std::chrono::milliseconds(0));
+  if (include_adaptive_latency_change) {
+    packet_size += kAdaptiveLatencyHeaderSize;
+  }
+  // The parity payload is as large as the largest protected payload, which is
+  // always the first one.
+  const int parity_size =
+      static_cast<int>(GetPacketPayload(frame, first_packet_id).size());
+  packet_size += parity_size;
+  OSP_DCHECK_LE(packet_size, max_packet_size_);
+  const absl::Span<uint8_t> packet(buffer.data(), packet_size);
+
+  AppendHeaderFields(frame, static_cast<FramePacketId>(first_packet_id),
+                     num_packets, false,
+                     include_adaptive_latency_change ? 2 : 1, &buffer);
+  if (include_adaptive_latency_change) {
+    AppendAdaptiveLatencyExtension(frame, &buffer);
+  }
+
+  // Extension of Cast Header for FEC.
+  uint16_t payload_sizes_xor = 0;
+  for (int i = 0; i < num_protected; ++i) {
+    payload_sizes_xor ^= static_cast<uint16_t>(
+        GetPacketPayload(frame, first_packet_id + i).size());
+  }
+  AppendField<uint16_t>(
+      (kFecRtpExtensionType << kNumExtensionDataSizeFieldBits) |
+          (2 * sizeof(uint16_t)),
+      &buffer);
+  AppendField<uint16_t>(num_protected, &buffer);
+  AppendField<uint16_t>(payload_sizes_xor, &buffer);
+
+  OSP_DCHECK_EQ(buffer.data() + parity_size, packet.end());
+
+  // Compute the parity payload. If the |frame| is not encrypted yet, each
+  // protected payload is encrypted into |fec_scratch_| first.
+  memset(buffer.data(), 0, parity_size);
+  if (crypto) {
+    fec_scratch_.resize(max_payload_size());
+  }
+  for (int i = 0; i < num_protected; ++i) {
+    absl::Span<const uint8_t> data_chunk =
+        GetPacketPayload(frame, first_packet_id + i);
+    if (crypto) {
+      CopyPacketPayload(frame, crypto, first_packet_id + i,
+                        fec_scratch_.data());
+      data_chunk = absl::Span<const uint8_t>(fec_scratch_.data(),
+                                             data_chunk.size());
+    }
+    for (size_t j = 0; j < data_chunk.size(); ++j) {
+      buffer[j] ^= data_chunk[j];
+    }
+  }
+
+  return packet;
+}
+
+int RtpPacketizer::ComputeNumberOfPackets(const EncodedFrame& frame) const {
   // The total number of packets is computed by assuming the payload will be
   // split-up across as few packets as possible.
   int num_packets = DividePositivesRoundingUp(
@@ -133,5 +215,76 @@ int RtpPacketizer::ComputeNumberOfPackets(const EncryptedFrame& frame) const {
   return num_packets <= int{kMaxAllowedFramePacketId} ? num_packets : -1;
 }
 
+int RtpPacketizer::ComputeNumberOfFecPackets(int num_packets) const {
+  if (fec_group_size_ <= 0) {
+    return 0;
+  }
+  return DividePositivesRoundingUp(num_packets, fec_group_size_);
+}
+
+absl::Span<const uint8_t> RtpPacketizer::GetPacketPayload(
+    const EncodedFrame& frame,
+    int packet_id) const {
+  const int data_chunk_start = max_payload_size() * packet_id;
+  const int data_chunk_size =
+      std::min(max_payload_size(),
+               static_cast<int>(frame.data.size()) - data_chunk_start);
+  return absl::Span<const uint8_t>(frame.data.data() + data_chunk_start,
+                                   data_chunk_size);
+}
+
+void RtpPacketizer::CopyPacketPayload(const EncodedFrame& frame,
+                                      const FrameCrypto* crypto,
+                                      int packet_id,
+                                      uint8_t* out) const {
+  const absl::Span<const uint8_t> data_chunk =
+      GetPacketPayload(frame, packet_id);
+  if (crypto) {
+    crypto->EncryptPart(frame.frame_id, max_payload_size() * packet_id,
+                        data_chunk,
+                        absl::Span<uint8_t>(out, data_chunk.size()));
+  } else {
+    memcpy(out, data_chunk.data(), data_chunk.size());
+  }
+}
+
+void RtpPacketizer::AppendHeaderFields(const EncodedFrame& frame,
+                                       FramePacketId packet_id,
+                                       int num_packets,
+                                       bool marker_bit,
+                                       int num_extensions,
+                                       absl::Span<uint8_t>* buffer) {
+  // RTP Header.
+  AppendField<uint8_t>(kRtpRequiredFirstByte, buffer);
+  AppendField<uint8_t>(
+      (marker_bit ? kRtpMarkerBitMask : 0) | payload_type_7bits_, buffer);
+  AppendField<uint16_t>(sequence_number_++, buffer);
+  AppendField<uint32_t>(frame.rtp_timestamp.lower_32_bits(), buffer);
+  AppendField<uint32_t>(sender_ssrc_, buffer);
+
+  // Cast Header.
+  AppendField<uint8_t>(
+      ((frame.dependency == EncodedFrame::KEY_FRAME) ? kRtpKeyFrameBitMask
+                                                     : 0) |
+          kRtpHasReferenceFrameIdBitMask | num_extensions,
+      buffer);
+  AppendField<uint8_t>(frame.frame_id.lower_8_bits(), buffer);
+  AppendField<uint16_t>(packet_id, buffer);
+  AppendField<uint16_t>(num_packets - 1, buffer);
+  AppendField<uint8_t>(frame.referenced_frame_id.lower_8_bits(), buffer);
+}
+
+void RtpPacketizer::AppendAdaptiveLatencyExtension(
+    const EncodedFrame& frame,
+    absl::Span<uint8_t>* buffer) {
+  OSP_DCHECK_LE(frame.new_playout_delay.count(),
+                int{std::numeric_limits<uint16_t>::max()});
+  AppendField<uint16_t>(
+      (kAdaptiveLatencyRtpExtensionType << kNumExtensionDataSizeFieldBits) |
+          sizeof(uint16_t),
+      buffer);
+  AppendField<uint16_t>(frame.new_playout_delay.count(), buffer);
+}
+
 }  // namespace cast
 }  // namespace openscreen
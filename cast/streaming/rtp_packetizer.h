@@ -7,6 +7,8 @@
 
 #include <stdint.h>
 
+#include <vector>
+
 #include "absl/types/span.h"
 #include "cast/streaming/frame_crypto.h"
 #include "cast/streaming/rtp_defines.h"
@@ -26,9 +28,13 @@ class RtpPacketizer {
   // The |max_packet_size| argument depends on the optimal over-the-wire size of
   // packets for the network medium being used. See discussion in rtp_defines.h
   // for further info.
+  //
+  // |fec_group_size| is the number of consecutive packets of each frame that
+  // are protected by one FEC packet, or zero to disable FEC.
   RtpPacketizer(RtpPayloadType payload_type,
                 Ssrc sender_ssrc,
-                int max_packet_size);
+                int max_packet_size,
+                int fec_group_size);
 
   ~RtpPacketizer();
 
@@ -42,10 +48,37 @@ class RtpPacketizer {
                                      FramePacketId packet_id,
                                      absl::Span<uint8_t> buffer);
 
+  // Wire-format the |fec_index|'th FEC packet for the given frame. Like
+  // GeneratePacket(), this should be called each time the packet is to be
+  // transmitted. |fec_index| must be less than the value returned by
+  // ComputeNumberOfFecPackets().
+  absl::Span<uint8_t> GenerateFecPacket(const EncryptedFrame& frame,
+                                        int fec_index,
+                                        absl::Span<uint8_t> buffer);
+
+  // Like GeneratePacket() and GenerateFecPacket(), but for a |frame| whose
+  // payload has not been encrypted. Each part of the payload a packet carries
+  // is encrypted with |crypto| as it is copied into the packet. This allows one
+  // unencrypted payload to be shared by several Senders, each having its own
+  // keys, without any of them keeping an encrypted copy.
+  absl::Span<uint8_t> GeneratePacket(const EncodedFrame& frame,
+                                     const FrameCrypto& crypto,
+                                     FramePacketId packet_id,
+                                     absl::Span<uint8_t> buffer);
+  absl::Span<uint8_t> GenerateFecPacket(const EncodedFrame& frame,
+                                        const FrameCrypto& crypto,
+                                        int fec_index,
+                                        absl::Span<uint8_t> buffer);
+
   // Given |frame|, compute the total number of packets over which the whole
   // frame will be split-up. Returns -1 if the frame is too large and cannot be
-  // packetized.
-  int ComputeNumberOfPackets(const EncryptedFrame& frame) const;
+  // packetized. Since encryption does not change the size of the payload, the
+  // |frame| may be encrypted or not.
+  int ComputeNumberOfPackets(const EncodedFrame& frame) const;
+
+  // Returns the number of FEC packets that will protect a frame split-up into
+  // |num_packets|. This is always zero when FEC is disabled.
+  int ComputeNumberOfFecPackets(int num_packets) const;
 
   // See rtp_defines.h for wire-format diagram.
   static constexpr int kBaseRtpHeaderSize =
@@ -55,24 +88,70 @@ class RtpPacketizer {
   static constexpr int kAdaptiveLatencyHeaderSize = 4;
   static constexpr int kMaxRtpHeaderSize =
       kBaseRtpHeaderSize + kAdaptiveLatencyHeaderSize;
+  static constexpr int kFecHeaderSize = 6;
+  static constexpr int kMaxFecRtpHeaderSize =
+      kMaxRtpHeaderSize + kFecHeaderSize;
 
  private:
   int max_payload_size() const {
     // Start with the configured max packet size, then subtract reserved space
-    // for packet header fields. The rest can be allocated to the payload.
-    return max_packet_size_ - kMaxRtpHeaderSize;
+    // for packet header fields. The rest can be allocated to the payload. When
+    // FEC is enabled, the FEC packets must also fit, and these carry the
+    // largest payloads with the largest headers.
+    return max_packet_size_ -
+           (fec_group_size_ > 0 ? kMaxFecRtpHeaderSize : kMaxRtpHeaderSize);
   }
 
+  // Implementations of the public methods. If |crypto| is null, the |frame|'s
+  // payload is already encrypted; otherwise, it is encrypted by |crypto|.
+  absl::Span<uint8_t> GeneratePacketCommon(const EncodedFrame& frame,
+                                           const FrameCrypto* crypto,
+                                           FramePacketId packet_id,
+                                           absl::Span<uint8_t> buffer);
+  absl::Span<uint8_t> GenerateFecPacketCommon(const EncodedFrame& frame,
+                                              const FrameCrypto* crypto,
+                                              int fec_index,
+                                              absl::Span<uint8_t> buffer);
+
+  // Returns the portion of the |frame|'s data carried by the given packet.
+  absl::Span<const uint8_t> GetPacketPayload(const EncodedFrame& frame,
+                                             int packet_id) const;
+
+  // Copies the given packet's portion of the |frame|'s data into |out|,
+  // encrypting it if |crypto| is not null.
+  void CopyPacketPayload(const EncodedFrame& frame,
+                         const FrameCrypto* crypto,
+                         int packet_id,
+                         uint8_t* out) const;
+
+  // Serializes the RTP header and the Cast header fields, up to but not
+  // including the Cast extensions.
+  void AppendHeaderFields(const EncodedFrame& frame,
+                          FramePacketId packet_id,
+                          int num_packets,
+                          bool marker_bit,
+                          int num_extensions,
+                          absl::Span<uint8_t>* buffer);
+
+  // Serializes the Adaptive Latency extension for the |frame|.
+  void AppendAdaptiveLatencyExtension(const EncodedFrame& frame,
+                                      absl::Span<uint8_t>* buffer);
+
   // The validated ctor RtpPayloadType arg, in wire-format form.
   const uint8_t payload_type_7bits_;
 
   const Ssrc sender_ssrc_;
   const int max_packet_size_;
+  const int fec_group_size_;
 
   // Incremented each time GeneratePacket() is called. Every packet, even those
   // re-transmitted, must have different sequence numbers (within wrap-around
   // concerns) per the RTP spec.
   uint16_t sequence_number_;
+
+  // Holds each protected payload, once encrypted, while computing the parity
+  // payload of a FEC packet for an unencrypted frame.
+  std::vector<uint8_t> fec_scratch_;
 };
 
 }  // namespace cast
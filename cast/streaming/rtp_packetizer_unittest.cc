@@ -4,8 +4,11 @@
 
 #include "cast/streaming/rtp_packetizer.h"
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "cast/streaming/frame_crypto.h"
@@ -129,7 +132,8 @@ class RtpPacketizerTest : public testing::Test {
   const Ssrc ssrc_{GenerateSsrc(true)};
   const FrameCrypto crypto_{GenerateRandomBytes16(), GenerateRandomBytes16()};
   RtpPacketizer packetizer_{kPayloadType, ssrc_,
-                            kMaxRtpPacketSizeForIpv4UdpOnEthernet};
+                            kMaxRtpPacketSizeForIpv4UdpOnEthernet,
+                            /*fec_group_size=*/0};
   RtpPacketParser parser_{ssrc_};
 
   // absl::nullopt until the random starting sequence number, from the first
@@ -204,6 +208,183 @@ TEST_F(RtpPacketizerTest, GeneratesPacketForRetransmission) {
   }
 }
 
+// Tests that FEC packets are generated after grouping the media packets, and
+// that each contains the XOR parity of the payloads it protects.
+TEST_F(RtpPacketizerTest, GeneratesFecPackets) {
+  constexpr Ssrc kSsrc = 42;
+  constexpr int kFecGroupSize = 3;
+  RtpPacketizer fec_packetizer(kPayloadType, kSsrc,
+                               kMaxRtpPacketSizeForIpv4UdpOnEthernet,
+                               kFecGroupSize);
+  RtpPacketParser parser(kSsrc);
+  const EncryptedFrame frame =
+      CreateFrame(FrameId::first() + 7, true, milliseconds(250), 10000);
+  const int num_packets = fec_packetizer.ComputeNumberOfPackets(frame);
+  ASSERT_EQ(7, num_packets);
+  const int num_fec_packets =
+      fec_packetizer.ComputeNumberOfFecPackets(num_packets);
+  ASSERT_EQ(3, num_fec_packets);
+  // With FEC disabled, there are never any FEC packets.
+  EXPECT_EQ(0, packetizer()->ComputeNumberOfFecPackets(num_packets));
+
+  // Collect the payloads of the media packets.
+  std::vector<std::vector<uint8_t>> payloads;
+  for (int i = 0; i < num_packets; ++i) {
+    uint8_t scratch[kMaxRtpPacketSizeForIpv4UdpOnEthernet];
+    const auto packet = fec_packetizer.GeneratePacket(
+        frame, static_cast<FramePacketId>(i), scratch);
+    const auto result = parser.Parse(packet);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(0, result->fec_protected_packet_count);
+    payloads.emplace_back(result->payload.begin(), result->payload.end());
+  }
+
+  for (int i = 0; i < num_fec_packets; ++i) {
+    SCOPED_TRACE(testing::Message() << "fec_index=" << i);
+    uint8_t scratch[kMaxRtpPacketSizeForIpv4UdpOnEthernet];
+    const auto packet = fec_packetizer.GenerateFecPacket(frame, i, scratch);
+    ASSERT_TRUE(IsSubspan(packet, scratch));
+    const auto result = parser.Parse(packet);
+    ASSERT_TRUE(result);
+
+    const int first = i * kFecGroupSize;
+    const int count = std::min(kFecGroupSize, num_packets - first);
+    EXPECT_EQ(frame.frame_id, result->frame_id);
+    EXPECT_EQ(first, int{result->packet_id});
+    EXPECT_EQ(num_packets - 1, int{result->max_packet_id});
+    EXPECT_EQ(count, result->fec_protected_packet_count);
+    EXPECT_TRUE(result->is_key_frame);
+    EXPECT_EQ(frame.rtp_timestamp, result->rtp_timestamp);
+    // Only the FEC packet protecting the first packet carries its Adaptive
+    // Latency information.
+    EXPECT_EQ(first == 0 ? frame.new_playout_delay : milliseconds(0),
+              result->new_playout_delay);
+
+    std::vector<uint8_t> expected_parity(payloads[first].size());
+    uint16_t expected_size_xor = 0;
+    for (int j = first; j < first + count; ++j) {
+      for (size_t k = 0; k < payloads[j].size(); ++k) {
+        expected_parity[k] ^= payloads[j][k];
+      }
+      expected_size_xor ^= static_cast<uint16_t>(payloads[j].size());
+    }
+    EXPECT_EQ(expected_size_xor, result->fec_payload_size_xor);
+    EXPECT_EQ(absl::Span<const uint8_t>(expected_parity), result->payload);
+  }
+}
+
+// Tests that generating packets from an unencrypted frame, encrypting each
+// packet's part of the payload along the way, produces the same packets as
+// generating them from the frame encrypted up-front.
+TEST_F(RtpPacketizerTest, EncryptsPayloadWhileGeneratingPackets) {
+  constexpr Ssrc kSsrc = 42;
+  constexpr int kFecGroupSize = 3;
+  const FrameCrypto crypto(GenerateRandomBytes16(), GenerateRandomBytes16());
+
+  std::vector<uint8_t> buffer(10000);
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    buffer[i] = static_cast<uint8_t>(i * 7);
+  }
+  EncodedFrame frame;
+  frame.dependency = EncodedFrame::KEY_FRAME;
+  frame.frame_id = FrameId::first() + 300;
+  frame.referenced_frame_id = frame.frame_id;
+  frame.rtp_timestamp = RtpTimeTicks() + RtpTimeDelta::FromTicks(987);
+  frame.reference_time = Clock::now();
+  frame.new_playout_delay = milliseconds(250);
+  frame.data = absl::Span<uint8_t>(buffer);
+  const EncryptedFrame encrypted_frame = crypto.Encrypt(frame);
+
+  RtpPacketizer expected_packetizer(kPayloadType, kSsrc,
+                                    kMaxRtpPacketSizeForIpv4UdpOnEthernet,
+                                    kFecGroupSize);
+  RtpPacketizer packetizer(kPayloadType, kSsrc,
+                           kMaxRtpPacketSizeForIpv4UdpOnEthernet,
+                           kFecGroupSize);
+  const int num_packets = packetizer.ComputeNumberOfPackets(frame);
+  ASSERT_EQ(expected_packetizer.ComputeNumberOfPackets(encrypted_frame),
+            num_packets);
+  const int num_fec_packets = packetizer.ComputeNumberOfFecPackets(num_packets);
+  ASSERT_LT(0, num_fec_packets);
+
+  // Each packetizer starts with a random sequence number, and so those bytes
+  // of the RTP header are ignored.
+  const auto ExpectSamePackets = [](absl::Span<uint8_t> expected,
+                                    absl::Span<uint8_t> actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    expected[2] = expected[3] = actual[2] = actual[3] = 0;
+    EXPECT_EQ(absl::Span<const uint8_t>(expected),
+              absl::Span<const uint8_t>(actual));
+  };
+  uint8_t expected_scratch[kMaxRtpPacketSizeForIpv4UdpOnEthernet];
+  uint8_t scratch[kMaxRtpPacketSizeForIpv4UdpOnEthernet];
+  for (int i = 0; i < num_packets; ++i) {
+    SCOPED_TRACE(testing::Message() << "packet_id=" << i);
+    const FramePacketId packet_id = static_cast<FramePacketId>(i);
+    ExpectSamePackets(expected_packetizer.GeneratePacket(
+                          encrypted_frame, packet_id, expected_scratch),
+                      packetizer.GeneratePacket(frame, crypto, packet_id,
+                                                scratch));
+  }
+  for (int i = 0; i < num_fec_packets; ++i) {
+    SCOPED_TRACE(testing::Message() << "fec_index=" << i);
+    ExpectSamePackets(
+        expected_packetizer.GenerateFecPacket(encrypted_frame, i,
+                                              expected_scratch),
+        packetizer.GenerateFecPacket(frame, crypto, i, scratch));
+  }
+}
+
+// Simulates packetizing a stream of large (e.g., 4K key) frames using the max
+// packet sizes computed from the path MTUs of a VPN link, standard Ethernet,
+// and a jumbo-frame LAN. Records the number of packets per frame and the time
+// spent generating them, since each packet also has a fixed cost in the
+// SenderPacketRouter, the network stack, and at the Receiver.
+TEST_F(RtpPacketizerTest, GeneratesFewerPacketsForLargerPathMtus) {
+  constexpr int kFrameSize = 200000;
+  constexpr int kNumFrames = 50;
+  const EncryptedFrame frame =
+      CreateFrame(FrameId::first(), true, milliseconds(0), kFrameSize);
+
+  struct Link {
+    const char* name;
+    int path_mtu;
+    int num_packets_per_frame;
+  };
+  Link links[] = {{"vpn", 1400, 0}, {"ethernet", 1500, 0}, {"jumbo", 9000, 0}};
+  for (Link& link : links) {
+    const int max_packet_size =
+        link.path_mtu - kIpv4HeaderSize - kUdpHeaderSize;
+    RtpPacketizer link_packetizer(kPayloadType, 42, max_packet_size,
+                                  /*fec_group_size=*/0);
+    std::vector<uint8_t> scratch(max_packet_size);
+    link.num_packets_per_frame = link_packetizer.ComputeNumberOfPackets(frame);
+
+    const Clock::time_point start_time = Clock::now();
+    int64_t num_bytes = 0;
+    for (int i = 0; i < kNumFrames; ++i) {
+      for (int j = 0; j < link.num_packets_per_frame; ++j) {
+        num_bytes += link_packetizer
+                         .GeneratePacket(frame, static_cast<FramePacketId>(j),
+                                         absl::Span<uint8_t>(scratch))
+                         .size();
+      }
+    }
+    const auto elapsed = to_microseconds(Clock::now() - start_time);
+    EXPECT_LT(int64_t{kFrameSize} * kNumFrames, num_bytes);
+
+    ::testing::Test::RecordProperty(
+        std::string(link.name) + "_packets_per_frame",
+        link.num_packets_per_frame);
+    ::testing::Test::RecordProperty(
+        std::string(link.name) + "_packetize_us_per_frame",
+        static_cast<int>(elapsed.count() / kNumFrames));
+  }
+
+  EXPECT_GT(links[0].num_packets_per_frame, links[1].num_packets_per_frame);
+  EXPECT_LT(links[2].num_packets_per_frame * 5, links[1].num_packets_per_frame);
+}
+
 }  // namespace
 }  // namespace cast
 }  // namespace openscreen
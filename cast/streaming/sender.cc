@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <chrono>
 #include <ratio>
+#include <utility>
 
 #include "cast/streaming/session_config.h"
 #include "util/chrono_helpers.h"
@@ -22,7 +23,8 @@ Sender::Sender(Environment* environment,
                SenderPacketRouter* packet_router,
                SessionConfig config,
                RtpPayloadType rtp_payload_type)
-    : config_(config),
+    : now_(environment->now_function()),
+      config_(config),
       packet_router_(packet_router),
       rtcp_session_(config.sender_ssrc,
                     config.receiver_ssrc,
@@ -31,11 +33,15 @@ Sender::Sender(Environment* environment,
       sender_report_builder_(&rtcp_session_),
       rtp_packetizer_(rtp_payload_type,
                       config.sender_ssrc,
-                      packet_router_->max_packet_size()),
+                      packet_router_->max_packet_size(),
+                      config.fec_group_size),
       rtp_timebase_(config.rtp_timebase),
       crypto_(config.aes_secret_key, config.aes_iv_mask),
+      pending_frames_(config.max_unacked_frames),
       target_playout_delay_(config.target_playout_delay) {
   OSP_DCHECK(packet_router_);
+  OSP_DCHECK_GE(config.max_unacked_frames, kMinUnackedFrames);
+  OSP_DCHECK_LE(config.max_unacked_frames, kMaxUnackedFrames);
   OSP_DCHECK_NE(rtcp_session_.sender_ssrc(), rtcp_session_.receiver_ssrc());
   OSP_DCHECK_GT(rtp_timebase_, 0);
   OSP_DCHECK(target_playout_delay_ > milliseconds::zero());
@@ -95,20 +101,34 @@ FrameId Sender::GetNextFrameId() const {
 }
 
 Sender::EnqueueFrameResult Sender::EnqueueFrame(const EncodedFrame& frame) {
+  OSP_DCHECK(frame.data.data());
+  return EnqueueFrameCommon(frame, nullptr);
+}
+
+Sender::EnqueueFrameResult Sender::EnqueueSharedFrame(
+    const EncodedFrame& frame,
+    std::shared_ptr<const std::vector<uint8_t>> payload) {
+  OSP_DCHECK(payload);
+  return EnqueueFrameCommon(frame, std::move(payload));
+}
+
+Sender::EnqueueFrameResult Sender::EnqueueFrameCommon(
+    const EncodedFrame& frame,
+    std::shared_ptr<const std::vector<uint8_t>> shared_payload) {
   // Assume the fields of the |frame| have all been set correctly, with
-  // monotonically increasing timestamps and a valid pointer to the data.
+  // monotonically increasing timestamps.
   OSP_DCHECK_EQ(frame.frame_id, GetNextFrameId());
   OSP_DCHECK_GE(frame.referenced_frame_id, FrameId::first());
   if (frame.frame_id != FrameId::first()) {
     OSP_DCHECK_GT(frame.rtp_timestamp, pending_sender_report_.rtp_timestamp);
     OSP_DCHECK_GT(frame.reference_time, pending_sender_report_.reference_time);
   }
-  OSP_DCHECK(frame.data.data());
 
   // Check whether enqueuing the frame would exceed the design limit for the
-  // span of FrameIds. Even if |num_frames_in_flight_| is less than
-  // kMaxUnackedFrames, it's the span of FrameIds that is restricted.
-  if ((frame.frame_id - checkpoint_frame_id_) > kMaxUnackedFrames) {
+  // span of FrameIds. Even if |num_frames_in_flight_| is less than the size of
+  // |pending_frames_|, it's the span of FrameIds that is restricted.
+  if ((frame.frame_id - checkpoint_frame_id_) >
+      static_cast<int>(pending_frames_.size())) {
     return REACHED_ID_SPAN_LIMIT;
   }
 
@@ -119,20 +139,41 @@ Sender::EnqueueFrameResult Sender::EnqueueFrame(const EncodedFrame& frame) {
     return MAX_DURATION_IN_FLIGHT;
   }
 
-  // Encrypt the frame and initialize the slot tracking its sending.
+  // Encrypt the frame, unless its payload is shared, and initialize the slot
+  // tracking its sending. A shared payload is encrypted one packet at a time,
+  // as each is generated.
   PendingFrameSlot* const slot = get_slot_for(frame.frame_id);
   OSP_DCHECK(!slot->frame);
-  slot->frame = crypto_.Encrypt(frame);
+  if (shared_payload) {
+    slot->frame.emplace();
+    frame.CopyMetadataTo(&*slot->frame);
+    // The payload is never mutated. See comments for EncodedFrame::data.
+    slot->frame->data =
+        absl::Span<uint8_t>(const_cast<uint8_t*>(shared_payload->data()),
+                            shared_payload->size());
+    slot->shared_payload = std::move(shared_payload);
+  } else {
+    slot->frame = crypto_.Encrypt(frame);
+  }
   const int packet_count = rtp_packetizer_.ComputeNumberOfPackets(*slot->frame);
   if (packet_count <= 0) {
     slot->frame.reset();
+    slot->shared_payload.reset();
     return PAYLOAD_TOO_LARGE;
   }
-  slot->send_flags.Resize(packet_count, YetAnotherBitVector::SET);
-  slot->packet_sent_times.assign(packet_count, SenderPacketRouter::kNever);
+  // FEC packets are sent once, right after the media packets. They are never
+  // re-transmitted: Re-transmitting the lost media packets is always as cheap.
+  const int total_count =
+      packet_count + rtp_packetizer_.ComputeNumberOfFecPackets(packet_count);
+  slot->num_media_packets = packet_count;
+  slot->send_flags.Resize(total_count, YetAnotherBitVector::SET);
+  slot->packet_sent_times.assign(total_count, SenderPacketRouter::kNever);
+  slot->enqueue_time = now_();
+  slot->num_media_packets_sent = 0;
 
   // Officially record the "enqueue."
   ++num_frames_in_flight_;
+  ++stats_.num_frames_enqueued;
   last_enqueued_frame_id_ = slot->frame->frame_id;
   OSP_DCHECK_LE(num_frames_in_flight_,
                 last_enqueued_frame_id_ - checkpoint_frame_id_);
@@ -146,6 +187,13 @@ Sender::EnqueueFrameResult Sender::EnqueueFrame(const EncodedFrame& frame) {
     playout_delay_change_at_frame_id_ = slot->frame->frame_id;
   }
 
+  if (frame_timelines_) {
+    frame_timelines_->RecordStage(frame.frame_id, FrameStage::kCaptured,
+                                  frame.reference_time);
+    frame_timelines_->RecordStage(frame.frame_id, FrameStage::kEnqueued,
+                                  slot->enqueue_time);
+  }
+
   // Update the lip-sync information for the next Sender Report.
   pending_sender_report_.reference_time = slot->frame->reference_time;
   pending_sender_report_.rtp_timestamp = slot->frame->rtp_timestamp;
@@ -173,10 +221,22 @@ Sender::EnqueueFrameResult Sender::EnqueueFrame(const EncodedFrame& frame) {
 void Sender::CancelInFlightData() {
   while (checkpoint_frame_id_ <= last_enqueued_frame_id_) {
     ++checkpoint_frame_id_;
-    CancelPendingFrame(checkpoint_frame_id_);
+    CancelPendingFrame(checkpoint_frame_id_, false);
   }
 }
 
+void Sender::EnableFrameTimelines(FrameTimelineRecorder::Client* client) {
+  frame_timelines_.emplace("Sender::Frame", ssrc(),
+                           static_cast<int>(pending_frames_.size()), client);
+}
+
+SenderStats Sender::GetStats() const {
+  SenderStats stats = stats_;
+  stats.round_trip_time = round_trip_time_;
+  stats.estimated_bandwidth = packet_router_->ComputeNetworkBandwidth();
+  return stats;
+}
+
 void Sender::OnReceivedRtcpPacket(Clock::time_point arrival_time,
                                   absl::Span<const uint8_t> packet) {
   rtcp_packet_arrival_time_ = arrival_time;
@@ -232,10 +292,41 @@ absl::Span<uint8_t> Sender::GetRtpPacketForImmediateSend(
     OSP_DCHECK(chosen);
   }
 
-  const absl::Span<uint8_t> result = rtp_packetizer_.GeneratePacket(
-      *chosen.slot->frame, chosen.packet_id, buffer);
+  const int fec_index = int{chosen.packet_id} - chosen.slot->num_media_packets;
+  const EncryptedFrame& frame = *chosen.slot->frame;
+  absl::Span<uint8_t> result;
+  if (chosen.slot->shared_payload) {
+    const EncodedFrame& unencrypted_frame = frame;
+    result = (fec_index >= 0)
+                 ? rtp_packetizer_.GenerateFecPacket(unencrypted_frame, crypto_,
+                                                     fec_index, buffer)
+                 : rtp_packetizer_.GeneratePacket(unencrypted_frame, crypto_,
+                                                  chosen.packet_id, buffer);
+  } else {
+    result = (fec_index >= 0)
+                 ? rtp_packetizer_.GenerateFecPacket(frame, fec_index, buffer)
+                 : rtp_packetizer_.GeneratePacket(frame, chosen.packet_id,
+                                                  buffer);
+  }
   chosen.slot->send_flags.Clear(chosen.packet_id);
+  if (fec_index < 0 && chosen.slot->packet_sent_times[chosen.packet_id] ==
+                           SenderPacketRouter::kNever) {
+    const FrameId frame_id = frame.frame_id;
+    if (++chosen.slot->num_media_packets_sent == 1 && frame_timelines_) {
+      frame_timelines_->RecordStage(frame_id, FrameStage::kFirstPacketSent,
+                                    send_time);
+    }
+    if (chosen.slot->num_media_packets_sent ==
+        chosen.slot->num_media_packets) {
+      ++stats_.num_frames_sent;
+      if (frame_timelines_) {
+        frame_timelines_->RecordStage(frame_id, FrameStage::kLastPacketSent,
+                                      send_time);
+      }
+    }
+  }
   chosen.slot->packet_sent_times[chosen.packet_id] = send_time;
+  ++stats_.num_packets_sent;
 
   ++pending_sender_report_.send_packet_count;
   // According to RFC3550, the octet count does not include the RTP header. The
@@ -315,6 +406,8 @@ void Sender::OnReceiverReport(const RtcpReportBlock& receiver_report) {
 }
 
 void Sender::OnReceiverIndicatesPictureLoss() {
+  ++stats_.num_plis_received;
+
   // The Receiver will continue the PLI notifications until it has received a
   // key frame. Thus, if a key frame is already in-flight, don't make a state
   // change that would cause this Sender to force another expensive key frame.
@@ -354,14 +447,21 @@ void Sender::OnReceiverCheckpoint(FrameId frame_id,
 
   while (checkpoint_frame_id_ < frame_id) {
     ++checkpoint_frame_id_;
-    CancelPendingFrame(checkpoint_frame_id_);
+    CancelPendingFrame(checkpoint_frame_id_, true);
   }
   latest_expected_frame_id_ = std::max(latest_expected_frame_id_, frame_id);
 
-  if (playout_delay != target_playout_delay_ &&
+  // Once the Receiver has acknowledged the frame carrying this Sender's latest
+  // target playout delay change, any difference means the Receiver has since
+  // adapted the delay on its own (e.g., in response to network jitter). Adopt
+  // its setting, since that is what actually determines when frames must
+  // arrive.
+  if (playout_delay > milliseconds::zero() &&
+      playout_delay != target_playout_delay_ &&
       frame_id >= playout_delay_change_at_frame_id_) {
-    OSP_LOG_WARN << "Sender's target playout delay (" << target_playout_delay_
-                 << ") disagrees with the Receiver's (" << playout_delay << ")";
+    OSP_LOG_INFO << "Receiver changed the target playout delay from "
+                 << target_playout_delay_ << " to " << playout_delay << '.';
+    target_playout_delay_ = playout_delay;
   }
 }
 
@@ -378,11 +478,32 @@ void Sender::OnReceiverHasFrames(std::vector<FrameId> acks) {
   }
 
   for (FrameId id : acks) {
-    CancelPendingFrame(id);
+    CancelPendingFrame(id, true);
   }
   latest_expected_frame_id_ = std::max(latest_expected_frame_id_, acks.back());
 }
 
+void Sender::OnReceiverPacketArrivals(std::vector<PacketArrival> arrivals) {
+  // Match each arrival with the time the packet was last sent, and provide both
+  // to the congestion control logic. Arrivals for frames no longer being
+  // tracked, or for packets never sent, are ignored.
+  for (const PacketArrival& arrival : arrivals) {
+    if (arrival.frame_id > last_enqueued_frame_id_) {
+      continue;
+    }
+    const PendingFrameSlot* const slot = get_slot_for(arrival.frame_id);
+    if (!slot->is_active_for_frame(arrival.frame_id) ||
+        arrival.packet_id >= slot->num_media_packets) {
+      continue;
+    }
+    const Clock::time_point send_time =
+        slot->packet_sent_times[arrival.packet_id];
+    if (send_time != SenderPacketRouter::kNever) {
+      packet_router_->OnPacketArrival(ssrc(), send_time, arrival.arrival_time);
+    }
+  }
+}
+
 void Sender::OnReceiverIsMissingPackets(std::vector<PacketNack> nacks) {
   OSP_DCHECK(!nacks.empty() && AreElementsSortedAndUnique(nacks));
   OSP_DCHECK_NE(rtcp_packet_arrival_time_, SenderPacketRouter::kNever);
@@ -425,20 +546,33 @@ void Sender::OnReceiverIsMissingPackets(std::vector<PacketNack> nacks) {
     // NOLINTNEXTLINE
     latest_expected_frame_id_ = std::max(latest_expected_frame_id_, frame_id);
 
+    // Consecutive NACK reports will often mention the same packets. Only
+    // retransmit each once: Skip those already queued for sending, as well as
+    // those sent too recently.
     const auto HandleIndividualNack = [&](FramePacketId packet_id) {
-      if (slot->packet_sent_times[packet_id] <= too_recent_a_send_time) {
-        slot->send_flags.Set(packet_id);
-        need_to_send = true;
+      if (slot->send_flags.IsSet(packet_id) ||
+          slot->packet_sent_times[packet_id] > too_recent_a_send_time) {
+        // A packet that has not been sent even once is still awaiting its
+        // first transmission, so there is no duplicate re-transmit to avoid.
+        if (slot->packet_sent_times[packet_id] != SenderPacketRouter::kNever) {
+          ++stats_.num_duplicate_retransmits_avoided;
+        }
+        return;
       }
+      slot->send_flags.Set(packet_id);
+      ++stats_.num_packets_retransmitted;
+      need_to_send = true;
     };
-    const FramePacketId range_end = slot->packet_sent_times.size();
+    const FramePacketId range_end = slot->num_media_packets;
     if (nack_it->packet_id == kAllPacketsLost) {
+      ++stats_.num_nacks_received;
       for (FramePacketId packet_id = 0; packet_id < range_end; ++packet_id) {
         HandleIndividualNack(packet_id);
       }
       ++nack_it;
     } else {
       do {
+        ++stats_.num_nacks_received;
         if (nack_it->packet_id < range_end) {
           HandleIndividualNack(nack_it->packet_id);
         } else {
@@ -490,7 +624,7 @@ Sender::ChosenPacketAndWhen Sender::ChooseKickstartPacket() {
   // Note: This frame cannot have been canceled since
   // |latest_expected_frame_id_| hasn't yet reached this point.
   OSP_DCHECK(chosen.slot->is_active_for_frame(last_enqueued_frame_id_));
-  chosen.packet_id = chosen.slot->send_flags.size() - 1;
+  chosen.packet_id = chosen.slot->num_media_packets - 1;
 
   const Clock::time_point time_last_sent =
       chosen.slot->packet_sent_times[chosen.packet_id];
@@ -519,16 +653,33 @@ Sender::ChosenPacketAndWhen Sender::ChooseKickstartPacket() {
   return chosen;
 }
 
-void Sender::CancelPendingFrame(FrameId frame_id) {
+void Sender::CancelPendingFrame(FrameId frame_id, bool was_acked) {
   PendingFrameSlot* const slot = get_slot_for(frame_id);
   if (!slot->is_active_for_frame(frame_id)) {
     return;  // Frame was already canceled.
   }
 
+  if (was_acked) {
+    ++stats_.num_frames_acked;
+    stats_.frame_ack_latency_ms.Add(
+        to_milliseconds(rtcp_packet_arrival_time_ - slot->enqueue_time)
+            .count());
+  } else {
+    ++stats_.num_frames_canceled;
+  }
+  if (frame_timelines_) {
+    if (was_acked) {
+      frame_timelines_->RecordStage(frame_id, FrameStage::kAcked,
+                                    rtcp_packet_arrival_time_);
+    }
+    frame_timelines_->FinishFrame(frame_id, !was_acked);
+  }
+
   packet_router_->OnPayloadReceived(
       slot->frame->data.size(), rtcp_packet_arrival_time_, round_trip_time_);
 
   slot->frame.reset();
+  slot->shared_payload.reset();
   OSP_DCHECK_GT(num_frames_in_flight_, 0);
   --num_frames_in_flight_;
   if (observer_) {
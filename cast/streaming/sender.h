@@ -7,8 +7,8 @@
 
 #include <stdint.h>
 
-#include <array>
 #include <chrono>
+#include <memory>
 #include <vector>
 
 #include "absl/types/span.h"
@@ -16,12 +16,14 @@
 #include "cast/streaming/constants.h"
 #include "cast/streaming/frame_crypto.h"
 #include "cast/streaming/frame_id.h"
+#include "cast/streaming/frame_timeline.h"
 #include "cast/streaming/rtp_defines.h"
 #include "cast/streaming/rtp_packetizer.h"
 #include "cast/streaming/rtp_time.h"
 #include "cast/streaming/sender_packet_router.h"
 #include "cast/streaming/sender_report_builder.h"
 #include "cast/streaming/session_config.h"
+#include "cast/streaming/statistics.h"
 #include "platform/api/time.h"
 #include "util/yet_another_bit_vector.h"
 
@@ -134,6 +136,19 @@ class Sender final : public SenderPacketRouter::Sender,
   // throttling decisions.
   int GetInFlightFrameCount() const;
 
+  // Returns a snapshot of the statistics tracked since this Sender was
+  // created. This is cheap enough to be polled periodically.
+  SenderStats GetStats() const;
+
+  // Starts recording the FrameTimeline of each frame, from capture until it is
+  // ACKed (or canceled), and emitting these as trace spans. If |client| is not
+  // null, it is notified as each frame's timeline is finished. The timelines of
+  // the most recent frames can be inspected via frame_timelines().
+  void EnableFrameTimelines(FrameTimelineRecorder::Client* client);
+  const FrameTimelineRecorder* frame_timelines() const {
+    return frame_timelines_ ? &*frame_timelines_ : nullptr;
+  }
+
   // Returns the total media duration of the frames currently in-flight,
   // assuming the next not-yet-enqueued frame will have the given RTP timestamp.
   // For a better user experience, the result should be compared to
@@ -168,6 +183,15 @@ class Sender final : public SenderPacketRouter::Sender,
   // prior frame; and the frame's |data| pointer must be set.
   [[nodiscard]] EnqueueFrameResult EnqueueFrame(const EncodedFrame& frame);
 
+  // Like EnqueueFrame(), except that the |frame|'s payload is the given
+  // |payload| instead of its |data|, and is not copied. It is also not
+  // encrypted up-front: Each packet's part of it is encrypted as the packet is
+  // generated. This allows several Senders to share one payload (see
+  // SenderGroup) while each uses its own keys.
+  [[nodiscard]] EnqueueFrameResult EnqueueSharedFrame(
+      const EncodedFrame& frame,
+      std::shared_ptr<const std::vector<uint8_t>> payload);
+
   // Causes all pending operations to discard data when they are processed
   // later.
   void CancelInFlightData();
@@ -179,16 +203,31 @@ class Sender final : public SenderPacketRouter::Sender,
     // The frame to send, or nullopt if this slot is not in use.
     absl::optional<EncryptedFrame> frame;
 
+    // For a frame from EnqueueSharedFrame(), the unencrypted payload. In this
+    // case, the |frame|'s data refers to this payload rather than to encrypted
+    // data of its own.
+    std::shared_ptr<const std::vector<uint8_t>> shared_payload;
+
+    // The number of media packets in the frame. Any FEC packets are tracked
+    // after these in |send_flags| and |packet_sent_times|.
+    int num_media_packets = 0;
+
     // Represents which packets need to be sent. Elements are indexed by
-    // FramePacketId. A set bit means a packet needs to be sent (or re-sent).
+    // FramePacketId, followed by one element per FEC packet. A set bit means a
+    // packet needs to be sent (or re-sent).
     YetAnotherBitVector send_flags;
 
     // The time when each of the packets was last sent, or
     // |SenderPacketRouter::kNever| if the packet has not been sent yet.
-    // Elements are indexed by FramePacketId. This is used to avoid
+    // Elements are indexed like |send_flags|. This is used to avoid
     // re-transmitting any given packet too frequently.
     std::vector<Clock::time_point> packet_sent_times;
 
+    // When the frame was enqueued, and the number of media packets that have
+    // been sent at least once. These are used for SenderStats.
+    Clock::time_point enqueue_time;
+    int num_media_packets_sent = 0;
+
     PendingFrameSlot();
     ~PendingFrameSlot();
 
@@ -230,6 +269,13 @@ class Sender final : public SenderPacketRouter::Sender,
                             std::chrono::milliseconds playout_delay) final;
   void OnReceiverHasFrames(std::vector<FrameId> acks) final;
   void OnReceiverIsMissingPackets(std::vector<PacketNack> nacks) final;
+  void OnReceiverPacketArrivals(std::vector<PacketArrival> arrivals) final;
+
+  // Implementation of EnqueueFrame() and EnqueueSharedFrame(). If
+  // |shared_payload| is null, the |frame|'s data is encrypted and copied.
+  EnqueueFrameResult EnqueueFrameCommon(
+      const EncodedFrame& frame,
+      std::shared_ptr<const std::vector<uint8_t>> shared_payload);
 
   // Helper to choose which packet to send, from those that have been flagged as
   // "need to send." Returns a "false" result if nothing needs to be sent.
@@ -241,9 +287,10 @@ class Sender final : public SenderPacketRouter::Sender,
   ChosenPacketAndWhen ChooseKickstartPacket();
 
   // Cancels the given frame once it is known to have been fully received (i.e.,
-  // based on the ACK feedback from the Receiver in a RTCP packet). This clears
-  // the corresponding entry in |pending_frames_| and notifies the Observer.
-  void CancelPendingFrame(FrameId frame_id);
+  // based on the ACK feedback from the Receiver in a RTCP packet), or when it
+  // is no longer needed (|was_acked| is false). This clears the corresponding
+  // entry in |pending_frames_| and notifies the Observer.
+  void CancelPendingFrame(FrameId frame_id, bool was_acked);
 
   // Inline helper to return the slot that would contain the tracking info for
   // the given |frame_id|.
@@ -256,6 +303,7 @@ class Sender final : public SenderPacketRouter::Sender,
                             pending_frames_.size()];
   }
 
+  const ClockNowFunctionPtr now_;
   const SessionConfig config_;
   SenderPacketRouter* const packet_router_;
   RtcpSession rtcp_session_;
@@ -265,10 +313,11 @@ class Sender final : public SenderPacketRouter::Sender,
   const int rtp_timebase_;
   FrameCrypto crypto_;
 
-  // Ring buffer of PendingFrameSlots. The frame having FrameId x will always
-  // be slotted at position x % pending_frames_.size(). Use get_slot_for() to
-  // access the correct slot for a given FrameId.
-  std::array<PendingFrameSlot, kMaxUnackedFrames> pending_frames_{};
+  // Ring buffer of PendingFrameSlots, sized to the session's
+  // |max_unacked_frames|. The frame having FrameId x will always be slotted at
+  // position x % pending_frames_.size(). Use get_slot_for() to access the
+  // correct slot for a given FrameId.
+  std::vector<PendingFrameSlot> pending_frames_;
 
   // A count of the number of frames in-flight (i.e., the number of active
   // entries in |pending_frames_|).
@@ -286,7 +335,8 @@ class Sender final : public SenderPacketRouter::Sender,
   FrameId latest_expected_frame_id_ = FrameId::leader();
 
   // The target playout delay for the last-enqueued frame. This is auto-updated
-  // when a frame is enqueued that changes the delay.
+  // when a frame is enqueued that changes the delay, or when the Receiver
+  // reports that it has adapted the delay.
   std::chrono::milliseconds target_playout_delay_;
   FrameId playout_delay_change_at_frame_id_ = FrameId::first();
 
@@ -298,6 +348,13 @@ class Sender final : public SenderPacketRouter::Sender,
   // round trip time has not been measured yet.
   Clock::duration round_trip_time_{0};
 
+  // Counters and histograms returned by GetStats(). The |round_trip_time| and
+  // |estimated_bandwidth| fields are filled-in only when a snapshot is taken.
+  SenderStats stats_;
+
+  // Records per-frame timelines, if enabled. See EnableFrameTimelines().
+  absl::optional<FrameTimelineRecorder> frame_timelines_;
+
   // Maintain current stats in a Sender Report that is ready for sending at any
   // time. This includes up-to-date lip-sync information, and packet and byte
   // count stats.
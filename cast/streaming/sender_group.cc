@@ -0,0 +1,82 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/sender_group.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "cast/streaming/sender.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+SenderGroup::SenderGroup() = default;
+
+SenderGroup::~SenderGroup() = default;
+
+void SenderGroup::AddSender(Sender* sender) {
+  OSP_DCHECK(sender);
+  OSP_DCHECK(std::none_of(
+      members_.begin(), members_.end(),
+      [sender](const Member& member) { return member.sender == sender; }));
+  members_.push_back(Member{sender});
+}
+
+void SenderGroup::RemoveSender(Sender* sender) {
+  members_.erase(
+      std::remove_if(
+          members_.begin(), members_.end(),
+          [sender](const Member& member) { return member.sender == sender; }),
+      members_.end());
+}
+
+bool SenderGroup::NeedsKeyFrame() const {
+  return std::any_of(members_.begin(), members_.end(),
+                     [](const Member& member) {
+                       return member.needs_key_frame ||
+                              member.sender->NeedsKeyFrame();
+                     });
+}
+
+int SenderGroup::EnqueueFrame(const EncodedFrame& frame) {
+  const bool is_key_frame = frame.dependency == EncodedFrame::KEY_FRAME;
+  const int reference_distance = frame.frame_id - frame.referenced_frame_id;
+  OSP_DCHECK_GE(reference_distance, 0);
+
+  // Each Sender is given a copy of the frame's metadata, relabeled with its own
+  // FrameIds, along with one shared copy of the payload. The payload is only
+  // copied if at least one Sender will take it.
+  EncodedFrame relabeled;
+  frame.CopyMetadataTo(&relabeled);
+  std::shared_ptr<const std::vector<uint8_t>> payload;
+  int num_accepted = 0;
+  for (Member& member : members_) {
+    if (member.needs_key_frame && !is_key_frame) {
+      continue;
+    }
+
+    relabeled.frame_id = member.sender->GetNextFrameId();
+    relabeled.referenced_frame_id =
+        is_key_frame ? relabeled.frame_id
+                     : relabeled.frame_id - reference_distance;
+    if (!payload) {
+      payload = std::make_shared<const std::vector<uint8_t>>(frame.data.begin(),
+                                                             frame.data.end());
+    }
+    if (member.sender->EnqueueSharedFrame(relabeled, payload) == Sender::OK) {
+      member.needs_key_frame = false;
+      ++num_accepted;
+    } else {
+      // The Sender's FrameIds no longer line up with the frames that depend on
+      // this one, so it must wait for the next key frame.
+      member.needs_key_frame = true;
+    }
+  }
+  return num_accepted;
+}
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,70 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_SENDER_GROUP_H_
+#define CAST_STREAMING_SENDER_GROUP_H_
+
+#include <vector>
+
+#include "cast/streaming/encoded_frame.h"
+
+namespace openscreen {
+namespace cast {
+
+class Sender;
+
+// Fans out one encoded stream to the Senders of multiple streaming sessions
+// (e.g., mirroring the same screen to several Receivers). The encoded payload
+// of each frame is copied once, into a reference-counted buffer shared by all
+// the Senders (see Sender::EnqueueSharedFrame()). Each Sender encrypts only the
+// part of it carried by each packet, as the packet is generated, and so the
+// per-Sender state is just the packet headers and re-transmission state.
+//
+// Each Sender encrypts with its own AES key and IV mask (see SessionConfig),
+// since the encryption nonce is derived from the FrameId alone: Sharing keys
+// would re-use the AES-CTR keystream whenever two Senders' FrameIds map to
+// different payloads, such as after a Sender joins late or rejects a frame.
+//
+// Each Sender also assigns its own FrameIds, and so the frames passed to
+// EnqueueFrame() are re-labeled for each Sender. A Sender that joins late, or
+// that rejects a frame, is given its frames from its next key frame onwards.
+class SenderGroup {
+ public:
+  SenderGroup();
+  ~SenderGroup();
+
+  // Adds/Removes a Sender to/from the group. The |sender| must outlive its
+  // membership in the group. A newly-added Sender is only given frames starting
+  // with the next key frame.
+  void AddSender(Sender* sender);
+  void RemoveSender(Sender* sender);
+  int num_senders() const { return static_cast<int>(members_.size()); }
+
+  // Returns true if any of the Senders in the group needs a key frame.
+  bool NeedsKeyFrame() const;
+
+  // Enqueues the given |frame| with each of the Senders in the group that can
+  // accept it, and returns the number that did. The |frame_id| and
+  // |referenced_frame_id| need only be consistent with each other: Each Sender
+  // is given the frame under its own GetNextFrameId(). Senders waiting for a
+  // key frame are skipped, and a Sender that rejects the frame waits for the
+  // next key frame.
+  int EnqueueFrame(const EncodedFrame& frame);
+
+ private:
+  struct Member {
+    Sender* sender;
+
+    // Set until the Sender has accepted a key frame, after joining or
+    // rejecting a frame.
+    bool needs_key_frame = true;
+  };
+
+  std::vector<Member> members_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_SENDER_GROUP_H_
@@ -0,0 +1,411 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/sender_group.h"
+
+#include <stdint.h>
+
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/frame_collector.h"
+#include "cast/streaming/frame_crypto.h"
+#include "cast/streaming/frame_id.h"
+#include "cast/streaming/mock_environment.h"
+#include "cast/streaming/packet_util.h"
+#include "cast/streaming/rtp_defines.h"
+#include "cast/streaming/rtp_packet_parser.h"
+#include "cast/streaming/sender.h"
+#include "cast/streaming/sender_packet_router.h"
+#include "cast/streaming/session_config.h"
+#include "cast/streaming/ssrc.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "platform/api/time.h"
+#include "platform/test/fake_clock.h"
+#include "platform/test/fake_task_runner.h"
+#include "util/chrono_helpers.h"
+#include "util/crypto/random_bytes.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+constexpr int kRtpTimebase = 90000;
+constexpr int kFramesPerSecond = 30;
+constexpr milliseconds kFrameDuration{1000 / kFramesPerSecond};
+
+// Long enough that none of the frames enqueued by these tests are rejected for
+// exceeding the maximum in-flight media duration.
+constexpr milliseconds kTargetPlayoutDelay{2000};
+
+// Send all packets in one burst, so the tests need not wait long for them.
+constexpr int kNumPacketsPerBurst = 10000;
+constexpr milliseconds kBurstInterval{10};
+
+// An EncodedFrame that also holds onto its own copy of data.
+struct EncodedFrameWithBuffer : public EncodedFrame {
+  std::vector<uint8_t> buffer;
+};
+
+// Reassembles and decrypts the frames sent by each Sender, keyed by its SSRC.
+class FakeReceivers {
+ public:
+  // Adds a Receiver for the Sender having the given |ssrc| and keys.
+  void AddReceiver(Ssrc ssrc,
+                   const std::array<uint8_t, 16>& aes_key,
+                   const std::array<uint8_t, 16>& aes_iv_mask) {
+    cryptos_.emplace(std::piecewise_construct, std::forward_as_tuple(ssrc),
+                     std::forward_as_tuple(aes_key, aes_iv_mask));
+    parsers_.emplace(ssrc, RtpPacketParser(ssrc));
+  }
+
+  void OnPacketSent(absl::Span<const uint8_t> packet) {
+    const std::pair<ApparentPacketType, Ssrc> type_and_ssrc =
+        InspectPacketForRouting(packet);
+    if (type_and_ssrc.first != ApparentPacketType::RTP) {
+      return;
+    }
+    const Ssrc ssrc = type_and_ssrc.second;
+    const auto parser_it = parsers_.find(ssrc);
+    ASSERT_NE(parsers_.end(), parser_it);
+    std::vector<uint8_t> buffer(packet.begin(), packet.end());
+    const absl::optional<RtpPacketParser::ParseResult> part =
+        parser_it->second.Parse(buffer);
+    ASSERT_TRUE(part);
+
+    std::map<FrameId, ReceivedFrame>& complete = complete_frames_[ssrc];
+    if (complete.find(part->frame_id) != complete.end()) {
+      return;
+    }
+    FrameCollector& collector = incomplete_frames_[ssrc][part->frame_id];
+    collector.set_frame_id(part->frame_id);
+    ASSERT_TRUE(collector.CollectRtpPacket(*part, &buffer));
+    if (!collector.is_complete()) {
+      return;
+    }
+    const EncryptedFrame& encrypted = collector.PeekAtAssembledFrame();
+    EncodedFrameWithBuffer decrypted;
+    decrypted.buffer.resize(FrameCrypto::GetPlaintextSize(encrypted));
+    decrypted.data = absl::Span<uint8_t>(decrypted.buffer);
+    cryptos_.at(ssrc).Decrypt(encrypted, &decrypted);
+    ReceivedFrame& received = complete[part->frame_id];
+    received.ciphertext.assign(encrypted.data.begin(), encrypted.data.end());
+    received.plaintext = std::move(decrypted.buffer);
+    incomplete_frames_[ssrc].erase(part->frame_id);
+  }
+
+  // Returns the decrypted payloads of the frames completely received from the
+  // Sender having the given |ssrc|, in FrameId order.
+  std::vector<std::vector<uint8_t>> GetCompleteFrames(Ssrc ssrc) const {
+    std::vector<std::vector<uint8_t>> result;
+    const auto it = complete_frames_.find(ssrc);
+    if (it != complete_frames_.end()) {
+      for (const auto& entry : it->second) {
+        result.push_back(entry.second.plaintext);
+      }
+    }
+    return result;
+  }
+
+  // Like GetCompleteFrames(), but returns the payloads as they were sent.
+  std::vector<std::vector<uint8_t>> GetCompleteCiphertexts(Ssrc ssrc) const {
+    std::vector<std::vector<uint8_t>> result;
+    const auto it = complete_frames_.find(ssrc);
+    if (it != complete_frames_.end()) {
+      for (const auto& entry : it->second) {
+        result.push_back(entry.second.ciphertext);
+      }
+    }
+    return result;
+  }
+
+ private:
+  struct ReceivedFrame {
+    std::vector<uint8_t> ciphertext;
+    std::vector<uint8_t> plaintext;
+  };
+
+  std::map<Ssrc, FrameCrypto> cryptos_;
+  std::map<Ssrc, RtpPacketParser> parsers_;
+  std::map<Ssrc, std::map<FrameId, FrameCollector>> incomplete_frames_;
+  std::map<Ssrc, std::map<FrameId, ReceivedFrame>> complete_frames_;
+};
+
+class SenderGroupTest : public testing::Test {
+ public:
+  SenderGroupTest()
+      : fake_clock_(Clock::now()),
+        task_runner_(&fake_clock_),
+        environment_(&FakeClock::now, &task_runner_),
+        packet_router_(&environment_, kNumPacketsPerBurst, kBurstInterval) {
+    environment_.set_remote_endpoint(
+        IPEndpoint{IPAddress(192, 168, 0, 42), 2344});
+    ON_CALL(environment_, SendPacket(_))
+        .WillByDefault(Invoke([this](absl::Span<const uint8_t> packet) {
+          receivers_.OnPacketSent(packet);
+        }));
+  }
+
+  ~SenderGroupTest() override = default;
+
+  // Creates a Sender, with its own pair of SSRCs and its own random keys, that
+  // shares this test's environment and packet router.
+  Sender* CreateSender(int fec_group_size = 0) {
+    const Ssrc sender_ssrc = 1 + 2 * static_cast<Ssrc>(senders_.size());
+    const std::array<uint8_t, 16> aes_key = GenerateRandomBytes16();
+    const std::array<uint8_t, 16> aes_iv_mask = GenerateRandomBytes16();
+    receivers_.AddReceiver(sender_ssrc, aes_key, aes_iv_mask);
+    SessionConfig config{/* .sender_ssrc = */ sender_ssrc,
+                         /* .receiver_ssrc = */ sender_ssrc + 1,
+                         /* .rtp_timebase = */ kRtpTimebase,
+                         /* .channels = */ 1,
+                         /* .target_playout_delay = */ kTargetPlayoutDelay,
+                         /* .aes_secret_key = */ aes_key,
+                         /* .aes_iv_mask = */ aes_iv_mask,
+                         /* .is_pli_enabled = */ true};
+    config.fec_group_size = fec_group_size;
+    senders_.push_back(std::make_unique<Sender>(&environment_, &packet_router_,
+                                                std::move(config),
+                                                RtpPayloadType::kVideoVp8));
+    return senders_.back().get();
+  }
+
+  // Populates the next |frame| of a stream, whose FrameIds are independent of
+  // any Sender's. Every |key_frame_interval|th frame is a key frame.
+  void PrepareNextFrame(int frame_size,
+                        int key_frame_interval,
+                        EncodedFrameWithBuffer* frame) {
+    frame->frame_id = next_frame_id_++;
+    if ((frame->frame_id - FrameId::first()) % key_frame_interval == 0) {
+      frame->dependency = EncodedFrame::KEY_FRAME;
+      frame->referenced_frame_id = frame->frame_id;
+    } else {
+      frame->dependency = EncodedFrame::DEPENDS_ON_ANOTHER;
+      frame->referenced_frame_id = frame->frame_id - 1;
+    }
+    const int frame_count = frame->frame_id - FrameId::first();
+    frame->rtp_timestamp =
+        RtpTimeTicks() +
+        RtpTimeDelta::FromTicks(frame_count * kRtpTimebase / kFramesPerSecond);
+    frame->reference_time = FakeClock::now();
+    frame->buffer.resize(frame_size);
+    for (int i = 0; i < frame_size; ++i) {
+      frame->buffer[i] = static_cast<uint8_t>(frame_count + i);
+    }
+    frame->data = absl::Span<uint8_t>(frame->buffer);
+  }
+
+  void SimulateExecution(Clock::duration how_long) {
+    fake_clock_.Advance(how_long);
+  }
+
+  const FakeReceivers& receivers() const { return receivers_; }
+
+ private:
+  FakeClock fake_clock_;
+  FakeTaskRunner task_runner_;
+  NiceMock<MockEnvironment> environment_;
+  SenderPacketRouter packet_router_;
+  FakeReceivers receivers_;
+  std::vector<std::unique_ptr<Sender>> senders_;
+  FrameId next_frame_id_ = FrameId::first();
+};
+
+// Tests that the same payload is delivered to every Receiver, each Sender
+// having encrypted it with its own keys.
+TEST_F(SenderGroupTest, DeliversEachFrameToAllSenders) {
+  constexpr int kNumSenders = 4;
+  constexpr int kNumFrames = 10;
+
+  SenderGroup group;
+  std::vector<Sender*> senders;
+  for (int i = 0; i < kNumSenders; ++i) {
+    senders.push_back(CreateSender());
+    group.AddSender(senders.back());
+  }
+  EXPECT_TRUE(group.NeedsKeyFrame());
+
+  std::vector<std::vector<uint8_t>> expected_frames;
+  for (int i = 0; i < kNumFrames; ++i) {
+    EncodedFrameWithBuffer frame;
+    PrepareNextFrame(3000 + i, kNumFrames, &frame);
+    EXPECT_EQ(kNumSenders, group.EnqueueFrame(frame));
+    expected_frames.push_back(frame.buffer);
+    SimulateExecution(kFrameDuration);
+  }
+  EXPECT_FALSE(group.NeedsKeyFrame());
+
+  for (Sender* sender : senders) {
+    EXPECT_EQ(expected_frames, receivers().GetCompleteFrames(sender->ssrc()));
+    EXPECT_EQ(kNumFrames, sender->GetStats().num_frames_enqueued);
+  }
+
+  // The Senders' FrameIds are the same, so sharing keys would have produced
+  // the same ciphertext for every Receiver.
+  const std::vector<std::vector<uint8_t>> first_ciphertexts =
+      receivers().GetCompleteCiphertexts(senders[0]->ssrc());
+  ASSERT_EQ(static_cast<size_t>(kNumFrames), first_ciphertexts.size());
+  for (int i = 1; i < kNumSenders; ++i) {
+    const std::vector<std::vector<uint8_t>> ciphertexts =
+        receivers().GetCompleteCiphertexts(senders[i]->ssrc());
+    ASSERT_EQ(first_ciphertexts.size(), ciphertexts.size());
+    for (int j = 0; j < kNumFrames; ++j) {
+      EXPECT_NE(first_ciphertexts[j], ciphertexts[j]);
+    }
+  }
+}
+
+// Tests that the FEC packets generated by Senders sharing a payload protect
+// the payload as each Sender encrypted it.
+TEST_F(SenderGroupTest, DeliversFramesWithFecToAllSenders) {
+  constexpr int kFecGroupSize = 3;
+  constexpr int kNumFrames = 4;
+
+  SenderGroup group;
+  Sender* const plain_sender = CreateSender();
+  Sender* const fec_sender = CreateSender(kFecGroupSize);
+  group.AddSender(plain_sender);
+  group.AddSender(fec_sender);
+
+  std::vector<std::vector<uint8_t>> expected_frames;
+  for (int i = 0; i < kNumFrames; ++i) {
+    EncodedFrameWithBuffer frame;
+    PrepareNextFrame(5000 + i, kNumFrames, &frame);
+    EXPECT_EQ(2, group.EnqueueFrame(frame));
+    expected_frames.push_back(frame.buffer);
+    SimulateExecution(kFrameDuration);
+  }
+
+  EXPECT_EQ(expected_frames,
+            receivers().GetCompleteFrames(plain_sender->ssrc()));
+  EXPECT_EQ(expected_frames, receivers().GetCompleteFrames(fec_sender->ssrc()));
+  EXPECT_LT(plain_sender->GetStats().num_packets_sent,
+            fec_sender->GetStats().num_packets_sent);
+}
+
+// Tests that a Sender joining the group late is only given frames starting
+// with the next key frame, under its own FrameIds.
+TEST_F(SenderGroupTest, StartsLateJoinersAtNextKeyFrame) {
+  constexpr int kKeyFrameInterval = 4;
+
+  SenderGroup group;
+  Sender* const first_sender = CreateSender();
+  group.AddSender(first_sender);
+
+  std::vector<std::vector<uint8_t>> expected_frames;
+  for (int i = 0; i < 2; ++i) {
+    EncodedFrameWithBuffer frame;
+    PrepareNextFrame(1000, kKeyFrameInterval, &frame);
+    EXPECT_EQ(1, group.EnqueueFrame(frame));
+    expected_frames.push_back(frame.buffer);
+    SimulateExecution(kFrameDuration);
+  }
+
+  Sender* const late_sender = CreateSender();
+  group.AddSender(late_sender);
+  EXPECT_EQ(2, group.num_senders());
+  EXPECT_TRUE(group.NeedsKeyFrame());
+  for (int i = 0; i < 2; ++i) {
+    EncodedFrameWithBuffer frame;
+    PrepareNextFrame(1000, kKeyFrameInterval, &frame);
+    EXPECT_EQ(1, group.EnqueueFrame(frame));
+    expected_frames.push_back(frame.buffer);
+    SimulateExecution(kFrameDuration);
+  }
+
+  // The key frame, and the frame after it, are given to both Senders.
+  std::vector<std::vector<uint8_t>> expected_late_frames;
+  for (int i = 0; i < 2; ++i) {
+    EncodedFrameWithBuffer frame;
+    PrepareNextFrame(1000, kKeyFrameInterval, &frame);
+    EXPECT_EQ(2, group.EnqueueFrame(frame));
+    expected_frames.push_back(frame.buffer);
+    expected_late_frames.push_back(frame.buffer);
+    SimulateExecution(kFrameDuration);
+  }
+  EXPECT_FALSE(group.NeedsKeyFrame());
+  EXPECT_EQ(FrameId::first() + 6, first_sender->GetNextFrameId());
+  EXPECT_EQ(FrameId::first() + 2, late_sender->GetNextFrameId());
+
+  EXPECT_EQ(expected_frames,
+            receivers().GetCompleteFrames(first_sender->ssrc()));
+  EXPECT_EQ(expected_late_frames,
+            receivers().GetCompleteFrames(late_sender->ssrc()));
+
+  group.RemoveSender(late_sender);
+  EXPECT_EQ(1, group.num_senders());
+}
+
+// Compares fanning out a stream of large frames to 1 to 32 Receivers through
+// separate Senders, each given the frames by EnqueueFrame(), against doing so
+// through a SenderGroup. Records the time spent enqueuing, and the size of the
+// payload data held for the frames in-flight. Note that, either way, each
+// Sender encrypts every payload byte it sends with its own keys: The group
+// only does so as each packet is generated.
+TEST_F(SenderGroupTest, FansOutToManyReceiversFromOneSharedPayload) {
+  constexpr int kFrameSize = 64 * 1024;
+  constexpr int kNumFrames = 20;
+  constexpr int kReceiverCounts[] = {1, 2, 4, 8, 16, 32};
+
+  std::vector<EncodedFrameWithBuffer> frames(kNumFrames);
+  for (EncodedFrameWithBuffer& frame : frames) {
+    PrepareNextFrame(kFrameSize, kNumFrames, &frame);
+    SimulateExecution(kFrameDuration);
+  }
+
+  for (int num_receivers : kReceiverCounts) {
+    std::vector<Sender*> separate_senders;
+    SenderGroup group;
+    for (int i = 0; i < num_receivers; ++i) {
+      separate_senders.push_back(CreateSender());
+      group.AddSender(CreateSender());
+    }
+
+    Clock::duration separate_time{};
+    Clock::duration group_time{};
+    for (const EncodedFrameWithBuffer& frame : frames) {
+      Clock::time_point start = Clock::now();
+      for (Sender* sender : separate_senders) {
+        EncodedFrame copy;
+        frame.CopyMetadataTo(&copy);
+        copy.data = frame.data;
+        ASSERT_EQ(Sender::OK, sender->EnqueueFrame(copy));
+      }
+      separate_time += Clock::now() - start;
+
+      start = Clock::now();
+      ASSERT_EQ(num_receivers, group.EnqueueFrame(frame));
+      group_time += Clock::now() - start;
+    }
+
+    const std::string suffix = "_" + std::to_string(num_receivers);
+    ::testing::Test::RecordProperty(
+        "separate_enqueue_us" + suffix,
+        static_cast<int>(to_microseconds(separate_time).count()));
+    ::testing::Test::RecordProperty(
+        "group_enqueue_us" + suffix,
+        static_cast<int>(to_microseconds(group_time).count()));
+    ::testing::Test::RecordProperty(
+        "separate_payload_kb" + suffix,
+        num_receivers * kNumFrames * kFrameSize / 1024);
+    ::testing::Test::RecordProperty("group_payload_kb" + suffix,
+                                    kNumFrames * kFrameSize / 1024);
+  }
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
@@ -47,24 +47,25 @@ SenderPacketRouter::SenderPacketRouter(Environment* environment,
 
 SenderPacketRouter::~SenderPacketRouter() {
   OSP_DCHECK(senders_.empty());
+  OSP_DCHECK(send_queue_.empty());
 }
 
 void SenderPacketRouter::OnSenderCreated(Ssrc receiver_ssrc, Sender* sender) {
-  OSP_DCHECK(FindEntry(receiver_ssrc) == senders_.end());
-  senders_.push_back(SenderEntry{receiver_ssrc, sender, kNever, kNever});
+  const bool inserted =
+      senders_.emplace(receiver_ssrc, SenderEntry{sender, kNever, kNever})
+          .second;
+  OSP_DCHECK(inserted);
 
   if (senders_.size() == 1) {
     environment_->ConsumeIncomingPackets(this);
-  } else {
-    // Sort the list of Senders so that they are iterated in priority order.
-    std::sort(senders_.begin(), senders_.end());
   }
 }
 
 void SenderPacketRouter::OnSenderDestroyed(Ssrc receiver_ssrc) {
-  const auto it = FindEntry(receiver_ssrc);
-  OSP_DCHECK(it != senders_.end());
-  senders_.erase(it);
+  const SenderEntryPtr entry = FindEntry(receiver_ssrc);
+  OSP_DCHECK(entry);
+  SetNextSendTimes(entry, kNever, kNever);
+  senders_.erase(receiver_ssrc);
 
   // If there are no longer any Senders, suspend receiving RTCP packets.
   if (senders_.empty()) {
@@ -73,16 +74,18 @@ void SenderPacketRouter::OnSenderDestroyed(Ssrc receiver_ssrc) {
 }
 
 void SenderPacketRouter::RequestRtcpSend(Ssrc receiver_ssrc) {
-  const auto it = FindEntry(receiver_ssrc);
-  OSP_DCHECK(it != senders_.end());
-  it->next_rtcp_send_time = Alarm::kImmediately;
+  const SenderEntryPtr entry = FindEntry(receiver_ssrc);
+  OSP_DCHECK(entry);
+  SetNextSendTimes(entry, Alarm::kImmediately,
+                   entry->second.next_rtp_send_time);
   ScheduleNextBurst();
 }
 
 void SenderPacketRouter::RequestRtpSend(Ssrc receiver_ssrc) {
-  const auto it = FindEntry(receiver_ssrc);
-  OSP_DCHECK(it != senders_.end());
-  it->next_rtp_send_time = Alarm::kImmediately;
+  const SenderEntryPtr entry = FindEntry(receiver_ssrc);
+  OSP_DCHECK(entry);
+  SetNextSendTimes(entry, entry->second.next_rtcp_send_time,
+                   Alarm::kImmediately);
   ScheduleNextBurst();
 }
 
@@ -108,54 +111,71 @@ void SenderPacketRouter::OnReceivedPacket(const IPEndpoint& source,
                         0, kMaxPartiaHexDumpSize));
     return;
   }
-  const auto it = FindEntry(seems_like.second);
-  if (it != senders_.end()) {
-    it->sender->OnReceivedRtcpPacket(arrival_time, std::move(packet));
+  const SenderEntryPtr entry = FindEntry(seems_like.second);
+  if (entry) {
+    entry->second.sender->OnReceivedRtcpPacket(arrival_time, std::move(packet));
   }
 }
 
-SenderPacketRouter::SenderEntries::iterator SenderPacketRouter::FindEntry(
+SenderPacketRouter::SenderEntryPtr SenderPacketRouter::FindEntry(
     Ssrc receiver_ssrc) {
-  return std::find_if(senders_.begin(), senders_.end(),
-                      [receiver_ssrc](const SenderEntry& entry) {
-                        return entry.receiver_ssrc == receiver_ssrc;
-                      });
+  const auto it = senders_.find(receiver_ssrc);
+  return it == senders_.end() ? nullptr : &*it;
 }
 
-void SenderPacketRouter::ScheduleNextBurst() {
-  // Determine the next burst time by scanning for the earliest of the
-  // next-scheduled send times for each Sender.
-  const Clock::time_point earliest_allowed_burst_time =
-      last_burst_time_ + burst_interval_;
-  Clock::time_point next_burst_time = kNever;
-  for (const SenderEntry& entry : senders_) {
-    const auto next_send_time =
-        std::min(entry.next_rtcp_send_time, entry.next_rtp_send_time);
-    if (next_send_time >= next_burst_time) {
-      continue;
-    }
-    if (next_send_time <= earliest_allowed_burst_time) {
-      next_burst_time = earliest_allowed_burst_time;
-      // No need to continue, since |next_burst_time| cannot become any earlier.
-      break;
-    }
-    next_burst_time = next_send_time;
+void SenderPacketRouter::SetNextSendTimes(
+    SenderEntryPtr entry,
+    Clock::time_point next_rtcp_send_time,
+    Clock::time_point next_rtp_send_time) {
+  SenderEntry& timing = entry->second;
+  const Clock::time_point old_send_time = timing.next_send_time();
+  timing.next_rtcp_send_time = next_rtcp_send_time;
+  timing.next_rtp_send_time = next_rtp_send_time;
+  const Clock::time_point new_send_time = timing.next_send_time();
+  if (new_send_time == old_send_time) {
+    return;
+  }
+  if (old_send_time != kNever) {
+    send_queue_.erase(std::make_pair(old_send_time, entry->first));
+  }
+  if (new_send_time != kNever) {
+    send_queue_.emplace(new_send_time, entry->first);
   }
+}
 
+void SenderPacketRouter::ScheduleNextBurst() {
   // Schedule the alarm for the next burst time unless none of the Senders has
-  // anything to send.
-  if (next_burst_time == kNever) {
+  // anything to send. The next burst time is the earliest of the
+  // next-scheduled send times for each Sender, but not before the burst
+  // interval has elapsed.
+  if (send_queue_.empty()) {
     alarm_.Cancel();
-  } else {
-    alarm_.Schedule([this] { SendBurstOfPackets(); }, next_burst_time);
+    return;
   }
+  const Clock::time_point next_burst_time = std::max(
+      send_queue_.begin()->first, last_burst_time_ + burst_interval_);
+  alarm_.Schedule([this] { SendBurstOfPackets(); }, next_burst_time);
 }
 
 void SenderPacketRouter::SendBurstOfPackets() {
+  // Collect only the Senders that have something due to send now, and order
+  // them by priority. All other Senders are left untouched.
+  const Clock::time_point burst_time = environment_->now();
+  due_senders_.clear();
+  for (auto it = send_queue_.begin();
+       it != send_queue_.end() && it->first <= burst_time; ++it) {
+    const SenderEntryPtr entry = FindEntry(it->second);
+    OSP_DCHECK(entry);
+    due_senders_.push_back(entry);
+  }
+  std::sort(due_senders_.begin(), due_senders_.end(),
+            [](SenderEntryPtr a, SenderEntryPtr b) {
+              return ComparePriority(a->first, b->first) < 0;
+            });
+
   // Treat RTCP packets as "critical priority," and so there is no upper limit
   // on the number to send. Practically, this will always be limited by the
   // number of Senders; so, this won't be a huge number of packets.
-  const Clock::time_point burst_time = environment_->now();
   const int num_rtcp_packets_sent = SendJustTheRtcpPackets(burst_time);
   // Now send all the RTP packets, up to the maximum number allowed in a burst.
   // Higher priority Senders' RTP packets are sent first.
@@ -171,8 +191,9 @@ void SenderPacketRouter::SendBurstOfPackets() {
 
 int SenderPacketRouter::SendJustTheRtcpPackets(Clock::time_point send_time) {
   int num_sent = 0;
-  for (SenderEntry& entry : senders_) {
-    if (entry.next_rtcp_send_time > send_time) {
+  for (SenderEntryPtr entry : due_senders_) {
+    const SenderEntry& timing = entry->second;
+    if (timing.next_rtcp_send_time > send_time) {
       continue;
     }
 
@@ -182,12 +203,13 @@ int SenderPacketRouter::SendJustTheRtcpPackets(Clock::time_point send_time) {
     // burst would mean that all but the last one are old/irrelevant snapshots
     // of Sender state, and this would just thrash/confuse the Receiver.
     const absl::Span<uint8_t> packet =
-        entry.sender->GetRtcpPacketForImmediateSend(
+        timing.sender->GetRtcpPacketForImmediateSend(
             send_time,
             absl::Span<uint8_t>(packet_buffer_.get(), packet_buffer_size_));
     if (!packet.empty()) {
       environment_->SendPacket(packet);
-      entry.next_rtcp_send_time = send_time + kRtcpReportInterval;
+      SetNextSendTimes(entry, send_time + kRtcpReportInterval,
+                       timing.next_rtp_send_time);
       ++num_sent;
     }
   }
@@ -198,17 +220,18 @@ int SenderPacketRouter::SendJustTheRtcpPackets(Clock::time_point send_time) {
 int SenderPacketRouter::SendJustTheRtpPackets(Clock::time_point send_time,
                                               int num_packets_to_send) {
   int num_sent = 0;
-  for (SenderEntry& entry : senders_) {
+  for (SenderEntryPtr entry : due_senders_) {
     if (num_sent >= num_packets_to_send) {
       break;
     }
-    if (entry.next_rtp_send_time > send_time) {
+    const SenderEntry& timing = entry->second;
+    if (timing.next_rtp_send_time > send_time) {
       continue;
     }
 
     for (; num_sent < num_packets_to_send; ++num_sent) {
       const absl::Span<uint8_t> packet =
-          entry.sender->GetRtpPacketForImmediateSend(
+          timing.sender->GetRtpPacketForImmediateSend(
               send_time,
               absl::Span<uint8_t>(packet_buffer_.get(), packet_buffer_size_));
       if (packet.empty()) {
@@ -216,7 +239,8 @@ int SenderPacketRouter::SendJustTheRtpPackets(Clock::time_point send_time,
       }
       environment_->SendPacket(packet);
     }
-    entry.next_rtp_send_time = entry.sender->GetRtpResumeTime();
+    SetNextSendTimes(entry, timing.next_rtcp_send_time,
+                     timing.sender->GetRtpResumeTime());
   }
 
   return num_sent;
@@ -7,8 +7,12 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
+#include <set>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "absl/types/span.h"
@@ -38,6 +42,11 @@ namespace cast {
 // packets can be sent together as one larger transmission unit, and this can be
 // critical for good performance over shared-medium networks (such as 802.11
 // WiFi). https://en.wikipedia.org/wiki/Frame-bursting
+//
+// Scalability: Many Senders (e.g., hundreds of concurrent streams in a
+// multi-session server) may share one SenderPacketRouter. Inbound packets are
+// routed by an O(1) SSRC lookup, and only the Senders having sends due are
+// visited in each burst; idle Senders cost nothing.
 class SenderPacketRouter : public BandwidthEstimator,
                            public Environment::PacketConsumer {
  public:
@@ -119,41 +128,50 @@ class SenderPacketRouter : public BandwidthEstimator,
 
  private:
   struct SenderEntry {
-    Ssrc receiver_ssrc;
     Sender* sender;
     Clock::time_point next_rtcp_send_time;
     Clock::time_point next_rtp_send_time;
 
-    // Entries are ordered by the transmission priority (high→low), as implied
-    // by their SSRC. See ssrc.h for details.
-    bool operator<(const SenderEntry& other) const {
-      return ComparePriority(receiver_ssrc, other.receiver_ssrc) < 0;
+    Clock::time_point next_send_time() const {
+      return std::min(next_rtcp_send_time, next_rtp_send_time);
     }
   };
 
-  using SenderEntries = std::vector<SenderEntry>;
+  // Senders are keyed by the SSRC of the Receiver they are sending to.
+  using SenderEntries = std::unordered_map<Ssrc, SenderEntry>;
+  using SenderEntryPtr = SenderEntries::value_type*;
+
+  // Identifies each Sender that has something to send, ordered by when it
+  // will next have something to send.
+  using SendQueue = std::set<std::pair<Clock::time_point, Ssrc>>;
 
   // Environment::PacketConsumer implementation.
   void OnReceivedPacket(const IPEndpoint& source,
                         Clock::time_point arrival_time,
                         std::vector<uint8_t> packet) final;
 
-  // Helper to return an iterator pointing to the entry corresponding to the
-  // given |receiver_ssrc|, or "end" if not found.
-  SenderEntries::iterator FindEntry(Ssrc receiver_ssrc);
+  // Helper to return a pointer to the entry corresponding to the given
+  // |receiver_ssrc|, or nullptr if not found.
+  SenderEntryPtr FindEntry(Ssrc receiver_ssrc);
+
+  // Updates the next send times of the given |entry|, and its position in the
+  // |send_queue_|.
+  void SetNextSendTimes(SenderEntryPtr entry,
+                        Clock::time_point next_rtcp_send_time,
+                        Clock::time_point next_rtp_send_time);
 
-  // Examine the next send time for all Senders, and decide whether to schedule
-  // a burst-send.
+  // Examine the earliest next send time among all Senders, and decide whether
+  // to schedule a burst-send.
   void ScheduleNextBurst();
 
   // Performs a burst-send of packets. This is called whenever the Alarm fires.
   void SendBurstOfPackets();
 
-  // Send an RTCP packet from each Sender that has one ready, and return the
-  // number of packets sent.
+  // Send an RTCP packet from each due Sender that has one ready, and return
+  // the number of packets sent.
   int SendJustTheRtcpPackets(Clock::time_point send_time);
 
-  // Send zero or more RTP packets from each Sender, up to a maximum of
+  // Send zero or more RTP packets from each due Sender, up to a maximum of
   // |num_packets_to_send|, and return the number of packets sent.
   int SendJustTheRtpPackets(Clock::time_point send_time,
                             int num_packets_to_send);
@@ -181,10 +199,17 @@ class SenderPacketRouter : public BandwidthEstimator,
   // time to send the next burst of packets.
   Alarm alarm_;
 
-  // The current list of Senders and their timing information. This is
-  // maintained in order of the priority implied by the Sender SSRC's.
+  // The current set of Senders and their timing information.
   SenderEntries senders_;
 
+  // The Senders having a next send time other than kNever.
+  SendQueue send_queue_;
+
+  // The Senders having sends due in the current burst, in order of the
+  // transmission priority (high→low) implied by their SSRC. See ssrc.h for
+  // details. This is only a member to avoid re-allocating it for every burst.
+  std::vector<SenderEntryPtr> due_senders_;
+
   // The last time a burst of packets was sent. This is used to determine the
   // next burst time.
   Clock::time_point last_burst_time_ = Clock::time_point::min();
@@ -5,6 +5,8 @@
 #include "cast/streaming/sender_packet_router.h"
 
 #include <chrono>
+#include <memory>
+#include <vector>
 
 #include "cast/streaming/constants.h"
 #include "cast/streaming/mock_environment.h"
@@ -149,6 +151,57 @@ class MockSender : public SenderPacketRouter::Sender {
   MOCK_METHOD(Clock::time_point, GetRtpResumeTime, (), (override));
 };
 
+// A lightweight Sender for simulating many concurrent streams: It always has an
+// RTCP packet to send and, while active, sends one RTP packet per frame
+// interval.
+class FakeSender final : public SenderPacketRouter::Sender {
+ public:
+  static constexpr Clock::duration kFrameInterval = milliseconds(40);
+
+  explicit FakeSender(bool is_active) : is_active_(is_active) {}
+  ~FakeSender() final = default;
+
+  int num_rtcp_packets_sent() const { return num_rtcp_packets_sent_; }
+  int num_rtp_packets_sent() const { return num_rtp_packets_sent_; }
+  int num_rtp_calls() const { return num_rtp_calls_; }
+
+  void OnReceivedRtcpPacket(Clock::time_point arrival_time,
+                            absl::Span<const uint8_t> packet) final {}
+
+  absl::Span<uint8_t> GetRtcpPacketForImmediateSend(
+      Clock::time_point send_time,
+      absl::Span<uint8_t> buffer) final {
+    ++num_rtcp_packets_sent_;
+    return MakeFakePacket(send_time, buffer);
+  }
+
+  absl::Span<uint8_t> GetRtpPacketForImmediateSend(
+      Clock::time_point send_time,
+      absl::Span<uint8_t> buffer) final {
+    ++num_rtp_calls_;
+    if (!is_active_ || send_time < next_frame_time_) {
+      return buffer.subspan(0, 0);
+    }
+    ++num_rtp_packets_sent_;
+    next_frame_time_ = send_time + kFrameInterval;
+    return MakeFakePacket(send_time, buffer);
+  }
+
+  Clock::time_point GetRtpResumeTime() final {
+    return is_active_ ? next_frame_time_ : SenderPacketRouter::kNever;
+  }
+
+ private:
+  const bool is_active_;
+  Clock::time_point next_frame_time_ = Clock::time_point::min();
+  int num_rtcp_packets_sent_ = 0;
+  int num_rtp_packets_sent_ = 0;
+  int num_rtp_calls_ = 0;
+};
+
+// static
+constexpr Clock::duration FakeSender::kFrameInterval;
+
 class SenderPacketRouterTest : public testing::Test {
  public:
   SenderPacketRouterTest()
@@ -603,6 +656,70 @@ TEST_F(SenderPacketRouterTest, SchedulesAndTransmitsAccountingForPriority) {
   router()->OnSenderDestroyed(kAudioReceiverSsrc);
 }
 
+// Simulates a multi-session server running from 1 to 500 concurrent Senders on
+// one SenderPacketRouter, where only a few of the streams are active at a time.
+// Confirms that every Sender is serviced on schedule, and that idle Senders are
+// not visited for RTP sends. The real (wall-clock) processing time spent per
+// simulated burst is recorded for each Sender count.
+TEST_F(SenderPacketRouterTest, ScalesToHundredsOfConcurrentSenders) {
+  constexpr int kMaxActiveSenders = 8;
+  constexpr int kPacketsPerBurst = 100;
+  constexpr Clock::duration kSimulationDuration = seconds(10);
+  constexpr Ssrc kFirstReceiverSsrc = 1000;
+
+  env()->set_remote_endpoint(kRemoteEndpoint);
+  for (int num_senders : {1, 10, 100, 500}) {
+    SCOPED_TRACE(testing::Message() << num_senders << " Senders");
+    SenderPacketRouter router(env(), kPacketsPerBurst, kBurstInterval);
+    std::vector<std::unique_ptr<FakeSender>> senders;
+    for (int i = 0; i < num_senders; ++i) {
+      const Ssrc ssrc = kFirstReceiverSsrc + i;
+      senders.emplace_back(new FakeSender(i < kMaxActiveSenders));
+      router.OnSenderCreated(ssrc, senders.back().get());
+      router.RequestRtcpSend(ssrc);
+      if (i < kMaxActiveSenders) {
+        router.RequestRtpSend(ssrc);
+      }
+    }
+
+    const Clock::time_point end_time = env()->now() + kSimulationDuration;
+    const auto wall_start = std::chrono::steady_clock::now();
+    RunTasksUntilIdle();
+    while (env()->now() < end_time) {
+      AdvanceClockAndRunTasks(kBurstInterval);
+    }
+    const auto wall_elapsed = std::chrono::steady_clock::now() - wall_start;
+
+    const int num_bursts = kSimulationDuration / kBurstInterval;
+    const int expected_rtcp_packets = kSimulationDuration / kRtcpReportInterval;
+    const int expected_rtp_packets =
+        kSimulationDuration / FakeSender::kFrameInterval;
+    for (int i = 0; i < num_senders; ++i) {
+      const FakeSender& sender = *senders[i];
+      EXPECT_LE(expected_rtcp_packets, sender.num_rtcp_packets_sent());
+      EXPECT_GE(expected_rtcp_packets + 1, sender.num_rtcp_packets_sent());
+      if (i < kMaxActiveSenders) {
+        EXPECT_LE(expected_rtp_packets, sender.num_rtp_packets_sent());
+        EXPECT_GE(expected_rtp_packets + 1, sender.num_rtp_packets_sent());
+      } else {
+        EXPECT_EQ(0, sender.num_rtp_calls());
+      }
+    }
+
+    ::testing::Test::RecordProperty(
+        "nanoseconds_per_burst_with_" + std::to_string(num_senders) +
+            "_senders",
+        static_cast<int>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(wall_elapsed)
+                .count() /
+            num_bursts));
+
+    for (int i = 0; i < num_senders; ++i) {
+      router.OnSenderDestroyed(kFirstReceiverSsrc + i);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace cast
 }  // namespace openscreen
@@ -42,7 +42,8 @@ AudioStream CreateStream(int index, const AudioCaptureConfig& config) {
              GenerateRandomBytes16(),
              false /* receiver_rtcp_event_log */,
              {} /* receiver_rtcp_dscp */,
-             config.sample_rate},
+             config.sample_rate,
+             config.fec_group_size},
       config.codec,
       (config.bit_rate >= capture_recommendations::kDefaultAudioMinBitRate)
           ? config.bit_rate
@@ -70,7 +71,8 @@ VideoStream CreateStream(int index, const VideoCaptureConfig& config) {
              GenerateRandomBytes16(),
              false /* receiver_rtcp_event_log */,
              {} /* receiver_rtcp_dscp */,
-             kRtpVideoTimebase},
+             kRtpVideoTimebase,
+             config.fec_group_size},
       config.codec,
       SimpleFraction{config.max_frame_rate.numerator,
                      config.max_frame_rate.denominator},
@@ -192,6 +194,18 @@ int SenderSession::GetEstimatedNetworkBandwidth() const {
   return packet_router_.ComputeNetworkBandwidth();
 }
 
+SenderSession::Stats SenderSession::GetStats() const {
+  Stats stats;
+  if (current_audio_sender_) {
+    stats.audio = current_audio_sender_->GetStats();
+  }
+  if (current_video_sender_) {
+    stats.video = current_video_sender_->GetStats();
+  }
+  stats.estimated_network_bandwidth = GetEstimatedNetworkBandwidth();
+  return stats;
+}
+
 void SenderSession::OnAnswer(ReceiverMessage message) {
   OSP_LOG_WARN << "Message sn: " << message.sequence_number
                << ", current: " << current_sequence_number_;
@@ -220,7 +234,8 @@ void SenderSession::OnAnswer(ReceiverMessage message) {
 
 std::unique_ptr<Sender> SenderSession::CreateSender(Ssrc receiver_ssrc,
                                                     const Stream& stream,
-                                                    RtpPayloadType type) {
+                                                    RtpPayloadType type,
+                                                    bool is_fec_enabled) {
   // Session config is currently only for mirroring.
   SessionConfig config{stream.ssrc,
                        receiver_ssrc,
@@ -230,6 +245,9 @@ std::unique_ptr<Sender> SenderSession::CreateSender(Ssrc receiver_ssrc,
                        stream.aes_key,
                        stream.aes_iv_mask,
                        /* is_pli_enabled*/ true};
+  if (is_fec_enabled) {
+    config.fec_group_size = stream.fec_group_size;
+  }
 
   return std::make_unique<Sender>(environment_, &packet_router_,
                                   std::move(config), type);
@@ -238,14 +256,16 @@ std::unique_ptr<Sender> SenderSession::CreateSender(Ssrc receiver_ssrc,
 void SenderSession::SpawnAudioSender(ConfiguredSenders* senders,
                                      Ssrc receiver_ssrc,
                                      int send_index,
-                                     int config_index) {
+                                     int config_index,
+                                     bool is_fec_enabled) {
   const AudioCaptureConfig& config =
       current_negotiation_->audio_configs[config_index];
   const RtpPayloadType payload_type = GetPayloadType(config.codec);
   for (const AudioStream& stream : current_negotiation_->offer.audio_streams) {
     if (stream.stream.index == send_index) {
       current_audio_sender_ =
-          CreateSender(receiver_ssrc, stream.stream, payload_type);
+          CreateSender(receiver_ssrc, stream.stream, payload_type,
+                       is_fec_enabled);
       senders->audio_sender = current_audio_sender_.get();
       senders->audio_config = config;
       break;
@@ -256,14 +276,16 @@ void SenderSession::SpawnAudioSender(ConfiguredSenders* senders,
 void SenderSession::SpawnVideoSender(ConfiguredSenders* senders,
                                      Ssrc receiver_ssrc,
                                      int send_index,
-                                     int config_index) {
+                                     int config_index,
+                                     bool is_fec_enabled) {
   const VideoCaptureConfig& config =
       current_negotiation_->video_configs[config_index];
   const RtpPayloadType payload_type = GetPayloadType(config.codec);
   for (const VideoStream& stream : current_negotiation_->offer.video_streams) {
     if (stream.stream.index == send_index) {
       current_video_sender_ =
-          CreateSender(receiver_ssrc, stream.stream, payload_type);
+          CreateSender(receiver_ssrc, stream.stream, payload_type,
+                       is_fec_enabled);
       senders->video_sender = current_video_sender_.get();
       senders->video_config = config;
       break;
@@ -286,14 +308,19 @@ SenderSession::ConfiguredSenders SenderSession::SpawnSenders(
   for (size_t i = 0; i < answer.send_indexes.size(); ++i) {
     const Ssrc receiver_ssrc = answer.ssrcs[i];
     const size_t send_index = static_cast<size_t>(answer.send_indexes[i]);
+    const bool is_fec_enabled =
+        std::find(answer.fec_enabled_indexes.begin(),
+                  answer.fec_enabled_indexes.end(),
+                  answer.send_indexes[i]) != answer.fec_enabled_indexes.end();
 
     const auto audio_size = current_negotiation_->audio_configs.size();
     const auto video_size = current_negotiation_->video_configs.size();
     if (send_index < audio_size) {
-      SpawnAudioSender(&senders, receiver_ssrc, send_index, send_index);
+      SpawnAudioSender(&senders, receiver_ssrc, send_index, send_index,
+                       is_fec_enabled);
     } else if (send_index < (audio_size + video_size)) {
       SpawnVideoSender(&senders, receiver_ssrc, send_index,
-                       send_index - audio_size);
+                       send_index - audio_size, is_fec_enabled);
     }
   }
   return senders;
@@ -10,6 +10,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "cast/common/public/message_port.h"
 #include "cast/streaming/answer_messages.h"
 #include "cast/streaming/capture_configs.h"
@@ -18,6 +19,7 @@
 #include "cast/streaming/sender_packet_router.h"
 #include "cast/streaming/session_config.h"
 #include "cast/streaming/session_messager.h"
+#include "cast/streaming/statistics.h"
 #include "json/value.h"
 #include "util/json/json_serialization.h"
 
@@ -49,6 +51,16 @@ class SenderSession final {
     VideoCaptureConfig video_config;
   };
 
+  // A snapshot of the statistics of the currently-configured senders. A field
+  // is nullopt if there is no sender for that stream.
+  struct Stats {
+    absl::optional<SenderStats> audio;
+    absl::optional<SenderStats> video;
+
+    // See GetEstimatedNetworkBandwidth().
+    int estimated_network_bandwidth = 0;
+  };
+
   // The embedder should provide a client for handling the negotiation.
   // When the negotiation is complete, the OnMirroringNegotiated callback is
   // called.
@@ -105,6 +117,10 @@ class SenderSession final {
   // feedback. Embedders may use this information to throttle capture devices.
   int GetEstimatedNetworkBandwidth() const;
 
+  // Returns the statistics of the currently-configured senders. This is cheap
+  // enough to be polled periodically.
+  Stats GetStats() const;
+
  private:
   // We store the current negotiation, so that when we get an answer from the
   // receiver we can line up the selected streams with the original
@@ -120,19 +136,24 @@ class SenderSession final {
   void OnAnswer(ReceiverMessage message);
 
   // Used by SpawnSenders to generate a sender for a specific stream.
+  // |is_fec_enabled| is true if the receiver accepted the FEC offered for the
+  // stream.
   std::unique_ptr<Sender> CreateSender(Ssrc receiver_ssrc,
                                        const Stream& stream,
-                                       RtpPayloadType type);
+                                       RtpPayloadType type,
+                                       bool is_fec_enabled);
 
   // Helper methods for spawning specific senders from the Answer message.
   void SpawnAudioSender(ConfiguredSenders* senders,
                         Ssrc receiver_ssrc,
                         int send_index,
-                        int config_index);
+                        int config_index,
+                        bool is_fec_enabled);
   void SpawnVideoSender(ConfiguredSenders* senders,
                         Ssrc receiver_ssrc,
                         int send_index,
-                        int config_index);
+                        int config_index,
+                        bool is_fec_enabled);
 
   // Spawn a set of configured senders from the currently stored negotiation.
   ConfiguredSenders SpawnSenders(const Answer& answer);
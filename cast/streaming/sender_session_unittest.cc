@@ -350,6 +350,54 @@ TEST_F(SenderSessionTest, HandlesValidAnswer) {
   message_port_->ReceiveMessage(answer);
 }
 
+TEST_F(SenderSessionTest, EnablesFecOnlyForStreamsAcceptedByReceiver) {
+  AudioCaptureConfig audio_config = kAudioCaptureConfigValid;
+  audio_config.fec_group_size = 4;
+  VideoCaptureConfig video_config = kVideoCaptureConfigValid;
+  video_config.fec_group_size = 8;
+  session_->NegotiateMirroring(std::vector<AudioCaptureConfig>{audio_config},
+                               std::vector<VideoCaptureConfig>{video_config});
+
+  const auto& messages = message_port_->posted_messages();
+  ASSERT_EQ(1u, messages.size());
+  auto message_body = json::Parse(messages[0]);
+  ASSERT_TRUE(message_body.is_value());
+  const Json::Value offer = std::move(message_body.value());
+  const Json::Value& streams = offer["offer"]["supportedStreams"];
+  ASSERT_EQ(2u, streams.size());
+  EXPECT_EQ(4, streams[0]["fecGroupSize"].asInt());
+  EXPECT_EQ(8, streams[1]["fecGroupSize"].asInt());
+
+  // The receiver only accepts FEC for the video stream.
+  constexpr char kAnswerTemplate[] = R"({
+      "type": "ANSWER",
+      "seqNum": %d,
+      "result": "ok",
+      "answer": {
+        "castMode": "mirroring",
+        "udpPort": 1234,
+        "sendIndexes": [%d, %d],
+        "ssrcs": [%d, %d],
+        "fecEnabledIndexes": [%d]
+      }
+      })";
+  const std::string answer = StringPrintf(
+      kAnswerTemplate, offer["seqNum"].asInt(), streams[0]["index"].asInt(),
+      streams[1]["index"].asInt(), streams[0]["ssrc"].asUInt() + 1,
+      streams[1]["ssrc"].asUInt() + 1, streams[1]["index"].asInt());
+
+  EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _, _))
+      .WillOnce([](const SenderSession* session,
+                   SenderSession::ConfiguredSenders senders,
+                   capture_recommendations::Recommendations recommendations) {
+        ASSERT_TRUE(senders.audio_sender);
+        EXPECT_EQ(0, senders.audio_sender->config().fec_group_size);
+        ASSERT_TRUE(senders.video_sender);
+        EXPECT_EQ(8, senders.video_sender->config().fec_group_size);
+      });
+  message_port_->ReceiveMessage(answer);
+}
+
 TEST_F(SenderSessionTest, HandlesInvalidNamespace) {
   std::string answer = NegotiateOfferAndConstructAnswer();
   message_port_->ReceiveMessage("random-namespace", answer);
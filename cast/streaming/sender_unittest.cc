@@ -11,6 +11,7 @@
 #include <chrono>
 #include <limits>
 #include <map>
+#include <memory>
 #include <set>
 #include <utility>
 #include <vector>
@@ -366,6 +367,24 @@ class SenderTest : public testing::Test {
   Sender* sender() { return &sender_; }
   MockReceiver* receiver() { return &receiver_; }
 
+  // Creates another Sender, sharing this test's environment and packet router,
+  // that is configured with the given in-flight frame window.
+  std::unique_ptr<Sender> CreateSenderWithInFlightWindow(
+      int max_unacked_frames) {
+    SessionConfig config{/* .sender_ssrc = */ kSenderSsrc + 2,
+                         /* .receiver_ssrc = */ kReceiverSsrc + 2,
+                         /* .rtp_timebase = */ kRtpTimebase,
+                         /* .channels = */ 2,
+                         /* .target_playout_delay = */ kTargetPlayoutDelay,
+                         /* .aes_secret_key = */ kAesKey,
+                         /* .aes_iv_mask = */ kCastIvMask,
+                         /* .is_pli_enabled = */ true};
+    config.max_unacked_frames = max_unacked_frames;
+    return std::make_unique<Sender>(&sender_environment_,
+                                    &sender_packet_router_, std::move(config),
+                                    kRtpPayloadType);
+  }
+
   void SetReceiverToSenderNetworkDelay(Clock::duration delay) {
     receiver_to_sender_pipe_.set_network_delay(delay);
   }
@@ -478,6 +497,7 @@ TEST_F(SenderTest, SendsFramesEfficiently) {
   EXPECT_CALL(observer, OnFrameCanceled(FrameId::first() + 1)).Times(1);
   EXPECT_CALL(observer, OnFrameCanceled(FrameId::first() + 2)).Times(1);
   sender()->SetObserver(&observer);
+  sender()->EnableFrameTimelines(nullptr);
 
   EncodedFrameWithBuffer frames[3];
   constexpr int kFrameDataSizes[] = {8196, 12, 1900};
@@ -496,6 +516,37 @@ TEST_F(SenderTest, SendsFramesEfficiently) {
   SimulateExecution(kTargetPlayoutDelay);
 
   ExpectFramesReceivedCorrectly(frames, receiver()->TakeCompleteFrames());
+
+  const SenderStats stats = sender()->GetStats();
+  EXPECT_EQ(3, stats.num_frames_enqueued);
+  EXPECT_EQ(3, stats.num_frames_sent);
+  EXPECT_EQ(3, stats.num_frames_acked);
+  EXPECT_EQ(0, stats.num_frames_canceled);
+  EXPECT_EQ(static_cast<int>(received_packets.size()), stats.num_packets_sent);
+  EXPECT_EQ(0, stats.num_packets_retransmitted);
+  EXPECT_EQ(0, stats.num_nacks_received);
+  EXPECT_EQ(3, stats.frame_ack_latency_ms.count());
+  EXPECT_LT(stats.frame_ack_latency_ms.GetApproximatePercentile(1.0),
+            kTargetPlayoutDelay.count());
+
+  // Each frame's timeline should have progressed through all the Sender stages,
+  // in order.
+  for (int i = 0; i < 3; ++i) {
+    const FrameTimeline* const timeline =
+        sender()->frame_timelines()->GetTimeline(FrameId::first() + i);
+    ASSERT_TRUE(timeline);
+    EXPECT_FALSE(timeline->was_dropped);
+    for (FrameStage stage :
+         {FrameStage::kEnqueued, FrameStage::kFirstPacketSent,
+          FrameStage::kLastPacketSent, FrameStage::kAcked}) {
+      const FrameStage prior_stage =
+          static_cast<FrameStage>(static_cast<int>(stage) - 1);
+      EXPECT_LE(Clock::duration::zero(),
+                timeline->GetDuration(prior_stage, stage).value_or(
+                    Clock::duration(-1)))
+          << FrameStageToString(stage);
+    }
+  }
 }
 
 // Tests that the Sender correctly computes the current in-flight media
@@ -661,6 +712,33 @@ TEST_F(SenderTest, RejectsEnqueuingBeforeProtocolDesignLimit) {
   SimulateExecution(kFrameDuration);
 }
 
+// Tests that a Sender configured with a smaller in-flight frame window than the
+// protocol design limit rejects frames beyond that window.
+TEST_F(SenderTest, RejectsEnqueuingBeyondConfiguredInFlightWindow) {
+  constexpr int kFramesPerSecond = 1000;
+  const std::unique_ptr<Sender> sender =
+      CreateSenderWithInFlightWindow(kMinUnackedFrames);
+
+  int frame_count = 0;
+  for (; frame_count < kMinUnackedFrames; ++frame_count) {
+    EncodedFrameWithBuffer frame;
+    PopulateFrameWithDefaults(sender->GetNextFrameId(),
+                              FakeClock::now() + milliseconds(frame_count), 0,
+                              13 /* bytes */, &frame);
+    OverrideRtpTimestamp(frame_count, &frame, kFramesPerSecond);
+    ASSERT_EQ(Sender::OK, sender->EnqueueFrame(frame));
+  }
+  EXPECT_EQ(kMinUnackedFrames, sender->GetInFlightFrameCount());
+
+  EncodedFrameWithBuffer one_frame_too_much;
+  PopulateFrameWithDefaults(sender->GetNextFrameId(),
+                            FakeClock::now() + milliseconds(frame_count), 0,
+                            13 /* bytes */, &one_frame_too_much);
+  OverrideRtpTimestamp(frame_count, &one_frame_too_much, kFramesPerSecond);
+  EXPECT_EQ(Sender::REACHED_ID_SPAN_LIMIT,
+            sender->EnqueueFrame(one_frame_too_much));
+}
+
 TEST_F(SenderTest, CanCancelAllInFlightFrames) {
   NiceMock<MockObserver> observer;
   sender()->SetObserver(&observer);
@@ -677,6 +755,8 @@ TEST_F(SenderTest, CanCancelAllInFlightFrames) {
 
   EXPECT_CALL(observer, OnFrameCanceled(_)).Times(kMaxUnackedFrames);
   sender()->CancelInFlightData();
+  EXPECT_EQ(kMaxUnackedFrames, sender()->GetStats().num_frames_canceled);
+  EXPECT_EQ(0, sender()->GetStats().num_frames_acked);
 }
 
 // Tests that the Sender rejects frames if too-long a media duration is
@@ -1049,6 +1129,92 @@ TEST_F(SenderTest, ResendsIndividuallyNackedPackets) {
   ExpectFramesReceivedCorrectly(frames, receiver()->TakeCompleteFrames());
 }
 
+// Tests that the Sender retransmits each NACK'ed packet only once, even if
+// consecutive NACK reports from the Receiver mention it again before the
+// retransmit could have arrived.
+TEST_F(SenderTest, DoesNotRetransmitPacketsForRepeatedNacks) {
+  constexpr int kFrameDataSize = 3 * kMaxRtpPacketSizeForIpv6UdpOnEthernet;
+  constexpr milliseconds kOneWayNetworkDelay{10};
+  SetSenderToReceiverNetworkDelay(kOneWayNetworkDelay);
+  SetReceiverToSenderNetworkDelay(kOneWayNetworkDelay);
+
+  // Reply to all Sender Reports, so that the Sender can measure the network
+  // round trip time.
+  EXPECT_CALL(*receiver(), OnSenderReport(_))
+      .WillRepeatedly(Invoke(
+          [&](const SenderReportParser::SenderReportWithId& sender_report) {
+            receiver()->SetReceiverReport(sender_report.report_id,
+                                          RtcpReportBlock::Delay::zero());
+            receiver()->TransmitRtcpFeedbackPacket();
+          }));
+
+  const std::vector<PacketNack> dropped_packets{
+      {FrameId::first(), FramePacketId{1}},
+      {FrameId::first(), FramePacketId{2}},
+  };
+  receiver()->SetIgnoreList(dropped_packets);
+  EncodedFrameWithBuffer frame;
+  PopulateFrameWithDefaults(FrameId::first(), FakeClock::now() - kCaptureDelay,
+                            0, kFrameDataSize, &frame);
+  ASSERT_EQ(Sender::OK, sender()->EnqueueFrame(frame));
+  SimulateExecution(kTargetPlayoutDelay);
+  receiver()->SetIgnoreList({});
+
+  // The Receiver NACKs the dropped packets, and then NACKs them again in its
+  // next report, half a round trip later.
+  EXPECT_CALL(*receiver(), OnRtpPacket(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](const RtpPacketParser::ParseResult& packet) {
+        EXPECT_FALSE(std::find(dropped_packets.begin(), dropped_packets.end(),
+                               PacketNack{packet.frame_id, packet.packet_id}) ==
+                     dropped_packets.end());
+      }));
+  EXPECT_CALL(*receiver(), OnFrameComplete(FrameId::first())).Times(1);
+  receiver()->SetNacksAndAcks(dropped_packets, {});
+  receiver()->TransmitRtcpFeedbackPacket();
+  SimulateExecution(kOneWayNetworkDelay);
+  receiver()->SetNacksAndAcks(dropped_packets, {});
+  receiver()->TransmitRtcpFeedbackPacket();
+  SimulateExecution(3 * kOneWayNetworkDelay);
+  Mock::VerifyAndClearExpectations(receiver());
+
+  EXPECT_EQ(2, sender()->GetStats().num_packets_retransmitted);
+  EXPECT_EQ(2, sender()->GetStats().num_duplicate_retransmits_avoided);
+}
+
+// Tests that NACKs for packets that have not yet been sent even once (e.g.,
+// because the frame is larger than one burst) neither trigger a re-transmit
+// nor count as duplicate re-transmits avoided.
+TEST_F(SenderTest, DoesNotCountNacksForUnsentPacketsAsDuplicates) {
+  constexpr int kFrameDataSize =
+      (kNumPacketsPerBurst + 5) * kMaxRtpPacketSizeForIpv6UdpOnEthernet;
+  constexpr milliseconds kOneWayNetworkDelay{1};
+  SetSenderToReceiverNetworkDelay(kOneWayNetworkDelay);
+  SetReceiverToSenderNetworkDelay(kOneWayNetworkDelay);
+
+  EncodedFrameWithBuffer frame;
+  PopulateFrameWithDefaults(FrameId::first(), FakeClock::now() - kCaptureDelay,
+                            0, kFrameDataSize, &frame);
+  ASSERT_EQ(Sender::OK, sender()->EnqueueFrame(frame));
+  SimulateExecution(kOneWayNetworkDelay);
+
+  // Only the first burst has been sent when the NACKs arrive: One NACK'ed
+  // packet was sent, and the other two are still waiting for the next burst.
+  const std::vector<PacketNack> nacks{
+      {FrameId::first(), FramePacketId{1}},
+      {FrameId::first(), FramePacketId{kNumPacketsPerBurst + 1}},
+      {FrameId::first(), FramePacketId{kNumPacketsPerBurst + 2}},
+  };
+  receiver()->SetNacksAndAcks(nacks, {});
+  receiver()->TransmitRtcpFeedbackPacket();
+  SimulateExecution(kOneWayNetworkDelay);
+
+  const SenderStats stats = sender()->GetStats();
+  EXPECT_EQ(3, stats.num_nacks_received);
+  EXPECT_EQ(1, stats.num_packets_retransmitted);
+  EXPECT_EQ(0, stats.num_duplicate_retransmits_avoided);
+}
+
 // Tests that the Sender retransmits an entire frame if the Receiver requests it
 // (i.e., a full frame NACK), but does not retransmit any packets for frames
 // (before or after) that have been acknowledged.
@@ -1142,6 +1308,12 @@ TEST_F(SenderTest, ResendsMissingFrames) {
   SimulateExecution(10 * kTargetPlayoutDelay);
 
   ExpectFramesReceivedCorrectly(frames, receiver()->TakeCompleteFrames());
+
+  // The whole-frame NACK counts once, even though it caused all of the second
+  // frame's packets to be re-transmitted.
+  const SenderStats stats = sender()->GetStats();
+  EXPECT_EQ(1, stats.num_nacks_received);
+  EXPECT_LE(3, stats.num_packets_retransmitted);
 }
 
 }  // namespace
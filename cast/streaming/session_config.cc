@@ -4,8 +4,12 @@
 
 #include "cast/streaming/session_config.h"
 
+#include <algorithm>
+#include <cmath>
 #include <utility>
 
+#include "util/osp_logging.h"
+
 namespace openscreen {
 namespace cast {
 
@@ -33,5 +37,19 @@ SessionConfig& SessionConfig::operator=(SessionConfig&& other) noexcept =
     default;
 SessionConfig::~SessionConfig() = default;
 
+int ComputeMaxUnackedFrames(double max_frame_rate,
+                            std::chrono::milliseconds target_playout_delay) {
+  OSP_DCHECK_GT(max_frame_rate, 0.0);
+  constexpr std::chrono::milliseconds kMinWindowDuration{1000};
+  const std::chrono::milliseconds window_duration =
+      std::max(2 * target_playout_delay, kMinWindowDuration);
+  const double num_frames =
+      std::ceil(max_frame_rate * window_duration.count() / 1000.0);
+  if (num_frames >= kMaxUnackedFrames) {
+    return kMaxUnackedFrames;
+  }
+  return std::max(kMinUnackedFrames, static_cast<int>(num_frames));
+}
+
 }  // namespace cast
 }  // namespace openscreen
@@ -9,6 +9,7 @@
 #include <chrono>
 #include <cstdint>
 
+#include "cast/streaming/constants.h"
 #include "cast/streaming/ssrc.h"
 
 namespace openscreen {
@@ -54,8 +55,34 @@ struct SessionConfig final {
 
   // Whether picture loss indication (PLI) should be used for this session.
   bool is_pli_enabled = false;
+
+  // The number of consecutive RTP packets of each frame protected by one XOR
+  // parity FEC packet, or zero if FEC is not used for this session. See
+  // kFecRtpExtensionType in rtp_defines.h.
+  int fec_group_size = 0;
+
+  // The maximum span of FrameIds that may be in-flight at once (i.e., between
+  // the Receiver's checkpoint and the latest frame enqueued), in the range
+  // [kMinUnackedFrames, kMaxUnackedFrames]. The Sender and Receiver size their
+  // frame queues from this. The OFFER/ANSWER exchange does not convey either
+  // side's window, and peers from other implementations assume
+  // kMaxUnackedFrames, so sessions negotiated over the wire keep the default.
+  // A smaller window may only be used when both ends are configured together
+  // (e.g., see ComputeMaxUnackedFrames()).
+  int max_unacked_frames = kMaxUnackedFrames;
 };
 
+// Returns the in-flight frame window for a stream having the given maximum
+// frame rate and target playout delay: enough frames to cover twice the
+// playout delay (or one second, whichever is longer), to allow for changes to
+// the delay and network round trips, clamped to the range [kMinUnackedFrames,
+// kMaxUnackedFrames]. The Sender and Receiver of a stream must both use the
+// result. The upper bound is imposed by the 8-bit FrameIds on the wire, which
+// must be expanded unambiguously; so high frame rate, long delay streams are
+// limited to kMaxUnackedFrames.
+int ComputeMaxUnackedFrames(double max_frame_rate,
+                            std::chrono::milliseconds target_playout_delay);
+
 }  // namespace cast
 }  // namespace openscreen
 
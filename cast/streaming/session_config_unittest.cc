@@ -0,0 +1,43 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/session_config.h"
+
+#include <chrono>
+
+#include "cast/streaming/constants.h"
+#include "gtest/gtest.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using std::chrono::milliseconds;
+
+TEST(SessionConfigTest, ComputesInFlightWindowFromFrameRateAndDelay) {
+  // At least one second of frames is always covered.
+  EXPECT_EQ(30, ComputeMaxUnackedFrames(30, milliseconds(100)));
+  EXPECT_EQ(30, ComputeMaxUnackedFrames(30, kDefaultTargetPlayoutDelay));
+  EXPECT_EQ(30, ComputeMaxUnackedFrames(29.97, kDefaultTargetPlayoutDelay));
+
+  // Otherwise, twice the playout delay is covered.
+  EXPECT_EQ(48, ComputeMaxUnackedFrames(30, milliseconds(800)));
+  EXPECT_EQ(kMaxUnackedFrames,
+            ComputeMaxUnackedFrames(kMaxAudioFrameRate, milliseconds(600)));
+}
+
+TEST(SessionConfigTest, ClampsInFlightWindowToSupportedRange) {
+  EXPECT_EQ(kMinUnackedFrames, ComputeMaxUnackedFrames(1, milliseconds(100)));
+  EXPECT_EQ(kMinUnackedFrames, ComputeMaxUnackedFrames(10, milliseconds(400)));
+
+  // A high frame rate stream with a long playout delay (e.g., 4K at 60 FPS
+  // with a two second delay) is limited by the 8-bit FrameIds on the wire.
+  EXPECT_EQ(kMaxUnackedFrames, ComputeMaxUnackedFrames(60, milliseconds(2000)));
+  EXPECT_EQ(kMaxUnackedFrames,
+            ComputeMaxUnackedFrames(120, milliseconds(10000)));
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
@@ -51,9 +51,13 @@ SessionMessager::~SessionMessager() {
 
 Error SessionMessager::SendMessage(const std::string& destination_id,
                                    const std::string& namespace_,
-                                   const Json::Value& message_root) {
+                                   Json::Value message_root) {
   OSP_DCHECK(namespace_ == kCastRemotingNamespace ||
              namespace_ == kCastWebrtcNamespace);
+  if (namespace_ == kCastRemotingNamespace &&
+      message_port_->SupportsBinaryMessages()) {
+    message_root[kAcceptsBinaryRpc] = true;
+  }
   auto body_or_error = json::Stringify(message_root);
   if (body_or_error.is_error()) {
     return std::move(body_or_error.error());
@@ -65,6 +69,30 @@ Error SessionMessager::SendMessage(const std::string& destination_id,
   return Error::None();
 }
 
+void SessionMessager::SendBinaryRpcMessage(const std::string& destination_id,
+                                           const std::string& rpc) {
+  OSP_DCHECK(is_binary_rpc_negotiated_);
+  OSP_DVLOG << "Sending binary RPC message: DESTINATION[" << destination_id
+            << "], SIZE[" << rpc.size() << "]";
+  message_port_->PostBinaryMessage(destination_id, kCastRemotingNamespace, rpc);
+}
+
+void SessionMessager::CheckForBinaryRpcAdvertisement(
+    const Json::Value& message_root) {
+  bool accepts_binary_rpc = false;
+  if (json::ParseBool(message_root[kAcceptsBinaryRpc], &accepts_binary_rpc) &&
+      accepts_binary_rpc) {
+    OnBinaryRpcMessageReceived();
+  }
+}
+
+void SessionMessager::OnBinaryRpcMessageReceived() {
+  if (!is_binary_rpc_negotiated_ && message_port_->SupportsBinaryMessages()) {
+    OSP_DVLOG << "Remote end accepts binary RPC messages, switching to them.";
+    is_binary_rpc_negotiated_ = true;
+  }
+}
+
 void SessionMessager::ReportError(Error error) {
   error_callback_(std::move(error));
 }
@@ -86,6 +114,11 @@ void SenderSessionMessager::SetHandler(ReceiverMessage::Type type,
 }
 
 Error SenderSessionMessager::SendOutboundMessage(SenderMessage message) {
+  if (message.type == SenderMessage::Type::kRpc && is_binary_rpc_negotiated()) {
+    SendBinaryRpcMessage(receiver_id_, absl::get<std::string>(message.body));
+    return Error::None();
+  }
+
   const auto namespace_ = (message.type == SenderMessage::Type::kRpc)
                               ? kCastRemotingNamespace
                               : kCastWebrtcNamespace;
@@ -93,7 +126,7 @@ Error SenderSessionMessager::SendOutboundMessage(SenderMessage message) {
   ErrorOr<Json::Value> jsonified = message.ToJson();
   OSP_CHECK(jsonified.is_value()) << "Tried to send an invalid message";
   return SessionMessager::SendMessage(receiver_id_, namespace_,
-                                      jsonified.value());
+                                      std::move(jsonified.value()));
 }
 
 Error SenderSessionMessager::SendRequest(SenderMessage message,
@@ -151,6 +184,7 @@ void SenderSessionMessager::OnMessage(const std::string& source_id,
     OSP_DLOG_WARN << "Received a message without a sequence number";
     return;
   }
+  CheckForBinaryRpcAdvertisement(message_body.value());
 
   // If the message is valid JSON and we don't understand it, there are two
   // options: (1) it's an unknown type, or (2) the receiver filled out the
@@ -184,6 +218,26 @@ void SenderSessionMessager::OnMessage(const std::string& source_id,
   }
 }
 
+void SenderSessionMessager::OnBinaryMessage(
+    const std::string& source_id,
+    const std::string& message_namespace,
+    const std::string& message) {
+  if (source_id != receiver_id_ ||
+      message_namespace != kCastRemotingNamespace) {
+    OSP_DLOG_WARN << "Received binary message from unexpected receiver \""
+                  << source_id << "\" or namespace: " << message_namespace;
+    return;
+  }
+
+  OnBinaryRpcMessageReceived();
+  if (rpc_callback_) {
+    rpc_callback_(ReceiverMessage{ReceiverMessage::Type::kRpc, -1,
+                                  true /* valid */, message});
+  } else {
+    OSP_DLOG_INFO << "Received RPC message but no callback, dropping";
+  }
+}
+
 void SenderSessionMessager::OnError(Error error) {
   OSP_DLOG_WARN << "Received an error in the session messager: " << error;
 }
@@ -205,6 +259,13 @@ Error ReceiverSessionMessager::SendMessage(ReceiverMessage message) {
                  "Tried to send a message without receving one first");
   }
 
+  if (message.type == ReceiverMessage::Type::kRpc &&
+      is_binary_rpc_negotiated()) {
+    SendBinaryRpcMessage(sender_session_id_,
+                         absl::get<std::string>(message.body));
+    return Error::None();
+  }
+
   const auto namespace_ = (message.type == ReceiverMessage::Type::kRpc)
                               ? kCastRemotingNamespace
                               : kCastWebrtcNamespace;
@@ -212,19 +273,13 @@ Error ReceiverSessionMessager::SendMessage(ReceiverMessage message) {
   ErrorOr<Json::Value> message_json = message.ToJson();
   OSP_CHECK(message_json.is_value()) << "Tried to send an invalid message";
   return SessionMessager::SendMessage(sender_session_id_, namespace_,
-                                      message_json.value());
+                                      std::move(message_json.value()));
 }
 
 void ReceiverSessionMessager::OnMessage(const std::string& source_id,
                                         const std::string& message_namespace,
                                         const std::string& message) {
-  // We assume we are connected to the first sender_id we receive.
-  if (sender_session_id_.empty()) {
-    sender_session_id_ = source_id;
-  } else if (source_id != sender_session_id_) {
-    OSP_DLOG_WARN << "Received message from unknown/incorrect sender, expected "
-                     "id \""
-                  << sender_session_id_ << "\", got \"" << source_id << "\"";
+  if (!IsFromConnectedSender(source_id)) {
     return;
   }
 
@@ -242,6 +297,7 @@ void ReceiverSessionMessager::OnMessage(const std::string& source_id,
     ReportError(message_body.error());
     return;
   }
+  CheckForBinaryRpcAdvertisement(message_body.value());
 
   // If the message is valid JSON and we don't understand it, there are two
   // options: (1) it's an unknown type, or (2) the sender filled out the message
@@ -265,9 +321,46 @@ void ReceiverSessionMessager::OnMessage(const std::string& source_id,
   }
 }
 
+void ReceiverSessionMessager::OnBinaryMessage(
+    const std::string& source_id,
+    const std::string& message_namespace,
+    const std::string& message) {
+  if (!IsFromConnectedSender(source_id)) {
+    return;
+  }
+  if (message_namespace != kCastRemotingNamespace) {
+    OSP_DLOG_WARN << "Received binary message from unexpected namespace: "
+                  << message_namespace;
+    return;
+  }
+
+  OnBinaryRpcMessageReceived();
+  auto it = callbacks_.find(SenderMessage::Type::kRpc);
+  if (it == callbacks_.end()) {
+    OSP_DLOG_INFO << "Received RPC message without a callback, dropping";
+  } else {
+    it->second(SenderMessage{SenderMessage::Type::kRpc, -1, true /* valid */,
+                             message});
+  }
+}
+
 void ReceiverSessionMessager::OnError(Error error) {
   OSP_DLOG_WARN << "Received an error in the session messager: " << error;
 }
 
+bool ReceiverSessionMessager::IsFromConnectedSender(
+    const std::string& source_id) {
+  // We assume we are connected to the first sender_id we receive.
+  if (sender_session_id_.empty()) {
+    sender_session_id_ = source_id;
+  } else if (source_id != sender_session_id_) {
+    OSP_DLOG_WARN << "Received message from unknown/incorrect sender, expected "
+                     "id \""
+                  << sender_session_id_ << "\", got \"" << source_id << "\"";
+    return false;
+  }
+  return true;
+}
+
 }  // namespace cast
 }  // namespace openscreen
@@ -37,10 +37,26 @@ class SessionMessager : public MessagePort::Client {
   ~SessionMessager() override;
 
  protected:
-  // Barebones message sending method shared by both children.
+  // Barebones message sending method shared by both children. If the
+  // MessagePort can carry binary messages, RPC messages advertise that this end
+  // accepts them.
   Error SendMessage(const std::string& destination_id,
                     const std::string& namespace_,
-                    const Json::Value& message_root);
+                    Json::Value message_root);
+
+  // Sends the serialized RpcMessage |rpc| directly as a binary message. Must
+  // only be called once is_binary_rpc_negotiated().
+  void SendBinaryRpcMessage(const std::string& destination_id,
+                            const std::string& rpc);
+
+  // Returns true once the remote end has advertised that it accepts binary RPC
+  // messages, and the MessagePort can carry them.
+  bool is_binary_rpc_negotiated() const { return is_binary_rpc_negotiated_; }
+
+  // Called by subclasses with each received JSON message, or whenever a binary
+  // RPC message is received, to complete the negotiation of binary RPC.
+  void CheckForBinaryRpcAdvertisement(const Json::Value& message_root);
+  void OnBinaryRpcMessageReceived();
 
   // Used to report errors in subclasses.
   void ReportError(Error error);
@@ -48,6 +64,7 @@ class SessionMessager : public MessagePort::Client {
  private:
   MessagePort* const message_port_;
   ErrorCallback error_callback_;
+  bool is_binary_rpc_negotiated_ = false;
 };
 
 class SenderSessionMessager final : public SessionMessager {
@@ -75,6 +92,9 @@ class SenderSessionMessager final : public SessionMessager {
   void OnMessage(const std::string& source_id,
                  const std::string& message_namespace,
                  const std::string& message) override;
+  void OnBinaryMessage(const std::string& source_id,
+                       const std::string& message_namespace,
+                       const std::string& message) override;
   void OnError(Error error) override;
 
  private:
@@ -113,9 +133,16 @@ class ReceiverSessionMessager final : public SessionMessager {
   void OnMessage(const std::string& source_id,
                  const std::string& message_namespace,
                  const std::string& message) override;
+  void OnBinaryMessage(const std::string& source_id,
+                       const std::string& message_namespace,
+                       const std::string& message) override;
   void OnError(Error error) override;
 
  private:
+  // Returns true if the message is from the connected sender, which is set to
+  // |source_id| if this is the first message received.
+  bool IsFromConnectedSender(const std::string& source_id);
+
   // The sender ID of the SenderSession we are connected to. Set on the
   // first message we receive.
   std::string sender_session_id_;
@@ -0,0 +1,105 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// The ranges of the SenderStats and ReceiverStats histograms. Each has 50
+// buckets, which is enough resolution to see the shape of the distributions
+// while keeping the snapshots small.
+constexpr int kNumBuckets = 50;
+constexpr int64_t kMaxFrameAckLatencyMs = 1000;
+constexpr int64_t kMaxFrameCompletionLatencyMs = 500;
+constexpr int64_t kMaxDecryptTimeUs = 10000;
+constexpr int64_t kMaxRtcpSendLatenessMs = 250;
+
+}  // namespace
+
+FixedBucketHistogram::FixedBucketHistogram(int64_t min,
+                                           int64_t max,
+                                           int num_buckets)
+    : min_(min),
+      max_(max),
+      bucket_width_((max - min + num_buckets - 1) / num_buckets),
+      bucket_counts_(num_buckets, 0) {
+  OSP_DCHECK_LT(min_, max_);
+  OSP_DCHECK_GT(num_buckets, 0);
+}
+
+FixedBucketHistogram::FixedBucketHistogram(const FixedBucketHistogram& other) =
+    default;
+FixedBucketHistogram::FixedBucketHistogram(
+    FixedBucketHistogram&& other) noexcept = default;
+FixedBucketHistogram& FixedBucketHistogram::operator=(
+    const FixedBucketHistogram& other) = default;
+FixedBucketHistogram& FixedBucketHistogram::operator=(
+    FixedBucketHistogram&& other) noexcept = default;
+FixedBucketHistogram::~FixedBucketHistogram() = default;
+
+void FixedBucketHistogram::Add(int64_t sample) {
+  const int64_t index =
+      std::max<int64_t>(0, std::min<int64_t>((sample - min_) / bucket_width_,
+                                             bucket_counts_.size() - 1));
+  ++bucket_counts_[index];
+  ++count_;
+  sum_ += sample;
+}
+
+double FixedBucketHistogram::mean() const {
+  if (count_ == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(sum_) / count_;
+}
+
+int64_t FixedBucketHistogram::GetApproximatePercentile(
+    double percentile) const {
+  OSP_DCHECK_GE(percentile, 0.0);
+  OSP_DCHECK_LE(percentile, 1.0);
+  if (count_ == 0) {
+    return min_;
+  }
+  const int rank =
+      std::max(1, static_cast<int>(std::ceil(percentile * count_)));
+  int cumulative_count = 0;
+  for (int i = 0; i < static_cast<int>(bucket_counts_.size()); ++i) {
+    cumulative_count += bucket_counts_[i];
+    if (cumulative_count >= rank) {
+      return std::min(max_, min_ + (i + 1) * bucket_width_);
+    }
+  }
+  OSP_NOTREACHED();
+  return max_;
+}
+
+SenderStats::SenderStats()
+    : frame_ack_latency_ms(0, kMaxFrameAckLatencyMs, kNumBuckets) {}
+SenderStats::SenderStats(const SenderStats& other) = default;
+SenderStats::SenderStats(SenderStats&& other) noexcept = default;
+SenderStats& SenderStats::operator=(const SenderStats& other) = default;
+SenderStats& SenderStats::operator=(SenderStats&& other) noexcept = default;
+SenderStats::~SenderStats() = default;
+
+ReceiverStats::ReceiverStats()
+    : frame_completion_latency_ms(0, kMaxFrameCompletionLatencyMs, kNumBuckets),
+      decrypt_time_us(0, kMaxDecryptTimeUs, kNumBuckets),
+      rtcp_send_lateness_ms(0, kMaxRtcpSendLatenessMs, kNumBuckets) {}
+ReceiverStats::ReceiverStats(const ReceiverStats& other) = default;
+ReceiverStats::ReceiverStats(ReceiverStats&& other) noexcept = default;
+ReceiverStats& ReceiverStats::operator=(const ReceiverStats& other) = default;
+ReceiverStats& ReceiverStats::operator=(ReceiverStats&& other) noexcept =
+    default;
+ReceiverStats::~ReceiverStats() = default;
+
+}  // namespace cast
+}  // namespace openscreen
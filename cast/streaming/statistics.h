@@ -0,0 +1,138 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_STATISTICS_H_
+#define CAST_STREAMING_STATISTICS_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "platform/api/time.h"
+
+namespace openscreen {
+namespace cast {
+
+// A histogram with a fixed number of equal-width buckets spanning [min, max).
+// Samples outside of that range are counted in the first or last bucket.
+// Adding a sample is O(1) and never allocates, which makes this suitable for
+// tracking per-frame or per-packet measurements on the hot path.
+class FixedBucketHistogram {
+ public:
+  FixedBucketHistogram(int64_t min, int64_t max, int num_buckets);
+  FixedBucketHistogram(const FixedBucketHistogram& other);
+  FixedBucketHistogram(FixedBucketHistogram&& other) noexcept;
+  FixedBucketHistogram& operator=(const FixedBucketHistogram& other);
+  FixedBucketHistogram& operator=(FixedBucketHistogram&& other) noexcept;
+  ~FixedBucketHistogram();
+
+  void Add(int64_t sample);
+
+  int64_t min() const { return min_; }
+  int64_t max() const { return max_; }
+  int64_t bucket_width() const { return bucket_width_; }
+  const std::vector<int>& bucket_counts() const { return bucket_counts_; }
+
+  // The number of samples added, and their exact sum and mean. The mean is
+  // zero if no samples have been added.
+  int count() const { return count_; }
+  int64_t sum() const { return sum_; }
+  double mean() const;
+
+  // Returns an approximation of the given |percentile| (in the range [0,1]) of
+  // the samples: the upper bound of the bucket containing it. Returns |min()|
+  // if no samples have been added.
+  int64_t GetApproximatePercentile(double percentile) const;
+
+ private:
+  int64_t min_;
+  int64_t max_;
+  int64_t bucket_width_;
+  std::vector<int> bucket_counts_;
+  int count_ = 0;
+  int64_t sum_ = 0;
+};
+
+// A snapshot of the statistics tracked by a Sender since it was created. See
+// Sender::GetStats().
+struct SenderStats {
+  SenderStats();
+  SenderStats(const SenderStats& other);
+  SenderStats(SenderStats&& other) noexcept;
+  SenderStats& operator=(const SenderStats& other);
+  SenderStats& operator=(SenderStats&& other) noexcept;
+  ~SenderStats();
+
+  // Frames accepted by EnqueueFrame(), frames whose packets have all been sent
+  // at least once, frames ACKed by the Receiver, and frames canceled before
+  // being ACKed (e.g., by CancelInFlightData()).
+  int num_frames_enqueued = 0;
+  int num_frames_sent = 0;
+  int num_frames_acked = 0;
+  int num_frames_canceled = 0;
+
+  // All RTP packets sent (including re-transmits and FEC packets), and the
+  // number of packets that were scheduled for re-transmit in response to the
+  // Receiver's NACKs. NACKed packets that were not re-transmitted because a
+  // re-transmit was likely already in-flight or queued are also counted.
+  int num_packets_sent = 0;
+  int num_packets_retransmitted = 0;
+  int num_duplicate_retransmits_avoided = 0;
+
+  // The number of packets NACKed by the Receiver (a whole-frame NACK counts
+  // once), and the number of picture loss indications received.
+  int num_nacks_received = 0;
+  int num_plis_received = 0;
+
+  // The smoothed round trip time, or zero if not yet measured.
+  Clock::duration round_trip_time{0};
+
+  // The current network bandwidth estimate, in bits per second, shared by all
+  // Senders using the same SenderPacketRouter. Zero if not yet known.
+  int estimated_bandwidth = 0;
+
+  // The time from EnqueueFrame() until the Receiver ACKed each frame.
+  FixedBucketHistogram frame_ack_latency_ms;
+};
+
+// A snapshot of the statistics tracked by a Receiver since it was created. See
+// Receiver::GetStats().
+struct ReceiverStats {
+  ReceiverStats();
+  ReceiverStats(const ReceiverStats& other);
+  ReceiverStats(ReceiverStats&& other) noexcept;
+  ReceiverStats& operator=(const ReceiverStats& other);
+  ReceiverStats& operator=(ReceiverStats&& other) noexcept;
+  ~ReceiverStats();
+
+  // Valid RTP packets received (including duplicates and FEC packets).
+  int num_packets_received = 0;
+
+  // Frames that were completely received, frames consumed by the Consumer, and
+  // frames that were dropped because they would have played out too late.
+  int num_frames_completed = 0;
+  int num_frames_consumed = 0;
+  int num_frames_dropped_late = 0;
+
+  // The number of packet NACKs (a whole-frame NACK counts once) and picture
+  // loss indications sent to the Sender.
+  int num_nacks_sent = 0;
+  int num_plis_sent = 0;
+
+  // The estimated round trip time, or zero if not yet known.
+  Clock::duration round_trip_time{0};
+
+  // The time from when the first packet of each frame arrived until the frame
+  // was complete, and the time spent decrypting each consumed frame.
+  FixedBucketHistogram frame_completion_latency_ms;
+  FixedBucketHistogram decrypt_time_us;
+
+  // How late each periodic RTCP packet was sent, relative to when it was due.
+  FixedBucketHistogram rtcp_send_lateness_ms;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_STATISTICS_H_
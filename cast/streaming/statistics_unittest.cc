@@ -0,0 +1,74 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/statistics.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+TEST(FixedBucketHistogramTest, CountsSamplesInBuckets) {
+  FixedBucketHistogram histogram(0, 100, 10);
+  EXPECT_EQ(10, histogram.bucket_width());
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(0.0, histogram.mean());
+  EXPECT_EQ(0, histogram.GetApproximatePercentile(0.5));
+
+  histogram.Add(0);
+  histogram.Add(9);
+  histogram.Add(10);
+  histogram.Add(55);
+  histogram.Add(99);
+
+  const std::vector<int> expected_counts = {2, 1, 0, 0, 0, 1, 0, 0, 0, 1};
+  EXPECT_EQ(expected_counts, histogram.bucket_counts());
+  EXPECT_EQ(5, histogram.count());
+  EXPECT_EQ(173, histogram.sum());
+  EXPECT_DOUBLE_EQ(34.6, histogram.mean());
+}
+
+// Tests that samples outside the histogram's range are counted in the first or
+// last bucket, but their exact values still contribute to the sum.
+TEST(FixedBucketHistogramTest, ClampsOutOfRangeSamples) {
+  FixedBucketHistogram histogram(10, 20, 5);
+  histogram.Add(-100);
+  histogram.Add(1000);
+
+  const std::vector<int> expected_counts = {1, 0, 0, 0, 1};
+  EXPECT_EQ(expected_counts, histogram.bucket_counts());
+  EXPECT_EQ(900, histogram.sum());
+}
+
+TEST(FixedBucketHistogramTest, ComputesApproximatePercentiles) {
+  FixedBucketHistogram histogram(0, 1000, 100);
+  for (int i = 0; i < 1000; ++i) {
+    histogram.Add(i);
+  }
+  EXPECT_EQ(10, histogram.GetApproximatePercentile(0.0));
+  EXPECT_EQ(500, histogram.GetApproximatePercentile(0.5));
+  EXPECT_EQ(990, histogram.GetApproximatePercentile(0.99));
+  EXPECT_EQ(1000, histogram.GetApproximatePercentile(1.0));
+}
+
+// Tests that the stats snapshots are independent copies.
+TEST(StatisticsTest, SnapshotsAreIndependentCopies) {
+  SenderStats stats;
+  stats.frame_ack_latency_ms.Add(42);
+  SenderStats snapshot = stats;
+  stats.frame_ack_latency_ms.Add(42);
+  EXPECT_EQ(1, snapshot.frame_ack_latency_ms.count());
+  EXPECT_EQ(2, stats.frame_ack_latency_ms.count());
+
+  ReceiverStats receiver_stats;
+  EXPECT_EQ(0, receiver_stats.frame_completion_latency_ms.min());
+  EXPECT_EQ(0, receiver_stats.decrypt_time_us.count());
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
@@ -40,24 +40,57 @@ class MessagePipeEnd : public MessagePort {
 
   void ResetClient() override { client_ = nullptr; }
 
+  // By default, both ends of the pipe can carry binary messages.
+  void SetSupportsBinaryMessages(bool supported) {
+    supports_binary_messages_ = supported;
+  }
+
+  int num_messages_posted() const { return num_messages_posted_; }
+  int num_binary_messages_posted() const {
+    return num_binary_messages_posted_;
+  }
+
   void ReceiveMessage(const std::string& namespace_,
                       const std::string& message) {
     ASSERT_NE(client_, nullptr);
     client_->OnMessage(destination_id_, namespace_, message);
   }
 
+  void ReceiveBinaryMessage(const std::string& namespace_,
+                            const std::string& message) {
+    ASSERT_NE(client_, nullptr);
+    client_->OnBinaryMessage(destination_id_, namespace_, message);
+  }
+
   void PostMessage(const std::string& sender_id,
                    const std::string& message_namespace,
                    const std::string& message) override {
     ASSERT_NE(other_end_, nullptr);
+    ++num_messages_posted_;
     other_end_->ReceiveMessage(message_namespace, message);
   }
 
+  bool SupportsBinaryMessages() const override {
+    return supports_binary_messages_;
+  }
+
+  void PostBinaryMessage(const std::string& sender_id,
+                         const std::string& message_namespace,
+                         const std::string& message) override {
+    ASSERT_TRUE(supports_binary_messages_);
+    ASSERT_NE(other_end_, nullptr);
+    ++num_binary_messages_posted_;
+    other_end_->ReceiveBinaryMessage(message_namespace, message);
+  }
+
  private:
   std::string sender_id_;
   std::string destination_id_;
   MessagePort::Client* client_ = nullptr;
   MessagePipeEnd* other_end_ = nullptr;
+  bool supports_binary_messages_ = true;
+  int num_messages_posted_ = 0;
+  int num_binary_messages_posted_ = 0;
 };
 
 class MessagePipe {
@@ -0,0 +1,377 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/testing/streaming_simulation.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/receiver_packet_router.h"
+#include "cast/streaming/rtp_defines.h"
+#include "cast/streaming/rtp_time.h"
+#include "cast/streaming/sender.h"
+#include "cast/streaming/sender_packet_router.h"
+#include "cast/streaming/session_config.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+
+constexpr Ssrc kSenderSsrc = 1;
+constexpr Ssrc kReceiverSsrc = 2;
+constexpr int kRtpTimebase = 90000;
+
+constexpr std::array<uint8_t, 16> kAesKey{{0x00, 0x11, 0x22, 0x33, 0x44, 0x55,
+                                           0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb,
+                                           0xcc, 0xdd, 0xee, 0xff}};
+constexpr std::array<uint8_t, 16> kAesIvMask{{0xff, 0xee, 0xdd, 0xcc, 0xbb,
+                                              0xaa, 0x99, 0x88, 0x77, 0x66,
+                                              0x55, 0x44, 0x33, 0x22, 0x11,
+                                              0x00}};
+
+// The fraction of pixels encoded at each BitrateController resolution step,
+// assuming VP8's 4/5, 3/5, and 1/2 scaling modes.
+constexpr std::array<double, 4> kPixelFractionForResolutionStep{
+    {1.0, 0.64, 0.36, 0.25}};
+
+const IPEndpoint kSenderEndpoint{IPAddress(10, 0, 0, 1), 2344};
+const IPEndpoint kReceiverEndpoint{IPAddress(10, 0, 0, 2), 2344};
+
+SessionConfig MakeSessionConfig(milliseconds target_playout_delay) {
+  return SessionConfig{/* .sender_ssrc = */ kSenderSsrc,
+                       /* .receiver_ssrc = */ kReceiverSsrc,
+                       /* .rtp_timebase = */ kRtpTimebase,
+                       /* .channels = */ 1,
+                       /* .target_playout_delay = */ target_playout_delay,
+                       /* .aes_secret_key = */ kAesKey,
+                       /* .aes_iv_mask = */ kAesIvMask,
+                       /* .is_pli_enabled = */ true};
+}
+
+}  // namespace
+
+SimulatedLink::SimulatedLink(TaskRunner* task_runner,
+                             Clock::time_point start_time,
+                             const IPEndpoint& source,
+                             const Params& params)
+    : task_runner_(task_runner),
+      start_time_(start_time),
+      source_(source),
+      params_(params),
+      random_(params.random_seed) {
+  OSP_DCHECK(task_runner_);
+  OSP_DCHECK_GE(params_.loss_rate, 0.0);
+  OSP_DCHECK_LE(params_.loss_rate, 1.0);
+  for (const CapacityChange& change : params_.capacity_trace) {
+    OSP_DCHECK_GT(change.bits_per_second, 0);
+  }
+}
+
+SimulatedLink::~SimulatedLink() = default;
+
+int64_t SimulatedLink::GetCapacityAt(Clock::time_point when) const {
+  int64_t capacity = 0;
+  for (const CapacityChange& change : params_.capacity_trace) {
+    if (start_time_ + change.at > when) {
+      break;
+    }
+    capacity = change.bits_per_second;
+  }
+  return capacity;
+}
+
+void SimulatedLink::Transmit(absl::Span<const uint8_t> packet) {
+  OSP_DCHECK(remote_);
+  ++num_packets_sent_;
+  if (params_.loss_rate > 0.0 &&
+      std::uniform_real_distribution<double>(0.0, 1.0)(random_) <
+          params_.loss_rate) {
+    ++num_packets_lost_;
+    return;
+  }
+
+  const Clock::time_point now = FakeClock::now();
+  Clock::time_point departure_time = now;
+  const int64_t capacity = GetCapacityAt(now);
+  if (capacity > 0) {
+    const Clock::duration transmit_duration =
+        duration_cast<Clock::duration>(std::chrono::duration<double>(
+            static_cast<double>(packet.size()) * 8 / capacity));
+    departure_time = std::max(now, link_free_time_) + transmit_duration;
+    if (departure_time - now > params_.max_queue_delay) {
+      ++num_packets_dropped_by_queue_;
+      return;
+    }
+    link_free_time_ = departure_time;
+  }
+
+  num_bytes_delivered_ += packet.size();
+  std::vector<uint8_t> copy(packet.begin(), packet.end());
+  task_runner_->PostTaskWithDelay(
+      [this, packet = std::move(copy)]() mutable {
+        remote_->OnReceivedPacket(source_, FakeClock::now(), std::move(packet));
+      },
+      (departure_time - now) + params_.propagation_delay);
+}
+
+class StreamingSimulation::SimulatedEnvironment final : public Environment {
+ public:
+  SimulatedEnvironment(TaskRunner* task_runner,
+                       const IPEndpoint& local_endpoint,
+                       const IPEndpoint& remote_endpoint,
+                       SimulatedLink* link)
+      : local_endpoint_(local_endpoint), link_(link) {
+    now_function_ = &FakeClock::now;
+    task_runner_ = task_runner;
+    set_remote_endpoint(remote_endpoint);
+  }
+
+  ~SimulatedEnvironment() final = default;
+
+  IPEndpoint GetBoundLocalEndpoint() const final { return local_endpoint_; }
+
+  void SendPacket(absl::Span<const uint8_t> packet) final {
+    link_->Transmit(packet);
+  }
+
+ private:
+  const IPEndpoint local_endpoint_;
+  SimulatedLink* const link_;
+};
+
+StreamingSimulation::Results::Results() = default;
+StreamingSimulation::Results::Results(const Results& other) = default;
+StreamingSimulation::Results::Results(Results&& other) noexcept = default;
+StreamingSimulation::Results& StreamingSimulation::Results::operator=(
+    const Results& other) = default;
+StreamingSimulation::Results& StreamingSimulation::Results::operator=(
+    Results&& other) noexcept = default;
+StreamingSimulation::Results::~Results() = default;
+
+StreamingSimulation::StreamingSimulation(const Params& params)
+    : params_(params),
+      clock_(Clock::now()),
+      task_runner_(&clock_),
+      start_time_(FakeClock::now()),
+      forward_link_(&task_runner_,
+                    start_time_,
+                    kSenderEndpoint,
+                    params.forward_link),
+      reverse_link_(&task_runner_,
+                    start_time_,
+                    kReceiverEndpoint,
+                    params.reverse_link),
+      sender_environment_(
+          std::make_unique<SimulatedEnvironment>(&task_runner_,
+                                                 kSenderEndpoint,
+                                                 kReceiverEndpoint,
+                                                 &forward_link_)),
+      receiver_environment_(
+          std::make_unique<SimulatedEnvironment>(&task_runner_,
+                                                 kReceiverEndpoint,
+                                                 kSenderEndpoint,
+                                                 &reverse_link_)),
+      sender_packet_router_(
+          std::make_unique<SenderPacketRouter>(sender_environment_.get())),
+      receiver_packet_router_(
+          std::make_unique<ReceiverPacketRouter>(receiver_environment_.get())),
+      sender_(std::make_unique<Sender>(
+          sender_environment_.get(),
+          sender_packet_router_.get(),
+          MakeSessionConfig(params.target_playout_delay),
+          RtpPayloadType::kVideoVp8)),
+      receiver_(std::make_unique<Receiver>(
+          receiver_environment_.get(),
+          receiver_packet_router_.get(),
+          MakeSessionConfig(params.target_playout_delay))) {
+  OSP_DCHECK_GT(params_.frames_per_second, 0);
+  OSP_DCHECK_GT(params_.key_frame_interval, 0);
+  OSP_DCHECK_GT(params_.min_bitrate, 0);
+  OSP_DCHECK_LE(params_.min_bitrate, params_.max_bitrate);
+  if (params_.bitrate_controller) {
+    bitrate_controller_.emplace(*params_.bitrate_controller);
+  }
+  forward_link_.set_remote(receiver_packet_router_.get());
+  reverse_link_.set_remote(sender_packet_router_.get());
+  receiver_->SetConsumer(this);
+}
+
+StreamingSimulation::~StreamingSimulation() {
+  receiver_->SetConsumer(nullptr);
+}
+
+StreamingSimulation::Results StreamingSimulation::Run() {
+  OSP_DCHECK(!has_run_);
+  has_run_ = true;
+
+  ProduceNextFrame();
+  SampleBandwidthEstimate();
+  if (bitrate_controller_) {
+    UpdateTargetBitrate();
+  }
+  clock_.Advance(params_.duration);
+
+  const double seconds =
+      std::chrono::duration<double>(FakeClock::now() - start_time_).count();
+  results_.consumed_bitrate =
+      static_cast<int64_t>(num_bytes_consumed_ * 8 / seconds);
+  if (results_.num_estimate_samples > 0) {
+    results_.mean_estimate_error =
+        sum_of_estimate_errors_ / results_.num_estimate_samples;
+  }
+  results_.num_forward_packets_dropped =
+      forward_link_.num_packets_lost() +
+      forward_link_.num_packets_dropped_by_queue();
+  results_.sender_stats = sender_->GetStats();
+  results_.receiver_stats = receiver_->GetStats();
+  return results_;
+}
+
+void StreamingSimulation::ProduceNextFrame() {
+  const Clock::time_point now = FakeClock::now();
+  if (now - start_time_ >= params_.duration) {
+    return;
+  }
+
+  const RtpTimeTicks rtp_timestamp =
+      RtpTimeTicks() +
+      RtpTimeDelta::FromTicks(static_cast<int64_t>(frame_count_) *
+                              kRtpTimebase / params_.frames_per_second);
+  ++frame_count_;
+  const Clock::time_point next_frame_time =
+      start_time_ + duration_cast<Clock::duration>(std::chrono::seconds(1)) *
+                        frame_count_ / params_.frames_per_second;
+  task_runner_.PostTaskWithDelay([this] { ProduceNextFrame(); },
+                                 next_frame_time - now);
+
+  int bitrate = params_.min_bitrate;
+  if (bitrate_controller_) {
+    if (bitrate_controller_->ShouldDropFrame(
+            sender_->GetInFlightMediaDuration(rtp_timestamp),
+            sender_->GetMaxInFlightMediaDuration())) {
+      ++results_.num_frames_dropped;
+      return;
+    }
+    bitrate = bitrate_controller_->target_bitrate();
+
+    // Model an encoder whose workload, and the bits needed to encode the
+    // content well, are proportional to the number of pixels.
+    const double pixel_fraction =
+        kPixelFractionForResolutionStep[std::min(
+            bitrate_controller_->resolution_step(),
+            static_cast<int>(kPixelFractionForResolutionStep.size()) - 1)];
+    BitrateController::EncoderFeedback feedback;
+    feedback.time_utilization =
+        pixel_fraction * params_.full_resolution_encode_time.count() *
+        params_.frames_per_second /
+        duration_cast<Clock::duration>(std::chrono::seconds(1)).count();
+    feedback.space_utilization = 1.0;
+    feedback.entropy_utilization =
+        pixel_fraction * params_.content_bitrate / bitrate;
+    bitrate_controller_->OnFrameEncoded(now, feedback);
+    results_.max_resolution_step = std::max(
+        results_.max_resolution_step, bitrate_controller_->resolution_step());
+  } else {
+    const int estimate = sender_packet_router_->ComputeNetworkBandwidth();
+    if (estimate > 0) {
+      bitrate = std::min(
+          std::max(static_cast<int>(estimate * params_.bandwidth_utilization),
+                   params_.min_bitrate),
+          params_.max_bitrate);
+    }
+  }
+  frame_buffer_.resize(std::max(bitrate / params_.frames_per_second / 8, 1));
+  std::fill(frame_buffer_.begin(), frame_buffer_.end(),
+            static_cast<uint8_t>(frame_count_));
+
+  EncodedFrame frame;
+  frame.frame_id = sender_->GetNextFrameId();
+  if (last_enqueued_frame_id_.is_null() || sender_->NeedsKeyFrame() ||
+      (frame_count_ - 1) % params_.key_frame_interval == 0) {
+    frame.dependency = EncodedFrame::KEY_FRAME;
+    frame.referenced_frame_id = frame.frame_id;
+  } else {
+    frame.dependency = EncodedFrame::DEPENDS_ON_ANOTHER;
+    frame.referenced_frame_id = last_enqueued_frame_id_;
+  }
+  frame.rtp_timestamp = rtp_timestamp;
+  frame.reference_time = now;
+  frame.data = absl::Span<uint8_t>(frame_buffer_);
+  ++results_.num_frames_encoded;
+
+  if (sender_->EnqueueFrame(frame) == Sender::OK) {
+    last_enqueued_frame_id_ = frame.frame_id;
+    enqueue_times_[frame.frame_id] = now;
+  } else {
+    ++results_.num_frames_rejected;
+  }
+}
+
+void StreamingSimulation::UpdateTargetBitrate() {
+  const Clock::time_point now = FakeClock::now();
+  if (now - start_time_ >= params_.duration) {
+    return;
+  }
+
+  const RtpTimeTicks next_rtp_timestamp =
+      RtpTimeTicks() +
+      RtpTimeDelta::FromTicks(static_cast<int64_t>(frame_count_) *
+                              kRtpTimebase / params_.frames_per_second);
+  bitrate_controller_->UpdateTargetBitrate(
+      sender_packet_router_->ComputeNetworkBandwidth(),
+      sender_->GetInFlightMediaDuration(next_rtp_timestamp),
+      sender_->GetMaxInFlightMediaDuration());
+
+  task_runner_.PostTaskWithDelay([this] { UpdateTargetBitrate(); },
+                                 params_.bitrate_update_interval);
+}
+
+void StreamingSimulation::SampleBandwidthEstimate() {
+  const Clock::time_point now = FakeClock::now();
+  if (now - start_time_ >= params_.duration) {
+    return;
+  }
+
+  const int estimate = sender_packet_router_->ComputeNetworkBandwidth();
+  const int64_t capacity = forward_link_.GetCapacityAt(now);
+  if (estimate > 0 && capacity > 0) {
+    sum_of_estimate_errors_ +=
+        std::abs(static_cast<double>(estimate - capacity)) / capacity;
+    ++results_.num_estimate_samples;
+  }
+
+  task_runner_.PostTaskWithDelay([this] { SampleBandwidthEstimate(); },
+                                 params_.estimate_sample_interval);
+}
+
+void StreamingSimulation::OnFramesReady(int next_frame_buffer_size) {
+  for (int size = next_frame_buffer_size; size != Receiver::kNoFramesReady;
+       size = receiver_->AdvanceToNextFrame()) {
+    frame_buffer_.resize(size);
+    const EncodedFrame frame =
+        receiver_->ConsumeNextFrame(absl::Span<uint8_t>(frame_buffer_));
+    ++results_.num_frames_consumed;
+    num_bytes_consumed_ += frame.data.size();
+
+    const auto it = enqueue_times_.find(frame.frame_id);
+    if (it != enqueue_times_.end()) {
+      results_.frame_latency_ms.Add(
+          duration_cast<milliseconds>(FakeClock::now() - it->second).count());
+    }
+    enqueue_times_.erase(enqueue_times_.begin(),
+                         enqueue_times_.upper_bound(frame.frame_id));
+  }
+}
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,266 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_TESTING_STREAMING_SIMULATION_H_
+#define CAST_STREAMING_TESTING_STREAMING_SIMULATION_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "cast/streaming/bitrate_controller.h"
+#include "cast/streaming/environment.h"
+#include "cast/streaming/frame_id.h"
+#include "cast/streaming/receiver.h"
+#include "cast/streaming/statistics.h"
+#include "platform/api/task_runner.h"
+#include "platform/api/time.h"
+#include "platform/base/ip_address.h"
+#include "platform/test/fake_clock.h"
+#include "platform/test/fake_task_runner.h"
+
+namespace openscreen {
+namespace cast {
+
+class ReceiverPacketRouter;
+class Sender;
+class SenderPacketRouter;
+
+// Simulates one direction of a network path, in virtual time: Packets are
+// randomly dropped, then queued behind each other at the link's capacity
+// (dropping those that would wait too long, like a drop-tail router queue),
+// and finally delivered to the remote PacketConsumer after a fixed propagation
+// delay. The capacity may change over time, following a trace.
+class SimulatedLink {
+ public:
+  // The link capacity from the point-in-time |at| (relative to the start of the
+  // simulation) until the next change.
+  struct CapacityChange {
+    Clock::duration at;
+    int64_t bits_per_second;
+  };
+
+  struct Params {
+    // The capacity changes, in chronological order. An empty trace means the
+    // link has unlimited capacity.
+    std::vector<CapacityChange> capacity_trace;
+
+    Clock::duration propagation_delay{};
+
+    // The fraction of packets dropped at random, in the range [0,1].
+    double loss_rate = 0.0;
+
+    Clock::duration max_queue_delay = std::chrono::milliseconds(250);
+
+    // Seeds the pseudo-random decisions, so runs are reproducible.
+    uint32_t random_seed = 1;
+  };
+
+  // Constructs a link whose packets appear to come from |source|. The link is
+  // idle until set_remote() is called.
+  SimulatedLink(TaskRunner* task_runner,
+                Clock::time_point start_time,
+                const IPEndpoint& source,
+                const Params& params);
+  ~SimulatedLink();
+
+  void set_remote(Environment::PacketConsumer* remote) { remote_ = remote; }
+
+  // Returns the capacity at the given point-in-time, in bits per second, or
+  // zero if it is unlimited.
+  int64_t GetCapacityAt(Clock::time_point when) const;
+
+  // Starts transmitting a copy of |packet| to the remote PacketConsumer. The
+  // caller needs to advance the FakeClock before it will arrive.
+  void Transmit(absl::Span<const uint8_t> packet);
+
+  // The number of packets passed to Transmit(), the number dropped at random or
+  // because the queue was full, and the bytes delivered to the remote.
+  int num_packets_sent() const { return num_packets_sent_; }
+  int num_packets_lost() const { return num_packets_lost_; }
+  int num_packets_dropped_by_queue() const {
+    return num_packets_dropped_by_queue_;
+  }
+  int64_t num_bytes_delivered() const { return num_bytes_delivered_; }
+
+ private:
+  TaskRunner* const task_runner_;
+  const Clock::time_point start_time_;
+  const IPEndpoint source_;
+  const Params params_;
+  Environment::PacketConsumer* remote_ = nullptr;
+
+  std::minstd_rand random_;
+
+  // When the link will have finished transmitting the packets queued so far.
+  Clock::time_point link_free_time_ = Clock::time_point::min();
+
+  int num_packets_sent_ = 0;
+  int num_packets_lost_ = 0;
+  int num_packets_dropped_by_queue_ = 0;
+  int64_t num_bytes_delivered_ = 0;
+};
+
+// A discrete-event simulation of a complete video stream, for benchmarking the
+// streaming stack and catching regressions in its pacing, bandwidth estimation,
+// and NACK/retransmit logic. A Sender and its SenderPacketRouter exchange RTP
+// and RTCP packets with a Receiver and its ReceiverPacketRouter over a pair of
+// SimulatedLinks, entirely in virtual time driven by a FakeClock. This allows
+// replaying long sessions with controlled capacity traces in seconds, with
+// fully reproducible results.
+//
+// A simple encoder model produces frames at a fixed rate, sized to use a
+// fraction of the Sender's current network bandwidth estimate. Alternatively,
+// a BitrateController may decide the frame sizes, frame drops, and resolution.
+//
+// Only one instance may exist at a time, since it owns the process-wide
+// FakeClock.
+class StreamingSimulation final : public Receiver::Consumer {
+ public:
+  struct Params {
+    // The Sender→Receiver and Receiver→Sender links.
+    SimulatedLink::Params forward_link;
+    SimulatedLink::Params reverse_link;
+
+    // How much virtual time to simulate.
+    Clock::duration duration = std::chrono::seconds(60);
+
+    int frames_per_second = 30;
+
+    // A key frame is produced every this many frames, and whenever the
+    // Receiver requests one.
+    int key_frame_interval = 100;
+
+    // The encoder bitrate is a fraction of the Sender's bandwidth estimate,
+    // clamped to the range [min_bitrate,max_bitrate]. |min_bitrate| is also
+    // used until the first estimate is available.
+    double bandwidth_utilization = 0.7;
+    int min_bitrate = 300000;
+    int max_bitrate = 10000000;
+
+    std::chrono::milliseconds target_playout_delay{400};
+
+    // If set, a BitrateController with these parameters decides the encoder
+    // bitrate (updated at |bitrate_update_interval|), and which frames to drop,
+    // instead of the fixed policy above. The encoder model then reports the
+    // utilization of encoding |content_bitrate| worth of content in
+    // |full_resolution_encode_time| per frame, both scaled down by the pixel
+    // count at the controller's current resolution step.
+    absl::optional<BitrateController::Params> bitrate_controller;
+    Clock::duration bitrate_update_interval = std::chrono::milliseconds(500);
+    int content_bitrate = 4000000;
+    Clock::duration full_resolution_encode_time = std::chrono::milliseconds(10);
+
+    // How often the bandwidth estimate is compared to the forward link's
+    // capacity.
+    Clock::duration estimate_sample_interval = std::chrono::milliseconds(100);
+  };
+
+  struct Results {
+    Results();
+    Results(const Results& other);
+    Results(Results&& other) noexcept;
+    Results& operator=(const Results& other);
+    Results& operator=(Results&& other) noexcept;
+    ~Results();
+
+    // Frames dropped by the BitrateController before encoding, frames produced
+    // by the encoder model, frames the Sender refused to enqueue (e.g., because
+    // too much media was in-flight), and frames the Receiver's Consumer
+    // consumed.
+    int num_frames_dropped = 0;
+    int num_frames_encoded = 0;
+    int num_frames_rejected = 0;
+    int num_frames_consumed = 0;
+
+    // The average rate of payload bytes consumed, in bits per second.
+    int64_t consumed_bitrate = 0;
+
+    // The time from when each frame was enqueued until it was consumed.
+    FixedBucketHistogram frame_latency_ms{0, 2000, 100};
+
+    // The mean absolute error of the Sender's bandwidth estimates relative to
+    // the forward link's capacity at the time, as a fraction of the capacity,
+    // and the number of estimates sampled. Only sampled while the estimate is
+    // known and the link capacity is limited.
+    double mean_estimate_error = 0.0;
+    int num_estimate_samples = 0;
+
+    // The lowest resolution chosen by the BitrateController.
+    int max_resolution_step = 0;
+
+    // Packets dropped by the forward link, whether at random or by its queue.
+    int num_forward_packets_dropped = 0;
+
+    SenderStats sender_stats;
+    ReceiverStats receiver_stats;
+  };
+
+  explicit StreamingSimulation(const Params& params);
+  ~StreamingSimulation() final;
+
+  // Runs the whole simulation and returns its metrics. May only be called once.
+  Results Run();
+
+ private:
+  // An Environment that transmits its packets over a SimulatedLink.
+  class SimulatedEnvironment;
+
+  // Produces and enqueues the next frame, and schedules the one after it.
+  void ProduceNextFrame();
+
+  // Updates the BitrateController's target bitrate, and schedules the next
+  // update.
+  void UpdateTargetBitrate();
+
+  // Compares the Sender's bandwidth estimate to the forward link's capacity,
+  // and schedules the next sample.
+  void SampleBandwidthEstimate();
+
+  // Receiver::Consumer implementation.
+  void OnFramesReady(int next_frame_buffer_size) final;
+
+  const Params params_;
+
+  FakeClock clock_;
+  FakeTaskRunner task_runner_;
+  const Clock::time_point start_time_;
+
+  SimulatedLink forward_link_;
+  SimulatedLink reverse_link_;
+  const std::unique_ptr<SimulatedEnvironment> sender_environment_;
+  const std::unique_ptr<SimulatedEnvironment> receiver_environment_;
+  const std::unique_ptr<SenderPacketRouter> sender_packet_router_;
+  const std::unique_ptr<ReceiverPacketRouter> receiver_packet_router_;
+  const std::unique_ptr<Sender> sender_;
+  const std::unique_ptr<Receiver> receiver_;
+
+  absl::optional<BitrateController> bitrate_controller_;
+
+  // Reused for producing and consuming each frame.
+  std::vector<uint8_t> frame_buffer_;
+
+  int frame_count_ = 0;
+  FrameId last_enqueued_frame_id_;
+
+  // When each not-yet-consumed frame was enqueued.
+  std::map<FrameId, Clock::time_point> enqueue_times_;
+
+  int64_t num_bytes_consumed_ = 0;
+  double sum_of_estimate_errors_ = 0.0;
+  bool has_run_ = false;
+
+  Results results_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_TESTING_STREAMING_SIMULATION_H_
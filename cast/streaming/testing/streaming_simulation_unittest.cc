@@ -0,0 +1,111 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/testing/streaming_simulation.h"
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+// Records the key metrics of a simulation run, so they can be tracked over time
+// to catch performance regressions.
+void RecordResults(const StreamingSimulation::Results& results) {
+  ::testing::Test::RecordProperty("consumed_bitrate",
+                                  static_cast<int>(results.consumed_bitrate));
+  ::testing::Test::RecordProperty(
+      "frame_latency_p50_ms",
+      static_cast<int>(
+          results.frame_latency_ms.GetApproximatePercentile(0.5)));
+  ::testing::Test::RecordProperty(
+      "frame_latency_p95_ms",
+      static_cast<int>(
+          results.frame_latency_ms.GetApproximatePercentile(0.95)));
+  ::testing::Test::RecordProperty(
+      "mean_estimate_error_percent",
+      static_cast<int>(results.mean_estimate_error * 100));
+  ::testing::Test::RecordProperty(
+      "packets_retransmitted",
+      results.sender_stats.num_packets_retransmitted);
+  ::testing::Test::RecordProperty("frames_rejected",
+                                  results.num_frames_rejected);
+}
+
+StreamingSimulation::Params MakeParams(Clock::duration duration) {
+  StreamingSimulation::Params params;
+  params.duration = duration;
+  params.forward_link.propagation_delay = milliseconds(20);
+  params.reverse_link.propagation_delay = milliseconds(20);
+  return params;
+}
+
+TEST(StreamingSimulationTest, StreamsOverUnimpairedLink) {
+  StreamingSimulation::Params params = MakeParams(seconds(30));
+  params.forward_link.capacity_trace = {{seconds(0), 20000000}};
+  const StreamingSimulation::Results results =
+      StreamingSimulation(params).Run();
+  RecordResults(results);
+
+  EXPECT_EQ(30 * 30, results.num_frames_encoded);
+  EXPECT_EQ(0, results.num_frames_rejected);
+  EXPECT_EQ(0, results.num_forward_packets_dropped);
+  EXPECT_GE(results.num_frames_consumed, results.num_frames_encoded - 30);
+  EXPECT_GE(results.consumed_bitrate, params.min_bitrate);
+  EXPECT_LE(results.frame_latency_ms.GetApproximatePercentile(0.95),
+            params.target_playout_delay.count());
+}
+
+TEST(StreamingSimulationTest, ProducesIdenticalResultsForIdenticalParams) {
+  StreamingSimulation::Params params = MakeParams(seconds(20));
+  params.forward_link.capacity_trace = {{seconds(0), 4000000}};
+  params.forward_link.loss_rate = 0.02;
+  params.reverse_link.loss_rate = 0.02;
+
+  const StreamingSimulation::Results first = StreamingSimulation(params).Run();
+  const StreamingSimulation::Results second =
+      StreamingSimulation(params).Run();
+  EXPECT_EQ(first.num_frames_consumed, second.num_frames_consumed);
+  EXPECT_EQ(first.consumed_bitrate, second.consumed_bitrate);
+  EXPECT_EQ(first.frame_latency_ms.bucket_counts(),
+            second.frame_latency_ms.bucket_counts());
+  EXPECT_EQ(first.sender_stats.num_packets_sent,
+            second.sender_stats.num_packets_sent);
+  EXPECT_EQ(first.mean_estimate_error, second.mean_estimate_error);
+
+  // The loss should have been recovered from by re-transmitting packets.
+  EXPECT_GT(first.num_forward_packets_dropped, 0);
+  EXPECT_GT(first.sender_stats.num_nacks_received, 0);
+  EXPECT_GT(first.sender_stats.num_packets_retransmitted, 0);
+}
+
+// Streams over a link whose capacity steps down and back up, which exercises
+// the pacing, bandwidth estimation, and NACK logic together. See
+// cast/test:streaming_simulation_benchmark for a longer replay.
+TEST(StreamingSimulationTest, AdaptsToCapacityTrace) {
+  StreamingSimulation::Params params = MakeParams(seconds(30));
+  params.forward_link.capacity_trace = {{seconds(0), 8000000},
+                                        {seconds(10), 1500000},
+                                        {seconds(20), 8000000}};
+  const StreamingSimulation::Results results =
+      StreamingSimulation(params).Run();
+  RecordResults(results);
+
+  EXPECT_EQ(30 * 30, results.num_frames_encoded);
+  EXPECT_GT(results.num_estimate_samples, 0);
+  EXPECT_GE(results.consumed_bitrate, params.min_bitrate);
+  EXPECT_LT(results.consumed_bitrate, 8000000);
+
+  // Most frames should have played out despite the drop in capacity.
+  EXPECT_GE(results.num_frames_consumed, results.num_frames_encoded * 9 / 10);
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,250 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how quickly a CastSocket frames the messages out of the blocks read
+// from its TlsConnection. The message stream is built by repeating the valid
+// messages among the given files (e.g., the message_framer_fuzzer seeds), and
+// is then fed to CastSocket in blocks of several sizes. For comparison, the
+// same blocks are also framed by the previous approach, which erased each
+// message from the front of the read buffer after parsing it.
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "cast/common/channel/message_framer.h"
+#include "cast/common/channel/proto/cast_channel.pb.h"
+#include "cast/common/public/cast_socket.h"
+#include "platform/api/tls_connection.h"
+#include "platform/base/ip_address.h"
+#include "platform/impl/logging.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using ::cast::channel::CastMessage;
+using message_serialization::DeserializeResult;
+
+// The sizes of the blocks the stream is split into: A full TLS read buffer,
+// a typical TLS record, an Ethernet MTU, and a read that splits most messages.
+constexpr size_t kBlockSizes[] = {65536, 16384, 1500, 100};
+
+class NullTlsConnection final : public TlsConnection {
+ public:
+  NullTlsConnection() = default;
+  ~NullTlsConnection() final = default;
+
+  // TlsConnection overrides.
+  void SetClient(Client* client) final {}
+  bool Send(const void* data, size_t len) final { return true; }
+  IPEndpoint GetLocalEndpoint() const final { return {}; }
+  IPEndpoint GetRemoteEndpoint() const final { return {}; }
+};
+
+class CountingClient final : public CastSocket::Client {
+ public:
+  CountingClient() = default;
+  ~CountingClient() final = default;
+
+  int num_messages() const { return num_messages_; }
+
+  // CastSocket::Client overrides.
+  void OnError(CastSocket* socket, Error error) final {
+    OSP_LOG_ERROR << "Unexpected socket error: " << error;
+  }
+  void OnMessage(CastSocket* socket, CastMessage message) final {
+    ++num_messages_;
+  }
+
+ private:
+  int num_messages_ = 0;
+};
+
+// The framing done by CastSocket::OnRead() before it parsed messages in-place,
+// which moved all of the remaining buffered bytes after each message.
+class EraseFromFrontFramer {
+ public:
+  int num_messages() const { return num_messages_; }
+
+  void OnRead(std::vector<uint8_t> block) {
+    read_buffer_.insert(read_buffer_.end(), block.begin(), block.end());
+    do {
+      ErrorOr<DeserializeResult> message_or_error =
+          message_serialization::TryDeserialize(
+              absl::Span<uint8_t>(&read_buffer_[0], read_buffer_.size()));
+      if (!message_or_error) {
+        return;
+      }
+      const size_t length = message_or_error.value().length;
+      read_buffer_.erase(read_buffer_.begin(), read_buffer_.begin() + length);
+      ++num_messages_;
+    } while (!read_buffer_.empty());
+  }
+
+ private:
+  std::vector<uint8_t> read_buffer_;
+  int num_messages_ = 0;
+};
+
+// Returns the framed message in the file at |path|, or an empty vector if the
+// file does not hold exactly one valid message.
+std::vector<uint8_t> ReadMessageFile(const char* path) {
+  std::ifstream file(path, std::ios::binary);
+  std::vector<uint8_t> contents((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+  const ErrorOr<DeserializeResult> result =
+      message_serialization::TryDeserialize(contents);
+  if (!result || result.value().length != contents.size()) {
+    return {};
+  }
+  return contents;
+}
+
+std::vector<std::vector<uint8_t>> SplitIntoBlocks(
+    const std::vector<uint8_t>& stream,
+    size_t block_size) {
+  std::vector<std::vector<uint8_t>> blocks;
+  for (size_t offset = 0; offset < stream.size(); offset += block_size) {
+    const size_t end = std::min(offset + block_size, stream.size());
+    blocks.emplace_back(stream.begin() + offset, stream.begin() + end);
+  }
+  return blocks;
+}
+
+// Runs |framer| on each of the |blocks|, and returns how long that took.
+template <typename Framer>
+std::chrono::duration<double> TimeFraming(
+    std::vector<std::vector<uint8_t>> blocks,
+    Framer framer) {
+  const auto start_time = std::chrono::steady_clock::now();
+  for (std::vector<uint8_t>& block : blocks) {
+    framer(std::move(block));
+  }
+  return std::chrono::steady_clock::now() - start_time;
+}
+
+void ReportResult(const char* name,
+                  std::chrono::duration<double> elapsed,
+                  size_t stream_size,
+                  int num_messages) {
+  std::cout << "  " << std::left << std::setw(18) << name << std::right
+            << std::setw(10) << (stream_size / elapsed.count() / (1 << 20))
+            << " MiB/s" << std::setw(12)
+            << (elapsed.count() * 1e9 / num_messages) << " ns/message\n";
+}
+
+void LogUsage(const char* argv0) {
+  std::cerr << "usage: " << argv0 << R"( <options> message_file...
+
+    message_file
+        A file holding one framed CastMessage, such as those in
+        cast/common/channel/message_framer_fuzzer_seeds. Files that do not
+        hold exactly one valid message are skipped.
+
+options:
+    -s, --stream-size=MiB: The amount of data to frame for each block size.
+                           Default: 16.
+
+    -h, --help: Show this help message.
+)";
+}
+
+int RunCastSocketFramingBenchmark(int argc, char* argv[]) {
+  const struct option kArgumentOptions[] = {
+      {"stream-size", required_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+
+  size_t stream_size = 16 << 20;
+  int ch = -1;
+  while ((ch = getopt_long(argc, argv, "s:h", kArgumentOptions, nullptr)) !=
+         -1) {
+    switch (ch) {
+      case 's':
+        stream_size = static_cast<size_t>(atoi(optarg)) << 20;
+        break;
+      case 'h':
+      default:
+        LogUsage(argv[0]);
+        return 1;
+    }
+  }
+
+  std::vector<std::vector<uint8_t>> messages;
+  for (int i = optind; i < argc; ++i) {
+    std::vector<uint8_t> message = ReadMessageFile(argv[i]);
+    if (!message.empty()) {
+      messages.push_back(std::move(message));
+    }
+  }
+  if (messages.empty() || stream_size == 0) {
+    LogUsage(argv[0]);
+    return 1;
+  }
+
+  SetLogLevel(LogLevel::kWarning);
+
+  std::vector<uint8_t> stream;
+  int num_messages = 0;
+  while (stream.size() < stream_size) {
+    const std::vector<uint8_t>& message =
+        messages[num_messages % messages.size()];
+    stream.insert(stream.end(), message.begin(), message.end());
+    ++num_messages;
+  }
+  std::cout << "Framing " << num_messages << " messages (" << messages.size()
+            << " distinct, " << (stream.size() / num_messages)
+            << " bytes on average):\n"
+            << std::fixed << std::setprecision(1);
+
+  for (size_t block_size : kBlockSizes) {
+    std::cout << block_size << "-byte blocks:\n";
+
+    CountingClient client;
+    CastSocket socket(std::make_unique<NullTlsConnection>(), &client);
+    const auto cast_socket_time =
+        TimeFraming(SplitIntoBlocks(stream, block_size),
+                    [&socket](std::vector<uint8_t> block) {
+                      socket.OnRead(nullptr, std::move(block));
+                    });
+    ReportResult("CastSocket", cast_socket_time, stream.size(),
+                 client.num_messages());
+
+    EraseFromFrontFramer legacy_framer;
+    const auto legacy_time =
+        TimeFraming(SplitIntoBlocks(stream, block_size),
+                    [&legacy_framer](std::vector<uint8_t> block) {
+                      legacy_framer.OnRead(std::move(block));
+                    });
+    ReportResult("erase-from-front", legacy_time, stream.size(),
+                 legacy_framer.num_messages());
+
+    if (client.num_messages() != num_messages ||
+        legacy_framer.num_messages() != num_messages) {
+      std::cerr << "Expected " << num_messages << " messages, but CastSocket "
+                << "framed " << client.num_messages() << " and the legacy "
+                << "framer " << legacy_framer.num_messages() << ".\n";
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
+
+int main(int argc, char* argv[]) {
+  return openscreen::cast::RunCastSocketFramingBenchmark(argc, argv);
+}
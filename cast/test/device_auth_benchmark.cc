@@ -0,0 +1,270 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how a receiver copes with a burst of auth challenges, such as when
+// every sender reconnects at once after a network blip. The challenges are
+// answered by a DeviceAuthNamespaceHandler that either signs each reply on the
+// TaskRunner thread, or hands the signing to a SigningPool. For each, this
+// reports:
+//
+//   - The time from the burst's arrival until every reply has been sent, and
+//     the resulting throughput.
+//   - The longest that a periodic task, standing in for the packet I/O and
+//     RTCP reports of a streaming session, was delayed past its scheduled time.
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cast/common/channel/message_util.h"
+#include "cast/common/channel/proto/cast_channel.pb.h"
+#include "cast/common/channel/virtual_connection_router.h"
+#include "cast/common/public/cast_socket.h"
+#include "cast/receiver/channel/device_auth_namespace_handler.h"
+#include "cast/receiver/channel/signing_pool.h"
+#include "cast/receiver/channel/static_credentials.h"
+#include "platform/api/tls_connection.h"
+#include "platform/base/ip_address.h"
+#include "platform/impl/logging.h"
+#include "platform/impl/task_runner.h"
+#include "util/chrono_helpers.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using ::cast::channel::AuthChallenge;
+using ::cast::channel::CastMessage;
+using ::cast::channel::DeviceAuthMessage;
+
+// The numbers of SigningPool threads to benchmark. Zero means that the replies
+// are signed on the TaskRunner thread.
+constexpr int kThreadCounts[] = {0, 1, 2, 4};
+
+// The period of the task standing in for a streaming session.
+constexpr Clock::duration kStreamingTaskPeriod = std::chrono::milliseconds(1);
+
+// Discards the replies sent to a sender, calling |on_send| for each.
+class ReplySink final : public TlsConnection {
+ public:
+  explicit ReplySink(std::function<void()>* on_send) : on_send_(on_send) {}
+  ~ReplySink() final = default;
+
+  // TlsConnection overrides.
+  void SetClient(Client* client) final {}
+  bool Send(const void* data, size_t len) final {
+    (*on_send_)();
+    return true;
+  }
+  IPEndpoint GetLocalEndpoint() const final { return {}; }
+  IPEndpoint GetRemoteEndpoint() const final { return {}; }
+
+ private:
+  std::function<void()>* const on_send_;
+};
+
+class NullSocketErrorHandler final
+    : public VirtualConnectionRouter::SocketErrorHandler {
+ public:
+  // VirtualConnectionRouter::SocketErrorHandler overrides.
+  void OnClose(CastSocket* socket) final {}
+  void OnError(CastSocket* socket, Error error) final {}
+};
+
+CastMessage MakeAuthChallenge(std::mt19937* random_engine) {
+  std::string sender_nonce(16, 0);
+  for (char& c : sender_nonce) {
+    c = static_cast<char>((*random_engine)());
+  }
+  DeviceAuthMessage auth_message;
+  AuthChallenge* challenge = auth_message.mutable_challenge();
+  challenge->set_sender_nonce(std::move(sender_nonce));
+  challenge->set_hash_algorithm(::cast::channel::SHA256);
+
+  CastMessage message;
+  message.set_protocol_version(
+      ::cast::channel::CastMessage_ProtocolVersion_CASTV2_1_0);
+  message.set_source_id(kPlatformSenderId);
+  message.set_destination_id(kPlatformReceiverId);
+  message.set_namespace_(kAuthNamespace);
+  message.set_payload_type(::cast::channel::CastMessage_PayloadType_BINARY);
+  auth_message.SerializeToString(message.mutable_payload_binary());
+  return message;
+}
+
+struct BurstResult {
+  Clock::duration burst_time{};
+  Clock::duration max_streaming_delay{};
+  int num_rejected = 0;
+};
+
+// Delivers one challenge from each of |num_senders| senders at once, and runs
+// a TaskRunner until all of them have been answered.
+BurstResult RunBurst(StaticCredentialsProvider* credentials,
+                     int num_senders,
+                     int num_threads) {
+  TaskRunnerImpl task_runner(&Clock::now);
+  std::unique_ptr<SigningPool> signing_pool;
+  if (num_threads > 0) {
+    signing_pool = std::make_unique<SigningPool>(&task_runner, num_threads);
+  }
+
+  BurstResult result;
+  Clock::time_point burst_start;
+  int num_replies = 0;
+  std::function<void()> on_reply = [&] {
+    if (++num_replies == num_senders) {
+      result.burst_time = Clock::now() - burst_start;
+    }
+  };
+
+  NullSocketErrorHandler error_handler;
+  VirtualConnectionRouter router;
+  DeviceAuthNamespaceHandler auth_handler(credentials, signing_pool.get());
+  std::vector<CastSocket*> sockets;
+  std::vector<CastMessage> challenges;
+  std::mt19937 random_engine(num_senders);
+  for (int i = 0; i < num_senders; ++i) {
+    auto socket = std::make_unique<CastSocket>(
+        std::make_unique<ReplySink>(&on_reply), &router);
+    sockets.push_back(socket.get());
+    router.TakeSocket(&error_handler, std::move(socket));
+    challenges.push_back(MakeAuthChallenge(&random_engine));
+  }
+
+  // Runs every kStreamingTaskPeriod, noting how late it runs, until every
+  // challenge has been answered.
+  std::function<void(Clock::time_point)> run_streaming_task =
+      [&](Clock::time_point scheduled_time) {
+        const Clock::time_point now = Clock::now();
+        result.max_streaming_delay =
+            std::max(result.max_streaming_delay, now - scheduled_time);
+        if (num_replies == num_senders) {
+          task_runner.RequestStopSoon();
+          return;
+        }
+        task_runner.PostTaskWithDelay(
+            [&run_streaming_task, now] {
+              run_streaming_task(now + kStreamingTaskPeriod);
+            },
+            kStreamingTaskPeriod);
+      };
+
+  task_runner.PostTask([&] {
+    burst_start = Clock::now();
+    run_streaming_task(burst_start);
+    for (int i = 0; i < num_senders; ++i) {
+      auth_handler.OnMessage(&router, sockets[i], std::move(challenges[i]));
+    }
+  });
+  task_runner.RunUntilStopped();
+
+  if (signing_pool) {
+    result.num_rejected = signing_pool->GetStats().num_jobs_rejected;
+  }
+  return result;
+}
+
+void LogUsage(const char* argv0) {
+  std::cerr << "usage: " << argv0 << R"( <options>
+
+options:
+    -n, --senders=N: The number of senders whose challenges arrive at once.
+                     Default: 200.
+
+    -r, --repetitions=N: The number of bursts for each configuration, of which
+                         the fastest is reported. Default: 5.
+
+    -h, --help: Show this help message.
+)";
+}
+
+int RunDeviceAuthBenchmark(int argc, char* argv[]) {
+  const struct option kArgumentOptions[] = {
+      {"senders", required_argument, nullptr, 'n'},
+      {"repetitions", required_argument, nullptr, 'r'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+
+  int num_senders = 200;
+  int repetitions = 5;
+  int ch = -1;
+  while ((ch = getopt_long(argc, argv, "n:r:h", kArgumentOptions, nullptr)) !=
+         -1) {
+    switch (ch) {
+      case 'n':
+        num_senders = atoi(optarg);
+        break;
+      case 'r':
+        repetitions = atoi(optarg);
+        break;
+      case 'h':
+      default:
+        LogUsage(argv[0]);
+        return 1;
+    }
+  }
+  if (num_senders <= 0 || repetitions <= 0) {
+    LogUsage(argv[0]);
+    return 1;
+  }
+
+  SetLogLevel(LogLevel::kWarning);
+  ErrorOr<GeneratedCredentials> credentials =
+      GenerateCredentialsForTesting("device-auth-benchmark");
+  if (!credentials) {
+    std::cerr << "Failed to generate credentials: " << credentials.error()
+              << "\n";
+    return 1;
+  }
+
+  std::cout << num_senders << " simultaneous auth challenges:\n"
+            << std::setw(16) << "signing on" << std::setw(14) << "burst (ms)"
+            << std::setw(18) << "replies/second" << std::setw(24)
+            << "max streaming delay (ms)" << "\n";
+  std::cout << std::fixed << std::setprecision(1);
+  StaticCredentialsProvider* const provider =
+      credentials.value().provider.get();
+  for (int num_threads : kThreadCounts) {
+    BurstResult fastest;
+    for (int i = 0; i < repetitions; ++i) {
+      const BurstResult result = RunBurst(provider, num_senders, num_threads);
+      if (i == 0 || result.burst_time < fastest.burst_time) {
+        fastest = result;
+      }
+    }
+    if (fastest.num_rejected > 0) {
+      std::cerr << fastest.num_rejected << " challenges were rejected.\n";
+    }
+
+    const double burst_ms = to_microseconds(fastest.burst_time).count() / 1e3;
+    std::cout << std::setw(16)
+              << (num_threads == 0 ? std::string("task runner")
+                                   : std::to_string(num_threads) + " threads")
+              << std::setw(14) << burst_ms << std::setw(18)
+              << num_senders / (burst_ms / 1e3) << std::setw(24)
+              << to_microseconds(fastest.max_streaming_delay).count() / 1e3
+              << "\n";
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
+
+int main(int argc, char* argv[]) {
+  return openscreen::cast::RunDeviceAuthBenchmark(argc, argv);
+}
@@ -0,0 +1,436 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Streams synthetic frames from a Sender to a Receiver in the same process,
+// over loopback UDP, through sockets that simulate an impaired network link.
+// Reports sustained bitrate, frame latency percentiles, the re-transmit ratio,
+// and CPU time per frame. No codecs are involved, so this measures only the
+// cost and behavior of the Cast Streaming stack itself.
+
+#include <getopt.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/environment.h"
+#include "cast/streaming/frame_id.h"
+#include "cast/streaming/receiver.h"
+#include "cast/streaming/receiver_packet_router.h"
+#include "cast/streaming/rtp_defines.h"
+#include "cast/streaming/rtp_time.h"
+#include "cast/streaming/sender.h"
+#include "cast/streaming/sender_packet_router.h"
+#include "cast/streaming/session_config.h"
+#include "cast/streaming/statistics.h"
+#include "platform/api/time.h"
+#include "platform/base/ip_address.h"
+#include "platform/impl/logging.h"
+#include "platform/impl/platform_client_posix.h"
+#include "platform/impl/task_runner.h"
+#include "platform/test/impaired_udp_socket.h"
+#include "util/alarm.h"
+#include "util/chrono_helpers.h"
+#include "util/crypto/random_bytes.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+struct BenchmarkParams {
+  seconds duration{10};
+  int bitrate = 5000000;  // Bits per second.
+  int frame_rate = 30;
+  milliseconds target_playout_delay{400};
+
+  // Applied to the packets sent in each direction.
+  ImpairedUdpSocket::Impairments impairments;
+};
+
+constexpr Ssrc kSenderSsrc = 1;
+constexpr Ssrc kReceiverSsrc = 2;
+constexpr int kRtpTimebase = 90000;
+
+// A key frame is sent at least this often, and whenever the Receiver requests
+// one.
+constexpr seconds kKeyFrameInterval{10};
+
+// How long to keep running after the last frame is enqueued, so that in-flight
+// frames can be re-transmitted and consumed.
+constexpr seconds kDrainTime{2};
+
+// The frame latency histogram range, and its bucket width.
+constexpr int64_t kMaxLatencyMs = 2000;
+constexpr int kLatencyBucketMs = 5;
+
+// Returns the CPU time consumed by the calling thread, or by the whole process.
+// All of the Cast Streaming work happens on the TaskRunner's thread, while the
+// process also includes the platform's network polling thread.
+Clock::duration GetCpuTime(clockid_t clock_id) {
+  struct timespec ts {};
+  clock_gettime(clock_id, &ts);
+  return Clock::to_duration(seconds(ts.tv_sec) + nanoseconds(ts.tv_nsec));
+}
+
+// Owns the Sender and Receiver, each with its own Environment and socket,
+// produces the synthetic frames, and gathers the measurements.
+class LoopbackBenchmark final : public Receiver::Consumer {
+ public:
+  LoopbackBenchmark(TaskRunnerImpl* task_runner, const BenchmarkParams& params)
+      : task_runner_(task_runner),
+        params_(params),
+        frame_alarm_(&Clock::now, task_runner),
+        stop_alarm_(&Clock::now, task_runner),
+        latency_ms_(0, kMaxLatencyMs, kMaxLatencyMs / kLatencyBucketMs) {}
+
+  ~LoopbackBenchmark() final = default;
+
+  // Creates the Sender and Receiver, and starts streaming. Once finished, the
+  // results are reported and the TaskRunner is stopped.
+  void Start() {
+    ImpairedUdpSocket::Impairments receiver_impairments = params_.impairments;
+    ++receiver_impairments.random_seed;
+    sender_environment_ = CreateEnvironment(params_.impairments);
+    receiver_environment_ = CreateEnvironment(receiver_impairments);
+    OSP_CHECK_NE(sender_environment_->GetBoundLocalEndpoint().port, 0);
+    OSP_CHECK_NE(receiver_environment_->GetBoundLocalEndpoint().port, 0);
+    sender_environment_->set_remote_endpoint(
+        receiver_environment_->GetBoundLocalEndpoint());
+    receiver_environment_->set_remote_endpoint(
+        sender_environment_->GetBoundLocalEndpoint());
+
+    SessionConfig config(kSenderSsrc, kReceiverSsrc, kRtpTimebase,
+                         1 /* channels */, params_.target_playout_delay,
+                         GenerateRandomBytes16(), GenerateRandomBytes16(),
+                         true /* is_pli_enabled */);
+    config.max_unacked_frames = ComputeMaxUnackedFrames(
+        params_.frame_rate, params_.target_playout_delay);
+    sender_packet_router_ =
+        std::make_unique<SenderPacketRouter>(sender_environment_.get());
+    sender_ = std::make_unique<Sender>(sender_environment_.get(),
+                                       sender_packet_router_.get(), config,
+                                       RtpPayloadType::kVideoVp8);
+    receiver_packet_router_ =
+        std::make_unique<ReceiverPacketRouter>(receiver_environment_.get());
+    receiver_ = std::make_unique<Receiver>(receiver_environment_.get(),
+                                           receiver_packet_router_.get(),
+                                           std::move(config));
+    receiver_->SetConsumer(this);
+
+    frame_payload_.resize(
+        std::max(1, params_.bitrate / 8 / params_.frame_rate));
+    for (size_t i = 0; i < frame_payload_.size(); ++i) {
+      frame_payload_[i] = static_cast<uint8_t>(i);
+    }
+
+    start_time_ = Clock::now();
+    start_thread_cpu_time_ = GetCpuTime(CLOCK_THREAD_CPUTIME_ID);
+    start_process_cpu_time_ = GetCpuTime(CLOCK_PROCESS_CPUTIME_ID);
+    SendNextFrame();
+  }
+
+  // Receiver::Consumer implementation.
+  void OnFramesReady(int next_frame_buffer_size) final {
+    while (next_frame_buffer_size > 0) {
+      consume_buffer_.resize(next_frame_buffer_size);
+      const EncodedFrame frame =
+          receiver_->ConsumeNextFrame(absl::Span<uint8_t>(consume_buffer_));
+      const Clock::time_point now = Clock::now();
+      const auto it = enqueue_times_.find(frame.frame_id);
+      if (it != enqueue_times_.end()) {
+        latency_ms_.Add(to_milliseconds(now - it->second).count());
+        // Frames before this one were skipped, and will not be consumed.
+        enqueue_times_.erase(enqueue_times_.begin(), std::next(it));
+      }
+      ++num_frames_consumed_;
+      num_bytes_consumed_ += frame.data.size();
+      next_frame_buffer_size = receiver_->AdvanceToNextFrame();
+    }
+  }
+
+ private:
+  std::unique_ptr<Environment> CreateEnvironment(
+      const ImpairedUdpSocket::Impairments& impairments) {
+    return std::make_unique<Environment>(
+        &Clock::now, task_runner_, IPEndpoint{IPAddress(127, 0, 0, 1), 0},
+        [impairments](TaskRunner* task_runner, UdpSocket::Client* client,
+                      const IPEndpoint& local_endpoint) {
+          return ImpairedUdpSocket::Create(task_runner, &Clock::now, client,
+                                           local_endpoint, impairments);
+        });
+  }
+
+  void SendNextFrame() {
+    const Clock::time_point now = Clock::now();
+    if (now - start_time_ >= params_.duration) {
+      end_time_ = now;
+      end_thread_cpu_time_ = GetCpuTime(CLOCK_THREAD_CPUTIME_ID);
+      end_process_cpu_time_ = GetCpuTime(CLOCK_PROCESS_CPUTIME_ID);
+      stop_alarm_.ScheduleFromNow([this] { FinishAndReport(); }, kDrainTime);
+      return;
+    }
+
+    EncodedFrame frame;
+    frame.frame_id = sender_->GetNextFrameId();
+    const bool is_key_frame =
+        frame.frame_id == FrameId::first() || sender_->NeedsKeyFrame() ||
+        now - last_key_frame_time_ >= kKeyFrameInterval;
+    if (is_key_frame) {
+      frame.dependency = EncodedFrame::KEY_FRAME;
+      frame.referenced_frame_id = frame.frame_id;
+    } else {
+      frame.dependency = EncodedFrame::DEPENDS_ON_ANOTHER;
+      frame.referenced_frame_id = frame.frame_id - 1;
+    }
+    frame.rtp_timestamp = RtpTimeTicks::FromTimeSinceOrigin(
+        now - start_time_, kRtpTimebase);
+    frame.reference_time = now;
+    frame.data = absl::Span<uint8_t>(frame_payload_);
+
+    if (sender_->EnqueueFrame(frame) == Sender::OK) {
+      enqueue_times_[frame.frame_id] = now;
+      if (is_key_frame) {
+        last_key_frame_time_ = now;
+      }
+    } else {
+      ++num_frames_skipped_;
+    }
+
+    ++num_frames_produced_;
+    const Clock::time_point next_frame_time =
+        start_time_ + Clock::to_duration(num_frames_produced_ * seconds(1) /
+                                         params_.frame_rate);
+    frame_alarm_.Schedule([this] { SendNextFrame(); }, next_frame_time);
+  }
+
+  void FinishAndReport() {
+    const SenderStats sender_stats = sender_->GetStats();
+    const ReceiverStats receiver_stats = receiver_->GetStats();
+    const double elapsed_seconds =
+        std::chrono::duration<double>(end_time_ - start_time_).count();
+    const int num_frames = std::max(1, num_frames_produced_);
+    const double thread_cpu_us_per_frame =
+        static_cast<double>(
+            to_microseconds(end_thread_cpu_time_ - start_thread_cpu_time_)
+                .count()) /
+        num_frames;
+    const double process_cpu_us_per_frame =
+        static_cast<double>(
+            to_microseconds(end_process_cpu_time_ - start_process_cpu_time_)
+                .count()) /
+        num_frames;
+
+    const double retransmit_ratio =
+        sender_stats.num_packets_sent > 0
+            ? static_cast<double>(sender_stats.num_packets_retransmitted) /
+                  sender_stats.num_packets_sent
+            : 0.0;
+    const FixedBucketHistogram& completion_ms =
+        receiver_stats.frame_completion_latency_ms;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "frames produced:              " << num_frames_produced_
+              << "\nframes skipped by Sender:     " << num_frames_skipped_
+              << "\nframes consumed:              " << num_frames_consumed_
+              << "\nframes dropped late:          "
+              << receiver_stats.num_frames_dropped_late
+              << "\nsustained bitrate (kbps):     "
+              << (num_bytes_consumed_ * 8 / elapsed_seconds / 1000)
+              << "\nenqueue-to-consume ms p50:    "
+              << latency_ms_.GetApproximatePercentile(0.5)
+              << "\nenqueue-to-consume ms p90:    "
+              << latency_ms_.GetApproximatePercentile(0.9)
+              << "\nenqueue-to-consume ms p99:    "
+              << latency_ms_.GetApproximatePercentile(0.99)
+              << "\nframe completion ms p50:      "
+              << completion_ms.GetApproximatePercentile(0.5)
+              << "\nframe completion ms p90:      "
+              << completion_ms.GetApproximatePercentile(0.9)
+              << "\nframe completion ms p99:      "
+              << completion_ms.GetApproximatePercentile(0.99)
+              << "\npackets sent:                 "
+              << sender_stats.num_packets_sent
+              << "\nretransmit ratio:             " << retransmit_ratio
+              << "\nround trip time (ms):         "
+              << to_milliseconds(sender_stats.round_trip_time).count()
+              << "\nstreaming CPU per frame (us): " << thread_cpu_us_per_frame
+              << "\nprocess CPU per frame (us):   " << process_cpu_us_per_frame
+              << std::endl;
+
+    receiver_->SetConsumer(nullptr);
+    receiver_.reset();
+    receiver_packet_router_.reset();
+    sender_.reset();
+    sender_packet_router_.reset();
+    receiver_environment_.reset();
+    sender_environment_.reset();
+    task_runner_->RequestStopSoon();
+  }
+
+  TaskRunnerImpl* const task_runner_;
+  const BenchmarkParams params_;
+
+  std::unique_ptr<Environment> sender_environment_;
+  std::unique_ptr<Environment> receiver_environment_;
+  std::unique_ptr<SenderPacketRouter> sender_packet_router_;
+  std::unique_ptr<ReceiverPacketRouter> receiver_packet_router_;
+  std::unique_ptr<Sender> sender_;
+  std::unique_ptr<Receiver> receiver_;
+
+  Alarm frame_alarm_;
+  Alarm stop_alarm_;
+  std::vector<uint8_t> frame_payload_;
+  std::vector<uint8_t> consume_buffer_;
+
+  Clock::time_point start_time_;
+  Clock::time_point end_time_;
+  Clock::time_point last_key_frame_time_;
+  Clock::duration start_thread_cpu_time_{};
+  Clock::duration end_thread_cpu_time_{};
+  Clock::duration start_process_cpu_time_{};
+  Clock::duration end_process_cpu_time_{};
+
+  int num_frames_produced_ = 0;
+  int num_frames_skipped_ = 0;
+  int num_frames_consumed_ = 0;
+  int64_t num_bytes_consumed_ = 0;
+
+  // When each in-flight frame was enqueued, until it is consumed.
+  std::map<FrameId, Clock::time_point> enqueue_times_;
+  FixedBucketHistogram latency_ms_;
+};
+
+void LogUsage(const char* argv0) {
+  std::cerr << "usage: " << argv0 << R"( <options>
+
+options:
+    -t, --duration=seconds: How long to stream for. Default: 10.
+
+    -b, --bitrate=kbps: The bitrate of the synthetic video stream.
+                        Default: 5000.
+
+    -f, --frame-rate=fps: The frame rate of the stream. Default: 30.
+
+    -p, --playout-delay=ms: The target playout delay. Default: 400.
+
+    -l, --loss=percent: Packets dropped at random. Default: 0.
+
+    -d, --delay=ms: One-way network delay. Default: 0.
+
+    -j, --jitter=ms: Maximum random delay added to each packet. Default: 0.
+
+    -r, --reorder=percent: Packets held back to be reordered. Default: 0.
+
+    -w, --bandwidth=kbps: Link capacity in each direction, or 0 for
+                          unlimited. Default: 0.
+
+    -s, --seed=number: Seeds the simulated impairments. Default: 1.
+
+    -v, --verbose: Enable verbose logging.
+
+    -h, --help: Show this help message.
+)";
+}
+
+int RunStreamingLoopbackBenchmark(int argc, char* argv[]) {
+  const struct option kArgumentOptions[] = {
+      {"duration", required_argument, nullptr, 't'},
+      {"bitrate", required_argument, nullptr, 'b'},
+      {"frame-rate", required_argument, nullptr, 'f'},
+      {"playout-delay", required_argument, nullptr, 'p'},
+      {"loss", required_argument, nullptr, 'l'},
+      {"delay", required_argument, nullptr, 'd'},
+      {"jitter", required_argument, nullptr, 'j'},
+      {"reorder", required_argument, nullptr, 'r'},
+      {"bandwidth", required_argument, nullptr, 'w'},
+      {"seed", required_argument, nullptr, 's'},
+      {"verbose", no_argument, nullptr, 'v'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+
+  BenchmarkParams params;
+  bool is_verbose = false;
+  int ch = -1;
+  while ((ch = getopt_long(argc, argv, "t:b:f:p:l:d:j:r:w:s:vh",
+                           kArgumentOptions, nullptr)) != -1) {
+    switch (ch) {
+      case 't':
+        params.duration = seconds(atoi(optarg));
+        break;
+      case 'b':
+        params.bitrate = atoi(optarg) * 1000;
+        break;
+      case 'f':
+        params.frame_rate = atoi(optarg);
+        break;
+      case 'p':
+        params.target_playout_delay = milliseconds(atoi(optarg));
+        break;
+      case 'l':
+        params.impairments.loss_rate = atof(optarg) / 100;
+        break;
+      case 'd':
+        params.impairments.delay = milliseconds(atoi(optarg));
+        break;
+      case 'j':
+        params.impairments.jitter = milliseconds(atoi(optarg));
+        break;
+      case 'r':
+        params.impairments.reorder_rate = atof(optarg) / 100;
+        break;
+      case 'w':
+        params.impairments.bandwidth_cap = int64_t{atoi(optarg)} * 1000;
+        break;
+      case 's':
+        params.impairments.random_seed = atoi(optarg);
+        break;
+      case 'v':
+        is_verbose = true;
+        break;
+      case 'h':
+      default:
+        LogUsage(argv[0]);
+        return 1;
+    }
+  }
+  if (params.duration <= seconds(0) || params.bitrate <= 0 ||
+      params.frame_rate <= 0 ||
+      params.target_playout_delay <= milliseconds(0) ||
+      params.impairments.loss_rate < 0.0 ||
+      params.impairments.loss_rate > 1.0 ||
+      params.impairments.reorder_rate < 0.0 ||
+      params.impairments.reorder_rate > 1.0 ||
+      params.impairments.bandwidth_cap < 0) {
+    LogUsage(argv[0]);
+    return 1;
+  }
+
+  SetLogLevel(is_verbose ? LogLevel::kVerbose : LogLevel::kWarning);
+
+  auto* const task_runner = new TaskRunnerImpl(&Clock::now);
+  PlatformClientPosix::Create(milliseconds(50),
+                              std::unique_ptr<TaskRunnerImpl>(task_runner));
+  {
+    LoopbackBenchmark benchmark(task_runner, params);
+    task_runner->PostTask([&benchmark] { benchmark.Start(); });
+    task_runner->RunUntilStopped();
+  }
+  PlatformClientPosix::ShutDown();
+  return 0;
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
+
+int main(int argc, char* argv[]) {
+  return openscreen::cast::RunStreamingLoopbackBenchmark(argc, argv);
+}
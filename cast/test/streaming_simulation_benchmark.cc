@@ -0,0 +1,142 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Replays long streaming sessions in virtual time, using StreamingSimulation,
+// over links whose capacity steps down and back up. Reports the metrics of:
+//
+//   - A five minute session whose encoder bitrate follows the fixed policy (a
+//     fraction of the Sender's bandwidth estimate), which exercises the
+//     pacing, bandwidth estimation, and NACK logic together.
+//   - A two minute session whose content needs more than the link can carry
+//     for a while, streamed with both the fixed policy and a
+//     BitrateController, for comparison.
+//
+// These take too long to run as unit tests. Shorter versions are covered by
+// streaming_simulation_unittest.cc and bitrate_controller_unittest.cc.
+
+#include <getopt.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#include "cast/streaming/bitrate_controller.h"
+#include "cast/streaming/testing/streaming_simulation.h"
+#include "platform/impl/logging.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::minutes;
+using std::chrono::seconds;
+
+StreamingSimulation::Params MakeParams(Clock::duration duration) {
+  StreamingSimulation::Params params;
+  params.duration = duration;
+  params.forward_link.propagation_delay = milliseconds(20);
+  params.reverse_link.propagation_delay = milliseconds(20);
+  return params;
+}
+
+void ReportResults(const char* name,
+                   const StreamingSimulation::Results& results) {
+  std::cout << name << ":\n"
+            << "  frames encoded/dropped/rejected/consumed: "
+            << results.num_frames_encoded << '/' << results.num_frames_dropped
+            << '/' << results.num_frames_rejected << '/'
+            << results.num_frames_consumed << '\n'
+            << "  consumed bitrate: " << (results.consumed_bitrate / 1000)
+            << " kbps\n"
+            << "  frame latency p50/p95: "
+            << results.frame_latency_ms.GetApproximatePercentile(0.5) << '/'
+            << results.frame_latency_ms.GetApproximatePercentile(0.95)
+            << " ms\n"
+            << "  mean bandwidth estimate error: " << std::fixed
+            << std::setprecision(1) << (results.mean_estimate_error * 100)
+            << "%\n"
+            << "  packets sent/retransmitted: "
+            << results.sender_stats.num_packets_sent << '/'
+            << results.sender_stats.num_packets_retransmitted << '\n'
+            << "  forward packets dropped: "
+            << results.num_forward_packets_dropped << '\n'
+            << "  max resolution step: " << results.max_resolution_step
+            << '\n';
+}
+
+void RunCapacityTraceReplay() {
+  StreamingSimulation::Params params = MakeParams(minutes(5));
+  params.forward_link.capacity_trace = {{minutes(0), 8000000},
+                                        {minutes(2), 1500000},
+                                        {minutes(3), 8000000}};
+  ReportResults("5 minutes, 8 -> 1.5 -> 8 Mbps, fixed policy",
+                StreamingSimulation(params).Run());
+}
+
+void RunBitrateControllerComparison() {
+  constexpr int kMinBitrate = 500000;
+  constexpr int kMaxBitrate = 8000000;
+
+  StreamingSimulation::Params params = MakeParams(minutes(2));
+  params.forward_link.capacity_trace = {
+      {seconds(0), 6000000}, {seconds(40), 1000000}, {seconds(80), 6000000}};
+  params.min_bitrate = kMinBitrate;
+  params.max_bitrate = kMaxBitrate;
+  ReportResults("2 minutes, 6 -> 1 -> 6 Mbps, fixed policy",
+                StreamingSimulation(params).Run());
+
+  BitrateController::Params controller_params;
+  controller_params.min_bitrate = kMinBitrate;
+  controller_params.max_bitrate = kMaxBitrate;
+  params.bitrate_controller = controller_params;
+  ReportResults("2 minutes, 6 -> 1 -> 6 Mbps, BitrateController",
+                StreamingSimulation(params).Run());
+}
+
+void LogUsage(const char* argv0) {
+  std::cerr << "usage: " << argv0 << R"( <options>
+
+options:
+    -v, --verbose: Enable verbose logging.
+
+    -h, --help: Show this help message.
+)";
+}
+
+int RunStreamingSimulationBenchmark(int argc, char* argv[]) {
+  const struct option kArgumentOptions[] = {
+      {"verbose", no_argument, nullptr, 'v'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+
+  bool is_verbose = false;
+  int ch = -1;
+  while ((ch = getopt_long(argc, argv, "vh", kArgumentOptions, nullptr)) !=
+         -1) {
+    switch (ch) {
+      case 'v':
+        is_verbose = true;
+        break;
+      case 'h':
+      default:
+        LogUsage(argv[0]);
+        return 1;
+    }
+  }
+
+  SetLogLevel(is_verbose ? LogLevel::kVerbose : LogLevel::kWarning);
+
+  RunCapacityTraceReplay();
+  RunBitrateControllerComparison();
+  return 0;
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
+
+int main(int argc, char* argv[]) {
+  return openscreen::cast::RunStreamingSimulationBenchmark(argc, argv);
+}
@@ -0,0 +1,486 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how the costs of a receiver's VirtualConnectionRouter scale with the
+// number of virtual connections, for:
+//
+//   - Dispatching a received CastMessage through the VirtualConnectionRouter
+//     and a NamespaceRouter to its handler.
+//   - Removing all of the connections to an app that is stopping.
+//   - Broadcasting a message from an app to all senders.
+//
+// Each simulated sender has one virtual connection to the platform receiver
+// and one to an app. The senders either each have their own CastSocket, or
+// are all multiplexed over one CastSocket (e.g., tabs in one browser). For
+// comparison, the same operations are also done by the previous approach,
+// which looked up each string in std::maps keyed by strings, scanned every
+// socket to remove a local ID's connections, and serialized a broadcast message
+// once per socket.
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cast/common/channel/cast_message_handler.h"
+#include "cast/common/channel/message_util.h"
+#include "cast/common/channel/namespace_router.h"
+#include "cast/common/channel/proto/cast_channel.pb.h"
+#include "cast/common/channel/virtual_connection_router.h"
+#include "cast/common/public/cast_socket.h"
+#include "platform/api/tls_connection.h"
+#include "platform/base/ip_address.h"
+#include "platform/impl/logging.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using ::cast::channel::CastMessage;
+
+// The numbers of virtual connections to benchmark, two per sender.
+constexpr int kConnectionCounts[] = {100, 1000, 10000};
+
+// The number of apps the senders are connected to.
+constexpr int kNumApps = 4;
+
+// The number of distinct messages generated for each connection count, which
+// are dispatched in each pass. This is small enough that the copies of the
+// messages dispatched in a pass are still cached, as a freshly-parsed message
+// would be.
+constexpr int kNumDistinctMessages = 1 << 10;
+
+// The numbers of app stops and broadcasts in each pass.
+constexpr int kNumRemovals = 256;
+constexpr int kNumBroadcasts = 4;
+
+// The namespaces handled by each endpoint. The messages sent to the platform
+// receiver use the first, and those sent to apps use the last.
+constexpr const char* kNamespaces[] = {kReceiverNamespace, kHeartbeatNamespace,
+                                       kBroadcastNamespace, kMediaNamespace};
+
+// The local ID of an app that is repeatedly connected to, and then stopped.
+constexpr char kTransientAppId[] = "0F5096E8-transient";
+
+class NullTlsConnection final : public TlsConnection {
+ public:
+  NullTlsConnection() = default;
+  ~NullTlsConnection() final = default;
+
+  // TlsConnection overrides.
+  void SetClient(Client* client) final {}
+  bool Send(const void* data, size_t len) final { return true; }
+  IPEndpoint GetLocalEndpoint() const final { return {}; }
+  IPEndpoint GetRemoteEndpoint() const final { return {}; }
+};
+
+class NullSocketErrorHandler final
+    : public VirtualConnectionRouter::SocketErrorHandler {
+ public:
+  // VirtualConnectionRouter::SocketErrorHandler overrides.
+  void OnClose(CastSocket* socket) final {}
+  void OnError(CastSocket* socket, Error error) final {}
+};
+
+class CountingHandler final : public CastMessageHandler {
+ public:
+  CountingHandler() = default;
+  ~CountingHandler() final = default;
+
+  int num_messages() const { return num_messages_; }
+
+  // CastMessageHandler overrides.
+  void OnMessage(VirtualConnectionRouter* router,
+                 CastSocket* socket,
+                 CastMessage message) final {
+    ++num_messages_;
+  }
+
+ private:
+  int num_messages_ = 0;
+};
+
+// The routing done by NamespaceRouter::OnMessage() before the received payload
+// was passed along to the handlers.
+class StringKeyedNamespaceRouter final : public CastMessageHandler {
+ public:
+  void AddNamespaceHandler(std::string namespace_,
+                           CastMessageHandler* handler) {
+    handlers_.emplace(std::move(namespace_), handler);
+  }
+
+  // CastMessageHandler overrides.
+  void OnMessage(VirtualConnectionRouter* router,
+                 CastSocket* socket,
+                 CastMessage message) final {
+    const auto it = handlers_.find(message.namespace_());
+    if (it != handlers_.end()) {
+      it->second->OnMessage(router, socket, std::move(message));
+    }
+  }
+
+ private:
+  std::map<std::string, CastMessageHandler*> handlers_;
+};
+
+// The VirtualConnectionRouter before its connections were indexed.
+class StringKeyedRouter {
+ public:
+  void TakeSocket(CastSocket* socket) {
+    sockets_.emplace(socket->socket_id(), socket);
+  }
+
+  void AddConnection(VirtualConnection virtual_connection) {
+    connections_[virtual_connection.socket_id].emplace(
+        std::move(virtual_connection.local_id),
+        std::move(virtual_connection.peer_id));
+  }
+
+  void RemoveConnectionsByLocalId(const std::string& local_id) {
+    for (auto socket_entry = connections_.begin();
+         socket_entry != connections_.end();) {
+      socket_entry->second.erase(local_id);
+      if (socket_entry->second.empty()) {
+        socket_entry = connections_.erase(socket_entry);
+      } else {
+        ++socket_entry;
+      }
+    }
+  }
+
+  void AddHandlerForLocalId(std::string local_id, CastMessageHandler* handler) {
+    endpoints_.emplace(std::move(local_id), handler);
+  }
+
+  Error BroadcastFromLocalPeer(std::string local_id, CastMessage message) {
+    message.set_source_id(std::move(local_id));
+    message.set_destination_id(kBroadcastId);
+    for (const auto& entry : endpoints_) {
+      if (entry.first != message.source_id()) {
+        entry.second->OnMessage(nullptr, nullptr, message);
+      }
+    }
+    Error error;
+    for (const auto& entry : sockets_) {
+      Error result = entry.second->Send(message);
+      if (!result.ok() && error.ok()) {
+        error = std::move(result);
+      }
+    }
+    return error;
+  }
+
+  void OnMessage(CastSocket* socket, CastMessage message) {
+    const std::string& local_id = message.destination_id();
+    if (local_id == kBroadcastId ||
+        message.namespace_() == kConnectionNamespace) {
+      return;
+    }
+    if (!IsTransportNamespace(message.namespace_()) &&
+        !HasConnection(socket->socket_id(), local_id, message.source_id())) {
+      return;
+    }
+    const auto it = endpoints_.find(local_id);
+    if (it != endpoints_.end()) {
+      it->second->OnMessage(nullptr, socket, std::move(message));
+    }
+  }
+
+ private:
+  bool HasConnection(int socket_id,
+                     const std::string& local_id,
+                     const std::string& peer_id) const {
+    const auto socket_entry = connections_.find(socket_id);
+    if (socket_entry == connections_.end()) {
+      return false;
+    }
+    const auto local_entries = socket_entry->second.equal_range(local_id);
+    for (auto it = local_entries.first; it != local_entries.second; ++it) {
+      if (it->second == peer_id) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::map<int, CastSocket*> sockets_;
+  std::map<int, std::multimap<std::string, std::string>> connections_;
+  std::map<std::string, CastMessageHandler*> endpoints_;
+};
+
+std::string GetAppId(int i) {
+  return "E8C28D3C-8A1F-4E2B-9D4F-" + std::to_string(100000000000 + i);
+}
+
+// The local endpoints of a receiver, each dispatching messages by namespace to
+// a CountingHandler.
+template <typename Router, typename EndpointRouter>
+class Endpoints {
+ public:
+  explicit Endpoints(Router* router) : router_(router) {
+    Add(kPlatformReceiverId);
+    for (int i = 0; i < kNumApps; ++i) {
+      Add(GetAppId(i));
+    }
+  }
+
+  int num_messages() const { return handler_.num_messages(); }
+
+ private:
+  void Add(std::string local_id) {
+    auto router = std::make_unique<EndpointRouter>();
+    for (const char* namespace_ : kNamespaces) {
+      router->AddNamespaceHandler(namespace_, &handler_);
+    }
+    router_->AddHandlerForLocalId(std::move(local_id), router.get());
+    namespace_routers_.push_back(std::move(router));
+  }
+
+  Router* const router_;
+  CountingHandler handler_;
+  std::vector<std::unique_ptr<EndpointRouter>> namespace_routers_;
+};
+
+// A receiver with both kinds of routers, each having the same connections.
+struct Receiver {
+  Receiver(int num_connections, bool share_one_socket)
+      : endpoints(&router), legacy_endpoints(&legacy_router) {
+    std::mt19937 random_engine(num_connections);
+    const int num_senders = num_connections / 2;
+    for (int i = 0; i < num_senders; ++i) {
+      if (!share_one_socket || sockets.empty()) {
+        auto socket = std::make_unique<CastSocket>(
+            std::make_unique<NullTlsConnection>(), &router);
+        sockets.push_back(socket.get());
+        legacy_router.TakeSocket(socket.get());
+        router.TakeSocket(&error_handler, std::move(socket));
+      }
+      CastSocket* const socket = sockets.back();
+      senders.emplace_back(socket, "sender-" + std::to_string(random_engine()));
+
+      for (const std::string& local_id :
+           {std::string(kPlatformReceiverId), GetAppId(i % kNumApps)}) {
+        const VirtualConnection virtual_connection{
+            local_id, senders.back().second, socket->socket_id()};
+        router.AddConnection(virtual_connection, {});
+        legacy_router.AddConnection(virtual_connection);
+      }
+    }
+  }
+
+  NullSocketErrorHandler error_handler;
+  VirtualConnectionRouter router;
+  Endpoints<VirtualConnectionRouter, NamespaceRouter> endpoints;
+  StringKeyedRouter legacy_router;
+  Endpoints<StringKeyedRouter, StringKeyedNamespaceRouter> legacy_endpoints;
+
+  std::vector<CastSocket*> sockets;  // Owned by |router|.
+  std::vector<std::pair<CastSocket*, std::string /* sender_id */>> senders;
+};
+
+// Runs |pass| |repetitions| times, and returns the time taken by the fastest
+// run divided by |operations_per_pass|. |pass| is called with a function that
+// starts the clock, so that it can first do any setup that should not be
+// timed.
+template <typename Pass>
+std::chrono::duration<double> TimeOperation(int repetitions,
+                                            int operations_per_pass,
+                                            Pass pass) {
+  std::chrono::duration<double> fastest = std::chrono::hours(1);
+  for (int i = 0; i < repetitions; ++i) {
+    std::chrono::steady_clock::time_point start_time;
+    pass([&start_time] { start_time = std::chrono::steady_clock::now(); });
+    fastest = std::min<std::chrono::duration<double>>(
+        fastest, std::chrono::steady_clock::now() - start_time);
+  }
+  return fastest / operations_per_pass;
+}
+
+// Dispatches all of the |messages| to |router| in each pass. Copying the
+// messages is not timed, since the routers take ownership of each message.
+template <typename Router>
+std::chrono::duration<double> TimeDispatch(
+    Router* router,
+    const std::vector<std::pair<CastSocket*, CastMessage>>& messages,
+    int repetitions) {
+  return TimeOperation(repetitions, messages.size(),
+                       [&](const auto& start_clock) {
+                         auto copies = messages;
+                         start_clock();
+                         for (auto& entry : copies) {
+                           router->OnMessage(entry.first,
+                                             std::move(entry.second));
+                         }
+                       });
+}
+
+// Connects a sender to an app, and then removes all of the app's connections,
+// as when the app stops.
+template <typename Router, typename AddConnection>
+std::chrono::duration<double> TimeAppStop(Router* router,
+                                          const Receiver& receiver,
+                                          int repetitions,
+                                          AddConnection add_connection) {
+  return TimeOperation(
+      repetitions, kNumRemovals, [&](const auto& start_clock) {
+        start_clock();
+        for (int i = 0; i < kNumRemovals; ++i) {
+          const auto& sender = receiver.senders[i % receiver.senders.size()];
+          add_connection(VirtualConnection{kTransientAppId, sender.second,
+                                           sender.first->socket_id()});
+          router->RemoveConnectionsByLocalId(kTransientAppId);
+        }
+      });
+}
+
+template <typename Router>
+std::chrono::duration<double> TimeBroadcast(Router* router, int repetitions) {
+  const CastMessage message = MakeSimpleUTF8Message(
+      kMediaNamespace, R"({"type":"MEDIA_STATUS","status":[]})");
+  return TimeOperation(
+      repetitions, kNumBroadcasts, [&](const auto& start_clock) {
+        start_clock();
+        for (int i = 0; i < kNumBroadcasts; ++i) {
+          const Error error =
+              router->BroadcastFromLocalPeer(GetAppId(0), message);
+          OSP_CHECK(error.ok()) << error;
+        }
+      });
+}
+
+void ReportResult(const char* name,
+                  std::chrono::duration<double> elapsed,
+                  std::chrono::duration<double> legacy_elapsed,
+                  const char* unit) {
+  std::cout << "  " << std::left << std::setw(26) << name << std::right
+            << std::setw(12) << (elapsed.count() * 1e9) << std::setw(12)
+            << (legacy_elapsed.count() * 1e9) << " ns/" << unit << "\n";
+}
+
+// Benchmarks all of the operations with |num_connections| connections, and
+// returns false if any messages were not routed as expected.
+bool RunScenario(int num_connections, bool share_one_socket, int repetitions) {
+  Receiver receiver(num_connections, share_one_socket);
+
+  // Alternate between platform and app messages from random senders.
+  std::mt19937 random_engine(42);
+  std::uniform_int_distribution<size_t> pick_sender(
+      0, receiver.senders.size() - 1);
+  std::vector<std::pair<CastSocket*, CastMessage>> messages;
+  for (int i = 0; i < kNumDistinctMessages; ++i) {
+    const size_t sender = pick_sender(random_engine);
+    const bool to_app = (i % 2) != 0;
+    CastMessage message = MakeSimpleUTF8Message(
+        to_app ? kMediaNamespace : kReceiverNamespace,
+        R"({"type":"GET_STATUS","requestId":1})");
+    message.set_source_id(receiver.senders[sender].second);
+    message.set_destination_id(to_app ? GetAppId(sender % kNumApps)
+                                      : std::string(kPlatformReceiverId));
+    messages.emplace_back(receiver.senders[sender].first, std::move(message));
+  }
+
+  std::cout << num_connections << " virtual connections over "
+            << receiver.sockets.size() << " socket(s):\n";
+  ReportResult("dispatch",
+               TimeDispatch(&receiver.router, messages, repetitions),
+               TimeDispatch(&receiver.legacy_router, messages, repetitions),
+               "message");
+  ReportResult(
+      "RemoveConnectionsByLocalId",
+      TimeAppStop(&receiver.router, receiver, repetitions,
+                  [&receiver](VirtualConnection virtual_connection) {
+                    receiver.router.AddConnection(
+                        std::move(virtual_connection), {});
+                  }),
+      TimeAppStop(&receiver.legacy_router, receiver, repetitions,
+                  [&receiver](VirtualConnection virtual_connection) {
+                    receiver.legacy_router.AddConnection(
+                        std::move(virtual_connection));
+                  }),
+      "app stop");
+  ReportResult("BroadcastFromLocalPeer",
+               TimeBroadcast(&receiver.router, repetitions),
+               TimeBroadcast(&receiver.legacy_router, repetitions),
+               "broadcast");
+
+  // Each broadcast is also delivered to the other local endpoints.
+  const int expected_messages = (kNumDistinctMessages + kNumBroadcasts *
+                                 kNumApps) * repetitions;
+  if (receiver.endpoints.num_messages() != expected_messages ||
+      receiver.legacy_endpoints.num_messages() != expected_messages) {
+    std::cerr << "Expected " << expected_messages << " messages to be routed, "
+              << "but the VirtualConnectionRouter routed "
+              << receiver.endpoints.num_messages() << " and the legacy router "
+              << receiver.legacy_endpoints.num_messages() << ".\n";
+    return false;
+  }
+  return true;
+}
+
+void LogUsage(const char* argv0) {
+  std::cerr << "usage: " << argv0 << R"( <options>
+
+options:
+    -r, --repetitions=N: The number of passes over each operation, of which
+                         the fastest is reported. Default: 100.
+
+    -h, --help: Show this help message.
+)";
+}
+
+int RunVirtualConnectionRouterBenchmark(int argc, char* argv[]) {
+  const struct option kArgumentOptions[] = {
+      {"repetitions", required_argument, nullptr, 'r'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+
+  int repetitions = 100;
+  int ch = -1;
+  while ((ch = getopt_long(argc, argv, "r:h", kArgumentOptions, nullptr)) !=
+         -1) {
+    switch (ch) {
+      case 'r':
+        repetitions = atoi(optarg);
+        break;
+      case 'h':
+      default:
+        LogUsage(argv[0]);
+        return 1;
+    }
+  }
+  if (repetitions <= 0) {
+    LogUsage(argv[0]);
+    return 1;
+  }
+
+  SetLogLevel(LogLevel::kWarning);
+  std::cout << std::fixed << std::setprecision(1) << std::setw(40) << "current"
+            << std::setw(12) << "legacy" << "\n";
+  for (bool share_one_socket : {false, true}) {
+    for (int num_connections : kConnectionCounts) {
+      if (!RunScenario(num_connections, share_one_socket, repetitions)) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
+
+int main(int argc, char* argv[]) {
+  return openscreen::cast::RunVirtualConnectionRouterBenchmark(argc, argv);
+}
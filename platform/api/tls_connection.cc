@@ -9,4 +9,12 @@ namespace openscreen {
 TlsConnection::TlsConnection() = default;
 TlsConnection::~TlsConnection() = default;
 
+uint8_t* TlsConnection::ReserveSend(size_t len) {
+  return nullptr;
+}
+
+void TlsConnection::CommitSend(size_t len) {
+  // Nothing to do, since ReserveSend() never reserves space.
+}
+
 }  // namespace openscreen
@@ -40,6 +40,20 @@ class TlsConnection {
   // Sends a message. Returns true iff the message will be sent.
   [[nodiscard]] virtual bool Send(const void* data, size_t len) = 0;
 
+  // Reserves |len| contiguous bytes in the connection's send buffer, so that
+  // a message can be serialized directly into it instead of being copied in by
+  // Send(). Once the bytes are filled in, CommitSend() must be called to send
+  // them; they are discarded if another ReserveSend() or Send() call happens
+  // first. Returns nullptr if space cannot be reserved, either because the
+  // implementation does not support this or because there is not enough
+  // contiguous space at the moment. In that case, callers should use Send().
+  //
+  // The default implementation never reserves space.
+  virtual uint8_t* ReserveSend(size_t len);
+
+  // Sends the |len| bytes most recently returned by ReserveSend().
+  virtual void CommitSend(size_t len);
+
   // Get the local address.
   virtual IPEndpoint GetLocalEndpoint() const = 0;
 
@@ -115,6 +115,14 @@ class UdpSocket {
   // Sets the DSCP value to use for all messages sent from this socket.
   virtual void SetDscp(DscpMode state) = 0;
 
+  // Returns the path MTU, in bytes (including the IP and UDP headers), that
+  // the operating system currently knows for the route to |remote_address|.
+  // This is the interface MTU unless a smaller path MTU has been discovered
+  // along the route. Returns Error::Code::kNotImplemented if the platform
+  // cannot provide this information; callers should fall back to conservative
+  // defaults.
+  virtual ErrorOr<int> GetPathMtu(const IPAddress& remote_address) = 0;
+
  protected:
   UdpSocket();
 };
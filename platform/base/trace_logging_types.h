@@ -62,6 +62,7 @@ struct TraceCategory {
     kStandaloneReceiver = 0x01 << 4,
     kDiscovery = 0x01 << 5,
     kStandaloneSender = 0x01 << 6,
+    kStreaming = 0x01 << 7,
   };
 };
 
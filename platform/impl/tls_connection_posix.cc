@@ -99,7 +99,22 @@ void TlsConnectionPosix::SetClient(Client* client) {
 
 bool TlsConnectionPosix::Send(const void* data, size_t len) {
   OSP_DCHECK(task_runner_->IsRunningOnTaskRunner());
-  return buffer_.Push(data, len);
+  if (!buffer_.Append(data, len)) {
+    return false;
+  }
+  SchedulePublish();
+  return true;
+}
+
+uint8_t* TlsConnectionPosix::ReserveSend(size_t len) {
+  OSP_DCHECK(task_runner_->IsRunningOnTaskRunner());
+  return buffer_.GetWritableRegion(len);
+}
+
+void TlsConnectionPosix::CommitSend(size_t len) {
+  OSP_DCHECK(task_runner_->IsRunningOnTaskRunner());
+  buffer_.Commit(len);
+  SchedulePublish();
 }
 
 IPEndpoint TlsConnectionPosix::GetLocalEndpoint() const {
@@ -144,6 +159,26 @@ void TlsConnectionPosix::SendAvailableBytes() {
   }
 }
 
+void TlsConnectionPosix::SchedulePublish() {
+  // The maximum amount of application data in one TLS record.
+  constexpr size_t kMaxTlsRecordPayloadBytes = 16384;
+  if (buffer_.unpublished_bytes() >= kMaxTlsRecordPayloadBytes) {
+    buffer_.Publish();
+    return;
+  }
+
+  if (publish_scheduled_) {
+    return;
+  }
+  publish_scheduled_ = true;
+  task_runner_->PostTask([weak_this = weak_factory_.GetWeakPtr()] {
+    if (auto* self = weak_this.get()) {
+      self->publish_scheduled_ = false;
+      self->buffer_.Publish();
+    }
+  });
+}
+
 void TlsConnectionPosix::DispatchError(Error error) {
   task_runner_->PostTask([weak_this = weak_factory_.GetWeakPtr(),
                           moved_error = std::move(error)]() mutable {
@@ -34,6 +34,8 @@ class TlsConnectionPosix : public TlsConnection {
   // TlsConnection overrides.
   void SetClient(Client* client) override;
   bool Send(const void* data, size_t len) override;
+  uint8_t* ReserveSend(size_t len) override;
+  void CommitSend(size_t len) override;
   IPEndpoint GetLocalEndpoint() const override;
   IPEndpoint GetRemoteEndpoint() const override;
 
@@ -56,6 +58,12 @@ class TlsConnectionPosix : public TlsConnection {
   // has occurred.
   void DispatchError(Error error);
 
+  // Publishes the data appended to |buffer_| for sending once the current task
+  // has run, so that all of the messages sent during the task are coalesced
+  // into as few TLS records as possible. Publishes immediately if there is
+  // already enough unpublished data to fill a TLS record.
+  void SchedulePublish();
+
   TaskRunner* const task_runner_;
   PlatformClientPosix* platform_client_ = nullptr;
 
@@ -65,6 +73,7 @@ class TlsConnectionPosix : public TlsConnection {
   bssl::UniquePtr<SSL> ssl_;
 
   TlsWriteBuffer buffer_;
+  bool publish_scheduled_ = false;
 
   WeakPtrFactory<TlsConnectionPosix> weak_factory_{this};
 
@@ -16,14 +16,20 @@ TlsWriteBuffer::TlsWriteBuffer() = default;
 TlsWriteBuffer::~TlsWriteBuffer() = default;
 
 bool TlsWriteBuffer::Push(const void* data, size_t len) {
-  const size_t currently_written_bytes =
-      bytes_written_so_far_.load(std::memory_order_relaxed);
+  if (!Append(data, len)) {
+    return false;
+  }
+  Publish();
+  return true;
+}
+
+bool TlsWriteBuffer::Append(const void* data, size_t len) {
   const size_t current_read_bytes =
       bytes_read_so_far_.load(std::memory_order_acquire);
 
   // Calculates the current size of the buffer.
   const size_t bytes_currently_used =
-      currently_written_bytes - current_read_bytes;
+      bytes_appended_so_far_ - current_read_bytes;
   OSP_DCHECK_LE(bytes_currently_used, kBufferSizeBytes);
   if ((kBufferSizeBytes - bytes_currently_used) < len) {
     return false;
@@ -32,7 +38,7 @@ bool TlsWriteBuffer::Push(const void* data, size_t len) {
   // Calculates the number of bytes out of |len| to write in the first memcpy
   // operation, which is either all of |len| or the number that can be written
   // before wrapping around to the beginning of the underlying array.
-  const size_t current_write_index = currently_written_bytes % kBufferSizeBytes;
+  const size_t current_write_index = bytes_appended_so_far_ % kBufferSizeBytes;
   const size_t first_write_len =
       std::min(len, kBufferSizeBytes - current_write_index);
   memcpy(&buffer_[current_write_index], data, first_write_len);
@@ -46,12 +52,38 @@ bool TlsWriteBuffer::Push(const void* data, size_t len) {
     memcpy(buffer_, new_start, len - first_write_len);
   }
 
-  // Store and return updated values.
-  const size_t new_write_size = currently_written_bytes + len;
-  bytes_written_so_far_.store(new_write_size, std::memory_order_release);
+  bytes_appended_so_far_ += len;
   return true;
 }
 
+uint8_t* TlsWriteBuffer::GetWritableRegion(size_t len) {
+  const size_t current_read_bytes =
+      bytes_read_so_far_.load(std::memory_order_acquire);
+  const size_t bytes_currently_used =
+      bytes_appended_so_far_ - current_read_bytes;
+  OSP_DCHECK_LE(bytes_currently_used, kBufferSizeBytes);
+  const size_t current_write_index = bytes_appended_so_far_ % kBufferSizeBytes;
+  if ((kBufferSizeBytes - bytes_currently_used) < len ||
+      (kBufferSizeBytes - current_write_index) < len) {
+    return nullptr;
+  }
+  return &buffer_[current_write_index];
+}
+
+void TlsWriteBuffer::Commit(size_t len) {
+  OSP_DCHECK_LE(bytes_appended_so_far_ + len -
+                    bytes_read_so_far_.load(std::memory_order_relaxed),
+                kBufferSizeBytes);
+  OSP_DCHECK_LE(bytes_appended_so_far_ % kBufferSizeBytes + len,
+                kBufferSizeBytes);
+  bytes_appended_so_far_ += len;
+}
+
+void TlsWriteBuffer::Publish() {
+  bytes_written_so_far_.store(bytes_appended_so_far_,
+                              std::memory_order_release);
+}
+
 absl::Span<const uint8_t> TlsWriteBuffer::GetReadableRegion() {
   const size_t current_read_bytes =
       bytes_read_so_far_.load(std::memory_order_relaxed);
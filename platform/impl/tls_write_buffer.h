@@ -17,6 +17,9 @@ namespace openscreen {
 // this class is to allow for a single thread to act as a publisher of data and
 // for a separate thread to act as the consumer of that data. The data in
 // question is written to a lockless FIFO queue.
+//
+// The publisher may append data without publishing it right away, so that
+// several writes become readable (and are sent) together.
 class TlsWriteBuffer {
  public:
   TlsWriteBuffer();
@@ -27,6 +30,29 @@ class TlsWriteBuffer {
   // the data is pushed into the buffer.
   bool Push(const void* data, size_t len);
 
+  // Like Push(), but the data does not become readable until Publish() is
+  // called.
+  bool Append(const void* data, size_t len);
+
+  // Returns a pointer to |len| contiguous bytes of free space, into which data
+  // can be written in-place before calling Commit(len). Returns nullptr if
+  // there is not enough free space before the end of the underlying array
+  // (i.e., the region would wrap around).
+  uint8_t* GetWritableRegion(size_t len);
+
+  // Appends the first |len| bytes of the region returned by
+  // GetWritableRegion(), without publishing them.
+  void Commit(size_t len);
+
+  // Makes all appended data readable by the consumer thread.
+  void Publish();
+
+  // Returns the number of bytes appended, but not yet published.
+  size_t unpublished_bytes() const {
+    return bytes_appended_so_far_ -
+           bytes_written_so_far_.load(std::memory_order_relaxed);
+  }
+
   // Returns a subset of the readable region of data. At time of reading, more
   // data may be available for reading than what is represented in this Span.
   absl::Span<const uint8_t> GetReadableRegion();
@@ -48,6 +74,10 @@ class TlsWriteBuffer {
   std::atomic_size_t bytes_read_so_far_{0};
   std::atomic_size_t bytes_written_so_far_{0};
 
+  // Total number of bytes appended so far, including those not yet published
+  // to the consumer thread. Only accessed by the publisher thread.
+  size_t bytes_appended_so_far_ = 0;
+
   OSP_DISALLOW_COPY_AND_ASSIGN(TlsWriteBuffer);
 };
 
@@ -5,6 +5,8 @@
 #include "platform/impl/tls_write_buffer.h"
 
 #include <algorithm>
+#include <iterator>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -113,5 +115,52 @@ TEST(TlsWriteBufferTest, TestWrapAround) {
   EXPECT_TRUE(buffer.GetReadableRegion().empty());
 }
 
+TEST(TlsWriteBufferTest, PublishesAppendedDataTogether) {
+  TlsWriteBuffer buffer;
+  const uint8_t first[] = {1, 2, 3};
+  const uint8_t second[] = {4, 5};
+
+  EXPECT_TRUE(buffer.Append(first, sizeof(first)));
+  uint8_t* const region = buffer.GetWritableRegion(sizeof(second));
+  ASSERT_TRUE(region);
+  std::copy(std::begin(second), std::end(second), region);
+  buffer.Commit(sizeof(second));
+
+  // Nothing is readable until published.
+  EXPECT_EQ(buffer.unpublished_bytes(), sizeof(first) + sizeof(second));
+  EXPECT_TRUE(buffer.GetReadableRegion().empty());
+
+  buffer.Publish();
+  EXPECT_EQ(buffer.unpublished_bytes(), size_t{0});
+  const absl::Span<const uint8_t> readable = buffer.GetReadableRegion();
+  EXPECT_EQ(std::vector<uint8_t>(readable.begin(), readable.end()),
+            (std::vector<uint8_t>{1, 2, 3, 4, 5}));
+}
+
+TEST(TlsWriteBufferTest, WritableRegionIsContiguous) {
+  TlsWriteBuffer buffer;
+  constexpr size_t buffer_size = TlsWriteBuffer::kBufferSizeBytes;
+  std::vector<uint8_t> write_buffer(buffer_size, 1);
+
+  EXPECT_TRUE(buffer.Push(write_buffer.data(), buffer_size * 3 / 4));
+  buffer.Consume(buffer_size / 2);
+  // Buffer contents should now be: |········1111····|
+
+  // There is room for half of the buffer, but only a quarter of it is
+  // contiguous.
+  EXPECT_FALSE(buffer.GetWritableRegion(buffer_size / 2));
+  uint8_t* const region = buffer.GetWritableRegion(buffer_size / 4);
+  ASSERT_TRUE(region);
+  EXPECT_EQ(region, buffer.GetReadableRegion().data() + buffer_size / 4);
+  buffer.Commit(buffer_size / 4);
+  buffer.Publish();
+  // Buffer contents should now be: |········11111111|
+
+  // The next region starts back at the beginning of the buffer.
+  EXPECT_FALSE(buffer.GetWritableRegion(buffer_size / 2 + 1));
+  EXPECT_EQ(buffer.GetWritableRegion(buffer_size / 2),
+            buffer.GetReadableRegion().data() - buffer_size / 2);
+}
+
 }  // namespace
 }  // namespace openscreen
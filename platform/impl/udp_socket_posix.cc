@@ -571,6 +571,53 @@ void UdpSocketPosix::SetDscp(UdpSocket::DscpMode state) {
   }
 }
 
+ErrorOr<int> UdpSocketPosix::GetPathMtu(const IPAddress& remote_address) {
+#if defined(OS_LINUX)
+  // IP_MTU is only valid for connected sockets, and connecting this socket
+  // would restrict it to receiving packets from only one peer. So, query the
+  // route using a separate, short-lived socket. Nothing is sent: connect() on
+  // a UDP socket only resolves the route (and its cached path MTU).
+  constexpr uint16_t kDiscardPort = 9;
+  const bool is_v4 = remote_address.IsV4();
+  const int fd = socket(is_v4 ? AF_INET : AF_INET6, SOCK_DGRAM, 0);
+  if (fd == -1) {
+    return Error(Error::Code::kInitializationFailure, strerror(errno));
+  }
+
+  int mtu = 0;
+  socklen_t mtu_size = sizeof(mtu);
+  int result;
+  if (is_v4) {
+    struct sockaddr_in sa {};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(kDiscardPort);
+    remote_address.CopyToV4(reinterpret_cast<uint8_t*>(&sa.sin_addr.s_addr));
+    result = connect(fd, reinterpret_cast<struct sockaddr*>(&sa), sizeof(sa));
+    if (result == 0) {
+      result = getsockopt(fd, IPPROTO_IP, IP_MTU, &mtu, &mtu_size);
+    }
+  } else {
+    struct sockaddr_in6 sa {};
+    sa.sin6_family = AF_INET6;
+    sa.sin6_port = htons(kDiscardPort);
+    remote_address.CopyToV6(reinterpret_cast<uint8_t*>(&sa.sin6_addr.s6_addr));
+    result = connect(fd, reinterpret_cast<struct sockaddr*>(&sa), sizeof(sa));
+    if (result == 0) {
+      result = getsockopt(fd, IPPROTO_IPV6, IPV6_MTU, &mtu, &mtu_size);
+    }
+  }
+  const int saved_errno = errno;
+  close(fd);
+
+  if (result == -1) {
+    return Error(Error::Code::kSocketConnectFailure, strerror(saved_errno));
+  }
+  return mtu;
+#else
+  return Error::Code::kNotImplemented;
+#endif
+}
+
 void UdpSocketPosix::OnError(Error::Code error_code) {
   // The call to Close() may change |errno|, so save it here.
   const auto original_errno = errno;
@@ -44,6 +44,7 @@ class UdpSocketPosix : public UdpSocket {
                    size_t length,
                    const IPEndpoint& dest) override;
   void SetDscp(DscpMode state) override;
+  ErrorOr<int> GetPathMtu(const IPAddress& remote_address) override;
 
   const SocketHandle& GetHandle() const;
 
@@ -40,6 +40,7 @@ class MockUdpSocketPosix : public UdpSocketPosix {
                void(const IPAddress&, NetworkInterfaceIndex));
   MOCK_METHOD3(SendMessage, void(const void*, size_t, const IPEndpoint&));
   MOCK_METHOD1(SetDscp, void(DscpMode));
+  MOCK_METHOD1(GetPathMtu, ErrorOr<int>(const IPAddress&));
 
  private:
   Version version_;
@@ -51,6 +51,13 @@ void FakeUdpSocket::SetDscp(DscpMode mode) {
   ProcessConfigurationMethod(&set_dscp_errors_);
 }
 
+ErrorOr<int> FakeUdpSocket::GetPathMtu(const IPAddress& remote_address) {
+  if (path_mtu_ <= 0) {
+    return Error::Code::kNotImplemented;
+  }
+  return path_mtu_;
+}
+
 void FakeUdpSocket::MockReceivePacket(UdpPacket packet) {
   if (client_) {
     client_->OnRead(this, std::move(packet));
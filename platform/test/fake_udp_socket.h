@@ -49,6 +49,7 @@ class FakeUdpSocket : public UdpSocket {
   void JoinMulticastGroup(const IPAddress& address,
                           NetworkInterfaceIndex interface) override;
   void SetDscp(DscpMode mode) override;
+  ErrorOr<int> GetPathMtu(const IPAddress& remote_address) override;
 
   // Operatons to queue errors to be returned by the above functions
   void EnqueueBindResult(Error error) { bind_errors_.push(error); }
@@ -61,6 +62,10 @@ class FakeUdpSocket : public UdpSocket {
   }
   void EnqueueSetDscpResult(Error error) { set_dscp_errors_.push(error); }
 
+  // Sets the value returned by GetPathMtu(). If zero (the default), it returns
+  // Error::Code::kNotImplemented.
+  void set_path_mtu(int path_mtu) { path_mtu_ = path_mtu; }
+
   // Accessors for the size of the internal error queues.
   size_t bind_queue_size() { return bind_errors_.size(); }
   size_t send_queue_size() { return send_errors_.size(); }
@@ -86,6 +91,8 @@ class FakeUdpSocket : public UdpSocket {
   std::queue<Error> set_multicast_outbound_interface_errors_;
   std::queue<Error> join_multicast_group_errors_;
   std::queue<Error> set_dscp_errors_;
+
+  int path_mtu_ = 0;
 };
 
 }  // namespace openscreen
@@ -0,0 +1,166 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "platform/test/impaired_udp_socket.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "util/osp_logging.h"
+
+namespace openscreen {
+
+// static
+ErrorOr<std::unique_ptr<UdpSocket>> ImpairedUdpSocket::Create(
+    TaskRunner* task_runner,
+    ClockNowFunctionPtr now_function,
+    UdpSocket::Client* client,
+    const IPEndpoint& local_endpoint,
+    const Impairments& impairments) {
+  auto impaired = std::make_unique<ImpairedUdpSocket>(
+      task_runner, now_function, client, impairments);
+  ErrorOr<std::unique_ptr<UdpSocket>> result =
+      UdpSocket::Create(task_runner, impaired.get(), local_endpoint);
+  if (result.is_error()) {
+    return std::move(result.error());
+  }
+  impaired->set_socket(std::move(result.value()));
+  return std::unique_ptr<UdpSocket>(std::move(impaired));
+}
+
+ImpairedUdpSocket::ImpairedUdpSocket(TaskRunner* task_runner,
+                                     ClockNowFunctionPtr now_function,
+                                     UdpSocket::Client* client,
+                                     const Impairments& impairments)
+    : task_runner_(task_runner),
+      now_(now_function),
+      client_(client),
+      impairments_(impairments),
+      random_(impairments.random_seed) {
+  OSP_DCHECK(task_runner_);
+  OSP_DCHECK(now_);
+  OSP_DCHECK(client_);
+  OSP_DCHECK_GE(impairments_.loss_rate, 0.0);
+  OSP_DCHECK_LE(impairments_.loss_rate, 1.0);
+  OSP_DCHECK_GE(impairments_.reorder_rate, 0.0);
+  OSP_DCHECK_LE(impairments_.reorder_rate, 1.0);
+  OSP_DCHECK_GE(impairments_.bandwidth_cap, 0);
+}
+
+ImpairedUdpSocket::~ImpairedUdpSocket() = default;
+
+bool ImpairedUdpSocket::IsIPv4() const {
+  return socket_->IsIPv4();
+}
+
+bool ImpairedUdpSocket::IsIPv6() const {
+  return socket_->IsIPv6();
+}
+
+IPEndpoint ImpairedUdpSocket::GetLocalEndpoint() const {
+  return socket_->GetLocalEndpoint();
+}
+
+void ImpairedUdpSocket::Bind() {
+  socket_->Bind();
+}
+
+void ImpairedUdpSocket::SetMulticastOutboundInterface(
+    NetworkInterfaceIndex ifindex) {
+  socket_->SetMulticastOutboundInterface(ifindex);
+}
+
+void ImpairedUdpSocket::JoinMulticastGroup(const IPAddress& address,
+                                           NetworkInterfaceIndex ifindex) {
+  socket_->JoinMulticastGroup(address, ifindex);
+}
+
+void ImpairedUdpSocket::SendMessage(const void* data,
+                                    size_t length,
+                                    const IPEndpoint& dest) {
+  OSP_DCHECK(socket_);
+  ++num_packets_sent_;
+  if (ShouldApply(impairments_.loss_rate)) {
+    ++num_packets_lost_;
+    return;
+  }
+
+  // Queue the packet behind those already being transmitted over the link.
+  const Clock::time_point now = now_();
+  Clock::time_point departure_time = now;
+  if (impairments_.bandwidth_cap > 0) {
+    const Clock::duration transmit_duration =
+        std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(length) * 8 /
+                                          impairments_.bandwidth_cap));
+    departure_time = std::max(now, link_free_time_) + transmit_duration;
+    if (departure_time - now > impairments_.max_queue_delay) {
+      ++num_packets_dropped_by_queue_;
+      return;
+    }
+    link_free_time_ = departure_time;
+  }
+
+  Clock::duration delay = (departure_time - now) + impairments_.delay;
+  if (impairments_.jitter > Clock::duration::zero()) {
+    std::uniform_int_distribution<Clock::rep> jitter(
+        0, impairments_.jitter.count());
+    delay += Clock::duration(jitter(random_));
+  }
+  if (ShouldApply(impairments_.reorder_rate)) {
+    delay += impairments_.reorder_delay;
+  }
+
+  if (delay <= Clock::duration::zero()) {
+    socket_->SendMessage(data, length, dest);
+    return;
+  }
+  const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+  task_runner_->PostTaskWithDelay(
+      [weak_this = weak_factory_.GetWeakPtr(),
+       packet = std::vector<uint8_t>(bytes, bytes + length), dest] {
+        if (weak_this) {
+          weak_this->socket_->SendMessage(packet.data(), packet.size(), dest);
+        }
+      },
+      delay);
+}
+
+void ImpairedUdpSocket::SetDscp(DscpMode state) {
+  socket_->SetDscp(state);
+}
+
+ErrorOr<int> ImpairedUdpSocket::GetPathMtu(const IPAddress& remote_address) {
+  return socket_->GetPathMtu(remote_address);
+}
+
+void ImpairedUdpSocket::OnBound(UdpSocket* socket) {
+  client_->OnBound(this);
+}
+
+void ImpairedUdpSocket::OnError(UdpSocket* socket, Error error) {
+  client_->OnError(this, std::move(error));
+}
+
+void ImpairedUdpSocket::OnSendError(UdpSocket* socket, Error error) {
+  client_->OnSendError(this, std::move(error));
+}
+
+void ImpairedUdpSocket::OnRead(UdpSocket* socket, ErrorOr<UdpPacket> packet) {
+  if (packet.is_value()) {
+    packet.value().set_socket(this);
+  }
+  client_->OnRead(this, std::move(packet));
+}
+
+bool ImpairedUdpSocket::ShouldApply(double probability) {
+  if (probability <= 0.0) {
+    return false;
+  }
+  return std::uniform_real_distribution<double>(0.0, 1.0)(random_) <
+         probability;
+}
+
+}  // namespace openscreen
@@ -0,0 +1,129 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PLATFORM_TEST_IMPAIRED_UDP_SOCKET_H_
+#define PLATFORM_TEST_IMPAIRED_UDP_SOCKET_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <memory>
+#include <random>
+
+#include "platform/api/task_runner.h"
+#include "platform/api/time.h"
+#include "platform/api/udp_socket.h"
+#include "platform/base/error.h"
+#include "util/weak_ptr.h"
+
+namespace openscreen {
+
+// A UdpSocket decorator that simulates an impaired network link on the send
+// path: Outbound packets are randomly dropped, delayed, reordered, and queued
+// behind a bandwidth-limited "link" before being passed to the wrapped socket.
+// Everything else, including all Client callbacks, is passed through. This is
+// used to benchmark and test streaming over loopback under realistic network
+// conditions.
+class ImpairedUdpSocket final : public UdpSocket, public UdpSocket::Client {
+ public:
+  struct Impairments {
+    // The fraction of packets dropped at random, in the range [0,1].
+    double loss_rate = 0.0;
+
+    // The one-way delay added to every packet, plus a random amount in the
+    // range [0,jitter]. Jitter alone may cause packets to be reordered.
+    Clock::duration delay{};
+    Clock::duration jitter{};
+
+    // The fraction of packets, in the range [0,1], that are held back for an
+    // additional |reorder_delay|, allowing later packets to overtake them.
+    double reorder_rate = 0.0;
+    Clock::duration reorder_delay = std::chrono::milliseconds(10);
+
+    // The link capacity in bits per second, or zero for unlimited. Packets are
+    // queued behind each other at this rate, and those that would wait longer
+    // than |max_queue_delay| are dropped (like a drop-tail router queue).
+    int64_t bandwidth_cap = 0;
+    Clock::duration max_queue_delay = std::chrono::milliseconds(250);
+
+    // Seeds the pseudo-random decisions, so runs are reproducible.
+    uint32_t random_seed = 1;
+  };
+
+  // Creates a UdpSocket (see UdpSocket::Create()) wrapped by an
+  // ImpairedUdpSocket that reports to the given |client|.
+  static ErrorOr<std::unique_ptr<UdpSocket>> Create(
+      TaskRunner* task_runner,
+      ClockNowFunctionPtr now_function,
+      UdpSocket::Client* client,
+      const IPEndpoint& local_endpoint,
+      const Impairments& impairments);
+
+  // Constructs an instance that reports to the given |client|. set_socket()
+  // must be called before use, with a socket whose Client is this instance.
+  ImpairedUdpSocket(TaskRunner* task_runner,
+                    ClockNowFunctionPtr now_function,
+                    UdpSocket::Client* client,
+                    const Impairments& impairments);
+  ~ImpairedUdpSocket() override;
+
+  void set_socket(std::unique_ptr<UdpSocket> socket) {
+    socket_ = std::move(socket);
+  }
+  const Impairments& impairments() const { return impairments_; }
+
+  // The number of packets passed to SendMessage(), and the number dropped at
+  // random or because the link's queue was full.
+  int num_packets_sent() const { return num_packets_sent_; }
+  int num_packets_lost() const { return num_packets_lost_; }
+  int num_packets_dropped_by_queue() const {
+    return num_packets_dropped_by_queue_;
+  }
+
+  // UdpSocket overrides.
+  bool IsIPv4() const override;
+  bool IsIPv6() const override;
+  IPEndpoint GetLocalEndpoint() const override;
+  void Bind() override;
+  void SetMulticastOutboundInterface(NetworkInterfaceIndex ifindex) override;
+  void JoinMulticastGroup(const IPAddress& address,
+                          NetworkInterfaceIndex ifindex) override;
+  void SendMessage(const void* data,
+                   size_t length,
+                   const IPEndpoint& dest) override;
+  void SetDscp(DscpMode state) override;
+  ErrorOr<int> GetPathMtu(const IPAddress& remote_address) override;
+
+  // UdpSocket::Client overrides.
+  void OnBound(UdpSocket* socket) override;
+  void OnError(UdpSocket* socket, Error error) override;
+  void OnSendError(UdpSocket* socket, Error error) override;
+  void OnRead(UdpSocket* socket, ErrorOr<UdpPacket> packet) override;
+
+ private:
+  // Returns true with the given |probability|.
+  bool ShouldApply(double probability);
+
+  TaskRunner* const task_runner_;
+  const ClockNowFunctionPtr now_;
+  UdpSocket::Client* const client_;
+  const Impairments impairments_;
+  std::unique_ptr<UdpSocket> socket_;
+
+  std::minstd_rand random_;
+
+  // When the simulated link will have finished transmitting the packets queued
+  // so far.
+  Clock::time_point link_free_time_ = Clock::time_point::min();
+
+  int num_packets_sent_ = 0;
+  int num_packets_lost_ = 0;
+  int num_packets_dropped_by_queue_ = 0;
+
+  WeakPtrFactory<ImpairedUdpSocket> weak_factory_{this};
+};
+
+}  // namespace openscreen
+
+#endif  // PLATFORM_TEST_IMPAIRED_UDP_SOCKET_H_
@@ -0,0 +1,173 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "platform/test/impaired_udp_socket.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "platform/test/fake_clock.h"
+#include "platform/test/fake_task_runner.h"
+#include "platform/test/fake_udp_socket.h"
+#include "platform/test/mock_udp_socket.h"
+
+namespace openscreen {
+namespace {
+
+using std::chrono::milliseconds;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::StrictMock;
+
+const IPEndpoint kDestination{IPAddress(127, 0, 0, 1), 2344};
+
+class ImpairedUdpSocketTest : public ::testing::Test {
+ public:
+  ImpairedUdpSocketTest()
+      : clock_(Clock::now()),
+        task_runner_(&clock_),
+        start_time_(FakeClock::now()) {}
+
+  // Creates the ImpairedUdpSocket under test, wrapping a MockUdpSocket that
+  // records the index (the first byte) of each packet sent, and when.
+  std::unique_ptr<ImpairedUdpSocket> CreateSocket(
+      const ImpairedUdpSocket::Impairments& impairments) {
+    auto impaired = std::make_unique<ImpairedUdpSocket>(
+        &task_runner_, &FakeClock::now, &client_, impairments);
+    auto inner = std::make_unique<StrictMock<MockUdpSocket>>();
+    inner_ = inner.get();
+    ON_CALL(*inner_, SendMessage(_, _, _))
+        .WillByDefault(
+            Invoke([this](const void* data, size_t, const IPEndpoint& dest) {
+              EXPECT_EQ(kDestination, dest);
+              sent_indices_.push_back(*static_cast<const uint8_t*>(data));
+              sent_times_.push_back(FakeClock::now() - start_time_);
+            }));
+    EXPECT_CALL(*inner_, SendMessage(_, _, _)).Times(::testing::AnyNumber());
+    impaired->set_socket(std::move(inner));
+    return impaired;
+  }
+
+  // Sends |count| packets of the given |size|, whose indices start at
+  // |first_index|.
+  static void SendPackets(UdpSocket* socket,
+                          int count,
+                          size_t size,
+                          int first_index = 0) {
+    for (int i = first_index; i < first_index + count; ++i) {
+      std::vector<uint8_t> packet(size, static_cast<uint8_t>(i));
+      socket->SendMessage(packet.data(), packet.size(), kDestination);
+    }
+  }
+
+  void AdvanceClock(Clock::duration duration) { clock_.Advance(duration); }
+
+  FakeUdpSocket::MockClient* client() { return &client_; }
+  MockUdpSocket* inner() { return inner_; }
+  const std::vector<uint8_t>& sent_indices() const { return sent_indices_; }
+  const std::vector<Clock::duration>& sent_times() const { return sent_times_; }
+
+ private:
+  FakeClock clock_;
+  FakeTaskRunner task_runner_;
+  const Clock::time_point start_time_;
+  StrictMock<FakeUdpSocket::MockClient> client_;
+  MockUdpSocket* inner_ = nullptr;
+  std::vector<uint8_t> sent_indices_;
+  std::vector<Clock::duration> sent_times_;
+};
+
+TEST_F(ImpairedUdpSocketTest, PassesPacketsThroughWithoutImpairments) {
+  auto socket = CreateSocket(ImpairedUdpSocket::Impairments{});
+  SendPackets(socket.get(), 3, 100);
+  EXPECT_EQ((std::vector<uint8_t>{0, 1, 2}), sent_indices());
+  EXPECT_EQ(3, socket->num_packets_sent());
+  EXPECT_EQ(0, socket->num_packets_lost());
+}
+
+TEST_F(ImpairedUdpSocketTest, DelaysPacketsWithJitter) {
+  ImpairedUdpSocket::Impairments impairments;
+  impairments.delay = milliseconds(50);
+  impairments.jitter = milliseconds(10);
+  auto socket = CreateSocket(impairments);
+
+  SendPackets(socket.get(), 100, 100);
+  AdvanceClock(milliseconds(49));
+  EXPECT_TRUE(sent_indices().empty());
+  AdvanceClock(milliseconds(11));
+  ASSERT_EQ(100u, sent_indices().size());
+  for (Clock::duration sent_time : sent_times()) {
+    EXPECT_LE(milliseconds(50), sent_time);
+    EXPECT_GE(milliseconds(60), sent_time);
+  }
+  EXPECT_FALSE(std::is_sorted(sent_indices().begin(), sent_indices().end()));
+}
+
+TEST_F(ImpairedUdpSocketTest, DropsPacketsAtTheConfiguredRate) {
+  ImpairedUdpSocket::Impairments impairments;
+  impairments.loss_rate = 0.25;
+  auto socket = CreateSocket(impairments);
+
+  SendPackets(socket.get(), 10000, 10);
+  EXPECT_EQ(10000, socket->num_packets_sent());
+  EXPECT_NEAR(2500, socket->num_packets_lost(), 200);
+  EXPECT_EQ(10000 - socket->num_packets_lost(),
+            static_cast<int>(sent_indices().size()));
+}
+
+TEST_F(ImpairedUdpSocketTest, ReordersSomePackets) {
+  ImpairedUdpSocket::Impairments impairments;
+  impairments.reorder_rate = 0.5;
+  impairments.reorder_delay = milliseconds(5);
+  auto socket = CreateSocket(impairments);
+
+  for (int i = 0; i < 10; ++i) {
+    SendPackets(socket.get(), 1, 10, i);
+    AdvanceClock(milliseconds(1));
+  }
+  AdvanceClock(milliseconds(5));
+  ASSERT_EQ(10u, sent_indices().size());
+  EXPECT_FALSE(std::is_sorted(sent_indices().begin(), sent_indices().end()));
+}
+
+// Tests that packets are queued behind each other at the link's capacity, and
+// dropped once the queue would delay them for too long.
+TEST_F(ImpairedUdpSocketTest, LimitsBandwidthWithDropTailQueue) {
+  ImpairedUdpSocket::Impairments impairments;
+  impairments.bandwidth_cap = 1000000;  // 1250 bytes take 10 ms.
+  impairments.max_queue_delay = milliseconds(100);
+  auto socket = CreateSocket(impairments);
+
+  SendPackets(socket.get(), 20, 1250);
+  EXPECT_EQ(10, socket->num_packets_dropped_by_queue());
+  AdvanceClock(milliseconds(100));
+  ASSERT_EQ(10u, sent_indices().size());
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(i, sent_indices()[i]);
+    EXPECT_EQ(milliseconds(10 * (i + 1)), sent_times()[i]);
+  }
+}
+
+TEST_F(ImpairedUdpSocketTest, ForwardsClientCallbacksAsThisSocket) {
+  auto socket = CreateSocket(ImpairedUdpSocket::Impairments{});
+
+  EXPECT_CALL(*client(), OnBound(socket.get()));
+  socket->OnBound(inner());
+
+  EXPECT_CALL(*client(), OnReadInternal(socket.get(), _))
+      .WillOnce(Invoke([&](UdpSocket*, const ErrorOr<UdpPacket>& packet) {
+        ASSERT_TRUE(packet.is_value());
+        EXPECT_EQ(socket.get(), packet.value().socket());
+      }));
+  UdpPacket packet;
+  packet.set_socket(inner());
+  socket->OnRead(inner(), std::move(packet));
+}
+
+}  // namespace
+}  // namespace openscreen
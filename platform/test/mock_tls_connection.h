@@ -5,6 +5,8 @@
 #ifndef PLATFORM_TEST_MOCK_TLS_CONNECTION_H_
 #define PLATFORM_TEST_MOCK_TLS_CONNECTION_H_
 
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "platform/api/tls_connection.h"
 
@@ -24,6 +26,23 @@ class MockTlsConnection : public TlsConnection {
 
   MOCK_METHOD(bool, Send, (const void* data, size_t len), (override));
 
+  // Once enabled, ReserveSend() provides space in a local buffer, and
+  // CommitSend() passes the committed bytes to Send(), so tests can check the
+  // data sent either way.
+  void set_reserve_send_enabled(bool enabled) {
+    reserve_send_enabled_ = enabled;
+  }
+  uint8_t* ReserveSend(size_t len) override {
+    if (!reserve_send_enabled_) {
+      return nullptr;
+    }
+    reserved_.resize(len);
+    return reserved_.data();
+  }
+  void CommitSend(size_t len) override {
+    static_cast<void>(Send(reserved_.data(), len));
+  }
+
   IPEndpoint GetLocalEndpoint() const override { return local_address_; }
   IPEndpoint GetRemoteEndpoint() const override { return remote_address_; }
 
@@ -40,6 +59,8 @@ class MockTlsConnection : public TlsConnection {
 
  private:
   Client* client_;
+  bool reserve_send_enabled_ = false;
+  std::vector<uint8_t> reserved_;
   const IPEndpoint local_address_;
   const IPEndpoint remote_address_;
 };
@@ -27,6 +27,7 @@ class MockUdpSocket : public UdpSocket {
                void(const IPAddress&, NetworkInterfaceIndex));
   MOCK_METHOD3(SendMessage, void(const void*, size_t, const IPEndpoint&));
   MOCK_METHOD1(SetDscp, void(UdpSocket::DscpMode));
+  MOCK_METHOD1(GetPathMtu, ErrorOr<int>(const IPAddress&));
 };
 
 }  // namespace openscreen